@@ -0,0 +1,203 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "alertprofiler.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+using namespace BitTorrent;
+
+namespace
+{
+    quint64 toMicroseconds(const AlertProfiler::Clock::duration duration)
+    {
+        const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        return static_cast<quint64>(std::max<decltype(microseconds)>(microseconds, 0));
+    }
+}
+
+void LatencyHistogram::record(quint64 value)
+{
+    value = std::min(value, MAX_VALUE);
+
+    ++m_counts[bucketIndex(value)];
+    m_min = (m_count == 0) ? value : std::min(m_min, value);
+    m_max = std::max(m_max, value);
+    m_total += value;
+    ++m_count;
+}
+
+void LatencyHistogram::reset()
+{
+    m_counts.fill(0);
+    m_count = 0;
+    m_total = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+quint64 LatencyHistogram::count() const
+{
+    return m_count;
+}
+
+quint64 LatencyHistogram::min() const
+{
+    return m_min;
+}
+
+quint64 LatencyHistogram::max() const
+{
+    return m_max;
+}
+
+double LatencyHistogram::mean() const
+{
+    return (m_count > 0) ? (static_cast<double>(m_total) / m_count) : 0;
+}
+
+quint64 LatencyHistogram::valueAtPercentile(const double percentile) const
+{
+    if (m_count == 0)
+        return 0;
+
+    const double ratio = std::clamp(percentile, 0.0, 100.0) / 100;
+    const auto target = std::max<quint64>(static_cast<quint64>(std::ceil(ratio * m_count)), 1);
+
+    quint64 accumulated = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        accumulated += m_counts[i];
+        if (accumulated >= target)
+            return std::clamp(bucketHighestValue(i), m_min, m_max);
+    }
+
+    return m_max;
+}
+
+int LatencyHistogram::bucketIndex(const quint64 value)
+{
+    // values below 2^SUB_BUCKET_BITS have a bucket each, above that every power of two
+    // range is split into SUB_BUCKET_HALF_COUNT buckets
+    const int magnitude = std::max((std::bit_width(value) - SUB_BUCKET_BITS), 0);
+    return (magnitude * SUB_BUCKET_HALF_COUNT) + static_cast<int>(value >> magnitude);
+}
+
+quint64 LatencyHistogram::bucketHighestValue(const int index)
+{
+    if (index < (2 * SUB_BUCKET_HALF_COUNT))
+        return index;
+
+    const int magnitude = (index / SUB_BUCKET_HALF_COUNT) - 1;
+    const quint64 subBucket = index - (magnitude * SUB_BUCKET_HALF_COUNT);
+    return ((subBucket + 1) << magnitude) - 1;
+}
+
+void AlertProfiler::recordBatch(const qsizetype alertCount)
+{
+    m_batchSizes.record(static_cast<quint64>(alertCount));
+}
+
+void AlertProfiler::recordAlert(const int type, const char *name, const Clock::duration handlingTime)
+{
+    if (type < 0) [[unlikely]]
+        return;
+
+    const auto index = static_cast<std::size_t>(type);
+    if (index >= m_alertTypes.size())
+        m_alertTypes.resize(index + 1);
+
+    std::unique_ptr<AlertTypeStatistics> &statistics = m_alertTypes[index];
+    if (!statistics) [[unlikely]]
+        statistics.reset(new AlertTypeStatistics {.type = type, .name = QString::fromLatin1(name)});
+
+    statistics->handlingTime.record(toMicroseconds(handlingTime));
+}
+
+void AlertProfiler::torrentUpdatesPosted(const Clock::time_point time)
+{
+    if (!m_pendingTorrentUpdates)
+        m_pendingTorrentUpdates = time;
+}
+
+void AlertProfiler::torrentUpdatesReceived(const Clock::time_point time)
+{
+    if (!m_pendingTorrentUpdates)
+        return;
+
+    m_stateUpdateLatency.record(toMicroseconds(time - *m_pendingTorrentUpdates));
+    m_pendingTorrentUpdates.reset();
+}
+
+void AlertProfiler::recordTorrentsUpdatedHandlers(const Clock::duration handlingTime)
+{
+    m_torrentsUpdatedHandlers.record(toMicroseconds(handlingTime));
+}
+
+void AlertProfiler::reset()
+{
+    m_startTime = Clock::now();
+    m_batchSizes.reset();
+    m_stateUpdateLatency.reset();
+    m_torrentsUpdatedHandlers.reset();
+    m_pendingTorrentUpdates.reset();
+    m_alertTypes.clear();
+}
+
+AlertProfiler::Clock::time_point AlertProfiler::startTime() const
+{
+    return m_startTime;
+}
+
+const LatencyHistogram &AlertProfiler::batchSizes() const
+{
+    return m_batchSizes;
+}
+
+const LatencyHistogram &AlertProfiler::stateUpdateLatency() const
+{
+    return m_stateUpdateLatency;
+}
+
+const LatencyHistogram &AlertProfiler::torrentsUpdatedHandlers() const
+{
+    return m_torrentsUpdatedHandlers;
+}
+
+QList<const AlertProfiler::AlertTypeStatistics *> AlertProfiler::alertTypes() const
+{
+    QList<const AlertTypeStatistics *> result;
+    for (const std::unique_ptr<AlertTypeStatistics> &statistics : m_alertTypes)
+    {
+        if (statistics)
+            result.append(statistics.get());
+    }
+    return result;
+}
@@ -0,0 +1,116 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <QtTypes>
+#include <QList>
+#include <QString>
+
+namespace BitTorrent
+{
+    // Histogram of non-negative values with fixed memory and at most 1/16 relative error,
+    // buckets are laid out the same way as in HdrHistogram
+    class LatencyHistogram
+    {
+    public:
+        static constexpr int VALUE_BITS = 40;
+        static constexpr quint64 MAX_VALUE = (quint64 {1} << VALUE_BITS) - 1; // larger values are clamped
+
+        void record(quint64 value);
+        void reset();
+
+        quint64 count() const;
+        quint64 min() const;
+        quint64 max() const;
+        double mean() const;
+        // Highest value that is equivalent (within histogram precision) to the value at `percentile` (0..100)
+        quint64 valueAtPercentile(double percentile) const;
+
+    private:
+        static constexpr int SUB_BUCKET_BITS = 5;
+        static constexpr int SUB_BUCKET_HALF_COUNT = (1 << (SUB_BUCKET_BITS - 1));
+        static constexpr int BUCKET_COUNT = (VALUE_BITS - SUB_BUCKET_BITS + 2) * SUB_BUCKET_HALF_COUNT;
+
+        static int bucketIndex(quint64 value);
+        static quint64 bucketHighestValue(int index);
+
+        std::array<quint64, BUCKET_COUNT> m_counts {};
+        quint64 m_count = 0;
+        quint64 m_total = 0;
+        quint64 m_min = 0;
+        quint64 m_max = 0;
+    };
+
+    // Collects timings of the alert loop. Durations are recorded in microseconds.
+    class AlertProfiler
+    {
+        Q_DISABLE_COPY_MOVE(AlertProfiler)
+
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct AlertTypeStatistics
+        {
+            int type = -1;
+            QString name;
+            LatencyHistogram handlingTime;
+        };
+
+        AlertProfiler() = default;
+
+        void recordBatch(qsizetype alertCount);
+        void recordAlert(int type, const char *name, Clock::duration handlingTime);
+        // Remembers the time of the first `post_torrent_updates()` that isn't answered yet
+        void torrentUpdatesPosted(Clock::time_point time = Clock::now());
+        void torrentUpdatesReceived(Clock::time_point time = Clock::now());
+        void recordTorrentsUpdatedHandlers(Clock::duration handlingTime);
+        void reset();
+
+        Clock::time_point startTime() const;
+        const LatencyHistogram &batchSizes() const;
+        const LatencyHistogram &stateUpdateLatency() const;
+        const LatencyHistogram &torrentsUpdatedHandlers() const;
+        // Statistics of the alert types that were seen, ordered by type
+        QList<const AlertTypeStatistics *> alertTypes() const;
+
+    private:
+        Clock::time_point m_startTime = Clock::now();
+        LatencyHistogram m_batchSizes;
+        LatencyHistogram m_stateUpdateLatency;
+        LatencyHistogram m_torrentsUpdatedHandlers;
+        std::optional<Clock::time_point> m_pendingTorrentUpdates;
+        std::vector<std::unique_ptr<AlertTypeStatistics>> m_alertTypes; // indexed by alert type
+    };
+}
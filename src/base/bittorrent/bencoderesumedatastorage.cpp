@@ -28,7 +28,12 @@
 
 #include "bencoderesumedatastorage.h"
 
+#include <iterator>
+#include <utility>
+#include <vector>
+
 #include <libtorrent/bdecode.hpp>
+#include <libtorrent/bencode.hpp>
 #include <libtorrent/entry.hpp>
 #include <libtorrent/read_resume_data.hpp>
 #include <libtorrent/torrent_info.hpp>
@@ -40,6 +45,7 @@
 
 #include <QByteArray>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QRegularExpression>
 #include <QThread>
@@ -148,6 +154,14 @@ QList<BitTorrent::TorrentID> BitTorrent::BencodeResumeDataStorage::registeredTor
 
 BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::load(const TorrentID &id) const
 {
+    return load(id, nullptr);
+}
+
+BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::load(const TorrentID &id, LoadStatistics *statistics) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
     const QString idString = id.toString();
     const Path fastresumePath = path() / Path(idString + u".fastresume");
     const Path torrentFilePath = path() / Path(idString + u".torrent");
@@ -166,17 +180,42 @@ BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::load(cons
 
     const QByteArray data = resumeDataReadResult.value();
     const QByteArray metadata = metadataReadResult.value_or(QByteArray());
-    return loadTorrentResumeData(data, metadata);
+
+    if (!statistics)
+        return decodeResumeData(data, metadata);
+
+    statistics->readTime += timer.nsecsElapsed();
+    timer.restart();
+    LoadResumeDataResult result = decodeResumeData(data, metadata);
+    statistics->decodeTime += timer.nsecsElapsed();
+    return result;
 }
 
 void BitTorrent::BencodeResumeDataStorage::doLoadAll() const
 {
     qDebug() << "Loading torrents count: " << m_registeredTorrents.size();
 
+    QElapsedTimer timer;
+    timer.start();
+
     emit const_cast<BencodeResumeDataStorage *>(this)->loadStarted(m_registeredTorrents);
 
-    for (const TorrentID &torrentID : asConst(m_registeredTorrents))
-        onResumeDataLoaded(torrentID, load(torrentID));
+    // Resume data is loaded by batches so the loaded torrents
+    // can be added to the session while the next batch is being loaded
+    LoadStatistics statistics;
+    for (qsizetype batchStart = 0; batchStart < m_registeredTorrents.size(); batchStart += LOAD_BATCH_SIZE)
+    {
+        const QList<TorrentID> batch = m_registeredTorrents.mid(batchStart, LOAD_BATCH_SIZE);
+        std::vector<LoadResumeDataResult> results = loadInParallel(batch.size(), [this, &batch, &statistics](const qsizetype index)
+        {
+            return load(batch[index], &statistics);
+        });
+
+        for (qsizetype i = 0; i < batch.size(); ++i)
+            onResumeDataLoaded(batch[i], std::move(results[static_cast<std::size_t>(i)]));
+    }
+
+    logLoadStatistics(m_registeredTorrents.size(), timer.elapsed(), statistics);
 
     emit const_cast<BencodeResumeDataStorage *>(this)->loadFinished();
 }
@@ -226,7 +265,7 @@ void BitTorrent::BencodeResumeDataStorage::loadQueue(const Path &queueFilename)
     }
 }
 
-BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::loadTorrentResumeData(const QByteArray &data, const QByteArray &metadata) const
+BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::decodeResumeData(const QByteArray &data, const QByteArray &metadata)
 {
     const auto *pref = Preferences::instance();
 
@@ -374,36 +413,7 @@ BitTorrent::LoadResumeDataResult BitTorrent::BencodeResumeDataStorage::loadTorre
     return torrentParams;
 }
 
-void BitTorrent::BencodeResumeDataStorage::store(const TorrentID &id, LoadTorrentParams resumeData) const
-{
-    QMetaObject::invokeMethod(m_asyncWorker, [this, id, resumeData = std::move(resumeData)]
-    {
-        m_asyncWorker->store(id, resumeData);
-    });
-}
-
-void BitTorrent::BencodeResumeDataStorage::remove(const TorrentID &id) const
-{
-    QMetaObject::invokeMethod(m_asyncWorker, [this, id]()
-    {
-        m_asyncWorker->remove(id);
-    });
-}
-
-void BitTorrent::BencodeResumeDataStorage::storeQueue(const QList<TorrentID> &queue) const
-{
-    QMetaObject::invokeMethod(m_asyncWorker, [this, queue]()
-    {
-        m_asyncWorker->storeQueue(queue);
-    });
-}
-
-BitTorrent::BencodeResumeDataStorage::Worker::Worker(const Path &resumeDataDir)
-    : m_resumeDataDir {resumeDataDir}
-{
-}
-
-void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, const LoadTorrentParams &resumeData) const
+BitTorrent::BencodeResumeDataStorage::EncodedResumeData BitTorrent::BencodeResumeDataStorage::encodeResumeData(const LoadTorrentParams &resumeData)
 {
     // We need to adjust native libtorrent resume data
     lt::add_torrent_params p = resumeData.ltAddTorrentParams;
@@ -431,7 +441,9 @@ void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, co
 
     lt::entry data = lt::write_resume_data(p);
 
-    // metadata is stored in separate .torrent file
+    EncodedResumeData encodedResumeData;
+
+    // metadata is stored separately
     if (p.ti)
     {
         lt::entry::dictionary_type &dataDict = data.dict();
@@ -442,14 +454,7 @@ void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, co
         metadataDict.insert(dataDict.extract("created by"));
         metadataDict.insert(dataDict.extract("comment"));
 
-        const Path torrentFilepath = m_resumeDataDir / Path(u"%1.torrent"_s.arg(id.toString()));
-        const nonstd::expected<void, QString> result = Utils::IO::saveToFile(torrentFilepath, metadata);
-        if (!result)
-        {
-            LogMsg(tr("Couldn't save torrent metadata to '%1'. Error: %2.")
-                   .arg(torrentFilepath.toString(), result.error()), Log::CRITICAL);
-            return;
-        }
+        lt::bencode(std::back_inserter(encodedResumeData.metadata), metadata);
     }
 
     data["qBt-ratioLimit"] = static_cast<int>(resumeData.shareLimits.ratioLimit * 1000);
@@ -480,8 +485,58 @@ void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, co
         data["qBt-downloadPath"] = Profile::instance()->toPortablePath(resumeData.downloadPath).data().toStdString();
     }
 
+    lt::bencode(std::back_inserter(encodedResumeData.resumeData), data);
+    return encodedResumeData;
+}
+
+void BitTorrent::BencodeResumeDataStorage::store(const TorrentID &id, LoadTorrentParams resumeData) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, id, resumeData = std::move(resumeData)]
+    {
+        m_asyncWorker->store(id, resumeData);
+    });
+}
+
+void BitTorrent::BencodeResumeDataStorage::remove(const TorrentID &id) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, id]()
+    {
+        m_asyncWorker->remove(id);
+    });
+}
+
+void BitTorrent::BencodeResumeDataStorage::storeQueue(const QList<TorrentID> &queue) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, queue]()
+    {
+        m_asyncWorker->storeQueue(queue);
+    });
+}
+
+BitTorrent::BencodeResumeDataStorage::Worker::Worker(const Path &resumeDataDir)
+    : m_resumeDataDir {resumeDataDir}
+{
+}
+
+void BitTorrent::BencodeResumeDataStorage::Worker::store(const TorrentID &id, const LoadTorrentParams &resumeData) const
+{
+    const EncodedResumeData encodedResumeData = encodeResumeData(resumeData);
+
+    // metadata is stored in separate .torrent file
+    if (!encodedResumeData.metadata.isEmpty())
+    {
+        const Path torrentFilepath = m_resumeDataDir / Path(u"%1.torrent"_s.arg(id.toString()));
+        const nonstd::expected<void, QString> result = Utils::IO::saveToFile(torrentFilepath, encodedResumeData.metadata);
+        if (!result)
+        {
+            LogMsg(tr("Couldn't save torrent metadata to '%1'. Error: %2.")
+                   .arg(torrentFilepath.toString(), result.error()), Log::CRITICAL);
+            return;
+        }
+    }
+
     const Path resumeFilepath = m_resumeDataDir / Path(u"%1.fastresume"_s.arg(id.toString()));
-    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(resumeFilepath, data);
+    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(resumeFilepath, encodedResumeData.resumeData);
     if (!result)
     {
         LogMsg(tr("Couldn't save torrent resume data to '%1'. Error: %2.")
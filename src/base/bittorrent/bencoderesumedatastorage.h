@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <QByteArray>
 #include <QDir>
 #include <QList>
 
@@ -36,8 +37,6 @@
 
 #include "resumedatastorage.h"
 
-class QByteArray;
-
 namespace BitTorrent
 {
     class BencodeResumeDataStorage final : public ResumeDataStorage
@@ -46,6 +45,13 @@ namespace BitTorrent
         Q_DISABLE_COPY_MOVE(BencodeResumeDataStorage)
 
     public:
+        // Resume data in the format of ".fastresume" and ".torrent" files
+        struct EncodedResumeData
+        {
+            QByteArray resumeData;
+            QByteArray metadata;
+        };
+
         explicit BencodeResumeDataStorage(const Path &path, QObject *parent = nullptr);
 
         QList<TorrentID> registeredTorrents() const override;
@@ -54,10 +60,13 @@ namespace BitTorrent
         void remove(const TorrentID &id) const override;
         void storeQueue(const QList<TorrentID> &queue) const override;
 
+        static EncodedResumeData encodeResumeData(const LoadTorrentParams &resumeData);
+        static LoadResumeDataResult decodeResumeData(const QByteArray &data, const QByteArray &metadata);
+
     private:
         void doLoadAll() const override;
+        LoadResumeDataResult load(const TorrentID &id, LoadStatistics *statistics) const;
         void loadQueue(const Path &queueFilename);
-        LoadResumeDataResult loadTorrentResumeData(const QByteArray &data, const QByteArray &metadata) const;
 
         QList<TorrentID> m_registeredTorrents;
         Utils::Thread::UniquePtr m_ioThread;
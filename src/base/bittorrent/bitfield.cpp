@@ -0,0 +1,299 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "bitfield.h"
+
+#include <algorithm>
+#include <bit>
+
+#include <libtorrent/bitfield.hpp>
+
+#include <QtCompilerDetection>
+#include <QtEndian>
+#include <QtProcessorDetection>
+
+#if defined(Q_PROCESSOR_X86) && (defined(Q_CC_GNU) || defined(Q_CC_CLANG))
+#define QBT_BITFIELD_AVX2
+#include <immintrin.h>
+#elif defined(Q_PROCESSOR_ARM_64)
+#define QBT_BITFIELD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+    // Kernels count the set bits of `data & ~mask` over `size` whole bytes, `mask` is ignored when null
+
+    template <bool AndNot>
+    qsizetype popcountScalar(const uchar *data, const uchar *mask, const qsizetype size)
+    {
+        qsizetype count = 0;
+        qsizetype i = 0;
+        for (; (i + 8) <= size; i += 8)
+        {
+            quint64 word = qFromUnaligned<quint64>(data + i);
+            if constexpr (AndNot)
+                word &= ~qFromUnaligned<quint64>(mask + i);
+            count += std::popcount(word);
+        }
+        for (; i < size; ++i)
+        {
+            const uchar byte = AndNot ? (data[i] & ~mask[i]) : data[i];
+            count += std::popcount(byte);
+        }
+        return count;
+    }
+
+#if defined(QBT_BITFIELD_AVX2)
+    bool hasAVX2()
+    {
+        static const bool result = __builtin_cpu_supports("avx2");
+        return result;
+    }
+
+    // Per byte popcount using nibble lookup table
+    __attribute__((target("avx2")))
+    __m256i popcountBytes(const __m256i value)
+    {
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+            , 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowMask = _mm256_set1_epi8(0x0F);
+        const __m256i low = _mm256_and_si256(value, lowMask);
+        const __m256i high = _mm256_and_si256(_mm256_srli_epi16(value, 4), lowMask);
+        return _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+    }
+
+    template <bool AndNot>
+    __attribute__((target("avx2")))
+    qsizetype popcountAVX2(const uchar *data, const uchar *mask, const qsizetype size)
+    {
+        __m256i total = _mm256_setzero_si256();
+        qsizetype i = 0;
+        for (; (i + 32) <= size; i += 32)
+        {
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            if constexpr (AndNot)
+                value = _mm256_andnot_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask + i)), value);
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(popcountBytes(value), _mm256_setzero_si256()));
+        }
+
+        alignas(32) quint64 lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), total);
+        const qsizetype count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        return count + popcountScalar<AndNot>((data + i), (AndNot ? (mask + i) : nullptr), (size - i));
+    }
+#elif defined(QBT_BITFIELD_NEON)
+    template <bool AndNot>
+    qsizetype popcountNEON(const uchar *data, const uchar *mask, const qsizetype size)
+    {
+        uint64x2_t total = vdupq_n_u64(0);
+        qsizetype i = 0;
+        for (; (i + 16) <= size; i += 16)
+        {
+            uint8x16_t value = vld1q_u8(data + i);
+            if constexpr (AndNot)
+                value = vbicq_u8(value, vld1q_u8(mask + i));
+            total = vpadalq_u32(total, vpaddlq_u16(vpaddlq_u8(vcntq_u8(value))));
+        }
+
+        const qsizetype count = vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1);
+        return count + popcountScalar<AndNot>((data + i), (AndNot ? (mask + i) : nullptr), (size - i));
+    }
+#endif
+
+    template <bool AndNot>
+    qsizetype popcount(const uchar *data, const uchar *mask, const qsizetype size)
+    {
+#if defined(QBT_BITFIELD_AVX2)
+        if (hasAVX2())
+            return popcountAVX2<AndNot>(data, mask, size);
+        return popcountScalar<AndNot>(data, mask, size);
+#elif defined(QBT_BITFIELD_NEON)
+        return popcountNEON<AndNot>(data, mask, size);
+#else
+        return popcountScalar<AndNot>(data, mask, size);
+#endif
+    }
+
+    // Mask of the first `bitCount` bits of a byte
+    uchar leadingBitsMask(const int bitCount)
+    {
+        return static_cast<uchar>(0xFF00 >> bitCount);
+    }
+
+    qsizetype countAndNotImpl(const uchar *data, const uchar *mask, const qsizetype bitCount)
+    {
+        const qsizetype byteCount = bitCount / 8;
+        qsizetype count = popcount<true>(data, mask, byteCount);
+        if (const int tailBits = bitCount % 8; tailBits > 0)
+            count += std::popcount(static_cast<uchar>(data[byteCount] & ~mask[byteCount] & leadingBitsMask(tailBits)));
+        return count;
+    }
+
+    const uchar *bytes(const QByteArray &array)
+    {
+        return reinterpret_cast<const uchar *>(array.constData());
+    }
+}
+
+BitTorrent::Bitfield::Bitfield(const qsizetype size, const bool value)
+    : m_size {size}
+    , m_bytes((size + 7) / 8, (value ? '\xFF' : '\0'))
+{
+    clearTrailingBits();
+}
+
+BitTorrent::Bitfield::Bitfield(const lt::bitfield &bits)
+    : m_size {bits.size()}
+    , m_bytes(bits.data(), ((bits.size() + 7) / 8))
+{
+    clearTrailingBits();
+}
+
+qsizetype BitTorrent::Bitfield::size() const
+{
+    return m_size;
+}
+
+bool BitTorrent::Bitfield::isEmpty() const
+{
+    return (m_size == 0);
+}
+
+void BitTorrent::Bitfield::clear()
+{
+    m_size = 0;
+    m_bytes.clear();
+}
+
+void BitTorrent::Bitfield::fill(const bool value)
+{
+    m_bytes.fill((value ? '\xFF' : '\0'));
+    clearTrailingBits();
+}
+
+bool BitTorrent::Bitfield::at(const qsizetype i) const
+{
+    Q_ASSERT((i >= 0) && (i < m_size));
+    return (static_cast<uchar>(m_bytes[i / 8]) & (0x80 >> (i % 8))) != 0;
+}
+
+bool BitTorrent::Bitfield::operator[](const qsizetype i) const
+{
+    return at(i);
+}
+
+void BitTorrent::Bitfield::setBit(const qsizetype i)
+{
+    Q_ASSERT((i >= 0) && (i < m_size));
+    m_bytes[i / 8] = static_cast<char>(m_bytes[i / 8] | (0x80 >> (i % 8)));
+}
+
+void BitTorrent::Bitfield::clearBit(const qsizetype i)
+{
+    Q_ASSERT((i >= 0) && (i < m_size));
+    m_bytes[i / 8] = static_cast<char>(m_bytes[i / 8] & ~(0x80 >> (i % 8)));
+}
+
+qsizetype BitTorrent::Bitfield::count(const bool on) const
+{
+    const qsizetype setCount = popcount<false>(bytes(m_bytes), nullptr, m_bytes.size());
+    return on ? setCount : (m_size - setCount);
+}
+
+qsizetype BitTorrent::Bitfield::count(qsizetype from, qsizetype to) const
+{
+    from = std::max<qsizetype>(from, 0);
+    to = std::min(to, m_size);
+    if (from >= to)
+        return 0;
+
+    const uchar *data = bytes(m_bytes);
+    const qsizetype firstByte = from / 8;
+    const qsizetype lastByte = (to - 1) / 8;
+    const uchar headMask = ~leadingBitsMask(from % 8);
+    const uchar tailMask = leadingBitsMask(((to - 1) % 8) + 1);
+    if (firstByte == lastByte)
+        return std::popcount(static_cast<uchar>(data[firstByte] & headMask & tailMask));
+
+    return std::popcount(static_cast<uchar>(data[firstByte] & headMask))
+        + popcount<false>((data + firstByte + 1), nullptr, (lastByte - firstByte - 1))
+        + std::popcount(static_cast<uchar>(data[lastByte] & tailMask));
+}
+
+qsizetype BitTorrent::Bitfield::countAndNot(const Bitfield &mask) const
+{
+    return countAndNotImpl(bytes(m_bytes), bytes(mask.m_bytes), std::min(m_size, mask.m_size));
+}
+
+qsizetype BitTorrent::Bitfield::nextSetBit(qsizetype from) const
+{
+    from = std::max<qsizetype>(from, 0);
+    if (from >= m_size)
+        return -1;
+
+    const uchar *data = bytes(m_bytes);
+    qsizetype byteIndex = from / 8;
+    if (const uchar head = data[byteIndex] & ~leadingBitsMask(from % 8); head != 0)
+        return (byteIndex * 8) + std::countl_zero(head);
+
+    // skip runs of unset bits a word at a time
+    ++byteIndex;
+    while (((byteIndex + 8) <= m_bytes.size()) && (qFromUnaligned<quint64>(data + byteIndex) == 0))
+        byteIndex += 8;
+    for (; byteIndex < m_bytes.size(); ++byteIndex)
+    {
+        if (data[byteIndex] != 0)
+            return (byteIndex * 8) + std::countl_zero(data[byteIndex]);
+    }
+
+    return -1;
+}
+
+BitTorrent::Bitfield BitTorrent::Bitfield::operator^(const Bitfield &other) const
+{
+    const bool isLonger = (m_size >= other.m_size);
+    Bitfield result = isLonger ? *this : other;
+    const QByteArray &shorterBytes = isLonger ? other.m_bytes : m_bytes;
+
+    char *resultData = result.m_bytes.data();
+    for (qsizetype i = 0; i < shorterBytes.size(); ++i)
+        resultData[i] ^= shorterBytes[i];
+    return result;
+}
+
+void BitTorrent::Bitfield::clearTrailingBits()
+{
+    if (const int tailBits = m_size % 8; tailBits > 0)
+        m_bytes[m_bytes.size() - 1] = static_cast<char>(m_bytes[m_bytes.size() - 1] & leadingBitsMask(tailBits));
+}
+
+qsizetype BitTorrent::countAndNot(const lt::bitfield &bits, const Bitfield &mask)
+{
+    return countAndNotImpl(reinterpret_cast<const uchar *>(bits.data()), bytes(mask.m_bytes), std::min<qsizetype>(bits.size(), mask.size()));
+}
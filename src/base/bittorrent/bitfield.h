@@ -0,0 +1,79 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <libtorrent/fwd.hpp>
+
+#include <QtTypes>
+#include <QByteArray>
+
+namespace BitTorrent
+{
+    // Bit array in libtorrent bit order, i.e. bit 0 is the most significant bit of the first byte,
+    // so it can be copied from lt::bitfield as is. It is implicitly shared like QBitArray.
+    class Bitfield
+    {
+    public:
+        Bitfield() = default;
+        explicit Bitfield(qsizetype size, bool value = false);
+        explicit Bitfield(const lt::bitfield &bits);
+
+        qsizetype size() const;
+        bool isEmpty() const;
+        void clear();
+        void fill(bool value);
+
+        bool at(qsizetype i) const;
+        bool operator[](qsizetype i) const;
+        void setBit(qsizetype i);
+        void clearBit(qsizetype i);
+
+        qsizetype count(bool on) const;
+        // Number of set bits in [from, to)
+        qsizetype count(qsizetype from, qsizetype to) const;
+        // Number of bits which are set here and not in `mask`
+        qsizetype countAndNot(const Bitfield &mask) const;
+        // Index of the first set bit at or after `from`, -1 if there is none
+        qsizetype nextSetBit(qsizetype from) const;
+
+        Bitfield operator^(const Bitfield &other) const;
+
+        friend bool operator==(const Bitfield &left, const Bitfield &right) = default;
+        friend qsizetype countAndNot(const lt::bitfield &bits, const Bitfield &mask);
+
+    private:
+        void clearTrailingBits();
+
+        qsizetype m_size = 0;
+        QByteArray m_bytes;
+    };
+
+    // Same as Bitfield::countAndNot() but without copying `bits`
+    qsizetype countAndNot(const lt::bitfield &bits, const Bitfield &mask);
+}
@@ -28,9 +28,14 @@
 
 #include "dbresumedatastorage.h"
 
+#include <ctime>
 #include <memory>
+#include <optional>
 #include <queue>
+#include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <libtorrent/bdecode.hpp>
 #include <libtorrent/bencode.hpp>
@@ -44,9 +49,13 @@
 #endif
 
 #include <QByteArray>
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QList>
 #include <QMutex>
+#include <QScopeGuard>
 #include <QSet>
 #include <QSqlDatabase>
 #include <QSqlError>
@@ -60,6 +69,8 @@
 #include "base/path.h"
 #include "base/preferences.h"
 #include "base/profile.h"
+#include "base/utils/fs.h"
+#include "base/utils/gzip.h"
 #include "base/utils/sslkey.h"
 #include "base/utils/string.h"
 #include "infohash.h"
@@ -71,7 +82,15 @@ namespace
 {
     const QString DB_CONNECTION_NAME = u"ResumeDataStorage"_s;
 
-    const int DB_VERSION = 10;
+    const int DB_VERSION = 11;
+    // Resume data and metadata blobs may be compressed since this version, older versions of qBittorrent
+    // cannot read them, so the database is backed up before it is upgraded from an earlier version
+    const int COMPRESSED_BLOBS_DB_VERSION = 11;
+
+    // Number of WAL pages after which SQLite checkpoints the log automatically
+    const int WAL_AUTOCHECKPOINT_PAGES = 4096;
+    // Blobs are compressed with low level since they are written far more often than they are read
+    const int BLOB_COMPRESSION_LEVEL = 1;
 
     const QString DB_TABLE_META = u"meta"_s;
     const QString DB_TABLE_TORRENTS = u"torrents"_s;
@@ -80,18 +99,60 @@ namespace
 
     using namespace BitTorrent;
 
+    // Torrent metadata ("info" dictionary) cannot change for the same torrent ID
+    // so only the remaining metadata fields need to be compared
+    struct MetadataFingerprint
+    {
+        std::time_t creationDate = 0;
+        std::string createdBy;
+        std::string comment;
+
+        friend bool operator==(const MetadataFingerprint &, const MetadataFingerprint &) = default;
+    };
+
+    MetadataFingerprint makeMetadataFingerprint(const lt::add_torrent_params &p)
+    {
+        return {.creationDate = p.creation_date, .createdBy = p.created_by, .comment = p.comment};
+    }
+
+    class JobContext
+    {
+    public:
+        explicit JobContext(QSqlDatabase db);
+
+        QSqlQuery &preparedQuery(const QString &statement);
+
+        bool isMetadataStored(const TorrentID &torrentID, const MetadataFingerprint &fingerprint) const;
+        void setMetadataStored(const TorrentID &torrentID, const MetadataFingerprint &fingerprint);
+        bool isRowStored(const TorrentID &torrentID, const QByteArray &digest) const;
+        void setRowStored(const TorrentID &torrentID, const QByteArray &digest);
+        void forget(const TorrentID &torrentID);
+        void forgetAll();
+
+    private:
+        struct StoredTorrent
+        {
+            std::optional<MetadataFingerprint> metadata;
+            QByteArray rowDigest;
+        };
+
+        QSqlDatabase m_db;
+        std::unordered_map<QString, QSqlQuery> m_preparedQueries;
+        QHash<TorrentID, StoredTorrent> m_storedTorrents;
+    };
+
     class Job
     {
     public:
         virtual ~Job() = default;
-        virtual void perform(QSqlDatabase db) = 0;
+        virtual void perform(JobContext &context) = 0;
     };
 
     class StoreJob final : public Job
     {
     public:
         StoreJob(const TorrentID &torrentID, LoadTorrentParams resumeData);
-        void perform(QSqlDatabase db) override;
+        void perform(JobContext &context) override;
 
     private:
         const TorrentID m_torrentID;
@@ -102,7 +163,7 @@ namespace
     {
     public:
         explicit RemoveJob(const TorrentID &torrentID);
-        void perform(QSqlDatabase db) override;
+        void perform(JobContext &context) override;
 
     private:
         const TorrentID m_torrentID;
@@ -112,12 +173,23 @@ namespace
     {
     public:
         explicit StoreQueueJob(const QList<TorrentID> &queue);
-        void perform(QSqlDatabase db) override;
+        void perform(JobContext &context) override;
 
     private:
         const QList<TorrentID> m_queue;
     };
 
+    class RegisterMetadataJob final : public Job
+    {
+    public:
+        RegisterMetadataJob(const TorrentID &torrentID, MetadataFingerprint fingerprint);
+        void perform(JobContext &context) override;
+
+    private:
+        const TorrentID m_torrentID;
+        const MetadataFingerprint m_fingerprint;
+    };
+
     struct Column
     {
         QString name;
@@ -223,6 +295,47 @@ namespace
     {
         return u"%1 %2"_s.arg(quoted(column.name), definition);
     }
+
+    QByteArray packBlob(const QByteArray &data)
+    {
+        bool ok = false;
+        const QByteArray compressedData = Utils::Gzip::compress(data, BLOB_COMPRESSION_LEVEL, &ok);
+        return (ok && (compressedData.size() < data.size())) ? compressedData : data;
+    }
+
+    // Blobs stored by previous versions are plain bencoded data (i.e. start with 'd')
+    // so they can be distinguished from the compressed ones by gzip magic bytes
+    QByteArray unpackBlob(const QByteArray &blob, bool *ok)
+    {
+        if (!blob.startsWith("\x1f\x8b"))
+        {
+            *ok = true;
+            return blob;
+        }
+
+        return Utils::Gzip::decompress(blob, ok);
+    }
+
+    // Returns true if database is in WAL mode
+    bool applyWALPolicy(QSqlDatabase db)
+    {
+        QSqlQuery query {db};
+        if (!query.exec(u"PRAGMA journal_mode;"_s) || !query.next())
+            return false;
+
+        if (query.value(0).toString().compare(u"WAL"_s, Qt::CaseInsensitive) != 0)
+            return false;
+
+        // In WAL mode "NORMAL" synchronization is still safe from corruption,
+        // it only defers fsync until checkpoint so commits become much cheaper
+        if (!query.exec(u"PRAGMA synchronous = NORMAL;"_s))
+            qDebug() << "Couldn't set resume data synchronization mode:" << query.lastError().text();
+
+        if (!query.exec(u"PRAGMA wal_autocheckpoint = %1;"_s.arg(WAL_AUTOCHECKPOINT_PAGES)))
+            qDebug() << "Couldn't set resume data WAL checkpoint policy:" << query.lastError().text();
+
+        return true;
+    }
 }
 
 namespace BitTorrent
@@ -240,6 +353,7 @@ namespace BitTorrent
         void store(const TorrentID &id, LoadTorrentParams resumeData);
         void remove(const TorrentID &id);
         void storeQueue(const QList<TorrentID> &queue);
+        void registerStoredMetadata(const TorrentID &id, const MetadataFingerprint &fingerprint);
 
     private:
         void addJob(std::unique_ptr<Job> job);
@@ -259,6 +373,9 @@ BitTorrent::DBResumeDataStorage::DBResumeDataStorage(const Path &dbPath, QObject
 {
     const bool needCreateDB = !dbPath.exists();
 
+    // The connection must not outlive the failed construction, the destructor isn't called in this case
+    auto connectionGuard = qScopeGuard([] { QSqlDatabase::removeDatabase(DB_CONNECTION_NAME); });
+
     auto db = QSqlDatabase::addDatabase(u"QSQLITE"_s, DB_CONNECTION_NAME);
     db.setDatabaseName(dbPath.data());
     if (!db.open())
@@ -271,10 +388,21 @@ BitTorrent::DBResumeDataStorage::DBResumeDataStorage(const Path &dbPath, QObject
     else
     {
         const int dbVersion = (!db.record(DB_TABLE_TORRENTS).contains(DB_COLUMN_DOWNLOAD_PATH.name) ? 1 : currentDBVersion());
+        // Newer database may contain data this version cannot decode (e.g. compressed blobs)
+        // so it is refused rather than silently losing all the torrents stored in it
+        if (dbVersion > DB_VERSION)
+        {
+            throw RuntimeError(tr("Resume data database \"%1\" was created by a newer version of qBittorrent and cannot be used."
+                    " Database version: %2. Supported version: %3.")
+                    .arg(dbPath.toString(), QString::number(dbVersion), QString::number(DB_VERSION)));
+        }
+
         if (dbVersion < DB_VERSION)
             updateDB(dbVersion);
     }
 
+    connectionGuard.dismiss();
+
     m_asyncWorker = new Worker(dbPath, m_dbLock, this);
     m_asyncWorker->start();
 }
@@ -330,7 +458,7 @@ BitTorrent::LoadResumeDataResult BitTorrent::DBResumeDataStorage::load(const Tor
             .arg(id.toString(), err.message()));
     }
 
-    return parseQueryResultRow(query);
+    return parseQueryResultRow(query.record());
 }
 
 void BitTorrent::DBResumeDataStorage::store(const TorrentID &id, LoadTorrentParams resumeData) const
@@ -352,6 +480,9 @@ void BitTorrent::DBResumeDataStorage::doLoadAll() const
 {
     const QString connectionName = u"ResumeDataStorageLoadAll"_s;
 
+    QElapsedTimer timer;
+    timer.start();
+
     {
         auto db = QSqlDatabase::addDatabase(u"QSQLITE"_s, connectionName);
         db.setDatabaseName(path().data());
@@ -376,14 +507,53 @@ void BitTorrent::DBResumeDataStorage::doLoadAll() const
         emit const_cast<DBResumeDataStorage *>(this)->loadStarted(registeredTorrents);
 
         const auto selectStatement = u"SELECT * FROM %1 ORDER BY %2;"_s.arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_QUEUE_POSITION.name));
+        query.setForwardOnly(true);
         if (!query.exec(selectStatement))
             throw RuntimeError(query.lastError().text());
 
-        while (query.next())
+        // Rows are fetched sequentially by batches while parsing them is performed in parallel
+        LoadStatistics statistics;
+        QList<QSqlRecord> batch;
+        batch.reserve(LOAD_BATCH_SIZE);
+        bool hasMoreRows = true;
+        while (hasMoreRows)
         {
-            const auto torrentID = TorrentID::fromString(query.value(DB_COLUMN_TORRENT_ID.name).toString());
-            onResumeDataLoaded(torrentID, parseQueryResultRow(query));
+            QElapsedTimer readTimer;
+            readTimer.start();
+
+            batch.clear();
+            while (batch.size() < LOAD_BATCH_SIZE)
+            {
+                hasMoreRows = query.next();
+                if (!hasMoreRows)
+                    break;
+
+                batch.append(query.record());
+            }
+
+            statistics.readTime += readTimer.nsecsElapsed();
+
+            std::vector<LoadResumeDataResult> results = loadInParallel(batch.size(), [this, &batch, &statistics](const qsizetype index)
+            {
+                QElapsedTimer decodeTimer;
+                decodeTimer.start();
+                LoadResumeDataResult result = parseQueryResultRow(batch[index]);
+                statistics.decodeTime += decodeTimer.nsecsElapsed();
+                return result;
+            });
+
+            for (qsizetype i = 0; i < batch.size(); ++i)
+            {
+                const auto torrentID = TorrentID::fromString(batch[i].value(DB_COLUMN_TORRENT_ID.name).toString());
+                LoadResumeDataResult &result = results[static_cast<std::size_t>(i)];
+                // Let the worker know which metadata is already stored so it isn't rewritten on next save
+                if (result && result->ltAddTorrentParams.ti)
+                    m_asyncWorker->registerStoredMetadata(torrentID, makeMetadataFingerprint(result->ltAddTorrentParams));
+                onResumeDataLoaded(torrentID, std::move(result));
+            }
         }
+
+        logLoadStatistics(registeredTorrents.size(), timer.elapsed(), statistics);
     }
 
     emit const_cast<DBResumeDataStorage *>(this)->loadFinished();
@@ -512,6 +682,10 @@ void BitTorrent::DBResumeDataStorage::updateDB(const int fromVersion) const
     Q_ASSERT(fromVersion > 0);
     Q_ASSERT(fromVersion != DB_VERSION);
 
+    std::optional<Path> backupPath;
+    if (fromVersion < COMPRESSED_BLOBS_DB_VERSION)
+        backupPath = backupDB(fromVersion);
+
     auto db = QSqlDatabase::database(DB_CONNECTION_NAME);
 
     const QWriteLocker locker {&m_dbLock};
@@ -592,6 +766,10 @@ void BitTorrent::DBResumeDataStorage::updateDB(const int fromVersion) const
         if (fromVersion <= 9)
             addColumn(DB_TABLE_TORRENTS, DB_COLUMN_SHARE_LIMITS_MODE, u"TEXT NOT NULL DEFAULT `Default`"_s);
 
+        // Version 11 allows resume data and metadata blobs to be compressed.
+        // Existing uncompressed blobs remain readable so no data conversion is required,
+        // but the blobs stored from now on cannot be read by older versions (see backupDB()).
+
         const QString updateMetaVersionQuery = makeUpdateStatement(DB_TABLE_META, {DB_COLUMN_NAME, DB_COLUMN_VALUE});
         if (!query.prepare(updateMetaVersionQuery))
             throw RuntimeError(query.lastError().text());
@@ -610,6 +788,38 @@ void BitTorrent::DBResumeDataStorage::updateDB(const int fromVersion) const
         db.rollback();
         throw;
     }
+
+    if (backupPath)
+    {
+        LogMsg(tr("Resume data database is upgraded to a format that older versions of qBittorrent cannot read."
+                " Its previous version is saved to \"%1\". Restore it before going back to an older version.")
+                .arg(backupPath->toString()), Log::INFO);
+    }
+}
+
+// Returns path of the backup copy
+Path BitTorrent::DBResumeDataStorage::backupDB(const int version) const
+{
+    const Path backupPath = path() + u".v%1.bak"_s.arg(version);
+    if (backupPath.exists())
+        Utils::Fs::removeFile(backupPath);
+
+    auto db = QSqlDatabase::database(DB_CONNECTION_NAME);
+    QSqlQuery query {db};
+
+    // Unlike copying the file, "VACUUM INTO" also includes the changes that are still in WAL
+    const QString backupStatement = u"VACUUM INTO :path;"_s;
+    if (!query.prepare(backupStatement))
+        throw RuntimeError(query.lastError().text());
+
+    query.bindValue(u":path"_s, backupPath.data());
+    if (!query.exec())
+    {
+        throw RuntimeError(tr("Couldn't back up resume data database to \"%1\". Error: %2")
+                .arg(backupPath.toString(), query.lastError().text()));
+    }
+
+    return backupPath;
 }
 
 void BitTorrent::DBResumeDataStorage::enableWALMode() const
@@ -628,50 +838,54 @@ void BitTorrent::DBResumeDataStorage::enableWALMode() const
         throw RuntimeError(tr("WAL mode is probably unsupported due to filesystem limitations."));
 }
 
-LoadResumeDataResult DBResumeDataStorage::parseQueryResultRow(const QSqlQuery &query) const
+LoadResumeDataResult DBResumeDataStorage::parseQueryResultRow(const QSqlRecord &record) const
 {
     LoadTorrentParams resumeData;
-    resumeData.name = query.value(DB_COLUMN_NAME.name).toString();
-    resumeData.category = query.value(DB_COLUMN_CATEGORY.name).toString();
-    resumeData.comment = query.value(DB_COLUMN_COMMENT.name).toString();
-    const QString tagsData = query.value(DB_COLUMN_TAGS.name).toString();
+    resumeData.name = record.value(DB_COLUMN_NAME.name).toString();
+    resumeData.category = record.value(DB_COLUMN_CATEGORY.name).toString();
+    resumeData.comment = record.value(DB_COLUMN_COMMENT.name).toString();
+    const QString tagsData = record.value(DB_COLUMN_TAGS.name).toString();
     if (!tagsData.isEmpty())
     {
         const QStringList tagList = tagsData.split(u',');
         resumeData.tags.insert(tagList.cbegin(), tagList.cend());
     }
-    resumeData.hasFinishedStatus = query.value(DB_COLUMN_HAS_SEED_STATUS.name).toBool();
-    resumeData.firstLastPiecePriority = query.value(DB_COLUMN_HAS_OUTER_PIECES_PRIORITY.name).toBool();
+    resumeData.hasFinishedStatus = record.value(DB_COLUMN_HAS_SEED_STATUS.name).toBool();
+    resumeData.firstLastPiecePriority = record.value(DB_COLUMN_HAS_OUTER_PIECES_PRIORITY.name).toBool();
     resumeData.shareLimits = {
-        .ratioLimit = query.value(DB_COLUMN_RATIO_LIMIT.name).toInt() / 1000.0,
-        .seedingTimeLimit = query.value(DB_COLUMN_SEEDING_TIME_LIMIT.name).toInt(),
-        .inactiveSeedingTimeLimit = query.value(DB_COLUMN_INACTIVE_SEEDING_TIME_LIMIT.name).toInt(),
-        .mode = Utils::String::toEnum(query.value(DB_COLUMN_SHARE_LIMITS_MODE.name).toString(), ShareLimitsMode::Default),
-        .action = Utils::String::toEnum(query.value(DB_COLUMN_SHARE_LIMIT_ACTION.name).toString(), ShareLimitAction::Default)
+        .ratioLimit = record.value(DB_COLUMN_RATIO_LIMIT.name).toInt() / 1000.0,
+        .seedingTimeLimit = record.value(DB_COLUMN_SEEDING_TIME_LIMIT.name).toInt(),
+        .inactiveSeedingTimeLimit = record.value(DB_COLUMN_INACTIVE_SEEDING_TIME_LIMIT.name).toInt(),
+        .mode = Utils::String::toEnum(record.value(DB_COLUMN_SHARE_LIMITS_MODE.name).toString(), ShareLimitsMode::Default),
+        .action = Utils::String::toEnum(record.value(DB_COLUMN_SHARE_LIMIT_ACTION.name).toString(), ShareLimitAction::Default)
     };
     resumeData.contentLayout = Utils::String::toEnum<TorrentContentLayout>(
-        query.value(DB_COLUMN_CONTENT_LAYOUT.name).toString(), TorrentContentLayout::Original);
+        record.value(DB_COLUMN_CONTENT_LAYOUT.name).toString(), TorrentContentLayout::Original);
     resumeData.operatingMode = Utils::String::toEnum<TorrentOperatingMode>(
-        query.value(DB_COLUMN_OPERATING_MODE.name).toString(), TorrentOperatingMode::AutoManaged);
-    resumeData.stopped = query.value(DB_COLUMN_STOPPED.name).toBool();
+        record.value(DB_COLUMN_OPERATING_MODE.name).toString(), TorrentOperatingMode::AutoManaged);
+    resumeData.stopped = record.value(DB_COLUMN_STOPPED.name).toBool();
     resumeData.stopCondition = Utils::String::toEnum(
-        query.value(DB_COLUMN_STOP_CONDITION.name).toString(), Torrent::StopCondition::None);
+        record.value(DB_COLUMN_STOP_CONDITION.name).toString(), Torrent::StopCondition::None);
     resumeData.sslParameters = {
-        .certificate = QSslCertificate(query.value(DB_COLUMN_SSL_CERTIFICATE.name).toByteArray()),
-        .privateKey = Utils::SSLKey::load(query.value(DB_COLUMN_SSL_PRIVATE_KEY.name).toByteArray()),
-        .dhParams = query.value(DB_COLUMN_SSL_DH_PARAMS.name).toByteArray()
+        .certificate = QSslCertificate(record.value(DB_COLUMN_SSL_CERTIFICATE.name).toByteArray()),
+        .privateKey = Utils::SSLKey::load(record.value(DB_COLUMN_SSL_PRIVATE_KEY.name).toByteArray()),
+        .dhParams = record.value(DB_COLUMN_SSL_DH_PARAMS.name).toByteArray()
     };
 
     resumeData.savePath = Profile::instance()->fromPortablePath(
-        Path(query.value(DB_COLUMN_TARGET_SAVE_PATH.name).toString()));
+        Path(record.value(DB_COLUMN_TARGET_SAVE_PATH.name).toString()));
     resumeData.useAutoTMM = resumeData.savePath.isEmpty();
     if (!resumeData.useAutoTMM)
     {
         resumeData.downloadPath = Profile::instance()->fromPortablePath(
-            Path(query.value(DB_COLUMN_DOWNLOAD_PATH.name).toString()));
+            Path(record.value(DB_COLUMN_DOWNLOAD_PATH.name).toString()));
     }
 
-    const QByteArray bencodedResumeData = query.value(DB_COLUMN_RESUMEDATA.name).toByteArray();
+    bool isUnpacked = false;
+    const QByteArray bencodedResumeData = unpackBlob(record.value(DB_COLUMN_RESUMEDATA.name).toByteArray(), &isUnpacked);
+    if (!isUnpacked)
+        return nonstd::make_unexpected(tr("Cannot parse resume data: %1").arg(tr("invalid compressed data")));
+
     const auto *pref = Preferences::instance();
     const int bdecodeDepthLimit = pref->getBdecodeDepthLimit();
     const int bdecodeTokenLimit = pref->getBdecodeTokenLimit();
@@ -687,9 +901,13 @@ LoadResumeDataResult DBResumeDataStorage::parseQueryResultRow(const QSqlQuery &q
     if (ec)
         return nonstd::make_unexpected(tr("Cannot parse resume data: %1").arg(QString::fromStdString(ec.message())));
 
-    if (const QByteArray bencodedMetadata = query.value(DB_COLUMN_METADATA.name).toByteArray()
-            ; !bencodedMetadata.isEmpty())
+    if (const QByteArray metadataBlob = record.value(DB_COLUMN_METADATA.name).toByteArray()
+            ; !metadataBlob.isEmpty())
     {
+        const QByteArray bencodedMetadata = unpackBlob(metadataBlob, &isUnpacked);
+        if (!isUnpacked)
+            return nonstd::make_unexpected(tr("Cannot parse torrent info: %1").arg(tr("invalid compressed data")));
+
         const lt::bdecode_node torrentInfoRoot = lt::bdecode(bencodedMetadata, ec
                 , nullptr, bdecodeDepthLimit, bdecodeTokenLimit);
         if (ec)
@@ -744,48 +962,69 @@ void BitTorrent::DBResumeDataStorage::Worker::run()
         if (!db.open())
             throw RuntimeError(db.lastError().text());
 
-        int64_t transactedJobsCount = 0;
-        while (true)
-        {
-            m_jobsMutex.lock();
-            if (m_jobs.empty())
-            {
-                if (transactedJobsCount > 0)
-                {
-                    db.commit();
-                    m_dbLock.unlock();
+        const bool isWALMode = applyWALPolicy(db);
 
-                    qDebug() << "Resume data changes are committed. Transacted jobs:" << transactedJobsCount;
-                    transactedJobsCount = 0;
-                }
-
-                if (isInterruptionRequested())
-                {
-                    m_jobsMutex.unlock();
-                    break;
-                }
+        {
+            JobContext context {db};
 
-                m_waitCondition.wait(&m_jobsMutex);
-                if (isInterruptionRequested())
+            int64_t transactedJobsCount = 0;
+            while (true)
+            {
+                m_jobsMutex.lock();
+                if (m_jobs.empty())
                 {
-                    m_jobsMutex.unlock();
-                    break;
+                    if (transactedJobsCount > 0)
+                    {
+                        if (!db.commit())
+                        {
+                            LogMsg(tr("Couldn't commit transaction. Error: %1").arg(db.lastError().text()), Log::WARNING);
+                            db.rollback();
+                            // We can no longer rely on what is actually stored
+                            context.forgetAll();
+                        }
+                        m_dbLock.unlock();
+
+                        qDebug() << "Resume data changes are committed. Transacted jobs:" << transactedJobsCount;
+                        transactedJobsCount = 0;
+                    }
+
+                    if (isInterruptionRequested())
+                    {
+                        m_jobsMutex.unlock();
+                        break;
+                    }
+
+                    m_waitCondition.wait(&m_jobsMutex);
+                    if (isInterruptionRequested())
+                    {
+                        m_jobsMutex.unlock();
+                        break;
+                    }
+
+                    m_dbLock.lockForWrite();
+                    if (!db.transaction())
+                    {
+                        LogMsg(tr("Couldn't begin transaction. Error: %1").arg(db.lastError().text()), Log::WARNING);
+                        m_dbLock.unlock();
+                        break;
+                    }
                 }
+                std::unique_ptr<Job> job = std::move(m_jobs.front());
+                m_jobs.pop();
+                m_jobsMutex.unlock();
 
-                m_dbLock.lockForWrite();
-                if (!db.transaction())
-                {
-                    LogMsg(tr("Couldn't begin transaction. Error: %1").arg(db.lastError().text()), Log::WARNING);
-                    m_dbLock.unlock();
-                    break;
-                }
+                job->perform(context);
+                ++transactedJobsCount;
             }
-            std::unique_ptr<Job> job = std::move(m_jobs.front());
-            m_jobs.pop();
-            m_jobsMutex.unlock();
+        }
 
-            job->perform(db);
-            ++transactedJobsCount;
+        if (isWALMode)
+        {
+            // Leave the database in a consistent state so the next startup doesn't need to replay the log
+            const QWriteLocker locker {&m_dbLock};
+            QSqlQuery query {db};
+            if (!query.exec(u"PRAGMA wal_checkpoint(TRUNCATE);"_s))
+                qDebug() << "Couldn't checkpoint resume data WAL:" << query.lastError().text();
         }
 
         db.close();
@@ -815,6 +1054,11 @@ void BitTorrent::DBResumeDataStorage::Worker::storeQueue(const QList<TorrentID>
     addJob(std::make_unique<StoreQueueJob>(queue));
 }
 
+void BitTorrent::DBResumeDataStorage::Worker::registerStoredMetadata(const TorrentID &id, const MetadataFingerprint &fingerprint)
+{
+    addJob(std::make_unique<RegisterMetadataJob>(id, fingerprint));
+}
+
 void BitTorrent::DBResumeDataStorage::Worker::addJob(std::unique_ptr<Job> job)
 {
     m_jobsMutex.lock();
@@ -828,13 +1072,62 @@ namespace
 {
     using namespace BitTorrent;
 
-StoreJob::StoreJob(const TorrentID &torrentID, LoadTorrentParams resumeData)
+    JobContext::JobContext(QSqlDatabase db)
+        : m_db {std::move(db)}
+    {
+    }
+
+    QSqlQuery &JobContext::preparedQuery(const QString &statement)
+    {
+        if (const auto it = m_preparedQueries.find(statement); it != m_preparedQueries.end())
+            return it->second;
+
+        QSqlQuery query {m_db};
+        if (!query.prepare(statement))
+            throw RuntimeError(query.lastError().text());
+
+        return m_preparedQueries.emplace(statement, std::move(query)).first->second;
+    }
+
+    bool JobContext::isMetadataStored(const TorrentID &torrentID, const MetadataFingerprint &fingerprint) const
+    {
+        const auto it = m_storedTorrents.constFind(torrentID);
+        return (it != m_storedTorrents.cend()) && (it->metadata == fingerprint);
+    }
+
+    void JobContext::setMetadataStored(const TorrentID &torrentID, const MetadataFingerprint &fingerprint)
+    {
+        m_storedTorrents[torrentID].metadata = fingerprint;
+    }
+
+    bool JobContext::isRowStored(const TorrentID &torrentID, const QByteArray &digest) const
+    {
+        const auto it = m_storedTorrents.constFind(torrentID);
+        return (it != m_storedTorrents.cend()) && (it->rowDigest == digest);
+    }
+
+    void JobContext::setRowStored(const TorrentID &torrentID, const QByteArray &digest)
+    {
+        m_storedTorrents[torrentID].rowDigest = digest;
+    }
+
+    void JobContext::forget(const TorrentID &torrentID)
+    {
+        m_storedTorrents.remove(torrentID);
+    }
+
+    void JobContext::forgetAll()
+    {
+        m_storedTorrents.clear();
+    }
+
+    StoreJob::StoreJob(const TorrentID &torrentID, LoadTorrentParams resumeData)
         : m_torrentID {torrentID}
         , m_resumeData {std::move(resumeData)}
     {
     }
 
-    void StoreJob::perform(QSqlDatabase db)
+    void StoreJob::perform(JobContext &context)
     {
         // We need to adjust native libtorrent resume data
         lt::add_torrent_params p = m_resumeData.ltAddTorrentParams;
@@ -888,6 +1181,8 @@ StoreJob::StoreJob(const TorrentID &torrentID, LoadTorrentParams resumeData)
         lt::entry data = lt::write_resume_data(p);
 
         // metadata is stored in separate column
+        // and it is written only if it differs from already stored one
+        std::optional<MetadataFingerprint> metadataFingerprint;
         QByteArray bencodedMetadata;
         if (p.ti)
         {
@@ -899,19 +1194,24 @@ StoreJob::StoreJob(const TorrentID &torrentID, LoadTorrentParams resumeData)
             metadataDict.insert(dataDict.extract("created by"));
             metadataDict.insert(dataDict.extract("comment"));
 
-            try
-            {
-                bencodedMetadata.reserve(512 * 1024);
-                lt::bencode(std::back_inserter(bencodedMetadata), metadata);
-            }
-            catch (const std::exception &err)
+            if (const MetadataFingerprint fingerprint = makeMetadataFingerprint(p)
+                    ; !context.isMetadataStored(m_torrentID, fingerprint))
             {
-                LogMsg(ResumeDataStorage::tr("Couldn't save torrent metadata. Error: %1.")
-                        .arg(QString::fromLocal8Bit(err.what())), Log::CRITICAL);
-                return;
-            }
+                try
+                {
+                    bencodedMetadata.reserve(512 * 1024);
+                    lt::bencode(std::back_inserter(bencodedMetadata), metadata);
+                }
+                catch (const std::exception &err)
+                {
+                    LogMsg(ResumeDataStorage::tr("Couldn't save torrent metadata. Error: %1.")
+                            .arg(QString::fromLocal8Bit(err.what())), Log::CRITICAL);
+                    return;
+                }
 
-            columns.append(DB_COLUMN_METADATA);
+                metadataFingerprint = fingerprint;
+                columns.append(DB_COLUMN_METADATA);
+            }
         }
 
         QByteArray bencodedResumeData;
@@ -920,46 +1220,68 @@ StoreJob::StoreJob(const TorrentID &torrentID, LoadTorrentParams resumeData)
 
         const QString insertTorrentStatement = makeInsertStatement(DB_TABLE_TORRENTS, columns)
                 + makeOnConflictUpdateStatement(DB_COLUMN_TORRENT_ID, columns);
-        QSqlQuery query {db};
 
         try
         {
-            if (!query.prepare(insertTorrentStatement))
-                throw RuntimeError(query.lastError().text());
+            QSqlQuery &query = context.preparedQuery(insertTorrentStatement);
 
-            query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, m_torrentID.toString());
-            query.bindValue(DB_COLUMN_NAME.placeholder, m_resumeData.name);
-            query.bindValue(DB_COLUMN_CATEGORY.placeholder, m_resumeData.category);
-            query.bindValue(DB_COLUMN_TAGS.placeholder, (m_resumeData.tags.isEmpty()
+            // Digest of the row is collected while binding so unchanged rows can be skipped
+            QCryptographicHash rowHash {QCryptographicHash::Sha1};
+            const auto bindValue = [&query, &rowHash](const Column &column, const QVariant &value)
+            {
+                query.bindValue(column.placeholder, value);
+                rowHash.addData(value.toByteArray());
+                rowHash.addData(QByteArrayView("\0", 1));
+            };
+
+            bindValue(DB_COLUMN_TORRENT_ID, m_torrentID.toString());
+            bindValue(DB_COLUMN_NAME, m_resumeData.name);
+            bindValue(DB_COLUMN_CATEGORY, m_resumeData.category);
+            bindValue(DB_COLUMN_TAGS, (m_resumeData.tags.isEmpty()
                     ? QString() : Utils::String::joinIntoString(m_resumeData.tags, u","_s)));
-            query.bindValue(DB_COLUMN_COMMENT.placeholder, m_resumeData.comment);
-            query.bindValue(DB_COLUMN_CONTENT_LAYOUT.placeholder, Utils::String::fromEnum(m_resumeData.contentLayout));
-            query.bindValue(DB_COLUMN_RATIO_LIMIT.placeholder, static_cast<int>(m_resumeData.shareLimits.ratioLimit * 1000));
-            query.bindValue(DB_COLUMN_SEEDING_TIME_LIMIT.placeholder, m_resumeData.shareLimits.seedingTimeLimit);
-            query.bindValue(DB_COLUMN_INACTIVE_SEEDING_TIME_LIMIT.placeholder, m_resumeData.shareLimits.inactiveSeedingTimeLimit);
-            query.bindValue(DB_COLUMN_SHARE_LIMITS_MODE.placeholder, Utils::String::fromEnum(m_resumeData.shareLimits.mode));
-            query.bindValue(DB_COLUMN_SHARE_LIMIT_ACTION.placeholder, Utils::String::fromEnum(m_resumeData.shareLimits.action));
-            query.bindValue(DB_COLUMN_HAS_OUTER_PIECES_PRIORITY.placeholder, m_resumeData.firstLastPiecePriority);
-            query.bindValue(DB_COLUMN_HAS_SEED_STATUS.placeholder, m_resumeData.hasFinishedStatus);
-            query.bindValue(DB_COLUMN_OPERATING_MODE.placeholder, Utils::String::fromEnum(m_resumeData.operatingMode));
-            query.bindValue(DB_COLUMN_STOPPED.placeholder, m_resumeData.stopped);
-            query.bindValue(DB_COLUMN_STOP_CONDITION.placeholder, Utils::String::fromEnum(m_resumeData.stopCondition));
-            query.bindValue(DB_COLUMN_SSL_CERTIFICATE.placeholder, QString::fromLatin1(m_resumeData.sslParameters.certificate.toPem()));
-            query.bindValue(DB_COLUMN_SSL_PRIVATE_KEY.placeholder, QString::fromLatin1(m_resumeData.sslParameters.privateKey.toPem()));
-            query.bindValue(DB_COLUMN_SSL_DH_PARAMS.placeholder, QString::fromLatin1(m_resumeData.sslParameters.dhParams));
-
+            bindValue(DB_COLUMN_COMMENT, m_resumeData.comment);
+            bindValue(DB_COLUMN_CONTENT_LAYOUT, Utils::String::fromEnum(m_resumeData.contentLayout));
+            bindValue(DB_COLUMN_RATIO_LIMIT, static_cast<int>(m_resumeData.shareLimits.ratioLimit * 1000));
+            bindValue(DB_COLUMN_SEEDING_TIME_LIMIT, m_resumeData.shareLimits.seedingTimeLimit);
+            bindValue(DB_COLUMN_INACTIVE_SEEDING_TIME_LIMIT, m_resumeData.shareLimits.inactiveSeedingTimeLimit);
+            bindValue(DB_COLUMN_SHARE_LIMITS_MODE, Utils::String::fromEnum(m_resumeData.shareLimits.mode));
+            bindValue(DB_COLUMN_SHARE_LIMIT_ACTION, Utils::String::fromEnum(m_resumeData.shareLimits.action));
+            bindValue(DB_COLUMN_HAS_OUTER_PIECES_PRIORITY, m_resumeData.firstLastPiecePriority);
+            bindValue(DB_COLUMN_HAS_SEED_STATUS, m_resumeData.hasFinishedStatus);
+            bindValue(DB_COLUMN_OPERATING_MODE, Utils::String::fromEnum(m_resumeData.operatingMode));
+            bindValue(DB_COLUMN_STOPPED, m_resumeData.stopped);
+            bindValue(DB_COLUMN_STOP_CONDITION, Utils::String::fromEnum(m_resumeData.stopCondition));
+            bindValue(DB_COLUMN_SSL_CERTIFICATE, QString::fromLatin1(m_resumeData.sslParameters.certificate.toPem()));
+            bindValue(DB_COLUMN_SSL_PRIVATE_KEY, QString::fromLatin1(m_resumeData.sslParameters.privateKey.toPem()));
+            bindValue(DB_COLUMN_SSL_DH_PARAMS, QString::fromLatin1(m_resumeData.sslParameters.dhParams));
+
+            // Prepared query is reused so the values must be rebound even if they are empty
             if (!m_resumeData.useAutoTMM)
             {
-                query.bindValue(DB_COLUMN_TARGET_SAVE_PATH.placeholder, Profile::instance()->toPortablePath(m_resumeData.savePath).data());
-                query.bindValue(DB_COLUMN_DOWNLOAD_PATH.placeholder, Profile::instance()->toPortablePath(m_resumeData.downloadPath).data());
+                bindValue(DB_COLUMN_TARGET_SAVE_PATH, Profile::instance()->toPortablePath(m_resumeData.savePath).data());
+                bindValue(DB_COLUMN_DOWNLOAD_PATH, Profile::instance()->toPortablePath(m_resumeData.downloadPath).data());
             }
+            else
+            {
+                bindValue(DB_COLUMN_TARGET_SAVE_PATH, QString());
+                bindValue(DB_COLUMN_DOWNLOAD_PATH, QString());
+            }
+
+            rowHash.addData(bencodedResumeData);
+            const QByteArray rowDigest = rowHash.result();
+            if (!metadataFingerprint && context.isRowStored(m_torrentID, rowDigest))
+                return;
 
-            query.bindValue(DB_COLUMN_RESUMEDATA.placeholder, bencodedResumeData);
-            if (!bencodedMetadata.isEmpty())
-                query.bindValue(DB_COLUMN_METADATA.placeholder, bencodedMetadata);
+            query.bindValue(DB_COLUMN_RESUMEDATA.placeholder, packBlob(bencodedResumeData));
+            if (metadataFingerprint)
+                query.bindValue(DB_COLUMN_METADATA.placeholder, packBlob(bencodedMetadata));
 
             if (!query.exec())
                 throw RuntimeError(query.lastError().text());
+
+            context.setRowStored(m_torrentID, rowDigest);
+            if (metadataFingerprint)
+                context.setMetadataStored(m_torrentID, *metadataFingerprint);
         }
         catch (const RuntimeError &err)
         {
@@ -973,17 +1295,16 @@ StoreJob::StoreJob(const TorrentID &torrentID, LoadTorrentParams resumeData)
     {
     }
 
-    void RemoveJob::perform(QSqlDatabase db)
+    void RemoveJob::perform(JobContext &context)
     {
         const auto deleteTorrentStatement = u"DELETE FROM %1 WHERE %2 = %3;"_s
                 .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder);
 
-        QSqlQuery query {db};
+        context.forget(m_torrentID);
+
         try
         {
-            if (!query.prepare(deleteTorrentStatement))
-                throw RuntimeError(query.lastError().text());
-
+            QSqlQuery &query = context.preparedQuery(deleteTorrentStatement);
             query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, m_torrentID.toString());
 
             if (!query.exec())
@@ -1001,7 +1322,7 @@ StoreJob::StoreJob(const TorrentID &torrentID, LoadTorrentParams resumeData)
     {
     }
 
-    void StoreQueueJob::perform(QSqlDatabase db)
+    void StoreQueueJob::perform(JobContext &context)
     {
         const auto updateQueuePosStatement = u"UPDATE %1 SET %2 = %3 WHERE %4 = %5;"_s
                 .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_QUEUE_POSITION.name), DB_COLUMN_QUEUE_POSITION.placeholder
@@ -1009,10 +1330,7 @@ StoreJob::StoreJob(const TorrentID &torrentID, LoadTorrentParams resumeData)
 
         try
         {
-            QSqlQuery query {db};
-
-            if (!query.prepare(updateQueuePosStatement))
-                throw RuntimeError(query.lastError().text());
+            QSqlQuery &query = context.preparedQuery(updateQueuePosStatement);
 
             int pos = 0;
             for (const TorrentID &torrentID : m_queue)
@@ -1029,4 +1347,15 @@ StoreJob::StoreJob(const TorrentID &torrentID, LoadTorrentParams resumeData)
                     .arg(err.message()), Log::CRITICAL);
         }
     }
+
+    RegisterMetadataJob::RegisterMetadataJob(const TorrentID &torrentID, MetadataFingerprint fingerprint)
+        : m_torrentID {torrentID}
+        , m_fingerprint {std::move(fingerprint)}
+    {
+    }
+
+    void RegisterMetadataJob::perform(JobContext &context)
+    {
+        context.setMetadataStored(m_torrentID, m_fingerprint);
+    }
 }
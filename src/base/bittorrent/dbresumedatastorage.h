@@ -1,6 +1,6 @@
 /*
  * Bittorrent Client using Qt and libtorrent.
- * Copyright (C) 2021-2025  Vladimir Golovnev <glassez@yandex.ru>
+ * Copyright (C) 2021-2026  Vladimir Golovnev <glassez@yandex.ru>
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -33,7 +33,7 @@
 #include "base/pathfwd.h"
 #include "resumedatastorage.h"
 
-class QSqlQuery;
+class QSqlRecord;
 
 namespace BitTorrent
 {
@@ -58,8 +58,9 @@ namespace BitTorrent
         int currentDBVersion() const;
         void createDB() const;
         void updateDB(int fromVersion) const;
+        Path backupDB(int version) const;
         void enableWALMode() const;
-        LoadResumeDataResult parseQueryResultRow(const QSqlQuery &query) const;
+        LoadResumeDataResult parseQueryResultRow(const QSqlRecord &record) const;
 
         class Worker;
         Worker *m_asyncWorker = nullptr;
@@ -28,571 +28,707 @@
 
 #include "filterparserthread.h"
 
-#include <cctype>
+#include <algorithm>
+#include <limits>
+#include <optional>
 
 #include <libtorrent/error_code.hpp>
 
+#include <QtEndian>
+#include <QCryptographicHash>
 #include <QDataStream>
+#include <QDateTime>
 #include <QFile>
+#include <QList>
+#include <QThreadPool>
 
 #include "base/global.h"
 #include "base/logger.h"
+#include "base/profile.h"
+#include "base/utils/io.h"
 
 namespace
 {
-    class IPv4Parser
+    using Ruleset = FilterParserThread::Ruleset;
+
+    const int MAX_LOGGED_ERRORS = 5;
+    const int MAX_PARSING_THREADS = 8;
+    const qsizetype MIN_CHUNK_SIZE = 1024 * 1024; // 1 MiB
+
+    const quint32 CACHE_MAGIC = 0x71624946; // "qbIF"
+    const quint32 CACHE_VERSION = 1;
+
+    enum class LineError
     {
-    public:
-        bool tryParse(const char *str)
+        Malformed,
+        MalformedStartIP,
+        MalformedEndIP,
+        MixedIPVersions,
+        EndLowerThanStart
+    };
+
+    struct ChunkError
+    {
+        int line = 0; // relative to the chunk
+        LineError error = LineError::Malformed;
+    };
+
+    struct ChunkResult
+    {
+        std::vector<Ruleset::IPv4Range> ipv4Ranges;
+        std::vector<Ruleset::IPv6Range> ipv6Ranges;
+        int lineCount = 0;
+        int ruleCount = 0;
+        int errorCount = 0;
+        QList<ChunkError> errors;
+    };
+
+    struct ParsedAddress
+    {
+        bool isV4 = true;
+        quint32 v4 = 0;
+        lt::address_v6::bytes_type v6 {};
+    };
+
+    QString lineErrorMessage(const LineError error, const int line)
+    {
+        switch (error)
         {
-            unsigned char octetIndex = 0;
+        case LineError::MalformedStartIP:
+            return FilterParserThread::tr("IP filter line %1 is malformed. Start IP of the range is malformed.").arg(line);
+        case LineError::MalformedEndIP:
+            return FilterParserThread::tr("IP filter line %1 is malformed. End IP of the range is malformed.").arg(line);
+        case LineError::MixedIPVersions:
+            return FilterParserThread::tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!").arg(line);
+        case LineError::EndLowerThanStart:
+            return FilterParserThread::tr("IP filter line %1 is malformed. End IP is lower than Start IP!").arg(line);
+        default:
+            return FilterParserThread::tr("IP filter line %1 is malformed.").arg(line);
+        }
+    }
 
-            const char *octetStart = str;
-            char *endptr = nullptr;
-            for (; *str; ++str)
-            {
-                if (*str == '.')
-                {
-                    const long int extractedNum = strtol(octetStart, &endptr, 10);
-                    if ((extractedNum >= 0L) && (extractedNum <= 255L))
-                        m_buf[octetIndex++] = static_cast<unsigned char>(extractedNum);
-                    else
-                        return false;
-
-                    if (endptr != str)
-                        return false;
-                    if (octetIndex == 4)
-                        return true;
-
-                    octetStart = str + 1;
-                }
-            }
+    QString invalidP2BMessage()
+    {
+        return FilterParserThread::tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file.");
+    }
+
+    bool isDigit(const char c)
+    {
+        return (c >= '0') && (c <= '9');
+    }
 
-            if (str != octetStart)
+    bool parseIPv4Address(const QByteArrayView str, quint32 &address)
+    {
+        quint32 result = 0;
+        qsizetype i = 0;
+        for (int octetIndex = 0; octetIndex < 4; ++octetIndex)
+        {
+            if ((octetIndex > 0) && ((i >= str.size()) || (str[i++] != '.')))
+                return false;
+
+            const qsizetype octetStart = i;
+            quint32 octet = 0;
+            for (; (i < str.size()) && isDigit(str[i]); ++i)
             {
-                const long int extractedNum = strtol(octetStart, &endptr, 10);
-                if ((extractedNum >= 0L) && (extractedNum <= 255L))
-                    m_buf[octetIndex] = static_cast<unsigned char>(strtol(octetStart, &endptr, 10));
-                else
+                octet = (octet * 10) + (str[i] - '0');
+                if (octet > 255)
                     return false;
-
-                if ((endptr == str) && (octetIndex == 3))
-                    return true;
             }
 
-            return false;
-        }
+            if (i == octetStart)
+                return false;
 
-        lt::address_v4::bytes_type parsed() const
-        {
-            return m_buf;
+            result = (result << 8) | octet;
         }
 
-    private:
-        lt::address_v4::bytes_type m_buf {};
-    };
+        if (i != str.size())
+            return false;
 
-    bool parseIPAddress(const char *data, lt::address &address)
+        address = result;
+        return true;
+    }
+
+    bool parseIPAddress(const QByteArrayView str, ParsedAddress &address)
     {
-        IPv4Parser parser;
+        if (parseIPv4Address(str, address.v4))
+        {
+            address.isV4 = true;
+            return true;
+        }
+
         lt::error_code ec;
+        const lt::address parsed = lt::make_address(std::string(str.data(), static_cast<std::size_t>(str.size())), ec);
+        if (ec)
+            return false;
 
-        if (parser.tryParse(data))
-            address = lt::address_v4(parser.parsed());
+        address.isV4 = parsed.is_v4();
+        if (address.isV4)
+            address.v4 = parsed.to_v4().to_uint();
         else
-            address = lt::make_address(data, ec);
-
-        return !ec;
+            address.v6 = parsed.to_v6().to_bytes();
+        return true;
     }
 
-    const int BUFFER_SIZE = 2 * 1024 * 1024; // 2 MiB
-    const int MAX_LOGGED_ERRORS = 5;
-}
-
-FilterParserThread::FilterParserThread(QObject *parent)
-    : QThread(parent)
-{
-}
+    // Mimics strtol() which only needs to tell whether the level is above 127
+    int parseAccessLevel(QByteArrayView str)
+    {
+        str = str.trimmed();
 
-FilterParserThread::~FilterParserThread()
-{
-    m_abort = true;
-    wait();
-}
+        bool negative = false;
+        if (!str.isEmpty() && ((str[0] == '-') || (str[0] == '+')))
+        {
+            negative = (str[0] == '-');
+            str = str.sliced(1);
+        }
 
-// Parser for eMule ip filter in DAT format
-int FilterParserThread::parseDATFilterFile()
-{
-    int ruleCount = 0;
-    QFile file {m_filePath.data()};
-    if (!file.exists()) return ruleCount;
+        int level = 0;
+        for (const char c : str)
+        {
+            if (!isDigit(c) || (level > 255))
+                break;
+            level = (level * 10) + (c - '0');
+        }
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
-        return ruleCount;
+        return negative ? -level : level;
     }
 
-    std::vector<char> buffer(BUFFER_SIZE, 0); // seems a bit faster than QList
-    qint64 bytesRead = 0;
-    int offset = 0;
-    int start = 0;
-    int endOfLine = -1;
-    int nbLine = 0;
-    int parseErrorCount = 0;
-    const auto addLog = [&parseErrorCount](const QString &msg)
+    void addError(ChunkResult &result, const LineError error)
     {
-        if (parseErrorCount <= MAX_LOGGED_ERRORS)
-            LogMsg(msg, Log::CRITICAL);
-    };
+        ++result.errorCount;
+        if (result.errors.size() < MAX_LOGGED_ERRORS)
+            result.errors.append({result.lineCount, error});
+    }
 
-    while (true)
+    void addRange(ChunkResult &result, const QByteArrayView startStr, const QByteArrayView endStr)
     {
-        bytesRead = file.read(buffer.data() + offset, BUFFER_SIZE - offset - 1);
-        if (bytesRead < 0)
-            break;
-        const int dataSize = bytesRead + offset;
-        if ((bytesRead == 0) && (dataSize == 0))
-            break;
+        ParsedAddress startAddr;
+        if (!parseIPAddress(startStr.trimmed(), startAddr))
+        {
+            addError(result, LineError::MalformedStartIP);
+            return;
+        }
 
-        for (start = 0; start < dataSize; ++start)
+        ParsedAddress endAddr;
+        if (!parseIPAddress(endStr.trimmed(), endAddr))
         {
-            endOfLine = -1;
-            // The file might have ended without the last line having a newline
-            if (!((bytesRead == 0) && (dataSize > 0)))
-            {
-                for (int i = start; i < dataSize; ++i)
-                {
-                    if (buffer[i] == '\n')
-                    {
-                        endOfLine = i;
-                        // We need to NULL the newline in case the line has only an IP range.
-                        // In that case the parser won't work for the end IP, because it ends
-                        // with the newline and not with a number.
-                        buffer[i] = '\0';
-                        break;
-                    }
-                }
-            }
-            else
-            {
-                endOfLine = dataSize;
-                buffer[dataSize] = '\0';
-            }
+            addError(result, LineError::MalformedEndIP);
+            return;
+        }
 
-            if (endOfLine == -1)
-            {
-                // read the next chunk from file
-                // but first move(copy) the leftover data to the front of the buffer
-                offset = dataSize - start;
-                memmove(buffer.data(), buffer.data() + start, offset);
-                break;
-            }
+        if (startAddr.isV4 != endAddr.isV4)
+        {
+            addError(result, LineError::MixedIPVersions);
+            return;
+        }
 
-            ++nbLine;
+        if (startAddr.isV4 ? (startAddr.v4 > endAddr.v4) : (startAddr.v6 > endAddr.v6))
+        {
+            addError(result, LineError::EndLowerThanStart);
+            return;
+        }
 
-            if ((buffer[start] == '#')
-                || ((buffer[start] == '/') && ((start + 1 < dataSize) && (buffer[start + 1] == '/'))))
-            {
-                start = endOfLine;
-                continue;
-            }
+        if (startAddr.isV4)
+            result.ipv4Ranges.push_back({startAddr.v4, endAddr.v4});
+        else
+            result.ipv6Ranges.push_back({startAddr.v6, endAddr.v6});
+        ++result.ruleCount;
+    }
 
-            // Each line should follow this format:
-            // 001.009.096.105 - 001.009.096.105 , 000 , Some organization
-            // The 3rd entry is access level and if above 127 the IP range isn't blocked.
-            const int firstComma = findAndNullDelimiter(buffer.data(), ',', start, endOfLine);
-            if (firstComma != -1)
-                findAndNullDelimiter(buffer.data(), ',', firstComma + 1, endOfLine);
+    // Parser for eMule ip filter in DAT format
+    void parseDATLine(const QByteArrayView line, ChunkResult &result)
+    {
+        // Each line should follow this format:
+        // 001.009.096.105 - 001.009.096.105 , 000 , Some organization
+        // The 3rd entry is access level and if above 127 the IP range isn't blocked.
+        QByteArrayView ipRange = line;
+        if (const qsizetype firstComma = line.indexOf(','); firstComma >= 0)
+        {
+            ipRange = line.first(firstComma);
 
             // Check if there is an access value (apparently not mandatory)
-            if (firstComma != -1)
-            {
-                // There is possibly one
-                const long int nbAccess = strtol(buffer.data() + firstComma + 1, nullptr, 10);
-                // Ignoring this rule because access value is too high
-                if (nbAccess > 127L)
-                {
-                    start = endOfLine;
-                    continue;
-                }
-            }
+            QByteArrayView access = line.sliced(firstComma + 1);
+            if (const qsizetype secondComma = access.indexOf(','); secondComma >= 0)
+                access = access.first(secondComma);
+            // Ignoring this rule because access value is too high
+            if (parseAccessLevel(access) > 127)
+                return;
+        }
 
-            // IP Range should be split by a dash
-            const int endOfIPRange = ((firstComma == -1) ? (endOfLine - 1) : (firstComma - 1));
-            const int delimIP = findAndNullDelimiter(buffer.data(), '-', start, endOfIPRange);
-            if (delimIP == -1)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        // IP Range should be split by a dash
+        const qsizetype delimIP = ipRange.indexOf('-');
+        if (delimIP < 0)
+        {
+            addError(result, LineError::Malformed);
+            return;
+        }
 
-            lt::address startAddr;
-            int newStart = trim(buffer.data(), start, delimIP - 1);
-            if (!parseIPAddress(buffer.data() + newStart, startAddr))
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. Start IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        addRange(result, ipRange.first(delimIP), ipRange.sliced(delimIP + 1));
+    }
 
-            lt::address endAddr;
-            newStart = trim(buffer.data(), delimIP + 1, endOfIPRange);
-            if (!parseIPAddress(buffer.data() + newStart, endAddr))
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. End IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+    // Parser for PeerGuardian ip filter in p2p format
+    void parseP2PLine(const QByteArrayView line, ChunkResult &result)
+    {
+        // Each line should follow this format:
+        // Some organization:1.0.0.0-1.255.255.255
+        // The "Some organization" part might contain a ':' char itself so we find the last occurrence
+        const qsizetype partsDelimiter = line.lastIndexOf(':');
+        if (partsDelimiter < 0)
+        {
+            addError(result, LineError::Malformed);
+            return;
+        }
 
-            if ((startAddr.is_v4() != endAddr.is_v4())
-                || (startAddr.is_v6() != endAddr.is_v6()))
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        // IP Range should be split by a dash
+        const QByteArrayView ipRange = line.sliced(partsDelimiter + 1);
+        const qsizetype delimIP = ipRange.indexOf('-');
+        if (delimIP < 0)
+        {
+            addError(result, LineError::Malformed);
+            return;
+        }
 
-            if (startAddr > endAddr)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. End IP is lower than Start IP!").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        addRange(result, ipRange.first(delimIP), ipRange.sliced(delimIP + 1));
+    }
 
-            start = endOfLine;
+    template <typename Range>
+    bool lessByFirst(const Range &left, const Range &right)
+    {
+        return left.first < right.first;
+    }
 
-            // Now Add to the filter
-            try
-            {
-                m_filter.add_rule(startAddr, endAddr, lt::ip_filter::blocked);
-                ++ruleCount;
-            }
-            catch (const std::exception &e)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter exception thrown for line %1. Exception is: %2")
-                       .arg(nbLine).arg(QString::fromLocal8Bit(e.what())));
-            }
+    bool isNextAddress(const quint32 address, const quint32 next)
+    {
+        return (address != std::numeric_limits<quint32>::max()) && ((address + 1) == next);
+    }
+
+    bool isNextAddress(lt::address_v6::bytes_type address, const lt::address_v6::bytes_type &next)
+    {
+        for (auto it = address.rbegin(); it != address.rend(); ++it)
+        {
+            if (++(*it) != 0)
+                return address == next;
         }
 
-        if (start >= dataSize)
-            offset = 0;
+        return false;
     }
 
-    if (parseErrorCount > MAX_LOGGED_ERRORS)
-        LogMsg(tr("%1 extra IP filter parsing errors occurred.", "513 extra IP filter parsing errors occurred.")
-               .arg(parseErrorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
-    return ruleCount;
-}
+    // Joins overlapping and adjacent ranges, `ranges` must be sorted
+    template <typename Range>
+    void mergeRanges(std::vector<Range> &ranges)
+    {
+        if (ranges.empty())
+            return;
 
-// Parser for PeerGuardian ip filter in p2p format
-int FilterParserThread::parseP2PFilterFile()
-{
-    int ruleCount = 0;
-    QFile file {m_filePath.data()};
-    if (!file.exists()) return ruleCount;
+        auto merged = ranges.begin();
+        for (auto it = std::next(ranges.begin()); it != ranges.end(); ++it)
+        {
+            if ((it->first <= merged->last) || isNextAddress(merged->last, it->first))
+                merged->last = std::max(merged->last, it->last);
+            else
+                *(++merged) = *it;
+        }
+        ranges.erase(std::next(merged), ranges.end());
+    }
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    template <typename Range>
+    void sortAndMergeRanges(std::vector<Range> &ranges)
     {
-        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
-        return ruleCount;
+        std::sort(ranges.begin(), ranges.end(), lessByFirst<Range>);
+        mergeRanges(ranges);
     }
 
-    std::vector<char> buffer(BUFFER_SIZE, 0); // seems a bit faster than QList
-    qint64 bytesRead = 0;
-    int offset = 0;
-    int start = 0;
-    int endOfLine = -1;
-    int nbLine = 0;
-    int parseErrorCount = 0;
-    const auto addLog = [&parseErrorCount](const QString &msg)
+    template <typename Range>
+    void appendSortedRanges(std::vector<Range> &ranges, const std::vector<Range> &sortedRanges)
     {
-        if (parseErrorCount <= MAX_LOGGED_ERRORS)
-            LogMsg(msg, Log::CRITICAL);
-    };
+        const auto middle = static_cast<std::ptrdiff_t>(ranges.size());
+        ranges.insert(ranges.end(), sortedRanges.cbegin(), sortedRanges.cend());
+        std::inplace_merge(ranges.begin(), (ranges.begin() + middle), ranges.end(), lessByFirst<Range>);
+    }
 
-    while (true)
+    ChunkResult parseTextChunk(const QByteArrayView data, const FilterParserThread::Format format)
     {
-        bytesRead = file.read(buffer.data() + offset, BUFFER_SIZE - offset - 1);
-        if (bytesRead < 0)
-            break;
-        const int dataSize = bytesRead + offset;
-        if ((bytesRead == 0) && (dataSize == 0))
-            break;
+        ChunkResult result;
 
-        for (start = 0; start < dataSize; ++start)
+        qsizetype start = 0;
+        while (start < data.size())
         {
-            endOfLine = -1;
-            // The file might have ended without the last line having a newline
-            if (!((bytesRead == 0) && (dataSize > 0)))
-            {
-                for (int i = start; i < dataSize; ++i)
-                {
-                    if (buffer[i] == '\n')
-                    {
-                        endOfLine = i;
-                        // We need to NULL the newline in case the line has only an IP range.
-                        // In that case the parser won't work for the end IP, because it ends
-                        // with the newline and not with a number.
-                        buffer[i] = '\0';
-                        break;
-                    }
-                }
-            }
+            qsizetype endOfLine = data.indexOf('\n', start);
+            if (endOfLine < 0)
+                endOfLine = data.size();
+
+            QByteArrayView line = data.sliced(start, (endOfLine - start));
+            start = endOfLine + 1;
+            ++result.lineCount;
+
+            if (line.endsWith('\r'))
+                line.chop(1);
+            if (line.startsWith('#') || line.startsWith("//") || line.trimmed().isEmpty())
+                continue;
+
+            if (format == FilterParserThread::Format::DAT)
+                parseDATLine(line, result);
             else
-            {
-                endOfLine = dataSize;
-                buffer[dataSize] = '\0';
-            }
+                parseP2PLine(line, result);
+        }
 
-            if (endOfLine == -1)
+        sortAndMergeRanges(result.ipv4Ranges);
+        sortAndMergeRanges(result.ipv6Ranges);
+        return result;
+    }
+
+    // Splits `data` into chunks of whole lines
+    QList<QByteArrayView> splitIntoChunks(const QByteArrayView data, const int maxChunkCount)
+    {
+        const qsizetype chunkSize = std::max(MIN_CHUNK_SIZE, ((data.size() / maxChunkCount) + 1));
+
+        QList<QByteArrayView> chunks;
+        qsizetype start = 0;
+        while (start < data.size())
+        {
+            qsizetype end = data.size();
+            if ((start + chunkSize) < data.size())
             {
-                // read the next chunk from file
-                // but first move(copy) the leftover data to the front of the buffer
-                offset = dataSize - start;
-                memmove(buffer.data(), buffer.data() + start, offset);
-                break;
+                const qsizetype endOfLine = data.indexOf('\n', (start + chunkSize));
+                if (endOfLine >= 0)
+                    end = endOfLine + 1;
             }
 
-            ++nbLine;
+            chunks.append(data.sliced(start, (end - start)));
+            start = end;
+        }
 
-            if ((buffer[start] == '#')
-                || ((buffer[start] == '/') && ((start + 1 < dataSize) && (buffer[start + 1] == '/'))))
-                {
-                start = endOfLine;
-                continue;
-            }
+        return chunks;
+    }
 
-            // Each line should follow this format:
-            // Some organization:1.0.0.0-1.255.255.255
-            // The "Some organization" part might contain a ':' char itself so we find the last occurrence
-            const int partsDelimiter = findAndNullDelimiter(buffer.data(), ':', start, endOfLine, true);
-            if (partsDelimiter == -1)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+    class P2BReader
+    {
+    public:
+        explicit P2BReader(const QByteArrayView data)
+            : m_data {data}
+        {
+        }
 
-            // IP Range should be split by a dash
-            const int delimIP = findAndNullDelimiter(buffer.data(), '-', partsDelimiter + 1, endOfLine);
-            if (delimIP == -1)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        bool atEnd() const
+        {
+            return m_pos >= m_data.size();
+        }
 
-            lt::address startAddr;
-            int newStart = trim(buffer.data(), partsDelimiter + 1, delimIP - 1);
-            if (!parseIPAddress(buffer.data() + newStart, startAddr))
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. Start IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        bool readUInt8(quint8 &value)
+        {
+            if ((m_pos + 1) > m_data.size())
+                return false;
 
-            lt::address endAddr;
-            newStart = trim(buffer.data(), delimIP + 1, endOfLine);
-            if (!parseIPAddress(buffer.data() + newStart, endAddr))
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. End IP of the range is malformed.").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+            value = static_cast<quint8>(m_data[m_pos++]);
+            return true;
+        }
 
-            if ((startAddr.is_v4() != endAddr.is_v4())
-                || (startAddr.is_v6() != endAddr.is_v6()))
-                {
-                ++parseErrorCount;
-                addLog(tr("IP filter line %1 is malformed. One IP is IPv4 and the other is IPv6!").arg(nbLine));
-                start = endOfLine;
-                continue;
-            }
+        // Values are stored in network byte order
+        bool readUInt32(quint32 &value)
+        {
+            if ((m_pos + 4) > m_data.size())
+                return false;
 
-            start = endOfLine;
+            value = qFromBigEndian<quint32>(m_data.data() + m_pos);
+            m_pos += 4;
+            return true;
+        }
 
-            try
-            {
-                m_filter.add_rule(startAddr, endAddr, lt::ip_filter::blocked);
-                ++ruleCount;
-            }
-            catch (const std::exception &e)
-            {
-                ++parseErrorCount;
-                addLog(tr("IP filter exception thrown for line %1. Exception is: %2")
-                       .arg(nbLine).arg(QString::fromLocal8Bit(e.what())));
-            }
+        bool skipString()
+        {
+            const qsizetype end = m_data.indexOf('\0', m_pos);
+            if (end < 0)
+                return false;
+
+            m_pos = end + 1;
+            return true;
         }
 
-        if (start >= dataSize)
-            offset = 0;
-    }
+        bool skipHeader()
+        {
+            if (!m_data.startsWith(QByteArrayView("\xFF\xFF\xFF\xFFP2B", 7)))
+                return false;
 
-    if (parseErrorCount > MAX_LOGGED_ERRORS)
-        LogMsg(tr("%1 extra IP filter parsing errors occurred.", "513 extra IP filter parsing errors occurred.")
-               .arg(parseErrorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
-    return ruleCount;
+            m_pos = 7;
+            return true;
+        }
+
+    private:
+        QByteArrayView m_data;
+        qsizetype m_pos = 0;
+    };
+}
+
+FilterParserThread::FilterParserThread(QObject *parent)
+    : QThread(parent)
+{
+}
+
+FilterParserThread::~FilterParserThread()
+{
+    m_abort = true;
+    wait();
+}
+
+FilterParserThread::Ruleset FilterParserThread::parse(const QByteArrayView data, const Format format)
+{
+    if (format == Format::P2B)
+        return parseP2B(data);
+    return parseText(data, format);
 }
 
-int FilterParserThread::getlineInStream(QDataStream &stream, std::string &name, const char delim)
+// Text formats are parsed in chunks of whole lines, in parallel for large files
+FilterParserThread::Ruleset FilterParserThread::parseText(const QByteArrayView data, const Format format)
 {
-    char c;
-    int totalRead = 0;
-    int read;
-    do
-    {
-        read = stream.readRawData(&c, 1);
-        totalRead += read;
-        if (read > 0)
+    const int threadCount = std::clamp(QThread::idealThreadCount(), 1, MAX_PARSING_THREADS);
+    const QList<QByteArrayView> chunks = splitIntoChunks(data, threadCount);
+
+    std::vector<ChunkResult> results(chunks.size());
+    if (chunks.size() == 1)
+    {
+        results[0] = parseTextChunk(chunks[0], format);
+    }
+    else if (chunks.size() > 1)
+    {
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(threadCount);
+        threadPool.setObjectName("FilterParserThread threadPool");
+        for (qsizetype i = 0; i < chunks.size(); ++i)
         {
-            if (c != delim)
+            threadPool.start([&results, &chunks, format, i]
             {
-                name += c;
-            }
-            else
-            {
-                // Delim found
-                return totalRead;
-            }
+                results[i] = parseTextChunk(chunks[i], format);
+            });
+        }
+        threadPool.waitForDone();
+    }
+
+    Ruleset ruleset;
+    int lineOffset = 0;
+    for (const ChunkResult &result : results)
+    {
+        appendSortedRanges(ruleset.ipv4Ranges, result.ipv4Ranges);
+        appendSortedRanges(ruleset.ipv6Ranges, result.ipv6Ranges);
+        ruleset.ruleCount += result.ruleCount;
+        ruleset.errorCount += result.errorCount;
+        for (const ChunkError &error : result.errors)
+        {
+            if (ruleset.errors.size() < MAX_LOGGED_ERRORS)
+                ruleset.errors.append(lineErrorMessage(error.error, (lineOffset + error.line)));
         }
+        lineOffset += result.lineCount;
     }
-    while (read > 0);
 
-    return totalRead;
+    mergeRanges(ruleset.ipv4Ranges);
+    mergeRanges(ruleset.ipv6Ranges);
+    return ruleset;
 }
 
-// Parser for PeerGuardian ip filter in p2p format
-int FilterParserThread::parseP2BFilterFile()
+// Parser for PeerGuardian ip filter in p2b format
+FilterParserThread::Ruleset FilterParserThread::parseP2B(const QByteArrayView data)
 {
-    int ruleCount = 0;
-    QFile file {m_filePath.data()};
-    if (!file.exists()) return ruleCount;
-
-    if (!file.open(QIODevice::ReadOnly))
+    Ruleset ruleset;
+    const auto finish = [&ruleset](const bool isValid) -> Ruleset
     {
-        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
-        return ruleCount;
-    }
+        if (!isValid)
+        {
+            ++ruleset.errorCount;
+            ruleset.errors.append(invalidP2BMessage());
+        }
 
-    QDataStream stream(&file);
-    // Read header
-    char buf[7];
-    unsigned char version;
-    if (!stream.readRawData(buf, sizeof(buf))
-        || (memcmp(buf, "\xFF\xFF\xFF\xFFP2B", 7) != 0)
-        || !stream.readRawData(reinterpret_cast<char*>(&version), sizeof(version)))
+        sortAndMergeRanges(ruleset.ipv4Ranges);
+        return std::move(ruleset);
+    };
+    const auto addRule = [&ruleset](const quint32 first, const quint32 last)
     {
-        LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-        return ruleCount;
-    }
+        if (first > last)
+            return;
+
+        ruleset.ipv4Ranges.push_back({first, last});
+        ++ruleset.ruleCount;
+    };
+
+    P2BReader reader {data};
+    quint8 version = 0;
+    if (!reader.skipHeader() || !reader.readUInt8(version))
+        return finish(false);
 
     if ((version == 1) || (version == 2))
     {
-        qDebug ("p2b version 1 or 2");
-        unsigned int start, end;
-
-        std::string name;
-        while (getlineInStream(stream, name, '\0') && !m_abort)
+        qDebug("p2b version 1 or 2");
+        while (!reader.atEnd())
         {
-            if (!stream.readRawData(reinterpret_cast<char*>(&start), sizeof(start))
-                || !stream.readRawData(reinterpret_cast<char*>(&end), sizeof(end)))
-                {
-                LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-                return ruleCount;
-            }
+            quint32 start = 0;
+            quint32 end = 0;
+            if (!reader.skipString() || !reader.readUInt32(start) || !reader.readUInt32(end))
+                return finish(false);
 
-            // Network byte order to Host byte order
-            // asio address_v4 constructor expects it
-            // that way
-            const lt::address_v4 first(ntohl(start));
-            const lt::address_v4 last(ntohl(end));
-            // Apply to bittorrent session
-            try
-            {
-                m_filter.add_rule(first, last, lt::ip_filter::blocked);
-                ++ruleCount;
-            }
-            catch (const std::exception &) {}
+            addRule(start, end);
         }
     }
     else if (version == 3)
     {
-        qDebug ("p2b version 3");
-        unsigned int namecount;
-        if (!stream.readRawData(reinterpret_cast<char*>(&namecount), sizeof(namecount)))
-        {
-            LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-            return ruleCount;
-        }
+        qDebug("p2b version 3");
+        quint32 nameCount = 0;
+        if (!reader.readUInt32(nameCount))
+            return finish(false);
 
-        namecount = ntohl(namecount);
         // Reading names although, we don't really care about them
-        for (unsigned int i = 0; i < namecount; ++i)
+        for (quint32 i = 0; i < nameCount; ++i)
         {
-            std::string name;
-            if (!getlineInStream(stream, name, '\0'))
-            {
-                LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-                return ruleCount;
-            }
-
-            if (m_abort) return ruleCount;
+            if (!reader.skipString())
+                return finish(false);
         }
 
         // Reading the ranges
-        unsigned int rangecount;
-        if (!stream.readRawData(reinterpret_cast<char*>(&rangecount), sizeof(rangecount)))
+        quint32 rangeCount = 0;
+        if (!reader.readUInt32(rangeCount))
+            return finish(false);
+
+        for (quint32 i = 0; i < rangeCount; ++i)
         {
-            LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-            return ruleCount;
+            quint32 name = 0;
+            quint32 start = 0;
+            quint32 end = 0;
+            if (!reader.readUInt32(name) || !reader.readUInt32(start) || !reader.readUInt32(end))
+                return finish(false);
+
+            addRule(start, end);
         }
+    }
+    else
+    {
+        return finish(false);
+    }
 
-        rangecount = ntohl(rangecount);
-        unsigned int name, start, end;
-        for (unsigned int i = 0; i < rangecount; ++i)
-        {
-            if (!stream.readRawData(reinterpret_cast<char*>(&name), sizeof(name))
-                || !stream.readRawData(reinterpret_cast<char*>(&start), sizeof(start))
-                || !stream.readRawData(reinterpret_cast<char*>(&end), sizeof(end)))
-                {
-                LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
-                return ruleCount;
-            }
+    return finish(true);
+}
 
-            // Network byte order to Host byte order
-            // asio address_v4 constructor expects it
-            // that way
-            const lt::address_v4 first(ntohl(start));
-            const lt::address_v4 last(ntohl(end));
-            // Apply to bittorrent session
-            try
-            {
-                m_filter.add_rule(first, last, lt::ip_filter::blocked);
-                ++ruleCount;
-            }
-            catch (const std::exception &) {}
+lt::ip_filter FilterParserThread::toIPFilter(const Ruleset &ruleset)
+{
+    lt::ip_filter filter;
+    for (const Ruleset::IPv4Range &range : ruleset.ipv4Ranges)
+        filter.add_rule(lt::address_v4(range.first), lt::address_v4(range.last), lt::ip_filter::blocked);
+    for (const Ruleset::IPv6Range &range : ruleset.ipv6Ranges)
+        filter.add_rule(lt::address_v6(range.first), lt::address_v6(range.last), lt::ip_filter::blocked);
+    return filter;
+}
 
-            if (m_abort) return ruleCount;
-        }
+Path FilterParserThread::cacheFilePath()
+{
+    return specialFolderLocation(SpecialFolder::Cache) / Path(u"ipfilter.cache"_s);
+}
+
+// The cache holds the compiled ranges of the last parsed filter file.
+// Ranges are stored in host byte order since the cache is never shared between machines.
+bool FilterParserThread::loadCache(Ruleset &ruleset, const QByteArray &sourceHash, const qint64 sourceMTime) const
+{
+    QFile file {cacheFilePath().data()};
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QByteArray data = file.readAll();
+    QDataStream stream {data};
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString filePath;
+    qint64 mtime = 0;
+    QByteArray hash;
+    qint32 ruleCount = 0;
+    quint64 ipv4Count = 0;
+    quint64 ipv6Count = 0;
+    stream >> magic >> version >> filePath >> mtime >> hash >> ruleCount >> ipv4Count >> ipv6Count;
+    if ((stream.status() != QDataStream::Ok) || (magic != CACHE_MAGIC) || (version != CACHE_VERSION)
+        || (filePath != m_filePath.data()) || (mtime != sourceMTime) || (hash != sourceHash))
+    {
+        return false;
+    }
+
+    const auto available = static_cast<quint64>(stream.device()->bytesAvailable());
+    if (ipv4Count > (available / sizeof(Ruleset::IPv4Range)))
+        return false;
+    const quint64 ipv6Size = available - (ipv4Count * sizeof(Ruleset::IPv4Range));
+    if ((ipv6Count > (ipv6Size / sizeof(Ruleset::IPv6Range))) || ((ipv6Count * sizeof(Ruleset::IPv6Range)) != ipv6Size))
+        return false;
+
+    ruleset = {};
+    ruleset.ruleCount = ruleCount;
+    ruleset.ipv4Ranges.resize(ipv4Count);
+    ruleset.ipv6Ranges.resize(ipv6Count);
+    stream.readRawData(reinterpret_cast<char *>(ruleset.ipv4Ranges.data()), (ipv4Count * sizeof(Ruleset::IPv4Range)));
+    stream.readRawData(reinterpret_cast<char *>(ruleset.ipv6Ranges.data()), (ipv6Count * sizeof(Ruleset::IPv6Range)));
+    return (stream.status() == QDataStream::Ok);
+}
+
+void FilterParserThread::saveCache(const Ruleset &ruleset, const QByteArray &sourceHash, const qint64 sourceMTime) const
+{
+    QByteArray data;
+    QDataStream stream {&data, QIODevice::WriteOnly};
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << CACHE_MAGIC << CACHE_VERSION << m_filePath.data() << sourceMTime << sourceHash
+        << static_cast<qint32>(ruleset.ruleCount)
+        << static_cast<quint64>(ruleset.ipv4Ranges.size()) << static_cast<quint64>(ruleset.ipv6Ranges.size());
+    stream.writeRawData(reinterpret_cast<const char *>(ruleset.ipv4Ranges.data())
+        , (ruleset.ipv4Ranges.size() * sizeof(Ruleset::IPv4Range)));
+    stream.writeRawData(reinterpret_cast<const char *>(ruleset.ipv6Ranges.data())
+        , (ruleset.ipv6Ranges.size() * sizeof(Ruleset::IPv6Range)));
+
+    const nonstd::expected<void, QString> result = Utils::IO::saveToFile(cacheFilePath(), data);
+    if (!result)
+        LogMsg(tr("Couldn't save IP filter cache. Error: %1").arg(result.error()), Log::WARNING);
+}
+
+FilterParserThread::Ruleset FilterParserThread::parseFilterFile(const Format format) const
+{
+    QFile file {m_filePath.data()};
+    if (!file.exists())
+        return {};
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        LogMsg(tr("I/O Error: Could not open IP filter file in read mode."), Log::CRITICAL);
+        return {};
+    }
+
+    // Parse the file in place when it can be mapped into memory
+    const qint64 fileSize = file.size();
+    const uchar *mappedData = (fileSize > 0) ? file.map(0, fileSize) : nullptr;
+    QByteArray fileData;
+    QByteArrayView data;
+    if (mappedData)
+    {
+        data = QByteArrayView(mappedData, fileSize);
     }
     else
     {
-        LogMsg(tr("Parsing Error: The filter file is not a valid PeerGuardian P2B file."), Log::CRITICAL);
+        fileData = file.readAll();
+        data = fileData;
+    }
+
+    const QByteArray sourceHash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    const qint64 sourceMTime = file.fileTime(QFileDevice::FileModificationTime).toMSecsSinceEpoch();
+    if (Ruleset cachedRuleset; loadCache(cachedRuleset, sourceHash, sourceMTime))
+    {
+        qDebug("IP filter loaded from cache");
+        return cachedRuleset;
     }
 
-    return ruleCount;
+    if (m_abort)
+        return {};
+
+    Ruleset ruleset = parse(data, format);
+    for (const QString &error : asConst(ruleset.errors))
+        LogMsg(error, Log::CRITICAL);
+    if (ruleset.errorCount > MAX_LOGGED_ERRORS)
+    {
+        LogMsg(tr("%1 extra IP filter parsing errors occurred.", "513 extra IP filter parsing errors occurred.")
+               .arg(ruleset.errorCount - MAX_LOGGED_ERRORS), Log::CRITICAL);
+    }
+
+    if (!m_abort)
+        saveCache(ruleset, sourceHash, sourceMTime);
+    return ruleset;
 }
 
 // Process ip filter file
@@ -624,28 +760,21 @@ lt::ip_filter FilterParserThread::IPfilter()
 void FilterParserThread::run()
 {
     qDebug("Processing filter file");
-    int ruleCount = 0;
+    std::optional<Format> format;
     if (m_filePath.hasExtension(u".p2p"_s))
-    {
-        // PeerGuardian p2p file
-        ruleCount = parseP2PFilterFile();
-    }
+        format = Format::P2P; // PeerGuardian p2p file
     else if (m_filePath.hasExtension(u".p2b"_s))
-    {
-        // PeerGuardian p2b file
-        ruleCount = parseP2BFilterFile();
-    }
+        format = Format::P2B; // PeerGuardian p2b file
     else if (m_filePath.hasExtension(u".dat"_s))
-    {
-        // eMule DAT format
-        ruleCount = parseDATFilterFile();
-    }
+        format = Format::DAT; // eMule DAT format
 
+    const Ruleset ruleset = format ? parseFilterFile(*format) : Ruleset();
     if (m_abort) return;
 
     try
     {
-        emit IPFilterParsed(ruleCount);
+        m_filter = toIPFilter(ruleset);
+        emit IPFilterParsed(ruleset.ruleCount);
     }
     catch (const std::exception &)
     {
@@ -654,60 +783,3 @@ void FilterParserThread::run()
 
     qDebug("IP Filter thread: finished parsing, filter applied");
 }
-
-int FilterParserThread::findAndNullDelimiter(char *const data, const char delimiter, const int start, const int end, const bool reverse)
-{
-    if (!reverse)
-    {
-        for (int i = start; i <= end; ++i)
-        {
-            if (data[i] == delimiter)
-            {
-                data[i] = '\0';
-                return i;
-            }
-        }
-    }
-    else
-    {
-        for (int i = end; i >= start; --i)
-        {
-            if (data[i] == delimiter)
-            {
-                data[i] = '\0';
-                return i;
-            }
-        }
-    }
-
-    return -1;
-}
-
-int FilterParserThread::trim(char *const data, const int start, const int end)
-{
-    if (start >= end) return start;
-    int newStart = start;
-
-    for (int i = start; i <= end; ++i)
-    {
-        if (isspace(data[i]) != 0)
-        {
-            data[i] = '\0';
-        }
-        else
-        {
-            newStart = i;
-            break;
-        }
-    }
-
-    for (int i = end; i >= start; --i)
-    {
-        if (isspace(data[i]) != 0)
-            data[i] = '\0';
-        else
-            break;
-    }
-
-    return newStart;
-}
@@ -28,25 +28,61 @@
 
 #pragma once
 
+#include <vector>
+
+#include <libtorrent/address.hpp>
 #include <libtorrent/ip_filter.hpp>
 
+#include <QtTypes>
+#include <QByteArrayView>
+#include <QStringList>
 #include <QThread>
 
 #include "base/path.h"
 
-class QDataStream;
-
 class FilterParserThread final : public QThread
 {
     Q_OBJECT
     Q_DISABLE_COPY_MOVE(FilterParserThread)
 
 public:
+    enum class Format
+    {
+        DAT,
+        P2P,
+        P2B
+    };
+
+    // Blocked address ranges of a filter file, sorted and with overlapping ranges merged
+    struct Ruleset
+    {
+        struct IPv4Range
+        {
+            quint32 first = 0;
+            quint32 last = 0;
+        };
+
+        struct IPv6Range
+        {
+            lt::address_v6::bytes_type first {};
+            lt::address_v6::bytes_type last {};
+        };
+
+        std::vector<IPv4Range> ipv4Ranges;
+        std::vector<IPv6Range> ipv6Ranges;
+        int ruleCount = 0;
+        int errorCount = 0;
+        QStringList errors; // the first MAX_LOGGED_ERRORS ones only
+    };
+
     FilterParserThread(QObject *parent = nullptr);
     ~FilterParserThread();
     void processFilterFile(const Path &filePath);
     lt::ip_filter IPfilter();
 
+    static Ruleset parse(QByteArrayView data, Format format);
+    static lt::ip_filter toIPFilter(const Ruleset &ruleset);
+
 signals:
     void IPFilterParsed(int ruleCount);
     void IPFilterError();
@@ -55,12 +91,12 @@ protected:
     void run() override;
 
 private:
-    int findAndNullDelimiter(char *data, char delimiter, int start, int end, bool reverse = false);
-    int trim(char *data, int start, int end);
-    int parseDATFilterFile();
-    int parseP2PFilterFile();
-    int getlineInStream(QDataStream &stream, std::string &name, char delim);
-    int parseP2BFilterFile();
+    static Ruleset parseText(QByteArrayView data, Format format);
+    static Ruleset parseP2B(QByteArrayView data);
+    static Path cacheFilePath();
+    Ruleset parseFilterFile(Format format) const;
+    bool loadCache(Ruleset &ruleset, const QByteArray &sourceHash, qint64 sourceMTime) const;
+    void saveCache(const Ruleset &ruleset, const QByteArray &sourceHash, qint64 sourceMTime) const;
 
     bool m_abort = false;
     Path m_filePath;
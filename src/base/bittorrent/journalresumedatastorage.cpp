@@ -0,0 +1,809 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "journalresumedatastorage.h"
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <zlib.h>
+
+#include <libtorrent/sha1_hash.hpp>
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMetaObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QThread>
+#include <QTimer>
+#include <QtEndian>
+
+#include "base/exceptions.h"
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/path.h"
+#include "base/utils/io.h"
+#include "bencoderesumedatastorage.h"
+#include "infohash.h"
+#include "loadtorrentparams.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    // Version is the part of signature so incompatible files are rejected
+    const QByteArray FILE_SIGNATURE = QByteArrayLiteral("qBtRDJ02");
+
+    // Record consists of header (payload size, checksum, record type and 3 reserved bytes)
+    // and payload. Checksum covers the rest of the header as well as the payload.
+    // All the records except the queue one start their payload with torrent ID.
+    const qint64 RECORD_HEADER_SIZE = 12;
+    const qint64 TORRENT_ID_SIZE = BitTorrent::TorrentID::length();
+
+    // Pending records are written by single write and sync
+    const std::chrono::milliseconds FLUSH_DELAY = 100ms;
+    const std::chrono::seconds FLUSH_RETRY_DELAY = 10s;
+    // File is compacted when it is at least this large and outdated records take more than half of it
+    const qint64 COMPACTION_MIN_FILE_SIZE = 16 * 1024 * 1024;
+    const int COMPACTION_GARBAGE_RATIO = 2;
+
+    enum class RecordType : quint8
+    {
+        ResumeData = 1,
+        Metadata = 2,
+        Remove = 3,
+        Queue = 4
+    };
+
+    bool isValidRecordType(const quint8 type)
+    {
+        return (type >= static_cast<quint8>(RecordType::ResumeData)) && (type <= static_cast<quint8>(RecordType::Queue));
+    }
+
+    quint32 calculateChecksum(const RecordType type, const QByteArrayView payload)
+    {
+        // Header fields except the checksum itself, in the same layout as they are stored
+        char header[RECORD_HEADER_SIZE - 4] {};
+        qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), header);
+        header[4] = static_cast<char>(type);
+
+        const uLong checksum = ::crc32(::crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>(header), sizeof(header));
+        return ::crc32(checksum, reinterpret_cast<const Bytef *>(payload.data()), static_cast<uInt>(payload.size()));
+    }
+
+    QByteArray toBytes(const BitTorrent::TorrentID &id)
+    {
+        const lt::sha1_hash hash = id;
+        return {hash.data(), TORRENT_ID_SIZE};
+    }
+
+    BitTorrent::TorrentID torrentIDFromBytes(const QByteArrayView data)
+    {
+        return lt::sha1_hash(data.data());
+    }
+
+    QByteArray makeRecord(const RecordType type, const QByteArray &payload, const quint32 checksum)
+    {
+        QByteArray record(RECORD_HEADER_SIZE, '\0');
+        qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), record.data());
+        qToLittleEndian<quint32>(checksum, (record.data() + 4));
+        record[8] = static_cast<char>(type);
+        record.append(payload);
+        return record;
+    }
+
+    // Returns data stored in the record (i.e. without header and torrent ID).
+    // Record checksums are verified when the file is scanned so they aren't checked here.
+    // Returned data refers to the record so it must outlive the result.
+    QByteArray extractRecordData(const QByteArray &record, bool *ok)
+    {
+        const qint64 dataOffset = RECORD_HEADER_SIZE + TORRENT_ID_SIZE;
+        *ok = (record.size() >= dataOffset);
+        if (!*ok)
+            return {};
+
+        return QByteArray::fromRawData((record.constData() + dataOffset), (record.size() - dataOffset));
+    }
+
+    struct ScannedRecord
+    {
+        RecordType type;
+        qint64 size = 0;
+        quint32 checksum = 0;
+        QByteArrayView payload;
+    };
+
+    // Returns the record starting at given offset if it is complete and intact
+    std::optional<ScannedRecord> scanRecord(const QByteArrayView data, const qint64 offset)
+    {
+        if ((data.size() - offset) < RECORD_HEADER_SIZE)
+            return std::nullopt;
+
+        const char *header = data.data() + offset;
+        const auto payloadSize = qFromLittleEndian<quint32>(header);
+        const auto checksum = qFromLittleEndian<quint32>(header + 4);
+        const auto type = static_cast<quint8>(header[8]);
+        if (!isValidRecordType(type) || (header[9] != 0) || (header[10] != 0) || (header[11] != 0))
+            return std::nullopt;
+
+        const qint64 recordSize = RECORD_HEADER_SIZE + payloadSize;
+        if (recordSize > (data.size() - offset))
+            return std::nullopt;
+
+        const auto recordType = static_cast<RecordType>(type);
+        const QByteArrayView payload = data.sliced((offset + RECORD_HEADER_SIZE), payloadSize);
+        if (calculateChecksum(recordType, payload) != checksum)
+            return std::nullopt;
+        if ((recordType != RecordType::Queue) && (payload.size() < TORRENT_ID_SIZE))
+            return std::nullopt;
+
+        return ScannedRecord {.type = recordType, .size = recordSize, .checksum = checksum, .payload = payload};
+    }
+
+    bool syncFile(QFile &file)
+    {
+#ifdef Q_OS_WIN
+        return (::_commit(file.handle()) == 0);
+#else
+        return (::fsync(file.handle()) == 0);
+#endif
+    }
+}
+
+namespace BitTorrent
+{
+    class JournalResumeDataStorage::Worker final : public QObject
+    {
+        Q_DISABLE_COPY_MOVE(Worker)
+
+    public:
+        Worker(const Path &path, QReadWriteLock &lock, QHash<TorrentID, IndexEntry> &publishedIndex);
+        ~Worker() override;
+
+        QList<TorrentID> queue() const;
+
+        void store(const TorrentID &id, const LoadTorrentParams &resumeData);
+        void remove(const TorrentID &id);
+        void storeQueue(const QList<TorrentID> &queue);
+
+    private:
+        void scan();
+        RecordLocation appendRecord(RecordType type, const QByteArray &payload);
+        RecordLocation appendRecord(RecordType type, const QByteArray &payload, quint32 checksum);
+        void replaceRecord(RecordLocation &location, const RecordLocation &newLocation);
+        void scheduleFlush(std::chrono::milliseconds delay = FLUSH_DELAY);
+        bool flush();
+        bool needCompaction() const;
+        void compact();
+
+        const Path m_path;
+        QReadWriteLock &m_lock;
+        QHash<TorrentID, IndexEntry> &m_publishedIndex;
+
+        QFile m_file;
+        qint64 m_fileSize = 0;
+        qint64 m_liveDataSize = 0;
+        QByteArray m_pendingData;
+        QSet<TorrentID> m_changedTorrents;
+        QHash<TorrentID, IndexEntry> m_index;
+        QList<TorrentID> m_queue;
+        RecordLocation m_queueRecord;
+        bool m_isFlushScheduled = false;
+    };
+}
+
+BitTorrent::JournalResumeDataStorage::JournalResumeDataStorage(const Path &path, QObject *parent)
+    : ResumeDataStorage(path, parent)
+    , m_ioThread {new QThread}
+    , m_asyncWorker {new Worker(path, m_lock, m_index)}
+{
+    const QList<TorrentID> queue = m_asyncWorker->queue();
+    m_registeredTorrents.reserve(m_index.size());
+    QSet<TorrentID> queuedTorrents;
+    queuedTorrents.reserve(queue.size());
+    for (const TorrentID &torrentID : queue)
+    {
+        if (m_index.contains(torrentID))
+        {
+            m_registeredTorrents.append(torrentID);
+            queuedTorrents.insert(torrentID);
+        }
+    }
+    for (auto it = m_index.cbegin(); it != m_index.cend(); ++it)
+    {
+        if (!queuedTorrents.contains(it.key()))
+            m_registeredTorrents.append(it.key());
+    }
+
+    qDebug() << "Registered torrents count: " << m_registeredTorrents.size();
+
+    m_asyncWorker->moveToThread(m_ioThread.get());
+    connect(m_ioThread.get(), &QThread::finished, m_asyncWorker, &QObject::deleteLater);
+    m_ioThread->setObjectName("JournalResumeDataStorage m_ioThread");
+    m_ioThread->start();
+}
+
+QList<BitTorrent::TorrentID> BitTorrent::JournalResumeDataStorage::registeredTorrents() const
+{
+    return m_registeredTorrents;
+}
+
+BitTorrent::LoadResumeDataResult BitTorrent::JournalResumeDataStorage::load(const TorrentID &id) const
+{
+    QByteArray resumeDataRecord;
+    QByteArray metadataRecord;
+    {
+        const QReadLocker locker {&m_lock};
+
+        const auto it = m_index.constFind(id);
+        if ((it == m_index.cend()) || (it->resumeData.size == 0))
+        {
+            return nonstd::make_unexpected(tr("Couldn't load resume data of torrent '%1'. Error: %2")
+                    .arg(id.toString(), tr("Not found.")));
+        }
+
+        QFile file {path().data()};
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return nonstd::make_unexpected(tr("Couldn't load resume data of torrent '%1'. Error: %2")
+                    .arg(id.toString(), file.errorString()));
+        }
+
+        const auto readRecord = [&file](const RecordLocation &location) -> QByteArray
+        {
+            if ((location.size == 0) || !file.seek(location.offset))
+                return {};
+            return file.read(location.size);
+        };
+
+        resumeDataRecord = readRecord(it->resumeData);
+        metadataRecord = readRecord(it->metadata);
+    }
+
+    bool ok = false;
+    const QByteArray resumeData = extractRecordData(resumeDataRecord, &ok);
+    if (!ok)
+        return nonstd::make_unexpected(tr("Cannot parse resume data: %1").arg(tr("record is corrupted")));
+
+    QByteArray metadata;
+    if (!metadataRecord.isEmpty())
+    {
+        metadata = extractRecordData(metadataRecord, &ok);
+        if (!ok)
+            return nonstd::make_unexpected(tr("Cannot parse torrent info: %1").arg(tr("record is corrupted")));
+    }
+
+    return BencodeResumeDataStorage::decodeResumeData(resumeData, metadata);
+}
+
+void BitTorrent::JournalResumeDataStorage::store(const TorrentID &id, LoadTorrentParams resumeData) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, id, resumeData = std::move(resumeData)]
+    {
+        m_asyncWorker->store(id, resumeData);
+    });
+}
+
+void BitTorrent::JournalResumeDataStorage::remove(const TorrentID &id) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, id]()
+    {
+        m_asyncWorker->remove(id);
+    });
+}
+
+void BitTorrent::JournalResumeDataStorage::storeQueue(const QList<TorrentID> &queue) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, queue]()
+    {
+        m_asyncWorker->storeQueue(queue);
+    });
+}
+
+void BitTorrent::JournalResumeDataStorage::doLoadAll() const
+{
+    qDebug() << "Loading torrents count: " << m_registeredTorrents.size();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    emit const_cast<JournalResumeDataStorage *>(this)->loadStarted(m_registeredTorrents);
+
+    LoadStatistics statistics;
+    {
+        const QReadLocker locker {&m_lock};
+
+        QFile file {path().data()};
+        if (!file.open(QIODevice::ReadOnly))
+            throw RuntimeError(file.errorString());
+
+        // The whole file is read sequentially, so mapping it allows to avoid copying of the records.
+        // If it can't be mapped (e.g. due to lack of address space) the records are read one by one.
+        const qint64 fileSize = file.size();
+        uchar *fileData = file.map(0, fileSize);
+        const auto readRecord = [&file, fileData, fileSize](const RecordLocation &location) -> QByteArray
+        {
+            if ((location.size == 0) || ((location.offset + location.size) > fileSize))
+                return {};
+
+            if (fileData)
+                return QByteArray::fromRawData(reinterpret_cast<const char *>(fileData + location.offset), location.size);
+
+            if (!file.seek(location.offset))
+                return {};
+            return file.read(location.size);
+        };
+
+        struct Records
+        {
+            QByteArray resumeData;
+            QByteArray metadata;
+        };
+
+        for (qsizetype batchStart = 0; batchStart < m_registeredTorrents.size(); batchStart += LOAD_BATCH_SIZE)
+        {
+            QElapsedTimer readTimer;
+            readTimer.start();
+
+            const QList<TorrentID> batch = m_registeredTorrents.mid(batchStart, LOAD_BATCH_SIZE);
+            std::vector<Records> batchRecords;
+            batchRecords.reserve(static_cast<std::size_t>(batch.size()));
+            for (const TorrentID &torrentID : batch)
+            {
+                const IndexEntry entry = m_index.value(torrentID);
+                batchRecords.push_back({.resumeData = readRecord(entry.resumeData), .metadata = readRecord(entry.metadata)});
+            }
+
+            statistics.readTime += readTimer.nsecsElapsed();
+
+            std::vector<LoadResumeDataResult> results = loadInParallel(batch.size(), [&batchRecords, &statistics](const qsizetype index) -> LoadResumeDataResult
+            {
+                QElapsedTimer decodeTimer;
+                decodeTimer.start();
+
+                const Records &records = batchRecords[static_cast<std::size_t>(index)];
+
+                bool ok = false;
+                const QByteArray resumeData = extractRecordData(records.resumeData, &ok);
+                if (!ok)
+                    return nonstd::make_unexpected(tr("Cannot parse resume data: %1").arg(tr("record is corrupted")));
+
+                QByteArray metadata;
+                if (!records.metadata.isEmpty())
+                {
+                    metadata = extractRecordData(records.metadata, &ok);
+                    if (!ok)
+                        return nonstd::make_unexpected(tr("Cannot parse torrent info: %1").arg(tr("record is corrupted")));
+                }
+
+                LoadResumeDataResult result = BencodeResumeDataStorage::decodeResumeData(resumeData, metadata);
+                statistics.decodeTime += decodeTimer.nsecsElapsed();
+                return result;
+            });
+
+            for (qsizetype i = 0; i < batch.size(); ++i)
+                onResumeDataLoaded(batch[i], std::move(results[static_cast<std::size_t>(i)]));
+        }
+
+        // Decoded resume data doesn't refer to the mapped memory so it's safe to unmap it now
+        if (fileData)
+            file.unmap(fileData);
+    }
+
+    logLoadStatistics(m_registeredTorrents.size(), timer.elapsed(), statistics);
+
+    emit const_cast<JournalResumeDataStorage *>(this)->loadFinished();
+}
+
+BitTorrent::JournalResumeDataStorage::Worker::Worker(const Path &path, QReadWriteLock &lock, QHash<TorrentID, IndexEntry> &publishedIndex)
+    : m_path {path}
+    , m_lock {lock}
+    , m_publishedIndex {publishedIndex}
+    , m_file {path.data()}
+{
+    if (!m_file.open(QIODevice::ReadWrite))
+        throw RuntimeError(tr("Cannot open resume data journal \"%1\". Error: \"%2\"").arg(path.toString(), m_file.errorString()));
+
+    scan();
+    m_publishedIndex = m_index;
+}
+
+BitTorrent::JournalResumeDataStorage::Worker::~Worker()
+{
+    flush();
+}
+
+QList<BitTorrent::TorrentID> BitTorrent::JournalResumeDataStorage::Worker::queue() const
+{
+    return m_queue;
+}
+
+void BitTorrent::JournalResumeDataStorage::Worker::store(const TorrentID &id, const LoadTorrentParams &resumeData)
+{
+    const BencodeResumeDataStorage::EncodedResumeData encodedResumeData = BencodeResumeDataStorage::encodeResumeData(resumeData);
+    const QByteArray idBytes = toBytes(id);
+
+    IndexEntry &entry = m_index[id];
+
+    // Metadata is written only if it differs from already stored one
+    if (!encodedResumeData.metadata.isEmpty())
+    {
+        const QByteArray payload = idBytes + encodedResumeData.metadata;
+        const quint32 checksum = calculateChecksum(RecordType::Metadata, payload);
+        if ((entry.metadata.checksum != checksum) || (entry.metadata.size != (RECORD_HEADER_SIZE + payload.size())))
+            replaceRecord(entry.metadata, appendRecord(RecordType::Metadata, payload, checksum));
+    }
+
+    replaceRecord(entry.resumeData, appendRecord(RecordType::ResumeData, (idBytes + encodedResumeData.resumeData)));
+
+    m_changedTorrents.insert(id);
+    scheduleFlush();
+}
+
+void BitTorrent::JournalResumeDataStorage::Worker::remove(const TorrentID &id)
+{
+    const auto it = m_index.constFind(id);
+    if (it == m_index.cend())
+        return;
+
+    m_liveDataSize -= (it->resumeData.size + it->metadata.size);
+    m_index.erase(it);
+    appendRecord(RecordType::Remove, toBytes(id));
+
+    m_changedTorrents.insert(id);
+    scheduleFlush();
+}
+
+void BitTorrent::JournalResumeDataStorage::Worker::storeQueue(const QList<TorrentID> &queue)
+{
+    QByteArray payload;
+    payload.reserve(TORRENT_ID_SIZE * queue.size());
+    for (const TorrentID &torrentID : queue)
+        payload.append(toBytes(torrentID));
+
+    replaceRecord(m_queueRecord, appendRecord(RecordType::Queue, payload));
+    m_queue = queue;
+
+    scheduleFlush();
+}
+
+void BitTorrent::JournalResumeDataStorage::Worker::scan()
+{
+    const qint64 fileSize = m_file.size();
+    if (fileSize == 0)
+    {
+        if ((m_file.write(FILE_SIGNATURE) != FILE_SIGNATURE.size()) || !m_file.flush())
+            throw RuntimeError(tr("Cannot write resume data journal \"%1\". Error: \"%2\"").arg(m_path.toString(), m_file.errorString()));
+
+        m_fileSize = FILE_SIGNATURE.size();
+        m_liveDataSize = m_fileSize;
+        return;
+    }
+
+    QByteArray fileContent;
+    uchar *mappedData = m_file.map(0, fileSize);
+    if (mappedData)
+        fileContent = QByteArray::fromRawData(reinterpret_cast<const char *>(mappedData), fileSize);
+    else
+        fileContent = m_file.readAll();
+
+    if (!fileContent.startsWith(FILE_SIGNATURE))
+    {
+        if (mappedData)
+            m_file.unmap(mappedData);
+        throw RuntimeError(tr("Resume data journal \"%1\" has unsupported format.").arg(m_path.toString()));
+    }
+
+    // Damaged data doesn't stop the scan. The records following it are found by
+    // looking for the next intact one, so a single bad header doesn't cost all of them.
+    int corruptedRegionsCount = 0;
+    QByteArray discardedData;
+    qint64 endOffset = FILE_SIGNATURE.size();
+    qint64 offset = endOffset;
+    while (offset < fileContent.size())
+    {
+        const std::optional<ScannedRecord> record = scanRecord(fileContent, offset);
+        if (!record)
+        {
+            ++offset;
+            continue;
+        }
+
+        if (offset > endOffset)
+        {
+            ++corruptedRegionsCount;
+            discardedData.append(QByteArrayView(fileContent).sliced(endOffset, (offset - endOffset)));
+        }
+
+        const RecordLocation location {.offset = offset, .size = record->size, .checksum = record->checksum};
+        const QByteArrayView payload = record->payload;
+        offset += record->size;
+        endOffset = offset;
+
+        switch (record->type)
+        {
+        case RecordType::ResumeData:
+            m_index[torrentIDFromBytes(payload)].resumeData = location;
+            break;
+        case RecordType::Metadata:
+            m_index[torrentIDFromBytes(payload)].metadata = location;
+            break;
+        case RecordType::Remove:
+            m_index.remove(torrentIDFromBytes(payload));
+            break;
+        case RecordType::Queue:
+            m_queue.clear();
+            m_queue.reserve(payload.size() / TORRENT_ID_SIZE);
+            for (qsizetype i = 0; (i + TORRENT_ID_SIZE) <= payload.size(); i += TORRENT_ID_SIZE)
+                m_queue.append(torrentIDFromBytes(payload.sliced(i, TORRENT_ID_SIZE)));
+            m_queueRecord = location;
+            break;
+        }
+    }
+
+    // Incomplete record can be left at the end of file if the application was terminated while writing it
+    const qint64 tailSize = fileSize - endOffset;
+    if (tailSize > 0)
+        discardedData.append(QByteArrayView(fileContent).sliced(endOffset, tailSize));
+
+    if (mappedData)
+        m_file.unmap(mappedData);
+
+    if (corruptedRegionsCount > 0)
+    {
+        LogMsg(tr("Resume data journal contains corrupted records. They are ignored. Count: %1")
+                .arg(corruptedRegionsCount), Log::WARNING);
+    }
+
+    qint64 newFileSize = fileSize;
+    bool isDiscardedDataSaved = false;
+    if (!discardedData.isEmpty())
+    {
+        // Discarded data is kept aside so nothing is lost for good if the scan is mistaken
+        const Path corruptedDataPath = m_path + (u".corrupt-" + QString::number(QDateTime::currentSecsSinceEpoch()));
+        const nonstd::expected<void, QString> result = Utils::IO::saveToFile(corruptedDataPath, discardedData);
+        isDiscardedDataSaved = result.has_value();
+        if (isDiscardedDataSaved)
+        {
+            LogMsg(tr("Discarded data of resume data journal is saved to \"%1\". Size: %2 bytes")
+                    .arg(corruptedDataPath.toString(), QString::number(discardedData.size())), Log::WARNING);
+
+            // Only the tail is truncated here. Corrupted regions between the records are removed by compaction below.
+            if ((tailSize > 0) && m_file.resize(endOffset))
+                newFileSize = endOffset;
+        }
+        else
+        {
+            // The file is left intact. New records are appended after the damaged data
+            // and the next scan skips it the same way.
+            LogMsg(tr("Couldn't save discarded data of resume data journal to \"%1\". Error: %2")
+                    .arg(corruptedDataPath.toString(), result.error()), Log::WARNING);
+        }
+    }
+
+    m_fileSize = newFileSize;
+    m_liveDataSize = FILE_SIGNATURE.size() + m_queueRecord.size;
+    for (const IndexEntry &entry : asConst(m_index))
+        m_liveDataSize += (entry.resumeData.size + entry.metadata.size);
+
+    if (isDiscardedDataSaved && (corruptedRegionsCount > 0))
+        compact();
+}
+
+BitTorrent::JournalResumeDataStorage::RecordLocation BitTorrent::JournalResumeDataStorage::Worker::appendRecord(const RecordType type, const QByteArray &payload)
+{
+    return appendRecord(type, payload, calculateChecksum(type, payload));
+}
+
+BitTorrent::JournalResumeDataStorage::RecordLocation BitTorrent::JournalResumeDataStorage::Worker::appendRecord(const RecordType type
+        , const QByteArray &payload, const quint32 checksum)
+{
+    const QByteArray record = makeRecord(type, payload, checksum);
+    const RecordLocation location {.offset = (m_fileSize + m_pendingData.size()), .size = record.size(), .checksum = checksum};
+    m_pendingData.append(record);
+    return location;
+}
+
+void BitTorrent::JournalResumeDataStorage::Worker::replaceRecord(RecordLocation &location, const RecordLocation &newLocation)
+{
+    m_liveDataSize += (newLocation.size - location.size);
+    location = newLocation;
+}
+
+void BitTorrent::JournalResumeDataStorage::Worker::scheduleFlush(const std::chrono::milliseconds delay)
+{
+    if (m_isFlushScheduled)
+        return;
+
+    m_isFlushScheduled = true;
+    QTimer::singleShot(delay, this, [this]
+    {
+        if (flush() && needCompaction())
+            compact();
+    });
+}
+
+bool BitTorrent::JournalResumeDataStorage::Worker::flush()
+{
+    m_isFlushScheduled = false;
+
+    if (m_pendingData.isEmpty())
+        return true;
+
+    const bool isWritten = m_file.seek(m_fileSize)
+            && (m_file.write(m_pendingData) == m_pendingData.size())
+            && m_file.flush() && syncFile(m_file);
+    if (!isWritten)
+    {
+        LogMsg(tr("Couldn't save resume data to journal \"%1\". Error: %2")
+                .arg(m_path.toString(), m_file.errorString()), Log::CRITICAL);
+
+        // Discard partially written data. Pending records are kept
+        // so they still match the index and can be written later.
+        m_file.resize(m_fileSize);
+        scheduleFlush(FLUSH_RETRY_DELAY);
+        return false;
+    }
+
+    m_fileSize += m_pendingData.size();
+    m_pendingData.clear();
+
+    const QWriteLocker locker {&m_lock};
+    for (const TorrentID &torrentID : asConst(m_changedTorrents))
+    {
+        if (const auto it = m_index.constFind(torrentID); it != m_index.cend())
+            m_publishedIndex[torrentID] = it.value();
+        else
+            m_publishedIndex.remove(torrentID);
+    }
+    m_changedTorrents.clear();
+
+    return true;
+}
+
+bool BitTorrent::JournalResumeDataStorage::Worker::needCompaction() const
+{
+    return (m_fileSize >= COMPACTION_MIN_FILE_SIZE) && (m_fileSize > (m_liveDataSize * COMPACTION_GARBAGE_RATIO));
+}
+
+void BitTorrent::JournalResumeDataStorage::Worker::compact()
+{
+    qDebug() << "Compacting resume data journal. File size:" << m_fileSize << "Live data size:" << m_liveDataSize;
+
+    QSaveFile newFile {m_path.data()};
+    if (!newFile.open(QIODevice::WriteOnly))
+    {
+        LogMsg(tr("Couldn't compact resume data journal \"%1\". Error: %2")
+                .arg(m_path.toString(), newFile.errorString()), Log::WARNING);
+        return;
+    }
+
+    uchar *mappedData = m_file.map(0, m_fileSize);
+    const auto readRecord = [this, mappedData](const RecordLocation &location) -> QByteArray
+    {
+        if (mappedData)
+            return QByteArray::fromRawData(reinterpret_cast<const char *>(mappedData + location.offset), location.size);
+
+        if (!m_file.seek(location.offset))
+            return {};
+        return m_file.read(location.size);
+    };
+
+    qint64 newFileSize = 0;
+    bool isWritten = (newFile.write(FILE_SIGNATURE) == FILE_SIGNATURE.size());
+    newFileSize += FILE_SIGNATURE.size();
+    const auto copyRecord = [&](const RecordLocation &location) -> RecordLocation
+    {
+        if (!isWritten || (location.size == 0))
+            return {};
+
+        const QByteArray record = readRecord(location);
+        isWritten = (record.size() == location.size) && (newFile.write(record) == record.size());
+        const RecordLocation newLocation {.offset = newFileSize, .size = location.size, .checksum = location.checksum};
+        newFileSize += location.size;
+        return newLocation;
+    };
+
+    // Records are written in queue order so loading them at startup doesn't need to jump over the file
+    QList<TorrentID> torrentIDs;
+    torrentIDs.reserve(m_index.size());
+    QSet<TorrentID> queuedTorrents;
+    queuedTorrents.reserve(m_queue.size());
+    for (const TorrentID &torrentID : asConst(m_queue))
+    {
+        if (m_index.contains(torrentID))
+        {
+            torrentIDs.append(torrentID);
+            queuedTorrents.insert(torrentID);
+        }
+    }
+    for (auto it = m_index.cbegin(); it != m_index.cend(); ++it)
+    {
+        if (!queuedTorrents.contains(it.key()))
+            torrentIDs.append(it.key());
+    }
+
+    QHash<TorrentID, IndexEntry> newIndex;
+    newIndex.reserve(m_index.size());
+    for (const TorrentID &torrentID : asConst(torrentIDs))
+    {
+        const IndexEntry entry = m_index.value(torrentID);
+        IndexEntry &newEntry = newIndex[torrentID];
+        newEntry.metadata = copyRecord(entry.metadata);
+        newEntry.resumeData = copyRecord(entry.resumeData);
+    }
+    const RecordLocation newQueueRecord = copyRecord(m_queueRecord);
+
+    if (mappedData)
+        m_file.unmap(mappedData);
+
+    if (!isWritten)
+    {
+        LogMsg(tr("Couldn't compact resume data journal \"%1\". Error: %2")
+                .arg(m_path.toString(), newFile.errorString()), Log::WARNING);
+        newFile.cancelWriting();
+        return;
+    }
+
+    const QWriteLocker locker {&m_lock};
+
+    m_file.close();
+    const bool isCommitted = newFile.commit();
+    if (!m_file.open(QIODevice::ReadWrite))
+    {
+        LogMsg(tr("Cannot open resume data journal \"%1\". Error: \"%2\"")
+                .arg(m_path.toString(), m_file.errorString()), Log::CRITICAL);
+    }
+
+    if (!isCommitted)
+    {
+        LogMsg(tr("Couldn't compact resume data journal \"%1\". Error: %2")
+                .arg(m_path.toString(), newFile.errorString()), Log::WARNING);
+        return;
+    }
+
+    m_index = newIndex;
+    m_publishedIndex = newIndex;
+    m_queueRecord = newQueueRecord;
+    m_fileSize = newFileSize;
+    m_liveDataSize = newFileSize;
+
+    qDebug() << "Resume data journal is compacted. File size:" << m_fileSize;
+}
@@ -0,0 +1,86 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QtTypes>
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+
+#include "base/pathfwd.h"
+#include "base/utils/thread.h"
+#include "resumedatastorage.h"
+
+namespace BitTorrent
+{
+    // Stores resume data of all the torrents in a single append-only file.
+    // Outdated records are discarded by compacting the file in background.
+    class JournalResumeDataStorage final : public ResumeDataStorage
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY_MOVE(JournalResumeDataStorage)
+
+    public:
+        explicit JournalResumeDataStorage(const Path &path, QObject *parent = nullptr);
+
+        QList<TorrentID> registeredTorrents() const override;
+        LoadResumeDataResult load(const TorrentID &id) const override;
+        void store(const TorrentID &id, LoadTorrentParams resumeData) const override;
+        void remove(const TorrentID &id) const override;
+        void storeQueue(const QList<TorrentID> &queue) const override;
+
+    private:
+        struct RecordLocation
+        {
+            qint64 offset = 0;
+            qint64 size = 0;
+            quint32 checksum = 0;
+        };
+
+        struct IndexEntry
+        {
+            RecordLocation resumeData;
+            RecordLocation metadata;
+        };
+
+        void doLoadAll() const override;
+
+        QList<TorrentID> m_registeredTorrents;
+
+        // Index of the records that are already written to the file.
+        // Lock prevents the file from being replaced while it is read.
+        mutable QReadWriteLock m_lock;
+        QHash<TorrentID, IndexEntry> m_index;
+
+        Utils::Thread::UniquePtr m_ioThread;
+
+        class Worker;
+        Worker *m_asyncWorker = nullptr;
+    };
+}
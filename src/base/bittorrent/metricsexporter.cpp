@@ -0,0 +1,241 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "metricsexporter.h"
+
+#include <algorithm>
+#include <charconv>
+
+#include <libtorrent/session_stats.hpp>
+
+#include "base/global.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    const QByteArray LIBTORRENT_PREFIX = QByteArrayLiteral("libtorrent_");
+    const QByteArray CATEGORY_FAMILY = QByteArrayLiteral("qbittorrent_category_");
+    const QByteArray TRACKER_FAMILY = QByteArrayLiteral("qbittorrent_tracker_");
+
+    QByteArray escapeLabelValue(const QString &value)
+    {
+        QByteArray escaped = value.toUtf8();
+        escaped.replace('\\', "\\\\");
+        escaped.replace('"', "\\\"");
+        escaped.replace('\n', "\\n");
+        return escaped;
+    }
+
+    void appendNumber(QByteArray &buffer, const qint64 value)
+    {
+        char digits[24];
+        const auto result = std::to_chars(digits, (digits + sizeof(digits)), value);
+        buffer.append(digits, (result.ptr - digits));
+    }
+}
+
+QList<MetricsExporter::Metric> MetricsExporter::libtorrentMetrics()
+{
+    const std::vector<lt::stats_metric> ltMetrics = lt::session_stats_metrics();
+
+    QList<Metric> metrics;
+    metrics.reserve(static_cast<qsizetype>(ltMetrics.size()));
+    for (const lt::stats_metric &metric : ltMetrics)
+    {
+        metrics.append({.name = QByteArray(metric.name)
+            , .valueIndex = metric.value_index
+            , .isCounter = (metric.type == lt::metric_type_t::counter)});
+    }
+    return metrics;
+}
+
+MetricsExporter::MetricsExporter(const QList<Metric> &metrics)
+    : m_metrics {metrics}
+{
+    m_metricPrefixes.reserve(m_metrics.size());
+    for (const Metric &metric : m_metrics)
+    {
+        QByteArray name = LIBTORRENT_PREFIX + metric.name;
+        name.replace('.', '_');
+
+        const QByteArray prefix = "# TYPE " + name + (metric.isCounter ? " counter\n" : " gauge\n")
+            + name + ' ';
+        m_metricPrefixes.append(prefix);
+    }
+}
+
+void MetricsExporter::update(const std::span<const std::int64_t> counters)
+{
+    // reuse the buffer unless the previous text is still referenced by a response being sent
+    const qsizetype capacity = std::max(m_text.capacity(), m_text.size());
+    m_text.resize(0);
+    m_text.reserve(capacity);
+
+    for (qsizetype i = 0; i < m_metrics.size(); ++i)
+    {
+        const int index = m_metrics[i].valueIndex;
+        if ((index < 0) || (static_cast<std::size_t>(index) >= counters.size()))
+            continue;
+
+        m_text.append(m_metricPrefixes[i]);
+        appendNumber(m_text, counters[index]);
+        m_text.append('\n');
+    }
+
+    for (const ExtraMetric &metric : asConst(m_extraMetrics))
+    {
+        m_text.append(metric.prefix);
+        appendNumber(m_text, metric.value);
+        m_text.append('\n');
+    }
+
+    renderAggregates(CATEGORY_FAMILY, "category", m_categories);
+    renderAggregates(TRACKER_FAMILY, "tracker", m_trackers);
+}
+
+void MetricsExporter::updateTorrent(const TorrentID &id, const TorrentSample &sample)
+{
+    TorrentEntry &entry = m_torrents[id];
+    addContribution(entry, -1);
+    entry.sample = sample;
+    addContribution(entry, 1);
+}
+
+void MetricsExporter::setTorrentCategory(const TorrentID &id, const QString &category)
+{
+    TorrentEntry &entry = m_torrents[id];
+    addContribution(entry, -1);
+    entry.sample.category = category;
+    addContribution(entry, 1);
+}
+
+void MetricsExporter::setTorrentTrackers(const TorrentID &id, const QStringList &trackerHosts)
+{
+    TorrentEntry &entry = m_torrents[id];
+    addContribution(entry, -1);
+    entry.trackerHosts = trackerHosts;
+    entry.trackerHosts.removeDuplicates();
+    addContribution(entry, 1);
+}
+
+void MetricsExporter::removeTorrent(const TorrentID &id)
+{
+    const auto iter = m_torrents.find(id);
+    if (iter == m_torrents.end())
+        return;
+
+    addContribution(iter.value(), -1);
+    m_torrents.erase(iter);
+}
+
+void MetricsExporter::setExtraMetric(const QByteArray &name, const qint64 value, const bool isCounter)
+{
+    auto iter = m_extraMetrics.find(name);
+    if (iter == m_extraMetrics.end())
+    {
+        const QByteArray prefix = "# TYPE " + name + (isCounter ? " counter\n" : " gauge\n")
+            + name + ' ';
+        iter = m_extraMetrics.insert(name, {.prefix = prefix});
+    }
+
+    iter->value = value;
+}
+
+QByteArray MetricsExporter::text() const
+{
+    return m_text;
+}
+
+void MetricsExporter::addToAggregate(QMap<QString, Aggregate> &aggregates, const QString &key, const TorrentSample &sample, const int sign)
+{
+    auto iter = aggregates.find(key);
+    if (iter == aggregates.end())
+    {
+        if (sign < 0)
+            return;
+
+        iter = aggregates.insert(key, {.label = escapeLabelValue(key)});
+    }
+
+    Aggregate &aggregate = iter.value();
+    aggregate.torrents += sign;
+    aggregate.seeds += (sample.isSeed ? sign : 0);
+    aggregate.peers += sign * sample.peers;
+    aggregate.downloadRate += sign * sample.downloadRate;
+    aggregate.uploadRate += sign * sample.uploadRate;
+    aggregate.allTimeDownload += sign * sample.allTimeDownload;
+    aggregate.allTimeUpload += sign * sample.allTimeUpload;
+
+    if (aggregate.torrents <= 0)
+        aggregates.erase(iter);
+}
+
+void MetricsExporter::addContribution(TorrentEntry &entry, const int sign)
+{
+    // entry that was just created doesn't contribute anything yet
+    if ((sign < 0) && !entry.isCounted)
+        return;
+
+    entry.isCounted = (sign > 0);
+    addToAggregate(m_categories, entry.sample.category, entry.sample, sign);
+    for (const QString &host : entry.trackerHosts)
+        addToAggregate(m_trackers, host, entry.sample, sign);
+}
+
+void MetricsExporter::renderAggregates(const QByteArray &family, const QByteArray &labelName, const QMap<QString, Aggregate> &aggregates)
+{
+    struct Field
+    {
+        const char *name;
+        qint64 Aggregate::*member;
+    };
+
+    // all of them are gauges since aggregates shrink when torrents are removed
+    static const Field fields[] = {
+        {"torrents", &Aggregate::torrents},
+        {"seeding_torrents", &Aggregate::seeds},
+        {"peers", &Aggregate::peers},
+        {"download_rate_bytes", &Aggregate::downloadRate},
+        {"upload_rate_bytes", &Aggregate::uploadRate},
+        {"downloaded_bytes", &Aggregate::allTimeDownload},
+        {"uploaded_bytes", &Aggregate::allTimeUpload}
+    };
+
+    for (const Field &field : fields)
+    {
+        m_text.append("# TYPE ").append(family).append(field.name).append(" gauge\n");
+        for (const Aggregate &aggregate : aggregates)
+        {
+            m_text.append(family).append(field.name)
+                .append('{').append(labelName).append("=\"").append(aggregate.label).append("\"} ");
+            appendNumber(m_text, aggregate.*(field.member));
+            m_text.append('\n');
+        }
+    }
+}
@@ -0,0 +1,127 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include <QtTypes>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+#include "infohash.h"
+
+namespace BitTorrent
+{
+    // Renders session metrics in Prometheus text exposition format (version 0.0.4).
+    // Per-torrent values are folded into per-category and per-tracker aggregates as they change,
+    // so the cost of rendering doesn't depend on the number of torrents.
+    class MetricsExporter
+    {
+        Q_DISABLE_COPY_MOVE(MetricsExporter)
+
+    public:
+        struct Metric
+        {
+            QByteArray name; // libtorrent name, e.g. "net.recv_bytes"
+            int valueIndex = -1;
+            bool isCounter = false;
+        };
+
+        struct TorrentSample
+        {
+            QString category;
+            qint64 downloadRate = 0;
+            qint64 uploadRate = 0;
+            qint64 allTimeDownload = 0;
+            qint64 allTimeUpload = 0;
+            int peers = 0;
+            bool isSeed = false;
+        };
+
+        static QList<Metric> libtorrentMetrics();
+
+        explicit MetricsExporter(const QList<Metric> &metrics);
+
+        // Takes counters of `session_stats_alert` and renders the whole text
+        void update(std::span<const std::int64_t> counters);
+        void updateTorrent(const TorrentID &id, const TorrentSample &sample);
+        void setTorrentCategory(const TorrentID &id, const QString &category);
+        void setTorrentTrackers(const TorrentID &id, const QStringList &trackerHosts);
+        void removeTorrent(const TorrentID &id);
+        // Sets value of metric provided by other components, e.g. "qbittorrent_reverse_dns_lookups",
+        // it is rendered by the following `update()` calls
+        void setExtraMetric(const QByteArray &name, qint64 value, bool isCounter);
+
+        // Text rendered by the last `update()`
+        QByteArray text() const;
+
+    private:
+        struct Aggregate
+        {
+            QByteArray label; // escaped label value
+            qint64 torrents = 0;
+            qint64 seeds = 0;
+            qint64 peers = 0;
+            qint64 downloadRate = 0;
+            qint64 uploadRate = 0;
+            qint64 allTimeDownload = 0;
+            qint64 allTimeUpload = 0;
+        };
+
+        struct ExtraMetric
+        {
+            QByteArray prefix; // same as in `m_metricPrefixes`
+            qint64 value = 0;
+        };
+
+        struct TorrentEntry
+        {
+            TorrentSample sample;
+            QStringList trackerHosts;
+            bool isCounted = false;
+        };
+
+        static void addToAggregate(QMap<QString, Aggregate> &aggregates, const QString &key, const TorrentSample &sample, int sign);
+        void addContribution(TorrentEntry &entry, int sign);
+        void renderAggregates(const QByteArray &family, const QByteArray &labelName, const QMap<QString, Aggregate> &aggregates);
+
+        QList<Metric> m_metrics;
+        QList<QByteArray> m_metricPrefixes; // "# TYPE" line followed by the sample name, ready to append a value
+        QMap<QByteArray, ExtraMetric> m_extraMetrics;
+        QHash<TorrentID, TorrentEntry> m_torrents;
+        QMap<QString, Aggregate> m_categories;
+        QMap<QString, Aggregate> m_trackers;
+        QByteArray m_text;
+    };
+}
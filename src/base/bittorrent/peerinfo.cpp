@@ -30,17 +30,19 @@
 
 #include <libtorrent/version.hpp>
 
-#include <QBitArray>
+#include <QHostAddress>
+#include <QStringList>
 
-#include "base/bittorrent/ltqbitarray.h"
+#include "base/global.h"
 #include "base/net/geoipmanager.h"
 #include "base/unicodestrings.h"
 #include "base/utils/bytearray.h"
+#include "bitfield.h"
 #include "peeraddress.h"
 
 using namespace BitTorrent;
 
-PeerInfo::PeerInfo(const lt::peer_info &nativeInfo, const QBitArray &allPieces)
+PeerInfo::PeerInfo(const lt::peer_info &nativeInfo, const Bitfield &allPieces)
     : m_nativeInfo(nativeInfo)
     , m_relevance(calcRelevance(allPieces))
 {
@@ -62,6 +64,18 @@ bool PeerInfo::fromLSD() const
     return static_cast<bool>(m_nativeInfo.source & lt::peer_info::lsd);
 }
 
+void PeerInfo::resolveCountries(QList<PeerInfo> &peers)
+{
+    QList<QHostAddress> addresses;
+    addresses.reserve(peers.size());
+    for (const PeerInfo &peer : asConst(peers))
+        addresses.append(peer.address().ip);
+
+    const QStringList countries = Net::GeoIPManager::instance()->lookup(addresses);
+    for (qsizetype i = 0; i < peers.size(); ++i)
+        peers[i].m_country = countries.value(i);
+}
+
 QString PeerInfo::country() const
 {
     if (m_country.isEmpty())
@@ -267,9 +281,9 @@ qlonglong PeerInfo::totalDownload() const
     return m_nativeInfo.total_download;
 }
 
-QBitArray PeerInfo::pieces() const
+Bitfield PeerInfo::pieces() const
 {
-    return LT::toQBitArray(m_nativeInfo.pieces);
+    return Bitfield(m_nativeInfo.pieces);
 }
 
 QString PeerInfo::connectionType() const
@@ -282,14 +296,13 @@ QString PeerInfo::connectionType() const
         : u"Web"_s;
 }
 
-qreal PeerInfo::calcRelevance(const QBitArray &allPieces) const
+qreal PeerInfo::calcRelevance(const Bitfield &allPieces) const
 {
     const qsizetype localMissing = allPieces.count(false);
     if (localMissing <= 0)
         return 0;
 
-    const QBitArray peerPieces = pieces();
-    const qsizetype remoteHaves = (peerPieces & (~allPieces)).count(true);
+    const qsizetype remoteHaves = countAndNot(m_nativeInfo.pieces, allPieces);
     return static_cast<qreal>(remoteHaves) / localMissing;
 }
 
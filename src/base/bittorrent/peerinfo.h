@@ -31,11 +31,11 @@
 #include <libtorrent/peer_info.hpp>
 
 #include <QCoreApplication>
-
-class QBitArray;
+#include <QList>
 
 namespace BitTorrent
 {
+    class Bitfield;
     struct PeerAddress;
 
     class PeerInfo
@@ -44,7 +44,10 @@ namespace BitTorrent
 
     public:
         PeerInfo() = default;
-        PeerInfo(const lt::peer_info &nativeInfo, const QBitArray &allPieces);
+        PeerInfo(const lt::peer_info &nativeInfo, const Bitfield &allPieces);
+
+        // Looks up the countries of all the peers at once
+        static void resolveCountries(QList<PeerInfo> &peers);
 
         bool fromDHT() const;
         bool fromPeX() const;
@@ -84,7 +87,7 @@ namespace BitTorrent
         int payloadDownSpeed() const;
         qlonglong totalUpload() const;
         qlonglong totalDownload() const;
-        QBitArray pieces() const;
+        Bitfield pieces() const;
         QString connectionType() const;
         qreal relevance() const;
         QString flags() const;
@@ -93,7 +96,7 @@ namespace BitTorrent
         int downloadingPieceIndex() const;
 
     private:
-        qreal calcRelevance(const QBitArray &allPieces) const;
+        qreal calcRelevance(const Bitfield &allPieces) const;
         void determineFlags();
 
         lt::peer_info m_nativeInfo = {};
@@ -28,6 +28,7 @@
 
 #include "resumedatastorage.h"
 
+#include <algorithm>
 #include <utility>
 
 #include <QList>
@@ -35,12 +36,22 @@
 #include <QMutexLocker>
 #include <QThread>
 
+#include "base/logger.h"
+
+namespace
+{
+    // Resume data loading is mostly limited by disk I/O so too many threads don't help
+    const int MAX_LOADING_THREADS = 8;
+}
+
 const int TORRENTIDLIST_TYPEID = qRegisterMetaType<QList<BitTorrent::TorrentID>>();
 
 BitTorrent::ResumeDataStorage::ResumeDataStorage(const Path &path, QObject *parent)
     : QObject(parent)
     , m_path {path}
 {
+    m_loadingThreadPool.setMaxThreadCount(std::clamp(QThread::idealThreadCount(), 1, MAX_LOADING_THREADS));
+    m_loadingThreadPool.setObjectName("ResumeDataStorage m_loadingThreadPool");
 }
 
 Path BitTorrent::ResumeDataStorage::path() const
@@ -76,3 +87,27 @@ void BitTorrent::ResumeDataStorage::onResumeDataLoaded(const TorrentID &torrentI
     const QMutexLocker locker {&m_loadedResumeDataMutex};
     m_loadedResumeData.append({.torrentID = torrentID, .result = std::move(loadResumeDataResult)});
 }
+
+std::vector<BitTorrent::LoadResumeDataResult> BitTorrent::ResumeDataStorage::loadInParallel(const qsizetype count
+        , const std::function<LoadResumeDataResult (qsizetype index)> &loadFunc) const
+{
+    std::vector<LoadResumeDataResult> results(static_cast<std::size_t>(count));
+    for (qsizetype i = 0; i < count; ++i)
+    {
+        m_loadingThreadPool.start([&results, &loadFunc, i]
+        {
+            results[static_cast<std::size_t>(i)] = loadFunc(i);
+        });
+    }
+    m_loadingThreadPool.waitForDone();
+
+    return results;
+}
+
+void BitTorrent::ResumeDataStorage::logLoadStatistics(const qsizetype count, const qint64 elapsedTime, const LoadStatistics &statistics) const
+{
+    LogMsg(tr("Loaded resume data of %1 torrents in %2 ms. Total reading time: %3 ms. Total decoding time: %4 ms. Threads: %5")
+            .arg(QString::number(count), QString::number(elapsedTime)
+                    , QString::number(statistics.readTime / 1'000'000), QString::number(statistics.decodeTime / 1'000'000)
+                    , QString::number(m_loadingThreadPool.maxThreadCount())));
+}
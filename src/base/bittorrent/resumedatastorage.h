@@ -28,10 +28,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <vector>
+
 #include <QtContainerFwd>
 #include <QList>
 #include <QMutex>
 #include <QObject>
+#include <QThreadPool>
 
 #include "base/3rdparty/expected.hpp"
 #include "base/path.h"
@@ -72,7 +77,22 @@ namespace BitTorrent
         void loadFinished();
 
     protected:
+        // Number of torrents which resume data is loaded in parallel before being reported
+        static constexpr qsizetype LOAD_BATCH_SIZE = 256;
+
+        // Accumulated time (in nanoseconds) spent by all the loading threads
+        struct LoadStatistics
+        {
+            std::atomic<qint64> readTime = 0;
+            std::atomic<qint64> decodeTime = 0;
+        };
+
         void onResumeDataLoaded(const TorrentID &torrentID, LoadResumeDataResult loadResumeDataResult) const;
+        // Calls `loadFunc` for each index in range [0, count) using multiple threads.
+        // Results are returned in the order of their indexes.
+        std::vector<LoadResumeDataResult> loadInParallel(qsizetype count
+                , const std::function<LoadResumeDataResult (qsizetype index)> &loadFunc) const;
+        void logLoadStatistics(qsizetype count, qint64 elapsedTime, const LoadStatistics &statistics) const;
 
     private:
         virtual void doLoadAll() const = 0;
@@ -80,5 +100,6 @@ namespace BitTorrent
         const Path m_path;
         mutable QList<LoadedResumeData> m_loadedResumeData;
         mutable QMutex m_loadedResumeDataMutex;
+        mutable QThreadPool m_loadingThreadPool;
     };
 }
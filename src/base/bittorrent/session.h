@@ -45,14 +45,18 @@
 #include "trackerentrystatus.h"
 
 class QString;
+class TorrentFilter;
 
 namespace BitTorrent
 {
+    class AlertProfiler;
     class InfoHash;
+    class MetricsExporter;
     class Torrent;
     class TorrentDescriptor;
     class TorrentID;
     class TorrentInfo;
+    class TransferHistory;
     struct CacheStatus;
     struct SessionStatus;
 
@@ -131,7 +135,8 @@ namespace BitTorrent
         enum class ResumeDataStorageType
         {
             Legacy,
-            SQLite
+            SQLite,
+            Journal
         };
         Q_ENUM_NS(ResumeDataStorageType)
     }
@@ -459,9 +464,16 @@ namespace BitTorrent
         virtual Torrent *getTorrent(const TorrentID &id) const = 0;
         virtual Torrent *findTorrent(const InfoHash &infoHash) const = 0;
         virtual QList<Torrent *> torrents() const = 0;
+        // Uses incrementally maintained indexes, so it costs O(result) for most filters
+        virtual QList<Torrent *> torrents(const TorrentFilter &filter) const = 0;
         virtual qsizetype torrentsCount() const = 0;
         virtual const SessionStatus &status() const = 0;
         virtual const CacheStatus &cacheStatus() const = 0;
+        virtual TransferHistory *transferHistory() const = 0;
+        virtual const MetricsExporter *metricsExporter() const = 0;
+        // Timings of alert handling, nullptr unless profiling is enabled
+        virtual const AlertProfiler *alertProfiler() const = 0;
+        virtual void setAlertProfilingEnabled(bool enabled) = 0;
         virtual bool isListening() const = 0;
 
         virtual void banIP(const QString &ip) = 0;
@@ -63,6 +63,7 @@
 #include <QDeadlineTimer>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFuture>
 #include <QHostAddress>
 #include <QJsonArray>
@@ -77,6 +78,7 @@
 #include <QString>
 #include <QThread>
 #include <QTimer>
+#include <QUrl>
 #include <QUuid>
 
 #include "base/algorithm.h"
@@ -85,8 +87,10 @@
 #include "base/logger.h"
 #include "base/net/downloadmanager.h"
 #include "base/net/proxyconfigurationmanager.h"
+#include "base/net/reverseresolution.h"
 #include "base/preferences.h"
 #include "base/profile.h"
+#include "base/torrentfilter.h"
 #include "base/unicodestrings.h"
 #include "base/utils/fs.h"
 #include "base/utils/io.h"
@@ -95,6 +99,7 @@
 #include "base/utils/random.h"
 #include "base/utils/string.h"
 #include "base/version.h"
+#include "alertprofiler.h"
 #include "bandwidthscheduler.h"
 #include "bencoderesumedatastorage.h"
 #include "customstorage.h"
@@ -103,24 +108,28 @@
 #include "extensiondata.h"
 #include "filesearcher.h"
 #include "filterparserthread.h"
+#include "journalresumedatastorage.h"
 #include "loadtorrentparams.h"
 #include "lttypecast.h"
+#include "metricsexporter.h"
 #include "nativesessionextension.h"
 #include "portforwarderimpl.h"
 #include "resumedatastorage.h"
 #include "torrentcontentremover.h"
 #include "torrentdescriptor.h"
+#include "torrentfilterindex.h"
 #include "torrentimpl.h"
 #include "tracker.h"
 #include "trackerentry.h"
 #include "trackerentrystatus.h"
+#include "transferhistory.h"
 
 using namespace std::chrono_literals;
 using namespace BitTorrent;
 
 const Path CATEGORIES_FILE_NAME {u"categories.json"_s};
 const Path ADDITIONAL_TRACKERS_FROM_URL_FILE_NAME {u"additional_trackers_from_url.txt"_s};
-const int MAX_PROCESSING_RESUMEDATA_COUNT = 50;
+const int MAX_PROCESSING_RESUMEDATA_COUNT = 500;
 const std::chrono::seconds FREEDISKSPACE_CHECK_TIMEOUT = 30s;
 
 namespace
@@ -129,6 +138,34 @@ namespace
     const auto USER_AGENT = QStringLiteral("qBittorrent/" QBT_VERSION_2);
     const QString DEFAULT_DHT_BOOTSTRAP_NODES = u"dht.libtorrent.org:25401, dht.transmissionbt.com:6881, router.bittorrent.com:6881"_s;
 
+    QStringList trackerHosts(const Torrent *torrent)
+    {
+        const QList<TrackerEntryStatus> trackers = torrent->trackers();
+
+        QStringList hosts;
+        hosts.reserve(trackers.size());
+        for (const TrackerEntryStatus &tracker : trackers)
+            hosts.append(getTrackerHost(tracker.url));
+        return hosts;
+    }
+
+    void updateReverseResolutionMetrics(MetricsExporter &exporter)
+    {
+        const Net::ReverseResolution *reverseResolution = Net::ReverseResolution::instance();
+        if (!reverseResolution)
+            return;
+
+        const Net::ReverseResolution::Statistics statistics = reverseResolution->statistics();
+        exporter.setExtraMetric("qbittorrent_reverse_dns_cache_hits", statistics.cacheHits, true);
+        exporter.setExtraMetric("qbittorrent_reverse_dns_negative_cache_hits", statistics.negativeCacheHits, true);
+        exporter.setExtraMetric("qbittorrent_reverse_dns_cache_misses", statistics.cacheMisses, true);
+        exporter.setExtraMetric("qbittorrent_reverse_dns_lookups", statistics.lookups, true);
+        exporter.setExtraMetric("qbittorrent_reverse_dns_failed_lookups", statistics.failedLookups, true);
+        exporter.setExtraMetric("qbittorrent_reverse_dns_dropped_requests", statistics.droppedRequests, true);
+        exporter.setExtraMetric("qbittorrent_reverse_dns_queue_depth", statistics.queueDepth, false);
+        exporter.setExtraMetric("qbittorrent_reverse_dns_active_lookups", statistics.activeLookups, false);
+    }
+
     void torrentQueuePositionUp(const lt::torrent_handle &handle)
     {
         try
@@ -368,12 +405,17 @@ struct BitTorrent::SessionImpl::ResumeSessionContext final : public QObject
 
     ResumeDataStorage *startupStorage = nullptr;
     ResumeDataStorageType currentStorageType = ResumeDataStorageType::Legacy;
+    ResumeDataStorageType startupStorageType = ResumeDataStorageType::Legacy;
     QList<LoadedResumeData> loadedResumeData;
     int processingResumeDataCount = 0;
     int64_t totalResumeDataCount = 0;
     int64_t finishedResumeDataCount = 0;
     bool isLoadFinished = false;
     bool isLoadedResumeDataHandlingEnqueued = false;
+    QElapsedTimer startupTimer;
+    // Accumulated time (in nanoseconds) spent on main thread
+    qint64 processingTime = 0;
+    qint64 alertHandlingTime = 0;
     QSet<QString> recoveredCategories;
 #ifdef QBT_USES_LIBTORRENT2
     QSet<TorrentID> indexedTorrents;
@@ -686,6 +728,79 @@ SessionImpl::SessionImpl(QObject *parent)
     initMetrics();
     loadStatistics();
 
+    m_transferHistory = new TransferHistory((specialFolderLocation(SpecialFolder::Data) / Path(u"transferhistory"_s)), this);
+    connect(this, &Session::torrentsLoaded, m_transferHistory, [this](const QList<Torrent *> &torrents)
+    {
+        QList<TorrentID> torrentIDs;
+        torrentIDs.reserve(torrents.size());
+        for (const Torrent *torrent : torrents)
+            torrentIDs.append(torrent->id());
+        m_transferHistory->addTorrents(torrentIDs);
+    });
+    connect(this, &Session::torrentAboutToBeRemoved, m_transferHistory, [this](const Torrent *torrent)
+    {
+        m_transferHistory->removeTorrent(torrent->id());
+    });
+    connect(this, &Session::categoryRemoved, m_transferHistory, &TransferHistory::removeCategory);
+
+    m_metricsExporter = std::make_unique<MetricsExporter>(MetricsExporter::libtorrentMetrics());
+    const auto updateMetricsTrackers = [this](const Torrent *torrent)
+    {
+        m_metricsExporter->setTorrentTrackers(torrent->id(), trackerHosts(torrent));
+    };
+    connect(this, &Session::trackersAdded, this, updateMetricsTrackers);
+    connect(this, &Session::trackersRemoved, this, updateMetricsTrackers);
+    connect(this, &Session::trackersReset, this, updateMetricsTrackers);
+    connect(this, &Session::torrentsLoaded, this, [this, updateMetricsTrackers](const QList<Torrent *> &torrents)
+    {
+        for (const Torrent *torrent : torrents)
+        {
+            // otherwise the torrent is counted under empty category until its first state update
+            m_metricsExporter->setTorrentCategory(torrent->id(), torrent->category());
+            updateMetricsTrackers(torrent);
+        }
+    });
+    connect(this, &Session::torrentCategoryChanged, this, [this](const Torrent *torrent)
+    {
+        m_metricsExporter->setTorrentCategory(torrent->id(), torrent->category());
+    });
+    connect(this, &Session::torrentAboutToBeRemoved, this, [this](const Torrent *torrent)
+    {
+        m_metricsExporter->removeTorrent(torrent->id());
+    });
+
+    m_torrentFilterIndex = std::make_unique<TorrentFilterIndex>();
+    connect(this, &Session::torrentsLoaded, this, [this](const QList<Torrent *> &torrents)
+    {
+        for (const Torrent *torrent : torrents)
+            addToTorrentFilterIndex(torrent);
+    });
+    connect(this, &Session::torrentAboutToBeRemoved, this, [this](const Torrent *torrent)
+    {
+        m_torrentFilterIndex->removeTorrent(torrent->id());
+    });
+    connect(this, &Session::torrentCategoryChanged, this, [this](const Torrent *torrent)
+    {
+        m_torrentFilterIndex->setTorrentCategory(torrent->id(), torrent->category());
+    });
+    const auto updateIndexedTags = [this](const Torrent *torrent)
+    {
+        m_torrentFilterIndex->setTorrentTags(torrent->id(), torrent->tags());
+    };
+    connect(this, &Session::torrentTagAdded, this, updateIndexedTags);
+    connect(this, &Session::torrentTagRemoved, this, updateIndexedTags);
+    const auto updateIndexedTrackers = [this](const Torrent *torrent)
+    {
+        m_torrentFilterIndex->setTorrentTrackers(torrent->id(), trackerHosts(torrent));
+    };
+    connect(this, &Session::trackersAdded, this, updateIndexedTrackers);
+    connect(this, &Session::trackersRemoved, this, updateIndexedTrackers);
+    connect(this, &Session::trackersReset, this, updateIndexedTrackers);
+    connect(this, &Session::torrentMetadataReceived, this, [this](const Torrent *torrent)
+    {
+        m_torrentFilterIndex->setTorrentPrivate(torrent->id(), torrent->isPrivate());
+    });
+
     // initialize PortForwarder instance
     new PortForwarderImpl(this);
 
@@ -1343,33 +1458,75 @@ void SessionImpl::prepareStartup()
 {
     qDebug("Initializing torrents resume data storage...");
 
+    const Path dataPath = specialFolderLocation(SpecialFolder::Data) / Path(u"BT_backup"_s);
     const Path dbPath = specialFolderLocation(SpecialFolder::Data) / Path(u"torrents.db"_s);
+    const Path journalPath = specialFolderLocation(SpecialFolder::Data) / Path(u"torrents.journal"_s);
     const bool dbStorageExists = dbPath.exists();
+    const bool journalStorageExists = journalPath.exists();
 
     auto *context = new ResumeSessionContext(this);
     context->currentStorageType = resumeDataStorageType();
 
-    if (context->currentStorageType == ResumeDataStorageType::SQLite)
+    // If there is no storage of the current type yet, the existing data is migrated
+    // from the single file storage (if any) or from the fastresume files otherwise
+    switch (context->currentStorageType)
     {
+    case ResumeDataStorageType::SQLite:
         m_resumeDataStorage = new DBResumeDataStorage(dbPath, this);
 
         if (!dbStorageExists)
         {
-            const Path dataPath = specialFolderLocation(SpecialFolder::Data) / Path(u"BT_backup"_s);
-            context->startupStorage = new BencodeResumeDataStorage(dataPath, this);
+            if (journalStorageExists)
+            {
+                context->startupStorage = new JournalResumeDataStorage(journalPath, this);
+                context->startupStorageType = ResumeDataStorageType::Journal;
+            }
+            else
+            {
+                context->startupStorage = new BencodeResumeDataStorage(dataPath, this);
+                context->startupStorageType = ResumeDataStorageType::Legacy;
+            }
         }
-    }
-    else
-    {
-        const Path dataPath = specialFolderLocation(SpecialFolder::Data) / Path(u"BT_backup"_s);
+        break;
+    case ResumeDataStorageType::Journal:
+        m_resumeDataStorage = new JournalResumeDataStorage(journalPath, this);
+
+        if (!journalStorageExists)
+        {
+            if (dbStorageExists)
+            {
+                context->startupStorage = new DBResumeDataStorage(dbPath, this);
+                context->startupStorageType = ResumeDataStorageType::SQLite;
+            }
+            else
+            {
+                context->startupStorage = new BencodeResumeDataStorage(dataPath, this);
+                context->startupStorageType = ResumeDataStorageType::Legacy;
+            }
+        }
+        break;
+    case ResumeDataStorageType::Legacy:
+    default:
         m_resumeDataStorage = new BencodeResumeDataStorage(dataPath, this);
 
         if (dbStorageExists)
+        {
             context->startupStorage = new DBResumeDataStorage(dbPath, this);
+            context->startupStorageType = ResumeDataStorageType::SQLite;
+        }
+        else if (journalStorageExists)
+        {
+            context->startupStorage = new JournalResumeDataStorage(journalPath, this);
+            context->startupStorageType = ResumeDataStorageType::Journal;
+        }
+        break;
     }
 
     if (!context->startupStorage)
+    {
         context->startupStorage = m_resumeDataStorage;
+        context->startupStorageType = context->currentStorageType;
+    }
 
     connect(context->startupStorage, &ResumeDataStorage::loadStarted, context
             , [this, context](const QList<TorrentID> &torrents)
@@ -1400,12 +1557,15 @@ void SessionImpl::prepareStartup()
         if (!m_refreshEnqueued)
         {
             m_nativeSession->post_torrent_updates();
+            if (m_alertProfiler) [[unlikely]]
+                m_alertProfiler->torrentUpdatesPosted();
             m_refreshEnqueued = true;
         }
 
         emit startupProgressUpdated((context->finishedResumeDataCount * 100.) / context->totalResumeDataCount);
     });
 
+    context->startupTimer.start();
     context->startupStorage->loadAll();
 }
 
@@ -1413,6 +1573,9 @@ void SessionImpl::handleLoadedResumeData(ResumeSessionContext *context)
 {
     context->isLoadedResumeDataHandlingEnqueued = false;
 
+    QElapsedTimer timer;
+    timer.start();
+
     int count = context->processingResumeDataCount;
     while (context->processingResumeDataCount < MAX_PROCESSING_RESUMEDATA_COUNT)
     {
@@ -1442,6 +1605,7 @@ void SessionImpl::handleLoadedResumeData(ResumeSessionContext *context)
     }
 
     context->finishedResumeDataCount += (count - context->processingResumeDataCount);
+    context->processingTime += timer.nsecsElapsed();
 }
 
 void SessionImpl::processNextResumeData(ResumeSessionContext *context)
@@ -1601,8 +1765,11 @@ void SessionImpl::processNextResumeData(ResumeSessionContext *context)
 
     qDebug() << "Starting up torrent" << torrentID.toString() << "...";
     m_nativeSession->async_add_torrent(resumeData.ltAddTorrentParams);
-    m_addTorrentAlertHandlers.append([this, resumeData = std::move(resumeData)](const lt::add_torrent_alert *alert) mutable
+    m_addTorrentAlertHandlers.append([this, context, resumeData = std::move(resumeData)](const lt::add_torrent_alert *alert) mutable
     {
+        QElapsedTimer timer;
+        timer.start();
+
         if (alert->error)
         {
             const QString msg = QString::fromStdString(alert->message());
@@ -1615,6 +1782,8 @@ void SessionImpl::processNextResumeData(ResumeSessionContext *context)
 
             LogMsg(tr("Restored torrent. Torrent: \"%1\"").arg(torrent->name()));
         }
+
+        context->alertHandlingTime += timer.nsecsElapsed();
     });
 
     ++context->processingResumeDataCount;
@@ -1622,19 +1791,25 @@ void SessionImpl::processNextResumeData(ResumeSessionContext *context)
 
 void SessionImpl::endStartup(ResumeSessionContext *context)
 {
+    LogMsg(tr("Restored %1 torrents in %2 ms. Processing resume data: %3 ms. Handling added torrents: %4 ms")
+            .arg(QString::number(context->totalResumeDataCount), QString::number(context->startupTimer.elapsed())
+                    , QString::number(context->processingTime / 1'000'000), QString::number(context->alertHandlingTime / 1'000'000)));
+
     if (m_resumeDataStorage != context->startupStorage)
     {
         if (isQueueingSystemEnabled())
             saveTorrentsQueue();
 
-        const Path dbPath = context->startupStorage->path();
+        const Path storagePath = context->startupStorage->path();
         context->startupStorage->deleteLater();
 
-        if (context->currentStorageType == ResumeDataStorageType::Legacy)
+        // Single file storages are removed once migrated
+        // while fastresume files are kept as a backup
+        if (context->startupStorageType != ResumeDataStorageType::Legacy)
         {
-            connect(context->startupStorage, &QObject::destroyed, this, [dbPath]
+            connect(context->startupStorage, &QObject::destroyed, this, [storagePath]
             {
-                Utils::Fs::removeFile(dbPath);
+                Utils::Fs::removeFile(storagePath);
             });
         }
     }
@@ -1786,6 +1961,12 @@ void SessionImpl::processBannedIPs(lt::ip_filter &filter)
     }
 }
 
+void SessionImpl::addToTorrentFilterIndex(const Torrent *torrent)
+{
+    m_torrentFilterIndex->addTorrent(torrent->id(), {.category = torrent->category(), .tags = torrent->tags()
+            , .trackerHosts = trackerHosts(torrent), .state = torrent->state(), .isPrivate = torrent->isPrivate()});
+}
+
 void SessionImpl::initMetrics()
 {
     const auto findMetricIndex = [](const char *name) -> int
@@ -2648,6 +2829,38 @@ QList<Torrent *> SessionImpl::torrents() const
     return result;
 }
 
+QList<Torrent *> SessionImpl::torrents(const TorrentFilter &filter) const
+{
+    QList<Torrent *> result;
+
+    const std::optional<QList<TorrentID>> candidates = m_torrentFilterIndex->orderedCandidates(filter);
+    if (!candidates)
+    {
+        for (TorrentImpl *torrent : asConst(m_torrents))
+        {
+            if (filter.match(torrent))
+                result << torrent;
+        }
+
+        return result;
+    }
+
+    if (candidates->isEmpty())
+        return result;
+
+    // Only the candidates are visited. They are ordered by the index so paging over the result stays stable.
+    // Conditions that aren't indexed still need to be checked.
+    result.reserve(candidates->size());
+    for (const TorrentID &id : asConst(*candidates))
+    {
+        TorrentImpl *torrent = m_torrents.value(id);
+        if (torrent && filter.match(torrent))
+            result << torrent;
+    }
+
+    return result;
+}
+
 qsizetype SessionImpl::torrentsCount() const
 {
     return m_torrents.size();
@@ -5382,6 +5595,9 @@ void SessionImpl::handleTorrentInfoHashChanged(TorrentImpl *torrent, const InfoH
     {
         m_torrents[torrent->id()] = m_torrents.take(prevID);
         m_changedTorrentIDs[torrent->id()] = prevID;
+
+        m_torrentFilterIndex->removeTorrent(prevID);
+        addToTorrentFilterIndex(torrent);
     }
 }
 
@@ -5390,6 +5606,11 @@ void SessionImpl::handleTorrentStorageMovingStateChanged(TorrentImpl *torrent)
     emit torrentsUpdated({torrent});
 }
 
+void SessionImpl::handleTorrentStateChanged(TorrentImpl *torrent)
+{
+    m_torrentFilterIndex->setTorrentState(torrent->id(), torrent->state());
+}
+
 bool SessionImpl::addMoveTorrentStorageJob(TorrentImpl *torrent, const Path &newPath, const MoveStorageMode mode, const MoveStorageContext context)
 {
     Q_ASSERT(torrent);
@@ -5666,6 +5887,32 @@ const CacheStatus &SessionImpl::cacheStatus() const
     return m_cacheStatus;
 }
 
+TransferHistory *SessionImpl::transferHistory() const
+{
+    return m_transferHistory;
+}
+
+const MetricsExporter *SessionImpl::metricsExporter() const
+{
+    return m_metricsExporter.get();
+}
+
+const AlertProfiler *SessionImpl::alertProfiler() const
+{
+    return m_alertProfiler.get();
+}
+
+void SessionImpl::setAlertProfilingEnabled(const bool enabled)
+{
+    if (enabled == static_cast<bool>(m_alertProfiler))
+        return;
+
+    if (enabled)
+        m_alertProfiler = std::make_unique<AlertProfiler>();
+    else
+        m_alertProfiler.reset();
+}
+
 void SessionImpl::enqueueRefresh()
 {
     Q_ASSERT(!m_refreshEnqueued);
@@ -5673,6 +5920,8 @@ void SessionImpl::enqueueRefresh()
     QTimer::singleShot(refreshInterval(), Qt::CoarseTimer, this, [this]
     {
         m_nativeSession->post_torrent_updates();
+        if (m_alertProfiler) [[unlikely]]
+            m_alertProfiler->torrentUpdatesPosted();
         m_nativeSession->post_session_stats();
 
         if (m_torrentsQueueChanged)
@@ -5753,6 +6002,9 @@ void SessionImpl::readAlerts()
     if (!isRestored())
         m_loadedTorrents.reserve(MAX_PROCESSING_RESUMEDATA_COUNT);
 
+    if (m_alertProfiler) [[unlikely]]
+        m_alertProfiler->recordBatch(m_alerts.size());
+
     int previousAlertType = -1;
     qsizetype alertSequenceSize = 0;
     for (lt::alert *a : m_alerts)
@@ -5764,7 +6016,18 @@ void SessionImpl::readAlerts()
             alertSequenceSize = 0;
         }
 
-        handleAlert(a);
+        if (m_alertProfiler) [[unlikely]]
+        {
+            const auto start = AlertProfiler::Clock::now();
+            handleAlert(a);
+            // profiling could be disabled by a handler that runs nested event loop
+            if (m_alertProfiler)
+                m_alertProfiler->recordAlert(alertType, a->what(), (AlertProfiler::Clock::now() - start));
+        }
+        else
+        {
+            handleAlert(a);
+        }
         ++alertSequenceSize;
         previousAlertType = alertType;
     }
@@ -6227,6 +6490,9 @@ void SessionImpl::handleSessionStatsAlert(const lt::session_stats_alert *alert)
     m_status.trackerDownloadRate = calcRate(m_status.trackerDownload, trackerDownload);
     m_status.trackerUploadRate = calcRate(m_status.trackerUpload, trackerUpload);
 
+    m_transferHistory->addSessionTransfer((totalPayloadDownload - m_status.totalPayloadDownload)
+        , (totalPayloadUpload - m_status.totalPayloadUpload));
+
     m_status.totalPayloadDownload = totalPayloadDownload;
     m_status.totalPayloadUpload = totalPayloadUpload;
     m_status.ipOverheadDownload = ipOverheadDownload;
@@ -6244,6 +6510,9 @@ void SessionImpl::handleSessionStatsAlert(const lt::session_stats_alert *alert)
 
     m_status.queuedTrackerAnnounces = stats[m_metricIndices.tracker.numQueuedTrackerAnnounces];
 
+    updateReverseResolutionMetrics(*m_metricsExporter);
+    m_metricsExporter->update({stats.data(), static_cast<std::size_t>(stats.size())});
+
     if (totalDownload > m_status.totalDownload)
     {
         m_status.totalDownload = totalDownload;
@@ -6328,6 +6597,9 @@ void SessionImpl::handleStorageMovedFailedAlert(const lt::storage_moved_failed_a
 
 void SessionImpl::handleStateUpdateAlert(const lt::state_update_alert *alert)
 {
+    if (m_alertProfiler) [[unlikely]]
+        m_alertProfiler->torrentUpdatesReceived();
+
     QList<Torrent *> updatedTorrents;
     updatedTorrents.reserve(static_cast<decltype(updatedTorrents)::size_type>(alert->status.size()));
 
@@ -6339,10 +6611,28 @@ void SessionImpl::handleStateUpdateAlert(const lt::state_update_alert *alert)
 
         torrent->handleStateUpdate(status);
         updatedTorrents.push_back(torrent);
+        m_transferHistory->updateTorrentTransfer(torrent->id(), torrent->category()
+            , status.all_time_download, status.all_time_upload);
+        m_metricsExporter->updateTorrent(torrent->id(), {.category = torrent->category()
+            , .downloadRate = status.download_payload_rate, .uploadRate = status.upload_payload_rate
+            , .allTimeDownload = status.all_time_download, .allTimeUpload = status.all_time_upload
+            , .peers = status.num_peers, .isSeed = status.is_seeding});
     }
 
     if (!updatedTorrents.isEmpty())
-        emit torrentsUpdated(updatedTorrents);
+    {
+        if (m_alertProfiler) [[unlikely]]
+        {
+            const auto start = AlertProfiler::Clock::now();
+            emit torrentsUpdated(updatedTorrents);
+            if (m_alertProfiler)
+                m_alertProfiler->recordTorrentsUpdatedHandlers(AlertProfiler::Clock::now() - start);
+        }
+        else
+        {
+            emit torrentsUpdated(updatedTorrents);
+        }
+    }
 
     if (m_needSaveTorrentsQueue)
         saveTorrentsQueue();
@@ -31,6 +31,7 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -82,8 +83,10 @@ namespace BitTorrent
     class Torrent;
     class TorrentContentRemover;
     class TorrentDescriptor;
+    class TorrentFilterIndex;
     class TorrentImpl;
     class Tracker;
+    class TransferHistory;
 
     struct LoadTorrentParams;
     struct TrackerEntry;
@@ -433,9 +436,14 @@ namespace BitTorrent
         Torrent *getTorrent(const TorrentID &id) const override;
         Torrent *findTorrent(const InfoHash &infoHash) const override;
         QList<Torrent *> torrents() const override;
+        QList<Torrent *> torrents(const TorrentFilter &filter) const override;
         qsizetype torrentsCount() const override;
         const SessionStatus &status() const override;
         const CacheStatus &cacheStatus() const override;
+        TransferHistory *transferHistory() const override;
+        const MetricsExporter *metricsExporter() const override;
+        const AlertProfiler *alertProfiler() const override;
+        void setAlertProfilingEnabled(bool enabled) override;
         bool isListening() const override;
 
         void banIP(const QString &ip) override;
@@ -478,6 +486,7 @@ namespace BitTorrent
         void handleTorrentResumeDataReady(TorrentImpl *torrent, LoadTorrentParams data);
         void handleTorrentInfoHashChanged(TorrentImpl *torrent, const InfoHash &prevInfoHash);
         void handleTorrentStorageMovingStateChanged(TorrentImpl *torrent);
+        void handleTorrentStateChanged(TorrentImpl *torrent);
 
         bool addMoveTorrentStorageJob(TorrentImpl *torrent, const Path &newPath, MoveStorageMode mode, MoveStorageContext context);
 
@@ -550,6 +559,7 @@ namespace BitTorrent
         void applyNetworkInterfacesSettings(lt::settings_pack &settingsPack) const;
         void configurePeerClasses();
         void initMetrics();
+        void addToTorrentFilterIndex(const Torrent *torrent);
         void applyBandwidthLimits();
         void processBannedIPs(lt::ip_filter &filter);
         QStringList getListeningIPs() const;
@@ -821,6 +831,10 @@ namespace BitTorrent
         ResumeDataStorage *m_resumeDataStorage = nullptr;
         FileSearcher *m_fileSearcher = nullptr;
         TorrentContentRemover *m_torrentContentRemover = nullptr;
+        TransferHistory *m_transferHistory = nullptr;
+        std::unique_ptr<MetricsExporter> m_metricsExporter;
+        std::unique_ptr<TorrentFilterIndex> m_torrentFilterIndex;
+        std::unique_ptr<AlertProfiler> m_alertProfiler;
 
         using AddTorrentAlertHandler = std::function<void (const lt::add_torrent_alert *alert)>;
         QList<AddTorrentAlertHandler> m_addTorrentAlertHandlers;
@@ -42,6 +42,61 @@ namespace BitTorrent
         return ::qHash(static_cast<std::underlying_type_t<TorrentState>>(key), seed);
     }
 
+    bool isDownloadingState(const TorrentState state)
+    {
+        switch (state)
+        {
+        case TorrentState::Downloading:
+        case TorrentState::DownloadingMetadata:
+        case TorrentState::ForcedDownloadingMetadata:
+        case TorrentState::StalledDownloading:
+        case TorrentState::CheckingDownloading:
+        case TorrentState::StoppedDownloading:
+        case TorrentState::QueuedDownloading:
+        case TorrentState::ForcedDownloading:
+            return true;
+        default:
+            break;
+        };
+
+        return false;
+    }
+
+    bool isUploadingState(const TorrentState state)
+    {
+        switch (state)
+        {
+        case TorrentState::Uploading:
+        case TorrentState::StalledUploading:
+        case TorrentState::CheckingUploading:
+        case TorrentState::QueuedUploading:
+        case TorrentState::ForcedUploading:
+            return true;
+        default:
+            break;
+        };
+
+        return false;
+    }
+
+    bool isCompletedState(const TorrentState state)
+    {
+        return isUploadingState(state) || (state == TorrentState::StoppedUploading);
+    }
+
+    bool isCheckingState(const TorrentState state)
+    {
+        return (state == TorrentState::CheckingUploading)
+                || (state == TorrentState::CheckingDownloading)
+                || (state == TorrentState::CheckingResumeData);
+    }
+
+    bool isErroredState(const TorrentState state)
+    {
+        return (state == TorrentState::MissingFiles)
+                || (state == TorrentState::Error);
+    }
+
     // Torrent
 
     const qreal Torrent::MAX_RATIO = std::numeric_limits<qreal>::infinity();
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include <QtContainerFwd>
 #include <QtTypes>
 #include <QMetaType>
@@ -41,7 +43,6 @@
 #include "torrentannouncestatus.h"
 #include "torrentcontenthandler.h"
 
-class QBitArray;
 class QByteArray;
 class QDateTime;
 class QUrl;
@@ -52,6 +53,7 @@ namespace BitTorrent
 {
     enum class DownloadPriority;
 
+    class Bitfield;
     class InfoHash;
     class PeerInfo;
     class Session;
@@ -111,6 +113,13 @@ namespace BitTorrent
 
     std::size_t qHash(TorrentState key, std::size_t seed = 0);
 
+    // Classification of torrent states shared by `Torrent` implementations and state based filtering
+    bool isDownloadingState(TorrentState state);
+    bool isUploadingState(TorrentState state);
+    bool isCompletedState(TorrentState state);
+    bool isCheckingState(TorrentState state);
+    bool isErroredState(TorrentState state);
+
     class Torrent : public TorrentContentHandler
     {
         Q_OBJECT
@@ -225,6 +234,13 @@ namespace BitTorrent
 
         virtual PathList filePaths() const = 0;
         virtual PathList actualFilePaths() const = 0;
+        // Revision of file paths, priorities, progress and availability, it increases whenever any of them changes
+        virtual quint64 filesRevision() const = 0;
+        // Indexes of files changed after given revision, nothing if the changes can't be tracked that far back
+        virtual std::optional<QList<int>> updatedFiles(quint64 sinceRevision) const = 0;
+        // Availability isn't polled by the torrent itself, so the files whose availability differs
+        // from the previously reported one are marked as updated here
+        virtual void updateFilesAvailability(const QList<qreal> &availability) = 0;
 
         virtual TorrentInfo info() const = 0;
         virtual bool isFinished() const = 0;
@@ -263,7 +279,7 @@ namespace BitTorrent
         virtual bool isDHTDisabled() const = 0;
         virtual bool isPEXDisabled() const = 0;
         virtual bool isLSDDisabled() const = 0;
-        virtual QBitArray pieces() const = 0;
+        virtual Bitfield pieces() const = 0;
         virtual qreal distributedCopies() const = 0;
         virtual qreal realRatio() const = 0;
         virtual qreal popularity() const = 0;
@@ -311,7 +327,7 @@ namespace BitTorrent
         virtual QFuture<QList<PeerInfo>> fetchPeerInfo() const = 0;
         virtual QFuture<QList<QUrl>> fetchURLSeeds() const = 0;
         virtual QFuture<QList<int>> fetchPieceAvailability() const = 0;
-        virtual QFuture<QBitArray> fetchDownloadingPieces() const = 0;
+        virtual QFuture<Bitfield> fetchDownloadingPieces() const = 0;
 
         TorrentID id() const;
         bool isRunning() const;
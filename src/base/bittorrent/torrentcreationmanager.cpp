@@ -29,6 +29,7 @@
 
 #include "torrentcreationmanager.h"
 
+#include <algorithm>
 #include <utility>
 
 #include <boost/multi_index_container.hpp>
@@ -61,6 +62,8 @@ BitTorrent::TorrentCreationManager::TorrentCreationManager(IApplication *app, QO
     : ApplicationComponent(app, parent)
     , m_maxTasks {SETTINGS_KEY(u"MaxTasks"_s), 256}
     , m_numThreads {SETTINGS_KEY(u"NumThreads"_s), 1}
+    , m_hashingThreads {SETTINGS_KEY(u"HashingThreads"_s), 0}
+    , m_maxReadRate {SETTINGS_KEY(u"MaxReadRate"_s), 0}
     , m_tasks {std::make_unique<TaskSet>()}
     , m_threadPool(this)
 {
@@ -90,6 +93,9 @@ std::shared_ptr<BitTorrent::TorrentCreationTask> BitTorrent::TorrentCreationMana
     const QString taskID = generateTaskID();
 
     auto *torrentCreator = new TorrentCreator(params, this);
+    // MaxReadRate is stored in KiB/s
+    torrentCreator->setLimits({.hashingThreads = std::max(m_hashingThreads.get(), 0)
+            , .maxReadRate = (std::max<qint64>(m_maxReadRate.get(), 0) * 1024)});
     auto creationTask = std::make_shared<TorrentCreationTask>(app(), taskID, torrentCreator, startSeeding);
     connect(creationTask.get(), &QObject::destroyed, torrentCreator, &BitTorrent::TorrentCreator::requestInterruption);
 
@@ -61,6 +61,8 @@ namespace BitTorrent
 
         CachedSettingValue<qint32> m_maxTasks;
         CachedSettingValue<qint32> m_numThreads;
+        CachedSettingValue<qint32> m_hashingThreads;
+        CachedSettingValue<qint32> m_maxReadRate;
 
         class TaskSet;
         std::unique_ptr<TaskSet> m_tasks;
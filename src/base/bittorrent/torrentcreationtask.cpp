@@ -53,6 +53,12 @@ BitTorrent::TorrentCreationTask::TorrentCreationTask(IApplication *app, const QS
         m_progress = progress;
     });
 
+    connect(torrentCreator, &BitTorrent::TorrentCreator::throughputUpdated, this
+            , [this](const qint64 bytesPerSecond)
+    {
+        m_throughput = bytesPerSecond;
+    });
+
     connect(torrentCreator, &BitTorrent::TorrentCreator::creationSuccess, this
             , [this, app, startSeeding](const TorrentCreatorResult &result)
     {
@@ -128,6 +134,11 @@ int BitTorrent::TorrentCreationTask::progress() const
     return m_progress;
 }
 
+qint64 BitTorrent::TorrentCreationTask::throughput() const
+{
+    return m_throughput;
+}
+
 const BitTorrent::TorrentCreatorResult &BitTorrent::TorrentCreationTask::result() const
 {
     return m_result;
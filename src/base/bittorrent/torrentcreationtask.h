@@ -65,6 +65,7 @@ namespace BitTorrent
         QDateTime timeStarted() const;
         QDateTime timeFinished() const;
         int progress() const;
+        qint64 throughput() const;
         const TorrentCreatorResult &result() const;
         QString errorMsg() const;
 
@@ -75,6 +76,7 @@ namespace BitTorrent
         QDateTime m_timeStarted;
         QDateTime m_timeFinished;
         int m_progress = 0;
+        qint64 m_throughput = 0;
         TorrentCreatorResult m_result;
         QString m_errorMsg;
     };
@@ -30,24 +30,27 @@
 
 #include "torrentcreator.h"
 
+#include <algorithm>
 #include <functional>
 
 #include <libtorrent/create_torrent.hpp>
 #include <libtorrent/file_storage.hpp>
+#include <libtorrent/settings_pack.hpp>
 #include <libtorrent/torrent_info.hpp>
 #include <libtorrent/version.hpp>
 
 #include <QtSystemDetection>
 #include <QDirIterator>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QHash>
+#include <QThread>
 
 #include "base/exceptions.h"
 #include "base/global.h"
 #include "base/utils/compare.h"
 #include "base/utils/io.h"
 #include "base/version.h"
-#include "lttypecast.h"
 
 namespace
 {
@@ -83,11 +86,6 @@ TorrentCreator::TorrentCreator(const TorrentCreatorParams &params, QObject *pare
 {
 }
 
-void TorrentCreator::sendProgressSignal(int currentPieceIdx, int totalPieces)
-{
-    emit progressUpdated(static_cast<int>((currentPieceIdx * 100.) / totalPieces));
-}
-
 void TorrentCreator::checkInterruptionRequested() const
 {
     if (isInterruptionRequested())
@@ -223,12 +221,63 @@ void TorrentCreator::run()
         }
 
         // calculate the hash for all pieces
-        lt::set_piece_hashes(newTorrent, parentPath.toString().toStdString()
-            , [this, &newTorrent](const lt::piece_index_t n)
+        const int numPieces = newTorrent.num_pieces();
+        int hashedPieces = 0;
+        int lastProgress = 0;
+        qint64 hashedBytes = 0;
+        QElapsedTimer hashingTimer;
+        hashingTimer.start();
+
+        const auto emitThroughput = [this, &hashedBytes, &hashingTimer]
+        {
+            emit throughputUpdated((hashedBytes * 1000) / std::max<qint64>(hashingTimer.elapsed(), 1));
+        };
+
+        const auto pieceHashed = [&](const lt::piece_index_t piece)
         {
             checkInterruptionRequested();
-            sendProgressSignal(LT::toUnderlyingType(n), newTorrent.num_pieces());
-        });
+
+            // pieces are hashed in parallel and can be reported out of order
+            ++hashedPieces;
+            hashedBytes += newTorrent.piece_size(piece);
+
+            if (const int progress = static_cast<int>((hashedPieces * 100LL) / numPieces); progress != lastProgress)
+            {
+                lastProgress = progress;
+                emit progressUpdated(progress);
+                emitThroughput();
+            }
+
+            if (m_limits.maxReadRate > 0)
+            {
+                // Pieces are read ahead of this callback, so holding it back until
+                // the average rate drops to the limit throttles further reads
+                const qint64 targetElapsed = (hashedBytes * 1000) / m_limits.maxReadRate;
+                for (qint64 elapsed = hashingTimer.elapsed(); elapsed < targetElapsed; elapsed = hashingTimer.elapsed())
+                {
+                    checkInterruptionRequested();
+                    QThread::msleep(static_cast<unsigned long>(std::min<qint64>((targetElapsed - elapsed), 100)));
+                }
+            }
+        };
+
+#ifdef QBT_USES_LIBTORRENT2
+        // libtorrent reads pieces ahead and hashes them on its hashing threads,
+        // both v1 and v2 hashes of hybrid torrent are calculated in the same pass
+        const int hashingThreads = (m_limits.hashingThreads > 0)
+            ? m_limits.hashingThreads
+            : std::max(QThread::idealThreadCount(), 1);
+        lt::settings_pack hashingSettings;
+        hashingSettings.set_int(lt::settings_pack::hashing_threads, hashingThreads);
+
+        lt::error_code ec;
+        lt::set_piece_hashes(newTorrent, parentPath.toString().toStdString(), hashingSettings, pieceHashed, ec);
+        if (ec)
+            throw RuntimeError(QString::fromLocal8Bit(ec.message()));
+#else
+        lt::set_piece_hashes(newTorrent, parentPath.toString().toStdString(), pieceHashed);
+#endif
+        emitThroughput();
 
         // Set qBittorrent as creator and add user comment to
         // torrent_info structure
@@ -286,6 +335,11 @@ const TorrentCreatorParams &TorrentCreator::params() const
     return m_params;
 }
 
+void TorrentCreator::setLimits(const TorrentCreatorLimits &limits)
+{
+    m_limits = limits;
+}
+
 #ifdef QBT_USES_LIBTORRENT2
 int TorrentCreator::calculateTotalPieces(const Path &inputPath, const int pieceSize, const TorrentFormat torrentFormat)
 #else
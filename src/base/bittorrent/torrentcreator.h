@@ -32,6 +32,7 @@
 
 #include <atomic>
 
+#include <QtTypes>
 #include <QObject>
 #include <QRunnable>
 #include <QStringList>
@@ -67,6 +68,13 @@ namespace BitTorrent
         QStringList urlSeeds;
     };
 
+    // Limits of resources used for hashing the content
+    struct TorrentCreatorLimits
+    {
+        int hashingThreads = 0; // 0 means number of CPU cores
+        qint64 maxReadRate = 0; // bytes per second, 0 means unlimited
+    };
+
     struct TorrentCreatorResult
     {
         Path torrentFilePath;
@@ -84,6 +92,8 @@ namespace BitTorrent
 
         const TorrentCreatorParams &params() const;
         bool isInterruptionRequested() const;
+        // Must be set before the creator is started
+        void setLimits(const TorrentCreatorLimits &limits);
 
         void run() override;
 
@@ -102,12 +112,13 @@ namespace BitTorrent
         void creationFailure(const QString &msg);
         void creationSuccess(const TorrentCreatorResult &result);
         void progressUpdated(int progress);
+        void throughputUpdated(qint64 bytesPerSecond);
 
     private:
-        void sendProgressSignal(int currentPieceIdx, int totalPieces);
         void checkInterruptionRequested() const;
 
         TorrentCreatorParams m_params;
+        TorrentCreatorLimits m_limits;
         std::atomic_bool m_interruptionRequested;
     };
 }
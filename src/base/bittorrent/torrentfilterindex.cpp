@@ -0,0 +1,285 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "torrentfilterindex.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <QList>
+
+#include "base/global.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    template <typename Key>
+    void addToIndex(QHash<Key, TorrentIDSet> &index, const Key &key, const TorrentID &id)
+    {
+        index[key].insert(id);
+    }
+
+    template <typename Key>
+    void removeFromIndex(QHash<Key, TorrentIDSet> &index, const Key &key, const TorrentID &id)
+    {
+        const auto iter = index.find(key);
+        if (iter == index.end())
+            return;
+
+        iter->remove(id);
+        if (iter->isEmpty())
+            index.erase(iter);
+    }
+
+    void insertTags(QHash<Tag, TorrentIDSet> &index, const TagSet &tags, const TorrentID &id)
+    {
+        if (tags.isEmpty())
+            addToIndex(index, Tag(), id);
+        for (const Tag &tag : tags)
+            addToIndex(index, tag, id);
+    }
+
+    void removeTags(QHash<Tag, TorrentIDSet> &index, const TagSet &tags, const TorrentID &id)
+    {
+        if (tags.isEmpty())
+            removeFromIndex(index, Tag(), id);
+        for (const Tag &tag : tags)
+            removeFromIndex(index, tag, id);
+    }
+
+    void insertTrackerHosts(QHash<QString, TorrentIDSet> &index, const QSet<QString> &hosts, const TorrentID &id)
+    {
+        if (hosts.isEmpty())
+            addToIndex(index, QString(), id);
+        for (const QString &host : hosts)
+            addToIndex(index, host, id);
+    }
+
+    void removeTrackerHosts(QHash<QString, TorrentIDSet> &index, const QSet<QString> &hosts, const TorrentID &id)
+    {
+        if (hosts.isEmpty())
+            removeFromIndex(index, QString(), id);
+        for (const QString &host : hosts)
+            removeFromIndex(index, host, id);
+    }
+
+    QSet<QString> toHostSet(const QStringList &trackerHosts)
+    {
+        return {trackerHosts.cbegin(), trackerHosts.cend()};
+    }
+}
+
+void TorrentFilterIndex::addTorrent(const TorrentID &id, const TorrentKeys &keys)
+{
+    removeTorrent(id);
+
+    const Entry entry {.category = keys.category, .tags = keys.tags, .trackerHosts = toHostSet(keys.trackerHosts)
+            , .state = keys.state, .isPrivate = keys.isPrivate, .sequence = m_nextSequence++};
+    addToIndex(m_byCategory, entry.category, id);
+    insertTags(m_byTag, entry.tags, id);
+    insertTrackerHosts(m_byTrackerHost, entry.trackerHosts, id);
+    addToIndex(m_byState, entry.state, id);
+    (entry.isPrivate ? m_privateTorrents : m_publicTorrents).insert(id);
+
+    m_torrents.insert(id, entry);
+}
+
+void TorrentFilterIndex::removeTorrent(const TorrentID &id)
+{
+    const auto iter = m_torrents.constFind(id);
+    if (iter == m_torrents.cend())
+        return;
+
+    const Entry &entry = iter.value();
+    removeFromIndex(m_byCategory, entry.category, id);
+    removeTags(m_byTag, entry.tags, id);
+    removeTrackerHosts(m_byTrackerHost, entry.trackerHosts, id);
+    removeFromIndex(m_byState, entry.state, id);
+    (entry.isPrivate ? m_privateTorrents : m_publicTorrents).remove(id);
+
+    m_torrents.erase(iter);
+}
+
+void TorrentFilterIndex::setTorrentCategory(const TorrentID &id, const QString &category)
+{
+    const auto iter = m_torrents.find(id);
+    if ((iter == m_torrents.end()) || (iter->category == category))
+        return;
+
+    removeFromIndex(m_byCategory, iter->category, id);
+    iter->category = category;
+    addToIndex(m_byCategory, iter->category, id);
+}
+
+void TorrentFilterIndex::setTorrentTags(const TorrentID &id, const TagSet &tags)
+{
+    const auto iter = m_torrents.find(id);
+    if ((iter == m_torrents.end()) || (iter->tags == tags))
+        return;
+
+    removeTags(m_byTag, iter->tags, id);
+    iter->tags = tags;
+    insertTags(m_byTag, iter->tags, id);
+}
+
+void TorrentFilterIndex::setTorrentTrackers(const TorrentID &id, const QStringList &trackerHosts)
+{
+    const auto iter = m_torrents.find(id);
+    if (iter == m_torrents.end())
+        return;
+
+    QSet<QString> hosts = toHostSet(trackerHosts);
+    if (iter->trackerHosts == hosts)
+        return;
+
+    removeTrackerHosts(m_byTrackerHost, iter->trackerHosts, id);
+    iter->trackerHosts = std::move(hosts);
+    insertTrackerHosts(m_byTrackerHost, iter->trackerHosts, id);
+}
+
+void TorrentFilterIndex::setTorrentState(const TorrentID &id, const TorrentState state)
+{
+    const auto iter = m_torrents.find(id);
+    if ((iter == m_torrents.end()) || (iter->state == state))
+        return;
+
+    removeFromIndex(m_byState, iter->state, id);
+    iter->state = state;
+    addToIndex(m_byState, iter->state, id);
+}
+
+void TorrentFilterIndex::setTorrentPrivate(const TorrentID &id, const bool isPrivate)
+{
+    const auto iter = m_torrents.find(id);
+    if ((iter == m_torrents.end()) || (iter->isPrivate == isPrivate))
+        return;
+
+    (iter->isPrivate ? m_privateTorrents : m_publicTorrents).remove(id);
+    iter->isPrivate = isPrivate;
+    (iter->isPrivate ? m_privateTorrents : m_publicTorrents).insert(id);
+}
+
+qsizetype TorrentFilterIndex::torrentsCount() const
+{
+    return m_torrents.size();
+}
+
+std::optional<TorrentIDSet> TorrentFilterIndex::candidates(const TorrentFilter &filter) const
+{
+    // QSet is implicitly shared, so collecting the sets doesn't copy them
+    QList<TorrentIDSet> sets;
+
+    if (const std::optional<TorrentIDSet> &idSet = filter.torrentIDSet())
+        sets.append(*idSet);
+    if (const std::optional<QString> &category = filter.category())
+        sets.append(categoryTorrents(*category));
+    if (const std::optional<Tag> &tag = filter.tag())
+        sets.append(m_byTag.value(*tag));
+    if (const std::optional<bool> isPrivate = filter.isPrivate())
+        sets.append(*isPrivate ? m_privateTorrents : m_publicTorrents);
+    if (const std::optional<QString> &trackerHost = filter.trackerHost())
+        sets.append(m_byTrackerHost.value(*trackerHost));
+
+    // Statuses that don't depend on the state alone (e.g. Active) can't be looked up in the index
+    std::optional<TorrentIDSet> stateTorrents;
+    for (auto iter = m_byState.cbegin(); iter != m_byState.cend(); ++iter)
+    {
+        const std::optional<bool> isMatched = TorrentFilter::matchState(filter.status(), iter.key());
+        if (!isMatched)
+            break;
+
+        if (!stateTorrents)
+            stateTorrents.emplace();
+        if (*isMatched)
+            stateTorrents->unite(iter.value());
+    }
+    if (stateTorrents)
+        sets.append(*stateTorrents);
+
+    if (sets.isEmpty())
+        return std::nullopt;
+
+    // Start from the smallest set so the intersection costs O(smallest set)
+    std::ranges::sort(sets, {}, &TorrentIDSet::size);
+
+    TorrentIDSet result;
+    result.reserve(sets.first().size());
+    for (const TorrentID &id : asConst(sets.first()))
+    {
+        const bool isInAllSets = std::all_of(std::next(sets.cbegin()), sets.cend(), [&id](const TorrentIDSet &set)
+        {
+            return set.contains(id);
+        });
+        if (isInAllSets)
+            result.insert(id);
+    }
+
+    return result;
+}
+
+std::optional<QList<TorrentID>> TorrentFilterIndex::orderedCandidates(const TorrentFilter &filter) const
+{
+    const std::optional<TorrentIDSet> ids = candidates(filter);
+    if (!ids)
+        return std::nullopt;
+
+    // ID set of the filter can refer to torrents that aren't indexed
+    QList<std::pair<quint64, TorrentID>> sequencedIDs;
+    sequencedIDs.reserve(ids->size());
+    for (const TorrentID &id : *ids)
+    {
+        if (const auto iter = m_torrents.constFind(id); iter != m_torrents.cend())
+            sequencedIDs.emplaceBack(iter->sequence, id);
+    }
+
+    std::ranges::sort(sequencedIDs, {}, &std::pair<quint64, TorrentID>::first);
+
+    QList<TorrentID> result;
+    result.reserve(sequencedIDs.size());
+    for (const auto &[sequence, id] : asConst(sequencedIDs))
+        result.append(id);
+    return result;
+}
+
+TorrentIDSet TorrentFilterIndex::categoryTorrents(const QString &category) const
+{
+    // Torrents of subcategories belong to the category as well, see `Torrent::belongsToCategory()`
+    if (category.isEmpty())
+        return m_byCategory.value(category);
+
+    TorrentIDSet torrents = m_byCategory.value(category);
+    const QString subcategoryPrefix = category + u'/';
+    for (auto iter = m_byCategory.cbegin(); iter != m_byCategory.cend(); ++iter)
+    {
+        if (iter.key().startsWith(subcategoryPrefix))
+            torrents.unite(iter.value());
+    }
+    return torrents;
+}
@@ -0,0 +1,106 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <optional>
+
+#include <QtTypes>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "base/tag.h"
+#include "base/tagset.h"
+#include "base/torrentfilter.h"
+#include "infohash.h"
+#include "torrent.h"
+
+namespace BitTorrent
+{
+    // Sets of torrents keyed by category, tag, tracker host, state and private flag.
+    // They are kept up to date as torrents change, so filter queries cost O(result)
+    // instead of evaluating the filter against every torrent.
+    class TorrentFilterIndex
+    {
+        Q_DISABLE_COPY_MOVE(TorrentFilterIndex)
+
+    public:
+        struct TorrentKeys
+        {
+            QString category;
+            TagSet tags;
+            QStringList trackerHosts;
+            TorrentState state = TorrentState::Unknown;
+            bool isPrivate = false;
+        };
+
+        TorrentFilterIndex() = default;
+
+        void addTorrent(const TorrentID &id, const TorrentKeys &keys);
+        void removeTorrent(const TorrentID &id);
+        // The following ones ignore torrents that weren't added
+        void setTorrentCategory(const TorrentID &id, const QString &category);
+        void setTorrentTags(const TorrentID &id, const TagSet &tags);
+        void setTorrentTrackers(const TorrentID &id, const QStringList &trackerHosts);
+        void setTorrentState(const TorrentID &id, TorrentState state);
+        void setTorrentPrivate(const TorrentID &id, bool isPrivate);
+
+        qsizetype torrentsCount() const;
+
+        // Torrents that may match the filter, or `std::nullopt` if the filter doesn't narrow them down.
+        // Conditions the index doesn't cover (e.g. activity or announce status) are left to `TorrentFilter::match()`.
+        std::optional<TorrentIDSet> candidates(const TorrentFilter &filter) const;
+        // Same as `candidates()` but in the order the torrents were added, only the candidates are sorted
+        std::optional<QList<TorrentID>> orderedCandidates(const TorrentFilter &filter) const;
+
+    private:
+        struct Entry
+        {
+            QString category;
+            TagSet tags;
+            QSet<QString> trackerHosts;
+            TorrentState state = TorrentState::Unknown;
+            bool isPrivate = false;
+            quint64 sequence = 0;
+        };
+
+        TorrentIDSet categoryTorrents(const QString &category) const;
+
+        QHash<TorrentID, Entry> m_torrents;
+        QHash<QString, TorrentIDSet> m_byCategory; // empty category for uncategorized torrents
+        QHash<Tag, TorrentIDSet> m_byTag; // empty tag for untagged torrents
+        QHash<QString, TorrentIDSet> m_byTrackerHost; // empty host for trackerless torrents
+        QHash<TorrentState, TorrentIDSet> m_byState;
+        TorrentIDSet m_privateTorrents;
+        TorrentIDSet m_publicTorrents;
+        quint64 m_nextSequence = 0;
+    };
+}
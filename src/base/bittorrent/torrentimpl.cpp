@@ -71,7 +71,6 @@
 #include "extensiondata.h"
 #include "filesearcher.h"
 #include "loadtorrentparams.h"
-#include "ltqbitarray.h"
 #include "lttypecast.h"
 #include "peeraddress.h"
 #include "peerinfo.h"
@@ -90,6 +89,15 @@ using namespace BitTorrent;
 
 namespace
 {
+    // Revisions are taken from a counter shared by all torrents, so they only grow even when files are recreated
+    // (e.g. metadata is received again). They aren't tied to the torrent, so a client has to pass the revision
+    // it received for the same torrent, otherwise it is only detected when it is out of the torrent's revision range.
+    quint64 nextFilesRevision()
+    {
+        static quint64 revision = 0;
+        return ++revision;
+    }
+
     lt::announce_entry makeNativeAnnounceEntry(const QString &url, const int tier)
     {
         lt::announce_entry entry {url.toStdString()};
@@ -356,6 +364,7 @@ TorrentImpl::TorrentImpl(SessionImpl *session, const lt::torrent_handle &nativeH
 
         m_completedFiles.fill(static_cast<bool>(m_ltAddTorrentParams.flags & lt::torrent_flags::seed_mode), filesCount);
         m_filesProgress.resize(filesCount);
+        markAllFilesUpdated(true);
 
         for (int i = 0; i < filesCount; ++i)
         {
@@ -1178,22 +1187,7 @@ bool TorrentImpl::isChecking() const
 
 bool TorrentImpl::isDownloading() const
 {
-    switch (m_state)
-    {
-    case TorrentState::Downloading:
-    case TorrentState::DownloadingMetadata:
-    case TorrentState::ForcedDownloadingMetadata:
-    case TorrentState::StalledDownloading:
-    case TorrentState::CheckingDownloading:
-    case TorrentState::StoppedDownloading:
-    case TorrentState::QueuedDownloading:
-    case TorrentState::ForcedDownloading:
-        return true;
-    default:
-        break;
-    };
-
-    return false;
+    return isDownloadingState(m_state);
 }
 
 bool TorrentImpl::isMoving() const
@@ -1203,37 +1197,12 @@ bool TorrentImpl::isMoving() const
 
 bool TorrentImpl::isUploading() const
 {
-    switch (m_state)
-    {
-    case TorrentState::Uploading:
-    case TorrentState::StalledUploading:
-    case TorrentState::CheckingUploading:
-    case TorrentState::QueuedUploading:
-    case TorrentState::ForcedUploading:
-        return true;
-    default:
-        break;
-    };
-
-    return false;
+    return isUploadingState(m_state);
 }
 
 bool TorrentImpl::isCompleted() const
 {
-    switch (m_state)
-    {
-    case TorrentState::Uploading:
-    case TorrentState::StalledUploading:
-    case TorrentState::CheckingUploading:
-    case TorrentState::StoppedUploading:
-    case TorrentState::QueuedUploading:
-    case TorrentState::ForcedUploading:
-        return true;
-    default:
-        break;
-    };
-
-    return false;
+    return isCompletedState(m_state);
 }
 
 bool TorrentImpl::isActive() const
@@ -1248,8 +1217,7 @@ bool TorrentImpl::isInactive() const
 
 bool TorrentImpl::isErrored() const
 {
-    return ((m_state == TorrentState::MissingFiles)
-            || (m_state == TorrentState::Error));
+    return isErroredState(m_state);
 }
 
 bool TorrentImpl::isFinished() const
@@ -1280,6 +1248,8 @@ TorrentState TorrentImpl::state() const
 
 void TorrentImpl::updateState()
 {
+    const TorrentState prevState = m_state;
+
     if (m_nativeStatus.state == lt::torrent_status::checking_resume_data)
     {
         m_state = TorrentState::CheckingResumeData;
@@ -1336,6 +1306,9 @@ void TorrentImpl::updateState()
         else
             m_state = TorrentState::StalledDownloading;
     }
+
+    if (m_state != prevState)
+        m_session->handleTorrentStateChanged(this);
 }
 
 bool TorrentImpl::hasMetadata() const
@@ -1458,6 +1431,62 @@ QList<qreal> TorrentImpl::filesProgress() const
     return result;
 }
 
+quint64 TorrentImpl::filesRevision() const
+{
+    return m_filesRevision;
+}
+
+std::optional<QList<int>> TorrentImpl::updatedFiles(const quint64 sinceRevision) const
+{
+    // Files could be added or removed since then
+    if ((sinceRevision < m_filesBaseRevision) || (sinceRevision > m_filesRevision))
+        return std::nullopt;
+
+    QList<int> result;
+    for (qsizetype i = 0; i < m_fileRevisions.size(); ++i)
+    {
+        if (m_fileRevisions[i] > sinceRevision)
+            result.append(i);
+    }
+
+    return result;
+}
+
+void TorrentImpl::updateFilesAvailability(const QList<qreal> &availability)
+{
+    if (availability.size() != filesCount())
+        return;
+
+    // the previously reported values are unknown, so all of them are considered to be changed
+    if (m_filesAvailability.size() != availability.size())
+    {
+        m_filesAvailability = availability;
+        markAllFilesUpdated();
+        return;
+    }
+
+    for (qsizetype i = 0; i < availability.size(); ++i)
+    {
+        if (availability[i] != m_filesAvailability[i])
+            markFileUpdated(static_cast<int>(i));
+    }
+    m_filesAvailability = availability;
+}
+
+void TorrentImpl::markFileUpdated(const int index)
+{
+    m_filesRevision = nextFilesRevision();
+    m_fileRevisions[index] = m_filesRevision;
+}
+
+void TorrentImpl::markAllFilesUpdated(const bool isLayoutChanged)
+{
+    m_filesRevision = nextFilesRevision();
+    m_fileRevisions.fill(m_filesRevision, filesCount());
+    if (isLayoutChanged)
+        m_filesBaseRevision = m_filesRevision;
+}
+
 int TorrentImpl::seedsCount() const
 {
     return m_nativeStatus.num_seeds;
@@ -1519,7 +1548,7 @@ bool TorrentImpl::isLSDDisabled() const
     return static_cast<bool>(m_nativeStatus.flags & lt::torrent_flags::disable_lsd);
 }
 
-QBitArray TorrentImpl::pieces() const
+Bitfield TorrentImpl::pieces() const
 {
     return m_pieces;
 }
@@ -1695,6 +1724,7 @@ void TorrentImpl::forceRecheck()
     m_ltAddTorrentParams.unfinished_pieces.clear();
     m_completedFiles.fill(false);
     m_filesProgress.fill(0);
+    markAllFilesUpdated();
     m_pieces.fill(false);
     m_unchecked = false;
 
@@ -1858,6 +1888,7 @@ void TorrentImpl::endReceivedMetadataHandling(const Path &savePath, const PathLi
 
     m_completedFiles.fill(static_cast<bool>(p.flags & lt::torrent_flags::seed_mode), filesCount());
     m_filesProgress.resize(filesCount());
+    markAllFilesUpdated(true);
     updateProgress();
 
     for (qsizetype i = 0; i < fileNames.size(); ++i)
@@ -1940,6 +1971,7 @@ void TorrentImpl::reload()
 
         m_completedFiles.fill(false);
         m_filesProgress.fill(0);
+        markAllFilesUpdated();
         m_pieces.fill(false);
         m_nativeStatus.pieces.clear_all();
         m_nativeStatus.num_pieces = 0;
@@ -2341,6 +2373,7 @@ void TorrentImpl::handleFileRenamed(const lt::file_index_t nativeFileIndex, cons
     else
     {
         m_filePaths[fileIndex] = newFilePath;
+        markFileUpdated(fileIndex);
 
         // Remove empty leftover folders
         // For example renaming "a/b/c" to "d/b/c", then folders "a/b" and "a" will
@@ -2612,17 +2645,17 @@ void TorrentImpl::updateProgress()
 
     Q_ASSERT(!m_filesProgress.isEmpty());
     if (m_filesProgress.isEmpty()) [[unlikely]]
+    {
         m_filesProgress.resize(filesCount());
+        markAllFilesUpdated(true);
+    }
 
-    const QBitArray oldPieces = std::exchange(m_pieces, LT::toQBitArray(m_nativeStatus.pieces));
-    const QBitArray newPieces = m_pieces ^ oldPieces;
+    const Bitfield oldPieces = std::exchange(m_pieces, Bitfield(m_nativeStatus.pieces));
+    const Bitfield newPieces = m_pieces ^ oldPieces;
 
     const int64_t pieceSize = m_torrentInfo.pieceLength();
-    for (qsizetype index = 0; index < newPieces.size(); ++index)
+    for (qsizetype index = newPieces.nextSetBit(0); index >= 0; index = newPieces.nextSetBit(index + 1))
     {
-        if (!newPieces.at(index))
-            continue;
-
         int64_t size = m_torrentInfo.pieceLength(index);
         int64_t pieceOffset = index * pieceSize;
 
@@ -2632,6 +2665,7 @@ void TorrentImpl::updateProgress()
             const int64_t add = std::min<int64_t>((m_torrentInfo.fileSize(fileIndex) - fileOffsetInPiece), size);
 
             m_filesProgress[fileIndex] += add;
+            markFileUpdated(fileIndex);
 
             size -= add;
             if (size <= 0)
@@ -2850,9 +2884,9 @@ QFuture<QList<int>> TorrentImpl::fetchPieceAvailability() const
     });
 }
 
-QFuture<QBitArray> TorrentImpl::fetchDownloadingPieces() const
+QFuture<Bitfield> TorrentImpl::fetchDownloadingPieces() const
 {
-    return invokeAsync([nativeHandle = m_nativeHandle, torrentInfo = m_torrentInfo]() -> QBitArray
+    return invokeAsync([nativeHandle = m_nativeHandle, torrentInfo = m_torrentInfo]() -> Bitfield
     {
         try
         {
@@ -2862,8 +2896,7 @@ QFuture<QBitArray> TorrentImpl::fetchDownloadingPieces() const
             std::vector<lt::partial_piece_info> queue;
             nativeHandle.get_download_queue(queue);
 #endif
-            QBitArray result;
-            result.resize(torrentInfo.piecesCount());
+            Bitfield result {torrentInfo.piecesCount()};
             for (const lt::partial_piece_info &info : queue)
                 result.setBit(LT::toUnderlyingType(info.piece_index));
             return result;
@@ -2943,6 +2976,12 @@ void TorrentImpl::prioritizeFiles(const QList<DownloadPriority> &priorities)
     qDebug() << Q_FUNC_INFO << "Changing files priorities...";
     m_nativeHandle.prioritize_files(nativePriorities);
 
+    for (qsizetype i = 0; i < priorities.size(); ++i)
+    {
+        if (priorities[i] != oldPriorities[i])
+            markFileUpdated(static_cast<int>(i));
+    }
+
     m_filePriorities = priorities;
     // Restore first/last piece first option if necessary
     if (m_hasFirstLastPiecePriority)
@@ -31,6 +31,7 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 
 #include <libtorrent/add_torrent_params.hpp>
 #include <libtorrent/fwd.hpp>
@@ -49,6 +50,7 @@
 
 #include "base/path.h"
 #include "base/tagset.h"
+#include "bitfield.h"
 #include "infohash.h"
 #include "speedmonitor.h"
 #include "sslparameters.h"
@@ -186,6 +188,9 @@ namespace BitTorrent
         qlonglong totalUpload() const override;
         qlonglong eta() const override;
         QList<qreal> filesProgress() const override;
+        quint64 filesRevision() const override;
+        std::optional<QList<int>> updatedFiles(quint64 sinceRevision) const override;
+        void updateFilesAvailability(const QList<qreal> &availability) override;
         int seedsCount() const override;
         int peersCount() const override;
         int leechsCount() const override;
@@ -198,7 +203,7 @@ namespace BitTorrent
         bool isDHTDisabled() const override;
         bool isPEXDisabled() const override;
         bool isLSDDisabled() const override;
-        QBitArray pieces() const override;
+        Bitfield pieces() const override;
         qreal distributedCopies() const override;
         qreal realRatio() const override;
         qreal popularity() const override;
@@ -250,7 +255,7 @@ namespace BitTorrent
         QFuture<QList<PeerInfo>> fetchPeerInfo() const override;
         QFuture<QList<QUrl>> fetchURLSeeds() const override;
         QFuture<QList<int>> fetchPieceAvailability() const override;
-        QFuture<QBitArray> fetchDownloadingPieces() const override;
+        QFuture<Bitfield> fetchDownloadingPieces() const override;
         QFuture<QList<qreal>> fetchAvailableFileFractions() const override;
 
         bool needSaveResumeData() const;
@@ -288,6 +293,8 @@ namespace BitTorrent
         void updateStatus(const lt::torrent_status &nativeStatus);
         void updateProgress();
         void updateState();
+        void markFileUpdated(int index);
+        void markAllFilesUpdated(bool isLayoutChanged = false);
 
         bool isMoveInProgress() const;
 
@@ -370,8 +377,13 @@ namespace BitTorrent
         int m_downloadLimit = 0;
         int m_uploadLimit = 0;
 
-        QBitArray m_pieces;
+        Bitfield m_pieces;
         QList<std::int64_t> m_filesProgress;
+        QList<qreal> m_filesAvailability;
+        // Revision in which each file was changed last time
+        QList<quint64> m_fileRevisions;
+        quint64 m_filesRevision = 0;
+        quint64 m_filesBaseRevision = 0;
 
         bool m_deferredRequestResumeDataInvoked = false;
     };
@@ -30,10 +30,22 @@
 
 #include "tracker.h"
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
 #include <libtorrent/bencode.hpp>
 #include <libtorrent/entry.hpp>
+#include <libtorrent/sha1_hash.hpp>
 
+#include <QtEndian>
+#include <QDateTime>
 #include <QHostAddress>
+#include <QMessageAuthenticationCode>
+#include <QNetworkDatagram>
+#include <QThread>
+#include <QTimer>
+#include <QUdpSocket>
 
 #include "base/exceptions.h"
 #include "base/global.h"
@@ -42,15 +54,19 @@
 #include "base/http/server.h"
 #include "base/logger.h"
 #include "base/preferences.h"
+#include "base/utils/random.h"
 
 namespace
 {
     // static limits
-    const int MAX_TORRENTS = 10000;
-    const int MAX_PEERS_PER_TORRENT = 200;
+    const int MAX_TORRENTS = 100000;
+    const int MAX_PEERS_PER_TORRENT = 500;
     const int ANNOUNCE_INTERVAL = 1800;  // 30min
+    const std::chrono::seconds PEER_TTL {2 * ANNOUNCE_INTERVAL};
+    const std::chrono::minutes EXPIRED_PEERS_CHECK_INTERVAL {1};
 
     // constants
+    const int DEFAULT_NUM_WANT = 50;
     const int PEER_ID_SIZE = 20;
 
     const QString ANNOUNCE_REQUEST_PATH = u"/announce"_s;
@@ -83,6 +99,29 @@ namespace
     const char ANNOUNCE_RESPONSE_PEERS_PEER_ID[] = "peer id";
     const char ANNOUNCE_RESPONSE_PEERS_PORT[] = "port";
 
+    // [BEP-15] UDP Tracker Protocol
+    const quint64 UDP_PROTOCOL_ID = 0x41727101980;
+    const quint32 UDP_ACTION_CONNECT = 0;
+    const quint32 UDP_ACTION_ANNOUNCE = 1;
+    const quint32 UDP_ACTION_SCRAPE = 2;
+    const quint32 UDP_ACTION_ERROR = 3;
+
+    const quint32 UDP_EVENT_NONE = 0;
+    const quint32 UDP_EVENT_COMPLETED = 1;
+    const quint32 UDP_EVENT_STARTED = 2;
+    const quint32 UDP_EVENT_STOPPED = 3;
+
+    const int UDP_REQUEST_HEADER_SIZE = 16;
+    const int UDP_ANNOUNCE_REQUEST_SIZE = 98;
+    const int UDP_ANNOUNCE_RESPONSE_HEADER_SIZE = 20;
+    const int UDP_MAX_RESPONSE_SIZE = 1400;  // keep responses below the typical MTU
+    const int UDP_MAX_SCRAPE_TORRENTS = 74;
+    const int UDP_SCRAPE_ENTRY_SIZE = 12;
+    const int INFO_HASH_SIZE = 20;
+
+    // Connection ID stays valid for one to two minutes
+    const qint64 UDP_CONNECTION_ID_LIFETIME = 60;  // in seconds
+
     class TrackerError : public RuntimeError
     {
     public:
@@ -120,24 +159,44 @@ namespace
             return {};
         };
     }
-}
 
-namespace BitTorrent
-{
-    // Peer
-    QByteArray Peer::uniqueID() const
+    template <typename T>
+    T readBigEndian(const QByteArrayView data, const qsizetype offset)
+    {
+        return qFromBigEndian<T>(data.data() + offset);
+    }
+
+    template <typename T>
+    void appendBigEndian(QByteArray &data, const T value)
     {
-        return (QByteArray::fromStdString(address) + ':' + QByteArray::number(port));
+        char buffer[sizeof(T)];
+        qToBigEndian(value, buffer);
+        data.append(buffer, sizeof(T));
     }
 
-    bool operator==(const Peer &left, const Peer &right)
+    // Random 128-bit key of connection ID MAC
+    QByteArray generateConnectionIDKey()
     {
-        return (left.uniqueID() == right.uniqueID());
+        QByteArray key;
+        for (int i = 0; i < 4; ++i)
+            appendBigEndian(key, Utils::Random::rand());
+        return key;
     }
 
-    std::size_t qHash(const Peer &key, const std::size_t seed)
+    lt::entry::string_type makeEndpoint(const QHostAddress &address, const ushort port)
     {
-        return qHash(key.uniqueID(), seed);
+        return toBigEndianByteArray(address)
+            .append(static_cast<char>((port >> 8) & 0xFF))
+            .append(static_cast<char>(port & 0xFF))
+            .toStdString();
+    }
+
+    QHostAddress normalizedAddress(const QHostAddress &address)
+    {
+        // Enforce using IPv4 if address is indeed IPv4 or if it is an IPv4-mapped IPv6 address
+        bool ok = false;
+        const quint32 ipv4 = address.toIPv4Address(&ok);
+        return ok ? QHostAddress(ipv4) : address;
     }
 }
 
@@ -149,53 +208,250 @@ struct Tracker::TrackerAnnounceRequest
     QHostAddress socketAddress;
     QByteArray claimedAddress;  // self claimed by peer
     TorrentID torrentID;
-    QString event;
+    TrackerAnnounceEvent event = TrackerAnnounceEvent::None;
     Peer peer;
-    int numwant = 50;
+    int numwant = DEFAULT_NUM_WANT;
     bool compact = true;
     bool noPeerId = false;
 };
 
-// Tracker::TorrentStats
-void Tracker::TorrentStats::setPeer(const Peer &peer)
+// Tracker::UDPWorker
+class Tracker::UDPWorker final : public QObject
 {
-    // always replace existing peer
-    if (!removePeer(peer))
+public:
+    explicit UDPWorker(TrackerSwarmTable *swarms);
+
+    nonstd::expected<void, QString> listen(int port);
+
+private:
+    void readPendingDatagrams();
+    QByteArray processDatagram(QByteArrayView datagram, const QHostAddress &address, quint16 port);
+    QByteArray processAnnounceRequest(QByteArrayView request, const QHostAddress &address, quint32 transactionID);
+    QByteArray processScrapeRequest(QByteArrayView request, quint32 transactionID) const;
+    quint64 makeConnectionID(const QHostAddress &address, quint16 port, qint64 timeSlot) const;
+
+    TrackerSwarmTable *m_swarms = nullptr;
+    QUdpSocket *m_socket = nullptr;
+    const QByteArray m_connectionIDKey = generateConnectionIDKey();
+};
+
+Tracker::UDPWorker::UDPWorker(TrackerSwarmTable *swarms)
+    : m_swarms {swarms}
+{
+}
+
+nonstd::expected<void, QString> Tracker::UDPWorker::listen(const int port)
+{
+    if (m_socket && (m_socket->localPort() == port))
+        return {};
+
+    delete m_socket;
+    m_socket = new QUdpSocket(this);
+    if (!m_socket->bind(QHostAddress::Any, port))
     {
-        // Too many peers, remove a random one
-        if (peers.size() >= MAX_PEERS_PER_TORRENT)
-            removePeer(*peers.begin());
+        const QString errorString = m_socket->errorString();
+        delete m_socket;
+        m_socket = nullptr;
+        return nonstd::make_unexpected(errorString);
     }
 
-    // add peer
-    if (peer.isSeeder)
-        ++seeders;
-    peers.insert(peer);
+    connect(m_socket, &QUdpSocket::readyRead, this, &UDPWorker::readPendingDatagrams);
+    return {};
 }
 
-bool Tracker::TorrentStats::removePeer(const Peer &peer)
+void Tracker::UDPWorker::readPendingDatagrams()
 {
-    const auto iter = peers.find(peer);
-    if (iter == peers.end())
-        return false;
+    while (m_socket->hasPendingDatagrams())
+    {
+        const QNetworkDatagram datagram = m_socket->receiveDatagram();
+        const auto senderPort = static_cast<quint16>(datagram.senderPort());
+        const QByteArray response = processDatagram(datagram.data()
+                , normalizedAddress(datagram.senderAddress()), senderPort);
+        if (!response.isEmpty())
+            m_socket->writeDatagram(response, datagram.senderAddress(), senderPort);
+    }
+}
 
-    if (iter->isSeeder)
-        --seeders;
-    peers.remove(*iter);
-    return true;
+QByteArray Tracker::UDPWorker::processDatagram(const QByteArrayView datagram, const QHostAddress &address, const quint16 port)
+{
+    if (datagram.size() < UDP_REQUEST_HEADER_SIZE)
+        return {};
+
+    const auto connectionID = readBigEndian<quint64>(datagram, 0);
+    const auto action = readBigEndian<quint32>(datagram, 8);
+    const auto transactionID = readBigEndian<quint32>(datagram, 12);
+    const qint64 timeSlot = QDateTime::currentSecsSinceEpoch() / UDP_CONNECTION_ID_LIFETIME;
+
+    try
+    {
+        if (action == UDP_ACTION_CONNECT)
+        {
+            if (connectionID != UDP_PROTOCOL_ID)
+                return {};
+
+            QByteArray response;
+            appendBigEndian(response, UDP_ACTION_CONNECT);
+            appendBigEndian(response, transactionID);
+            appendBigEndian(response, makeConnectionID(address, port, timeSlot));
+            return response;
+        }
+
+        // Source address of the requests without valid connection ID may be spoofed,
+        // so they are dropped silently instead of being answered with an error
+        if ((connectionID != makeConnectionID(address, port, timeSlot))
+            && (connectionID != makeConnectionID(address, port, (timeSlot - 1))))
+        {
+            return {};
+        }
+
+        switch (action)
+        {
+        case UDP_ACTION_ANNOUNCE:
+            return processAnnounceRequest(datagram, address, transactionID);
+        case UDP_ACTION_SCRAPE:
+            return processScrapeRequest(datagram, transactionID);
+        default:
+            throw TrackerError(u"Invalid action"_s);
+        }
+    }
+    catch (const TrackerError &error)
+    {
+        QByteArray response;
+        appendBigEndian(response, UDP_ACTION_ERROR);
+        appendBigEndian(response, transactionID);
+        response.append(error.message().toUtf8());
+        return response;
+    }
+}
+
+QByteArray Tracker::UDPWorker::processAnnounceRequest(const QByteArrayView request, const QHostAddress &address, const quint32 transactionID)
+{
+    if (request.size() < UDP_ANNOUNCE_REQUEST_SIZE)
+        throw TrackerError(u"Malformed announce request"_s);
+
+    const TorrentID torrentID {lt::sha1_hash(request.data() + 16)};
+    const auto left = readBigEndian<qint64>(request, 64);
+    const auto event = readBigEndian<quint32>(request, 80);
+    const auto claimedIPv4 = readBigEndian<quint32>(request, 84);
+    const auto numWant = readBigEndian<qint32>(request, 92);
+    const auto port = readBigEndian<quint16>(request, 96);
+
+    if (port == 0)
+        throw TrackerError(u"Invalid \"port\" parameter"_s);
+
+    TrackerAnnounceEvent announceEvent = TrackerAnnounceEvent::None;
+    switch (event)
+    {
+    case UDP_EVENT_NONE:
+        break;
+    case UDP_EVENT_COMPLETED:
+        announceEvent = TrackerAnnounceEvent::Completed;
+        break;
+    case UDP_EVENT_STARTED:
+        announceEvent = TrackerAnnounceEvent::Started;
+        break;
+    case UDP_EVENT_STOPPED:
+        announceEvent = TrackerAnnounceEvent::Stopped;
+        break;
+    default:
+        throw TrackerError(u"Invalid \"event\" parameter"_s);
+    }
+
+    const QHostAddress peerAddress = (claimedIPv4 != 0) ? QHostAddress(claimedIPv4) : address;
+
+    Peer peer;
+    peer.peerId = request.sliced(36, PEER_ID_SIZE).toByteArray();
+    peer.port = port;
+    peer.isSeeder = (left == 0);
+    peer.address = peerAddress.toString().toStdString();
+    peer.endpoint = makeEndpoint(peerAddress, port);
+
+    // Only the peers of the same address family as the requester are sent back
+    const int endpointSize = (address.protocol() == QAbstractSocket::IPv4Protocol) ? 6 : 18;
+    const int maxPeers = (UDP_MAX_RESPONSE_SIZE - UDP_ANNOUNCE_RESPONSE_HEADER_SIZE) / endpointSize;
+    const int wantedPeers = std::min(((numWant < 0) ? DEFAULT_NUM_WANT : numWant), maxPeers);
+
+    const auto announceResult = m_swarms->announce(torrentID, peer, announceEvent, wantedPeers);
+    if (!announceResult)
+        throw TrackerError(announceResult.error());
+
+    QByteArray response;
+    response.reserve(UDP_ANNOUNCE_RESPONSE_HEADER_SIZE + (wantedPeers * endpointSize));
+    appendBigEndian(response, UDP_ACTION_ANNOUNCE);
+    appendBigEndian(response, transactionID);
+    appendBigEndian(response, static_cast<quint32>(ANNOUNCE_INTERVAL));
+    appendBigEndian(response, static_cast<quint32>(announceResult->stats.leechers));
+    appendBigEndian(response, static_cast<quint32>(announceResult->stats.seeders));
+    for (const Peer &swarmPeer : announceResult->peers)
+    {
+        if (std::ssize(swarmPeer.endpoint) == endpointSize)
+            response.append(swarmPeer.endpoint.data(), endpointSize);
+    }
+
+    return response;
+}
+
+QByteArray Tracker::UDPWorker::processScrapeRequest(const QByteArrayView request, const quint32 transactionID) const
+{
+    const qsizetype torrentsCount = std::min<qsizetype>(((request.size() - UDP_REQUEST_HEADER_SIZE) / INFO_HASH_SIZE)
+            , UDP_MAX_SCRAPE_TORRENTS);
+    if (torrentsCount == 0)
+        throw TrackerError(u"Malformed scrape request"_s);
+
+    QByteArray response;
+    response.reserve(8 + (torrentsCount * UDP_SCRAPE_ENTRY_SIZE));
+    appendBigEndian(response, UDP_ACTION_SCRAPE);
+    appendBigEndian(response, transactionID);
+    for (qsizetype i = 0; i < torrentsCount; ++i)
+    {
+        const TorrentID torrentID {lt::sha1_hash(request.data() + UDP_REQUEST_HEADER_SIZE + (i * INFO_HASH_SIZE))};
+        const TrackerSwarmStats stats = m_swarms->scrape(torrentID);
+        appendBigEndian(response, static_cast<quint32>(stats.seeders));
+        appendBigEndian(response, static_cast<quint32>(stats.completed));
+        appendBigEndian(response, static_cast<quint32>(stats.leechers));
+    }
+
+    return response;
+}
+
+quint64 Tracker::UDPWorker::makeConnectionID(const QHostAddress &address, const quint16 port, const qint64 timeSlot) const
+{
+    // Connection IDs are derived from the client endpoint so that the tracker
+    // doesn't need to keep any state for the clients that haven't announced yet.
+    // They are keyed MACs so clients can't forge them for the endpoints they don't own.
+    const Q_IPV6ADDR ipv6Address = address.toIPv6Address();
+    QByteArray message {reinterpret_cast<const char *>(ipv6Address.c), sizeof(ipv6Address.c)};
+    appendBigEndian(message, port);
+    appendBigEndian(message, timeSlot);
+
+    const QByteArray mac = QMessageAuthenticationCode::hash(message, m_connectionIDKey, QCryptographicHash::Sha256);
+    return qFromBigEndian<quint64>(mac.constData());
 }
 
 // Tracker
 Tracker::Tracker(QObject *parent)
     : QObject(parent)
     , m_server(new Http::Server(this, this))
+    , m_swarms {MAX_TORRENTS, MAX_PEERS_PER_TORRENT, PEER_TTL}
+    , m_udpThread {new QThread}
+    , m_udpWorker {new UDPWorker(&m_swarms)}
 {
+    m_udpWorker->moveToThread(m_udpThread.get());
+    connect(m_udpThread.get(), &QThread::finished, m_udpWorker, &QObject::deleteLater);
+    m_udpThread->setObjectName("Tracker m_udpThread");
+    m_udpThread->start();
+
+    auto *expiredPeersTimer = new QTimer(this);
+    connect(expiredPeersTimer, &QTimer::timeout, this, [this] { m_swarms.removeExpiredPeers(); });
+    expiredPeersTimer->start(EXPIRED_PEERS_CHECK_INTERVAL);
 }
 
 bool Tracker::start()
 {
     const int port = Preferences::instance()->getTrackerPort();
 
+    startUDP(port);
+
     if (m_server->isListening())
     {
         if (const int oldPort = m_server->serverPort()
@@ -227,6 +483,25 @@ bool Tracker::start()
     return listenSuccess;
 }
 
+bool Tracker::startUDP(const int port)
+{
+    nonstd::expected<void, QString> listenResult;
+    QMetaObject::invokeMethod(m_udpWorker, [this, port, &listenResult]
+    {
+        listenResult = m_udpWorker->listen(port);
+    }, Qt::BlockingQueuedConnection);
+
+    if (!listenResult)
+    {
+        LogMsg(tr("Embedded Tracker: Unable to bind UDP socket to port: %1. Reason: %2")
+                .arg(QString::number(port), listenResult.error())
+            , Log::WARNING);
+        return false;
+    }
+
+    return true;
+}
+
 Http::Response Tracker::processRequest(const Http::Request &request, const Http::Environment &env)
 {
     m_request = request;
@@ -277,15 +552,9 @@ void Tracker::processAnnounceRequest()
     TrackerAnnounceRequest announceReq;
 
     // ip address
-    announceReq.socketAddress = m_env.clientAddress;
+    announceReq.socketAddress = normalizedAddress(m_env.clientAddress);
     announceReq.claimedAddress = queryParams.value(ANNOUNCE_REQUEST_IP);
 
-    // Enforce using IPv4 if address is indeed IPv4 or if it is an IPv4-mapped IPv6 address
-    bool ok = false;
-    const qint32 decimalIPv4 = announceReq.socketAddress.toIPv4Address(&ok);
-    if (ok)
-        announceReq.socketAddress = QHostAddress(decimalIPv4);
-
     // 1. info_hash
     const auto infoHashIter = queryParams.find(ANNOUNCE_REQUEST_INFO_HASH);
     if (infoHashIter == queryParams.end())
@@ -340,74 +609,44 @@ void Tracker::processAnnounceRequest()
 
     // 8. cache `peers` field so we don't recompute when sending response
     const QHostAddress claimedIPAddress {QString::fromLatin1(announceReq.claimedAddress)};
-    announceReq.peer.endpoint = toBigEndianByteArray(!claimedIPAddress.isNull() ? claimedIPAddress : announceReq.socketAddress)
-        .append(static_cast<char>((announceReq.peer.port >> 8) & 0xFF))
-        .append(static_cast<char>(announceReq.peer.port & 0xFF))
-        .toStdString();
+    announceReq.peer.endpoint = makeEndpoint((!claimedIPAddress.isNull() ? claimedIPAddress : announceReq.socketAddress)
+        , announceReq.peer.port);
 
     // 9. cache `address` field so we don't recompute when sending response
     announceReq.peer.address = !announceReq.claimedAddress.isEmpty()
         ? announceReq.claimedAddress.constData()
-        : announceReq.socketAddress.toString().toLatin1().constData(),
+        : announceReq.socketAddress.toString().toLatin1().constData();
 
     // 10. event
-    announceReq.event = QString::fromLatin1(queryParams.value(ANNOUNCE_REQUEST_EVENT));
-
-    if (announceReq.event.isEmpty()
-        || (announceReq.event == ANNOUNCE_REQUEST_EVENT_EMPTY)
-        || (announceReq.event == ANNOUNCE_REQUEST_EVENT_COMPLETED)
-        || (announceReq.event == ANNOUNCE_REQUEST_EVENT_STARTED)
-        || (announceReq.event == ANNOUNCE_REQUEST_EVENT_PAUSED))
-        {
-        // [BEP-21] Extension for partial seeds
-        // (partial support - we don't support BEP-48 so the part that concerns that is not supported)
-        registerPeer(announceReq);
-    }
-    else if (announceReq.event == ANNOUNCE_REQUEST_EVENT_STOPPED)
-    {
-        unregisterPeer(announceReq);
-    }
+    const QString event = QString::fromLatin1(queryParams.value(ANNOUNCE_REQUEST_EVENT));
+
+    // [BEP-21] Extension for partial seeds
+    // (partial support - we don't support BEP-48 so the part that concerns that is not supported)
+    if (event.isEmpty() || (event == ANNOUNCE_REQUEST_EVENT_EMPTY) || (event == ANNOUNCE_REQUEST_EVENT_PAUSED))
+        announceReq.event = TrackerAnnounceEvent::None;
+    else if (event == ANNOUNCE_REQUEST_EVENT_STARTED)
+        announceReq.event = TrackerAnnounceEvent::Started;
+    else if (event == ANNOUNCE_REQUEST_EVENT_COMPLETED)
+        announceReq.event = TrackerAnnounceEvent::Completed;
+    else if (event == ANNOUNCE_REQUEST_EVENT_STOPPED)
+        announceReq.event = TrackerAnnounceEvent::Stopped;
     else
-    {
         throw TrackerError(u"Invalid \"event\" parameter"_s);
-    }
-
-    prepareAnnounceResponse(announceReq);
-}
-
-void Tracker::registerPeer(const TrackerAnnounceRequest &announceReq)
-{
-    if (!m_torrents.contains(announceReq.torrentID))
-    {
-        // Reached max size, remove a random torrent
-        if (m_torrents.size() >= MAX_TORRENTS)
-            m_torrents.erase(m_torrents.cbegin());
-    }
-
-    m_torrents[announceReq.torrentID].setPeer(announceReq.peer);
-}
-
-void Tracker::unregisterPeer(const TrackerAnnounceRequest &announceReq)
-{
-    const auto torrentStatsIter = m_torrents.find(announceReq.torrentID);
-    if (torrentStatsIter == m_torrents.end())
-        return;
 
-    torrentStatsIter->removePeer(announceReq.peer);
+    const auto announceResult = m_swarms.announce(announceReq.torrentID, announceReq.peer, announceReq.event, announceReq.numwant);
+    if (!announceResult)
+        throw TrackerError(announceResult.error());
 
-    if (torrentStatsIter->peers.isEmpty())
-        m_torrents.erase(torrentStatsIter);
+    prepareAnnounceResponse(announceReq, announceResult.value());
 }
 
-void Tracker::prepareAnnounceResponse(const TrackerAnnounceRequest &announceReq)
+void Tracker::prepareAnnounceResponse(const TrackerAnnounceRequest &announceReq, const TrackerAnnounceResult &announceResult)
 {
-    const TorrentStats &torrentStats = m_torrents[announceReq.torrentID];
-
     lt::entry::dictionary_type replyDict
     {
         {ANNOUNCE_RESPONSE_INTERVAL, ANNOUNCE_INTERVAL},
-        {ANNOUNCE_RESPONSE_COMPLETE, torrentStats.seeders},
-        {ANNOUNCE_RESPONSE_INCOMPLETE, (torrentStats.peers.size() - torrentStats.seeders)},
+        {ANNOUNCE_RESPONSE_COMPLETE, announceResult.stats.seeders},
+        {ANNOUNCE_RESPONSE_INCOMPLETE, announceResult.stats.leechers},
 
         // [BEP-24] Tracker Returns External IP (partial support - might not work properly for all IPv6 cases)
         {ANNOUNCE_RESPONSE_EXTERNAL_IP, toBigEndianByteArray(announceReq.socketAddress).toStdString()}
@@ -421,19 +660,12 @@ void Tracker::prepareAnnounceResponse(const TrackerAnnounceRequest &announceReq)
         lt::entry::string_type peers;
         lt::entry::string_type peers6;
 
-        if (announceReq.event != ANNOUNCE_REQUEST_EVENT_STOPPED)
+        for (const Peer &peer : announceResult.peers)
         {
-            int counter = 0;
-            for (const Peer &peer : asConst(torrentStats.peers))
-            {
-                if (counter++ >= announceReq.numwant)
-                    break;
-
-                if (peer.endpoint.size() == 6)  // IPv4 + port
-                    peers.append(peer.endpoint);
-                else if (peer.endpoint.size() == 18)  // IPv6 + port
-                    peers6.append(peer.endpoint);
-            }
+            if (peer.endpoint.size() == 6)  // IPv4 + port
+                peers.append(peer.endpoint);
+            else if (peer.endpoint.size() == 18)  // IPv6 + port
+                peers6.append(peer.endpoint);
         }
 
         replyDict[ANNOUNCE_RESPONSE_PEERS] = peers;  // required, even it's empty
@@ -444,25 +676,18 @@ void Tracker::prepareAnnounceResponse(const TrackerAnnounceRequest &announceReq)
     {
         lt::entry::list_type peerList;
 
-        if (announceReq.event != ANNOUNCE_REQUEST_EVENT_STOPPED)
+        for (const Peer &peer : announceResult.peers)
         {
-            int counter = 0;
-            for (const Peer &peer : torrentStats.peers)
+            lt::entry::dictionary_type peerDict =
             {
-                if (counter++ >= announceReq.numwant)
-                    break;
-
-                lt::entry::dictionary_type peerDict =
-                {
-                    {ANNOUNCE_RESPONSE_PEERS_IP, peer.address},
-                    {ANNOUNCE_RESPONSE_PEERS_PORT, peer.port}
-                };
+                {ANNOUNCE_RESPONSE_PEERS_IP, peer.address},
+                {ANNOUNCE_RESPONSE_PEERS_PORT, peer.port}
+            };
 
-                if (!announceReq.noPeerId)
-                    peerDict[ANNOUNCE_RESPONSE_PEERS_PEER_ID] = lt::entry::string_type(peer.peerId.constData(), peer.peerId.size());
+            if (!announceReq.noPeerId)
+                peerDict[ANNOUNCE_RESPONSE_PEERS_PEER_ID] = lt::entry::string_type(peer.peerId.constData(), peer.peerId.size());
 
-                peerList.emplace_back(peerDict);
-            }
+            peerList.emplace_back(peerDict);
         }
 
         replyDict[ANNOUNCE_RESPONSE_PEERS] = peerList;
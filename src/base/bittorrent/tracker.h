@@ -30,18 +30,14 @@
 
 #pragma once
 
-#include <libtorrent/entry.hpp>
-
-#include <QtTypes>
-#include <QHash>
 #include <QObject>
-#include <QSet>
 
-#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/trackerswarmtable.h"
 #include "base/http/environment.h"
 #include "base/http/irequesthandler.h"
 #include "base/http/request.h"
 #include "base/http/response.h"
+#include "base/utils/thread.h"
 
 namespace Http
 {
@@ -50,24 +46,9 @@ namespace Http
 
 namespace BitTorrent
 {
-    struct Peer
-    {
-        QByteArray peerId;
-        ushort port = 0;  // self-claimed by peer, might not be the same as socket port
-        bool isSeeder = false;
-
-        // caching precomputed values
-        lt::entry::string_type address;
-        lt::entry::string_type endpoint;
-
-        QByteArray uniqueID() const;
-    };
-
-    bool operator==(const Peer &left, const Peer &right);
-    std::size_t qHash(const Peer &key, std::size_t seed = 0);
-
     // *Basic* Bittorrent tracker implementation
     // [BEP-3] The BitTorrent Protocol Specification
+    // [BEP-15] UDP Tracker Protocol for BitTorrent
     // also see: https://wiki.theory.org/index.php/BitTorrentSpecification#Tracker_HTTP.2FHTTPS_Protocol
     class Tracker final : public QObject, public Http::IRequestHandler
     {
@@ -76,33 +57,28 @@ namespace BitTorrent
 
         struct TrackerAnnounceRequest;
 
-        struct TorrentStats
-        {
-            qint64 seeders = 0;
-            QSet<Peer> peers;
-
-            void setPeer(const Peer &peer);
-            bool removePeer(const Peer &peer);
-        };
-
     public:
         explicit Tracker(QObject *parent = nullptr);
 
         bool start();
 
     private:
+        class UDPWorker;
+
         Http::Response processRequest(const Http::Request &request, const Http::Environment &env) override;
         void processAnnounceRequest();
-
-        void registerPeer(const TrackerAnnounceRequest &announceReq);
-        void unregisterPeer(const TrackerAnnounceRequest &announceReq);
-        void prepareAnnounceResponse(const TrackerAnnounceRequest &announceReq);
+        void prepareAnnounceResponse(const TrackerAnnounceRequest &announceReq, const TrackerAnnounceResult &announceResult);
+        bool startUDP(int port);
 
         Http::Server *m_server = nullptr;
         Http::Request m_request;
         Http::Environment m_env;
         Http::Response m_response;
 
-        QHash<TorrentID, TorrentStats> m_torrents;
+        TrackerSwarmTable m_swarms;
+
+        // UDP requests are processed in a dedicated thread
+        Utils::Thread::UniquePtr m_udpThread;
+        UDPWorker *m_udpWorker = nullptr;
     };
 }
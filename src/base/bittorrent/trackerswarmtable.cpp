@@ -0,0 +1,245 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "trackerswarmtable.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "base/global.h"
+#include "base/utils/random.h"
+
+using namespace BitTorrent;
+
+// Peer
+QByteArray Peer::uniqueID() const
+{
+    return (QByteArray::fromStdString(address) + ':' + QByteArray::number(port));
+}
+
+// TrackerSwarmTable::Swarm
+TrackerSwarmStats TrackerSwarmTable::Swarm::stats() const
+{
+    return {.seeders = seeders, .leechers = (std::ssize(peers) - seeders), .completed = completed};
+}
+
+void TrackerSwarmTable::Swarm::addPeer(PeerEntry entry)
+{
+    if (entry.peer.isSeeder)
+        ++seeders;
+    peerIndexes.insert(entry.uniqueID, std::ssize(peers));
+    peers.push_back(std::move(entry));
+}
+
+void TrackerSwarmTable::Swarm::removePeerAt(const qsizetype index)
+{
+    // move the peer to the end so the removal doesn't shift the remaining ones
+    swapPeers(index, (std::ssize(peers) - 1));
+
+    const PeerEntry &entry = peers.back();
+    if (entry.peer.isSeeder)
+        --seeders;
+    peerIndexes.remove(entry.uniqueID);
+    peers.pop_back();
+}
+
+void TrackerSwarmTable::Swarm::swapPeers(const qsizetype index1, const qsizetype index2)
+{
+    if (index1 == index2)
+        return;
+
+    std::swap(peers[index1], peers[index2]);
+    peerIndexes[peers[index1].uniqueID] = index1;
+    peerIndexes[peers[index2].uniqueID] = index2;
+}
+
+qsizetype TrackerSwarmTable::Swarm::removeExpiredPeers(const Clock::time_point now)
+{
+    const qsizetype oldCount = std::ssize(peers);
+    for (qsizetype i = 0; i < std::ssize(peers);)
+    {
+        if (peers[i].expiryTime <= now)
+            removePeerAt(i);
+        else
+            ++i;
+    }
+
+    return (oldCount - std::ssize(peers));
+}
+
+// TrackerSwarmTable
+TrackerSwarmTable::TrackerSwarmTable(const qsizetype maxTorrents, const qsizetype maxPeersPerTorrent, const std::chrono::seconds peerTTL)
+    : m_maxTorrents {maxTorrents}
+    , m_maxPeersPerTorrent {maxPeersPerTorrent}
+    , m_peerTTL {peerTTL}
+{
+    for (Shard &shard : m_shards)
+        shard.randomEngine.seed(Utils::Random::rand());
+}
+
+nonstd::expected<TrackerAnnounceResult, QString> TrackerSwarmTable::announce(const TorrentID &id, const Peer &peer
+        , const TrackerAnnounceEvent event, const int numWant, const Clock::time_point now)
+{
+    Shard &shard = shardFor(id);
+    const QMutexLocker locker {&shard.mutex};
+
+    TrackerAnnounceResult result;
+    const QByteArray peerUniqueID = peer.uniqueID();
+
+    auto swarmIter = shard.swarms.find(id);
+    if (event == TrackerAnnounceEvent::Stopped)
+    {
+        if (swarmIter == shard.swarms.end())
+            return result;
+
+        if (const qsizetype index = swarmIter->peerIndexes.value(peerUniqueID, -1); index >= 0)
+            swarmIter->removePeerAt(index);
+
+        result.stats = swarmIter->stats();
+        if (swarmIter->peers.empty())
+        {
+            shard.swarms.erase(swarmIter);
+            --m_torrentsCount;
+        }
+
+        return result;
+    }
+
+    if (swarmIter == shard.swarms.end())
+    {
+        if (m_torrentsCount.fetch_add(1) >= m_maxTorrents)
+        {
+            --m_torrentsCount;
+            return nonstd::make_unexpected(u"Tracker is full"_s);
+        }
+
+        swarmIter = shard.swarms.insert(id, {});
+    }
+
+    Swarm &swarm = *swarmIter;
+    const Clock::time_point expiryTime = now + m_peerTTL;
+    if (const qsizetype index = swarm.peerIndexes.value(peerUniqueID, -1); index >= 0)
+    {
+        // always replace existing peer
+        PeerEntry &entry = swarm.peers[index];
+        if (entry.peer.isSeeder)
+            --swarm.seeders;
+        if (peer.isSeeder)
+            ++swarm.seeders;
+        entry.peer = peer;
+        entry.expiryTime = expiryTime;
+    }
+    else
+    {
+        // Too many peers, drop the stale ones or the least recently announced one
+        if ((std::ssize(swarm.peers) >= m_maxPeersPerTorrent) && (swarm.removeExpiredPeers(now) == 0))
+        {
+            const auto oldestIter = std::ranges::min_element(swarm.peers, {}, &PeerEntry::expiryTime);
+            swarm.removePeerAt(std::distance(swarm.peers.begin(), oldestIter));
+        }
+
+        swarm.addPeer({.peer = peer, .uniqueID = peerUniqueID, .expiryTime = expiryTime});
+    }
+
+    if (event == TrackerAnnounceEvent::Completed)
+        ++swarm.completed;
+
+    result.stats = swarm.stats();
+
+    // Choose random peers by partially shuffling the peer list (Fisher-Yates),
+    // so it costs O(numWant) regardless of the swarm size
+    const qsizetype peersCount = std::ssize(swarm.peers);
+    const qsizetype wantedCount = std::min<qsizetype>(numWant, (peersCount - 1));
+    if (wantedCount > 0)
+    {
+        result.peers.reserve(wantedCount);
+        for (qsizetype i = 0; (i < peersCount) && (std::ssize(result.peers) < wantedCount); ++i)
+        {
+            const qsizetype j = std::uniform_int_distribution<qsizetype>(i, (peersCount - 1))(shard.randomEngine);
+            swarm.swapPeers(i, j);
+
+            const PeerEntry &entry = swarm.peers[i];
+            if (entry.uniqueID != peerUniqueID)
+                result.peers.push_back(entry.peer);
+        }
+    }
+
+    return result;
+}
+
+TrackerSwarmStats TrackerSwarmTable::scrape(const TorrentID &id) const
+{
+    const Shard &shard = shardFor(id);
+    const QMutexLocker locker {&shard.mutex};
+
+    const auto swarmIter = shard.swarms.constFind(id);
+    if (swarmIter == shard.swarms.cend())
+        return {};
+
+    return swarmIter->stats();
+}
+
+qsizetype TrackerSwarmTable::removeExpiredPeers(const Clock::time_point now)
+{
+    qsizetype removedCount = 0;
+    for (Shard &shard : m_shards)
+    {
+        const QMutexLocker locker {&shard.mutex};
+
+        for (auto swarmIter = shard.swarms.begin(); swarmIter != shard.swarms.end();)
+        {
+            removedCount += swarmIter->removeExpiredPeers(now);
+            if (swarmIter->peers.empty())
+            {
+                swarmIter = shard.swarms.erase(swarmIter);
+                --m_torrentsCount;
+            }
+            else
+            {
+                ++swarmIter;
+            }
+        }
+    }
+
+    return removedCount;
+}
+
+qsizetype TrackerSwarmTable::torrentsCount() const
+{
+    return m_torrentsCount;
+}
+
+TrackerSwarmTable::Shard &TrackerSwarmTable::shardFor(const TorrentID &id)
+{
+    return m_shards[qHash(id) % SHARDS_COUNT];
+}
+
+const TrackerSwarmTable::Shard &TrackerSwarmTable::shardFor(const TorrentID &id) const
+{
+    return m_shards[qHash(id) % SHARDS_COUNT];
+}
@@ -0,0 +1,149 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <libtorrent/entry.hpp>
+
+#include <QtTypes>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include "base/3rdparty/expected.hpp"
+#include "base/bittorrent/infohash.h"
+
+namespace BitTorrent
+{
+    struct Peer
+    {
+        QByteArray peerId;
+        ushort port = 0;  // self-claimed by peer, might not be the same as socket port
+        bool isSeeder = false;
+
+        // caching precomputed values
+        lt::entry::string_type address;
+        lt::entry::string_type endpoint;
+
+        QByteArray uniqueID() const;
+    };
+
+    enum class TrackerAnnounceEvent
+    {
+        None,
+        Started,
+        Completed,
+        Stopped
+    };
+
+    struct TrackerSwarmStats
+    {
+        qint64 seeders = 0;
+        qint64 leechers = 0;
+        qint64 completed = 0;
+    };
+
+    struct TrackerAnnounceResult
+    {
+        TrackerSwarmStats stats;
+        std::vector<Peer> peers;
+    };
+
+    // Peers known to the embedded tracker.
+    // Swarms are distributed between independently locked shards by torrent ID,
+    // so announces can be processed concurrently by several endpoints.
+    // Each peer expires if it doesn't announce again within its time-to-live.
+    class TrackerSwarmTable
+    {
+        Q_DISABLE_COPY_MOVE(TrackerSwarmTable)
+
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        TrackerSwarmTable(qsizetype maxTorrents, qsizetype maxPeersPerTorrent, std::chrono::seconds peerTTL);
+
+        // Registers the peer (or unregisters it on `Stopped` event) and
+        // returns up to `numWant` other peers of the swarm chosen at random
+        nonstd::expected<TrackerAnnounceResult, QString> announce(const TorrentID &id, const Peer &peer
+                , TrackerAnnounceEvent event, int numWant, Clock::time_point now = Clock::now());
+        TrackerSwarmStats scrape(const TorrentID &id) const;
+
+        // Returns number of removed peers
+        qsizetype removeExpiredPeers(Clock::time_point now = Clock::now());
+
+        qsizetype torrentsCount() const;
+
+    private:
+        static constexpr qsizetype SHARDS_COUNT = 32;
+
+        struct PeerEntry
+        {
+            Peer peer;
+            QByteArray uniqueID;
+            Clock::time_point expiryTime;
+        };
+
+        struct Swarm
+        {
+            std::vector<PeerEntry> peers;
+            QHash<QByteArray, qsizetype> peerIndexes;
+            qint64 seeders = 0;
+            qint64 completed = 0;
+
+            TrackerSwarmStats stats() const;
+            void addPeer(PeerEntry entry);
+            void removePeerAt(qsizetype index);
+            void swapPeers(qsizetype index1, qsizetype index2);
+            qsizetype removeExpiredPeers(Clock::time_point now);
+        };
+
+        struct Shard
+        {
+            mutable QMutex mutex;
+            QHash<TorrentID, Swarm> swarms;
+            std::minstd_rand randomEngine;
+        };
+
+        Shard &shardFor(const TorrentID &id);
+        const Shard &shardFor(const TorrentID &id) const;
+
+        const qsizetype m_maxTorrents;
+        const qsizetype m_maxPeersPerTorrent;
+        const std::chrono::seconds m_peerTTL;
+
+        std::array<Shard, SHARDS_COUNT> m_shards;
+        std::atomic<qsizetype> m_torrentsCount = 0;
+    };
+}
@@ -0,0 +1,602 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "transferhistory.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include <QDateTime>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/utils/fs.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    const quint32 FILE_MAGIC = 0x71625448; // "qbTH"
+    const quint32 FILE_VERSION = 2;
+
+    // Number of torrent slots the file is created with, it is doubled each time they are exhausted
+    const int MIN_TORRENT_SLOT_COUNT = 64;
+    // Transfer of a torrent isn't spread over longer periods when its updates were sparse
+    const qint64 MAX_TORRENT_SPREAD_MSECS = 10 * 1000;
+    const qint64 MAX_SESSION_SPREAD_MSECS = 10 * 1000;
+
+    // 1 hour by seconds, 1 day by minutes, 30 days by hours
+    const QList<TransferHistorySeries::RingLayout> FULL_LAYOUT = {
+        {TransferHistory::SECOND, 3600},
+        {TransferHistory::MINUTE, 1440},
+        {TransferHistory::HOUR, 720}
+    };
+    // Per torrent history doesn't need per second resolution, it is kept small since there can be lots of torrents
+    const QList<TransferHistorySeries::RingLayout> TORRENT_LAYOUT = {
+        {TransferHistory::MINUTE, 1440},
+        {TransferHistory::HOUR, 720}
+    };
+
+    struct FileHeader
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 ringCount;
+        quint32 slotCount;
+    };
+
+    QByteArray torrentKey(const TorrentID &id)
+    {
+        return id.toString().toLatin1();
+    }
+}
+
+struct TransferHistoryFile::SlotHeader
+{
+    char key[MAX_KEY_SIZE]; // zero padded, all zeros if the slot is free
+    quint32 isUsed;
+    quint32 reserved;
+};
+
+struct TransferHistorySeries::RingHeader
+{
+    quint32 resolution;
+    quint32 capacity;
+    qint64 headBucket; // -1 if the ring is empty
+};
+
+TransferHistorySeries::TransferHistorySeries(uchar *data, const QList<RingLayout> &layout, const QList<qsizetype> &ringOffsets)
+    : m_data {data}
+    , m_layout {layout}
+    , m_ringOffsets {ringOffsets}
+{
+}
+
+bool TransferHistorySeries::isNull() const
+{
+    return !m_data;
+}
+
+bool TransferHistorySeries::isValid() const
+{
+    for (qsizetype i = 0; i < m_layout.size(); ++i)
+    {
+        const RingHeader *ring = ringHeader(i);
+        if ((ring->resolution != static_cast<quint32>(m_layout[i].resolution))
+            || (ring->capacity != static_cast<quint32>(m_layout[i].capacity)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void TransferHistorySeries::reset()
+{
+    std::memset(m_data, 0, m_ringOffsets.last());
+    for (qsizetype i = 0; i < m_layout.size(); ++i)
+    {
+        *ringHeader(i) = {.resolution = static_cast<quint32>(m_layout[i].resolution)
+            , .capacity = static_cast<quint32>(m_layout[i].capacity), .headBucket = -1};
+    }
+}
+
+TransferHistorySeries::RingHeader *TransferHistorySeries::ringHeader(const qsizetype index) const
+{
+    return reinterpret_cast<RingHeader *>(m_data + (index * sizeof(RingHeader)));
+}
+
+TransferHistorySample *TransferHistorySeries::ringSamples(const qsizetype index) const
+{
+    return reinterpret_cast<TransferHistorySample *>(m_data + m_ringOffsets[index]);
+}
+
+TransferHistorySample *TransferHistorySeries::bucketSample(const qsizetype ringIndex, const qint64 bucket)
+{
+    RingHeader *ring = ringHeader(ringIndex);
+    TransferHistorySample *bucketSamples = ringSamples(ringIndex);
+    const qint64 capacity = ring->capacity;
+
+    if (bucket > ring->headBucket)
+    {
+        // clear the samples the ring is advanced over
+        const qint64 firstStale = std::max<qint64>(((ring->headBucket < 0) ? 0 : (ring->headBucket + 1)), (bucket - capacity + 1));
+        for (qint64 b = firstStale; b <= bucket; ++b)
+            bucketSamples[b % capacity] = {};
+        ring->headBucket = bucket;
+    }
+    else if (bucket <= (ring->headBucket - capacity))
+    {
+        return nullptr;
+    }
+
+    return &bucketSamples[bucket % capacity];
+}
+
+void TransferHistorySeries::add(qint64 startMSecs, const qint64 endMSecs, const quint64 downloaded, const quint64 uploaded)
+{
+    if ((endMSecs <= 0) || ((downloaded == 0) && (uploaded == 0)))
+        return;
+
+    startMSecs = std::clamp<qint64>(startMSecs, 0, (endMSecs - 1));
+
+    for (qsizetype ringIndex = 0; ringIndex < m_layout.size(); ++ringIndex)
+    {
+        const qint64 resolution = m_layout[ringIndex].resolution * 1000LL;
+        const qint64 lastBucket = (endMSecs - 1) / resolution;
+        const qint64 firstBucket = std::max((startMSecs / resolution), (lastBucket - m_layout[ringIndex].capacity + 1));
+        const qint64 start = std::max(startMSecs, (firstBucket * resolution));
+        const auto duration = static_cast<double>(endMSecs - start);
+
+        quint64 downloadedLeft = downloaded;
+        quint64 uploadedLeft = uploaded;
+        for (qint64 bucket = firstBucket; bucket <= lastBucket; ++bucket)
+        {
+            TransferHistorySample *sample = bucketSample(ringIndex, bucket);
+            if (bucket == lastBucket)
+            {
+                if (sample)
+                {
+                    sample->downloaded += downloadedLeft;
+                    sample->uploaded += uploadedLeft;
+                }
+                break;
+            }
+
+            const qint64 overlap = std::min(endMSecs, ((bucket + 1) * resolution)) - std::max(start, (bucket * resolution));
+            const auto bucketDownloaded = std::min(downloadedLeft, static_cast<quint64>((static_cast<double>(downloaded) * overlap) / duration));
+            const auto bucketUploaded = std::min(uploadedLeft, static_cast<quint64>((static_cast<double>(uploaded) * overlap) / duration));
+            downloadedLeft -= bucketDownloaded;
+            uploadedLeft -= bucketUploaded;
+            if (sample)
+            {
+                sample->downloaded += bucketDownloaded;
+                sample->uploaded += bucketUploaded;
+            }
+        }
+    }
+}
+
+TransferHistoryRange TransferHistorySeries::samples(const int resolution, const qint64 from, const qint64 to) const
+{
+    const auto ringIter = std::find_if(m_layout.cbegin(), m_layout.cend()
+        , [resolution](const RingLayout &ring) { return ring.resolution == resolution; });
+    if (ringIter == m_layout.cend())
+        return {};
+
+    const qsizetype ringIndex = std::distance(m_layout.cbegin(), ringIter);
+    const RingHeader *ring = ringHeader(ringIndex);
+    const TransferHistorySample *bucketSamples = ringSamples(ringIndex);
+    const qint64 capacity = ring->capacity;
+
+    const qint64 lastBucket = std::max<qint64>(to, 0) / resolution;
+    const qint64 firstBucket = std::max((std::max<qint64>(from, 0) / resolution), (lastBucket - capacity + 1));
+
+    TransferHistoryRange range {.resolution = resolution, .start = (firstBucket * resolution), .samples = {}};
+    if (firstBucket > lastBucket)
+        return range;
+
+    range.samples.reserve(lastBucket - firstBucket + 1);
+    for (qint64 bucket = firstBucket; bucket <= lastBucket; ++bucket)
+    {
+        const bool isStored = (ring->headBucket >= 0) && (bucket <= ring->headBucket) && (bucket > (ring->headBucket - capacity));
+        range.samples.append(isStored ? bucketSamples[bucket % capacity] : TransferHistorySample());
+    }
+
+    return range;
+}
+
+nonstd::expected<std::unique_ptr<TransferHistoryFile>, QString> TransferHistoryFile::open(const Path &path
+        , const QList<TransferHistorySeries::RingLayout> &layout, const int minSlotCount)
+{
+    std::unique_ptr<TransferHistoryFile> file {new TransferHistoryFile(path, layout)};
+    if (const nonstd::expected<void, QString> result = file->mapFile(minSlotCount); !result)
+        return nonstd::make_unexpected(result.error());
+    return file;
+}
+
+TransferHistoryFile::TransferHistoryFile(const Path &path, const QList<TransferHistorySeries::RingLayout> &layout)
+    : m_file {path.data()}
+    , m_layout {layout}
+{
+    static_assert(sizeof(FileHeader) == 16);
+    static_assert(sizeof(SlotHeader) == 48);
+    static_assert(sizeof(TransferHistorySeries::RingHeader) == 16);
+    static_assert(sizeof(TransferHistorySample) == 16);
+
+    // offsets are relative to the series data which follows the slot header
+    qsizetype offset = m_layout.size() * sizeof(TransferHistorySeries::RingHeader);
+    m_ringOffsets.reserve(m_layout.size() + 1);
+    for (const TransferHistorySeries::RingLayout &ring : asConst(m_layout))
+    {
+        m_ringOffsets.append(offset);
+        offset += ring.capacity * sizeof(TransferHistorySample);
+    }
+    m_ringOffsets.append(offset); // total size of series data
+    m_slotSize = sizeof(SlotHeader) + offset;
+}
+
+TransferHistoryFile::~TransferHistoryFile()
+{
+    if (m_data)
+        m_file.unmap(m_data);
+}
+
+nonstd::expected<void, QString> TransferHistoryFile::mapFile(const int minSlotCount)
+{
+    if (!m_file.open(QIODevice::ReadWrite))
+        return nonstd::make_unexpected(m_file.errorString());
+
+    FileHeader header {};
+    const bool hasHeader = (m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) == sizeof(header));
+    const bool isValid = hasHeader && (header.magic == FILE_MAGIC) && (header.version == FILE_VERSION)
+        && (header.ringCount == static_cast<quint32>(m_layout.size())) && (header.slotCount > 0)
+        && (m_file.size() == static_cast<qint64>(sizeof(FileHeader) + (header.slotCount * m_slotSize)));
+
+    // Layout has changed or the file is new. Truncating it makes the file zero filled, so all the slots are free.
+    if (!isValid && !m_file.resize(0))
+        return nonstd::make_unexpected(m_file.errorString());
+
+    const int slotCount = isValid ? static_cast<int>(header.slotCount) : 0;
+    if (const nonstd::expected<void, QString> result = resize(std::max(slotCount, minSlotCount)); !result)
+        return result;
+
+    m_freeSlots.clear();
+    for (int slot = (m_slotCount - 1); slot >= 0; --slot)
+    {
+        SlotHeader *slotHeader = this->slotHeader(slot);
+        if (slotHeader->isUsed && series(slot).isValid())
+            continue;
+
+        *slotHeader = {};
+        m_freeSlots.append(slot);
+    }
+
+    return {};
+}
+
+nonstd::expected<void, QString> TransferHistoryFile::resize(const int slotCount)
+{
+    if (m_data)
+    {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+
+    const qint64 fileSize = sizeof(FileHeader) + (slotCount * m_slotSize);
+    if ((m_file.size() != fileSize) && !m_file.resize(fileSize))
+    {
+        const QString errorString = m_file.errorString();
+        // keep the existing slots available
+        if (m_slotCount > 0)
+            m_data = m_file.map(0, (sizeof(FileHeader) + (m_slotCount * m_slotSize)));
+        return nonstd::make_unexpected(errorString);
+    }
+
+    m_data = m_file.map(0, fileSize);
+    if (!m_data)
+        return nonstd::make_unexpected(m_file.errorString());
+
+    // new slots are zero filled, i.e. free
+    for (int slot = m_slotCount; slot < slotCount; ++slot)
+        m_freeSlots.prepend(slot);
+    m_slotCount = slotCount;
+    *reinterpret_cast<FileHeader *>(m_data) = {.magic = FILE_MAGIC, .version = FILE_VERSION
+        , .ringCount = static_cast<quint32>(m_layout.size()), .slotCount = static_cast<quint32>(m_slotCount)};
+    return {};
+}
+
+TransferHistoryFile::SlotHeader *TransferHistoryFile::slotHeader(const int slot) const
+{
+    return reinterpret_cast<SlotHeader *>(m_data + sizeof(FileHeader) + (slot * m_slotSize));
+}
+
+int TransferHistoryFile::slotCount() const
+{
+    return m_slotCount;
+}
+
+QByteArray TransferHistoryFile::slotKey(const int slot) const
+{
+    const SlotHeader *slotHeader = this->slotHeader(slot);
+    if (!slotHeader->isUsed)
+        return {};
+    return QByteArray(slotHeader->key, qstrnlen(slotHeader->key, MAX_KEY_SIZE));
+}
+
+nonstd::expected<QList<int>, QString> TransferHistoryFile::allocateSlots(const QList<QByteArray> &keys)
+{
+    if (keys.size() > m_freeSlots.size())
+    {
+        int slotCount = m_slotCount;
+        while ((slotCount - m_slotCount + m_freeSlots.size()) < keys.size())
+            slotCount *= 2;
+        if (const nonstd::expected<void, QString> result = resize(slotCount); !result)
+            return nonstd::make_unexpected(result.error());
+    }
+
+    QList<int> allocatedSlots;
+    allocatedSlots.reserve(keys.size());
+    for (const QByteArray &key : keys)
+    {
+        Q_ASSERT(!key.isEmpty() && (key.size() <= MAX_KEY_SIZE));
+
+        const int slot = m_freeSlots.takeLast();
+        SlotHeader *slotHeader = this->slotHeader(slot);
+        *slotHeader = {};
+        std::memcpy(slotHeader->key, key.constData(), std::min<qsizetype>(key.size(), MAX_KEY_SIZE));
+        slotHeader->isUsed = 1;
+        series(slot).reset();
+        allocatedSlots.append(slot);
+    }
+
+    return allocatedSlots;
+}
+
+void TransferHistoryFile::freeSlot(const int slot)
+{
+    *slotHeader(slot) = {};
+    m_freeSlots.insert(std::lower_bound(m_freeSlots.begin(), m_freeSlots.end(), slot, std::greater<int>()), slot);
+}
+
+TransferHistorySeries TransferHistoryFile::series(const int slot) const
+{
+    return {(reinterpret_cast<uchar *>(slotHeader(slot)) + sizeof(SlotHeader)), m_layout, m_ringOffsets};
+}
+
+TransferHistory::TransferHistory(const Path &dirPath, QObject *parent)
+    : QObject(parent)
+    , m_dirPath {dirPath}
+{
+    m_sessionFile = openFile((m_dirPath / Path(u"session.history"_s)), FULL_LAYOUT, true);
+    m_lastSessionUpdate = QDateTime::currentMSecsSinceEpoch();
+
+    const Path torrentsFilePath = m_dirPath / Path(u"torrents.history"_s);
+    nonstd::expected<std::unique_ptr<TransferHistoryFile>, QString> result = TransferHistoryFile::open(torrentsFilePath
+        , TORRENT_LAYOUT, MIN_TORRENT_SLOT_COUNT);
+    if (!result)
+    {
+        LogMsg(tr("Failed to open transfer history. File: \"%1\". Error: \"%2\"").arg(torrentsFilePath.toString(), result.error()), Log::WARNING);
+        return;
+    }
+
+    m_torrentsFile = std::move(result.value());
+    for (int slot = 0; slot < m_torrentsFile->slotCount(); ++slot)
+    {
+        const QByteArray key = m_torrentsFile->slotKey(slot);
+        if (key.isEmpty())
+            continue;
+
+        if (const auto id = TorrentID::fromString(QString::fromLatin1(key)); id.isValid())
+            m_torrentSlots.insert(id, slot);
+        else
+            m_torrentsFile->freeSlot(slot);
+    }
+}
+
+TransferHistory::~TransferHistory()
+{
+    qDeleteAll(m_categoryFiles);
+}
+
+std::unique_ptr<TransferHistoryFile> TransferHistory::openFile(const Path &path
+    , const QList<TransferHistorySeries::RingLayout> &layout, const bool create) const
+{
+    if (!create && !path.exists())
+        return nullptr;
+
+    if (!Utils::Fs::mkpath(path.parentPath()))
+    {
+        LogMsg(tr("Failed to create transfer history folder. Path: \"%1\"").arg(path.parentPath().toString()), Log::WARNING);
+        return nullptr;
+    }
+
+    nonstd::expected<std::unique_ptr<TransferHistoryFile>, QString> result = TransferHistoryFile::open(path, layout);
+    if (result && (*result)->slotKey(0).isEmpty())
+    {
+        // the file keeps a single series
+        if (const auto allocatedSlots = (*result)->allocateSlots({QByteArrayLiteral("series")}); !allocatedSlots)
+            result = nonstd::make_unexpected(allocatedSlots.error());
+    }
+    if (!result)
+    {
+        LogMsg(tr("Failed to open transfer history. File: \"%1\". Error: \"%2\"").arg(path.toString(), result.error()), Log::WARNING);
+        return nullptr;
+    }
+
+    return std::move(result.value());
+}
+
+Path TransferHistory::categorySeriesPath(const QString &category) const
+{
+    // category names may contain any characters including path separators
+    const QByteArray encodedName = category.toUtf8().toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+    return m_dirPath / Path(u"categories/"_s + QString::fromLatin1(encodedName) + u".history"_s);
+}
+
+TransferHistorySeries TransferHistory::torrentSeries(const TorrentID &id, const bool create)
+{
+    if (!m_torrentsFile)
+        return {};
+
+    if (const auto iter = m_torrentSlots.constFind(id); iter != m_torrentSlots.cend())
+        return m_torrentsFile->series(iter.value());
+
+    if (!create)
+        return {};
+
+    addTorrents({id});
+    const auto iter = m_torrentSlots.constFind(id);
+    return (iter != m_torrentSlots.cend()) ? m_torrentsFile->series(iter.value()) : TransferHistorySeries();
+}
+
+TransferHistorySeries TransferHistory::categorySeries(const QString &category, const bool create)
+{
+    TransferHistoryFile *file = m_categoryFiles.value(category);
+    if (!file)
+    {
+        std::unique_ptr<TransferHistoryFile> newFile = openFile(categorySeriesPath(category), FULL_LAYOUT, create);
+        if (!newFile)
+            return {};
+
+        file = newFile.release();
+        m_categoryFiles.insert(category, file);
+    }
+
+    return file->series(0);
+}
+
+void TransferHistory::addSessionTransfer(const quint64 downloaded, const quint64 uploaded)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 start = std::max(m_lastSessionUpdate, (now - MAX_SESSION_SPREAD_MSECS));
+    m_lastSessionUpdate = now;
+
+    if (m_sessionFile)
+        m_sessionFile->series(0).add(start, now, downloaded, uploaded);
+}
+
+void TransferHistory::addTorrents(const QList<TorrentID> &ids)
+{
+    if (!m_torrentsFile)
+        return;
+
+    QList<TorrentID> newIDs;
+    QList<QByteArray> keys;
+    for (const TorrentID &id : ids)
+    {
+        if (m_torrentSlots.contains(id))
+            continue;
+
+        newIDs.append(id);
+        keys.append(torrentKey(id));
+    }
+
+    if (newIDs.isEmpty())
+        return;
+
+    const nonstd::expected<QList<int>, QString> allocatedSlots = m_torrentsFile->allocateSlots(keys);
+    if (!allocatedSlots)
+    {
+        LogMsg(tr("Failed to grow transfer history. Error: \"%1\"").arg(allocatedSlots.error()), Log::WARNING);
+        return;
+    }
+
+    for (qsizetype i = 0; i < newIDs.size(); ++i)
+        m_torrentSlots.insert(newIDs[i], allocatedSlots->at(i));
+}
+
+void TransferHistory::updateTorrentTransfer(const TorrentID &id, const QString &category, const qint64 allTimeDownload, const qint64 allTimeUpload)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    const auto iter = m_torrentCounters.find(id);
+    if (iter == m_torrentCounters.end())
+    {
+        // counters are only known from this point, nothing is recorded yet
+        m_torrentCounters.insert(id, {.download = allTimeDownload, .upload = allTimeUpload, .timestamp = now});
+        return;
+    }
+
+    const auto downloaded = static_cast<quint64>(std::max<qint64>((allTimeDownload - iter->download), 0));
+    const auto uploaded = static_cast<quint64>(std::max<qint64>((allTimeUpload - iter->upload), 0));
+    const qint64 start = std::max(iter->timestamp, (now - MAX_TORRENT_SPREAD_MSECS));
+    *iter = {.download = allTimeDownload, .upload = allTimeUpload, .timestamp = now};
+
+    if ((downloaded == 0) && (uploaded == 0))
+        return;
+
+    if (TransferHistorySeries series = torrentSeries(id, true); !series.isNull())
+        series.add(start, now, downloaded, uploaded);
+    if (!category.isEmpty())
+    {
+        if (TransferHistorySeries series = categorySeries(category, true); !series.isNull())
+            series.add(start, now, downloaded, uploaded);
+    }
+}
+
+void TransferHistory::removeTorrent(const TorrentID &id)
+{
+    m_torrentCounters.remove(id);
+    if (const auto iter = m_torrentSlots.constFind(id); iter != m_torrentSlots.cend())
+    {
+        m_torrentsFile->freeSlot(iter.value());
+        m_torrentSlots.erase(iter);
+    }
+}
+
+void TransferHistory::removeCategory(const QString &category)
+{
+    delete m_categoryFiles.take(category);
+    Utils::Fs::removeFile(categorySeriesPath(category));
+}
+
+TransferHistoryRange TransferHistory::sessionHistory(const int resolution, const qint64 from, const qint64 to) const
+{
+    if (!m_sessionFile)
+        return {};
+    return m_sessionFile->series(0).samples(resolution, from, to);
+}
+
+TransferHistoryRange TransferHistory::torrentHistory(const TorrentID &id, const int resolution, const qint64 from, const qint64 to)
+{
+    const TransferHistorySeries series = torrentSeries(id, false);
+    if (series.isNull())
+        return {};
+    return series.samples(resolution, from, to);
+}
+
+TransferHistoryRange TransferHistory::categoryHistory(const QString &category, const int resolution, const qint64 from, const qint64 to)
+{
+    const TransferHistorySeries series = categorySeries(category, false);
+    if (series.isNull())
+        return {};
+    return series.samples(resolution, from, to);
+}
@@ -0,0 +1,188 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <QtTypes>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include "base/3rdparty/expected.hpp"
+#include "base/path.h"
+#include "infohash.h"
+
+namespace BitTorrent
+{
+    struct TransferHistorySample
+    {
+        quint64 downloaded = 0;
+        quint64 uploaded = 0;
+    };
+
+    struct TransferHistoryRange
+    {
+        int resolution = 0; // seconds per sample
+        qint64 start = 0; // time of the first sample in seconds since epoch
+        QList<TransferHistorySample> samples;
+    };
+
+    // Bytes transferred over time, kept in fixed-size ring buffers of several resolutions.
+    // It refers to a slot of TransferHistoryFile and is invalidated when the file is grown.
+    class TransferHistorySeries
+    {
+    public:
+        struct RingLayout
+        {
+            int resolution = 0; // in seconds
+            int capacity = 0;
+        };
+
+        TransferHistorySeries() = default;
+
+        bool isNull() const;
+
+        // Spreads transferred bytes evenly over [startMSecs, endMSecs)
+        void add(qint64 startMSecs, qint64 endMSecs, quint64 downloaded, quint64 uploaded);
+        // Samples of ring with `resolution` covering [from, to] in seconds since epoch
+        TransferHistoryRange samples(int resolution, qint64 from, qint64 to) const;
+
+    private:
+        friend class TransferHistoryFile;
+
+        struct RingHeader;
+
+        TransferHistorySeries(uchar *data, const QList<RingLayout> &layout, const QList<qsizetype> &ringOffsets);
+
+        bool isValid() const;
+        void reset();
+        RingHeader *ringHeader(qsizetype index) const;
+        TransferHistorySample *ringSamples(qsizetype index) const;
+        TransferHistorySample *bucketSample(qsizetype ringIndex, qint64 bucket);
+
+        uchar *m_data = nullptr;
+        QList<RingLayout> m_layout;
+        QList<qsizetype> m_ringOffsets;
+    };
+
+    // Memory mapped file keeping a table of series having the same layout.
+    // Each slot is either free or bound to a key (e.g. torrent ID),
+    // so lots of series share a single file and a single mapping.
+    class TransferHistoryFile
+    {
+        Q_DISABLE_COPY_MOVE(TransferHistoryFile)
+
+    public:
+        static const qsizetype MAX_KEY_SIZE = 40;
+
+        static nonstd::expected<std::unique_ptr<TransferHistoryFile>, QString> open(const Path &path
+                , const QList<TransferHistorySeries::RingLayout> &layout, int minSlotCount = 1);
+
+        ~TransferHistoryFile();
+
+        int slotCount() const;
+        // Returns empty key if the slot is free
+        QByteArray slotKey(int slot) const;
+        // Binds free slots to the keys and clears their series. The file is grown at once if there are not enough free slots.
+        nonstd::expected<QList<int>, QString> allocateSlots(const QList<QByteArray> &keys);
+        void freeSlot(int slot);
+        TransferHistorySeries series(int slot) const;
+
+    private:
+        struct SlotHeader;
+
+        TransferHistoryFile(const Path &path, const QList<TransferHistorySeries::RingLayout> &layout);
+
+        nonstd::expected<void, QString> mapFile(int minSlotCount);
+        nonstd::expected<void, QString> resize(int slotCount);
+        SlotHeader *slotHeader(int slot) const;
+
+        QFile m_file;
+        uchar *m_data = nullptr;
+        int m_slotCount = 0;
+        QList<int> m_freeSlots; // in descending order, so the lowest one is taken first
+        QList<TransferHistorySeries::RingLayout> m_layout;
+        QList<qsizetype> m_ringOffsets;
+        qsizetype m_slotSize = 0;
+    };
+
+    class TransferHistory final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY_MOVE(TransferHistory)
+
+    public:
+        enum Resolution
+        {
+            SECOND = 1,
+            MINUTE = 60,
+            HOUR = 3600
+        };
+
+        explicit TransferHistory(const Path &dirPath, QObject *parent = nullptr);
+        ~TransferHistory() override;
+
+        void addSessionTransfer(quint64 downloaded, quint64 uploaded);
+        // Reserves series of the torrents beforehand, so the file doesn't need to be grown on their updates
+        void addTorrents(const QList<TorrentID> &ids);
+        // Takes all-time counters of the torrent and records their increase since previous call
+        void updateTorrentTransfer(const TorrentID &id, const QString &category, qint64 allTimeDownload, qint64 allTimeUpload);
+        void removeTorrent(const TorrentID &id);
+        void removeCategory(const QString &category);
+
+        TransferHistoryRange sessionHistory(int resolution, qint64 from, qint64 to) const;
+        TransferHistoryRange torrentHistory(const TorrentID &id, int resolution, qint64 from, qint64 to);
+        TransferHistoryRange categoryHistory(const QString &category, int resolution, qint64 from, qint64 to);
+
+    private:
+        struct TorrentCounters
+        {
+            qint64 download = 0;
+            qint64 upload = 0;
+            qint64 timestamp = 0;
+        };
+
+        std::unique_ptr<TransferHistoryFile> openFile(const Path &path, const QList<TransferHistorySeries::RingLayout> &layout, bool create) const;
+        TransferHistorySeries torrentSeries(const TorrentID &id, bool create);
+        TransferHistorySeries categorySeries(const QString &category, bool create);
+        Path categorySeriesPath(const QString &category) const;
+
+        Path m_dirPath;
+        std::unique_ptr<TransferHistoryFile> m_sessionFile;
+        qint64 m_lastSessionUpdate = 0;
+        QHash<TorrentID, TorrentCounters> m_torrentCounters;
+        std::unique_ptr<TransferHistoryFile> m_torrentsFile;
+        QHash<TorrentID, int> m_torrentSlots;
+        QHash<QString, TransferHistoryFile *> m_categoryFiles;
+    };
+}
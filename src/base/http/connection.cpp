@@ -32,19 +32,25 @@
 
 #include <QTcpSocket>
 
+#include "base/utils/gzip.h"
 #include "constants.h"
 #include "environment.h"
-#include "irequesthandler.h"
 #include "requestparser.h"
 #include "response.h"
 #include "responsegenerator.h"
 
 using namespace Http;
 
-Connection::Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObject *parent)
+namespace
+{
+    // keep the socket buffer filled up to this size while streaming the content,
+    // so the memory used by a single response stays bounded no matter how large it is
+    const qint64 CONTENT_STREAM_BUFFER_SIZE = 256 * 1024;
+}
+
+Connection::Connection(QTcpSocket *socket, QObject *parent)
     : QObject(parent)
     , m_socket(socket)
-    , m_requestHandler(requestHandler)
 {
     m_socket->setParent(this);
     connect(m_socket, &QAbstractSocket::disconnected, this, &Connection::closed);
@@ -63,9 +69,14 @@ Connection::Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObj
     connect(m_socket, &QIODevice::bytesWritten, this, [this]()
     {
         m_idleTimer.start();
+
+        if (m_contentStream)
+            requestContent();
     });
 }
 
+Connection::~Connection() = default;
+
 void Connection::read()
 {
     // reuse existing buffer and avoid unnecessary memory allocation/relocation
@@ -81,7 +92,13 @@ void Connection::read()
     if (bytesRead < bytesAvailable) [[unlikely]]
         m_receivedData.chop(bytesAvailable - bytesRead);
 
-    while (!m_receivedData.isEmpty())
+    processReceivedData();
+}
+
+void Connection::processReceivedData()
+{
+    // responses must be sent in the order of requests so wait until the current one is completely written
+    while (!m_isWaitingForResponse && !m_contentStream && !m_receivedData.isEmpty())
     {
         const RequestParser::ParseResult result = RequestParser::parse(m_receivedData);
 
@@ -98,7 +115,7 @@ void Connection::read()
                     const Response resp {
                             .status = {.code = 413, .text = u"Payload Too Large"_s},
                             .headers = {{HEADER_CONNECTION, u"close"_s}}};
-                    sendResponse(resp);
+                    writeResponse(resp);
                     m_socket->close();
                 }
             }
@@ -112,7 +129,7 @@ void Connection::read()
                 const Response resp {
                         .status = {.code = 501, .text = u"Not Implemented"_s},
                         .headers = {{HEADER_CONNECTION, u"close"_s}}};
-                sendResponse(resp);
+                writeResponse(resp);
                 m_socket->close();
             }
             return;
@@ -125,7 +142,7 @@ void Connection::read()
                 const Response resp {
                         .status = {.code = 400, .text = u"Bad Request"_s},
                         .headers = {{HEADER_CONNECTION, u"close"_s}}};
-                sendResponse(resp);
+                writeResponse(resp);
                 m_socket->close();
             }
             return;
@@ -134,35 +151,20 @@ void Connection::read()
             {
                 const Environment env {m_socket->localAddress(), m_socket->localPort(), m_socket->peerAddress(), m_socket->peerPort()};
 
-                if (result.request.method == HEADER_REQUEST_METHOD_HEAD)
-                {
-                    Request getRequest = result.request;
-                    getRequest.method = HEADER_REQUEST_METHOD_GET;
-
-                    Response resp = m_requestHandler->processRequest(getRequest, env);
-
-                    resp.headers[HEADER_CONNECTION] = u"keep-alive"_s;
-                    resp.headers[HEADER_CONTENT_LENGTH] = QString::number(resp.content.length());
-                    resp.content.clear();
-
-                    sendResponse(resp);
-                }
-                else
-                {
-                    Response resp = m_requestHandler->processRequest(result.request, env);
-
-                    if (acceptsGzipEncoding(result.request.headers.value(u"accept-encoding"_s)))
-                        resp.headers[HEADER_CONTENT_ENCODING] = u"gzip"_s;
-                    resp.headers[HEADER_CONNECTION] = u"keep-alive"_s;
-
-                    sendResponse(resp);
-                }
+                Request request = result.request;
+                m_isHeadRequest = (request.method == HEADER_REQUEST_METHOD_HEAD);
+                if (m_isHeadRequest)
+                    request.method = HEADER_REQUEST_METHOD_GET;
+                m_acceptsGzipEncoding = acceptsGzipEncoding(request.headers.value(u"accept-encoding"_s));
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
                 m_receivedData.slice(result.frameSize);
 #else
                 m_receivedData.remove(0, result.frameSize);
 #endif
+
+                m_isWaitingForResponse = true;
+                emit requestReceived(request, env);
             }
             break;
 
@@ -173,57 +175,115 @@ void Connection::read()
     }
 }
 
-void Connection::sendResponse(const Response &response) const
+void Connection::sendResponse(Response response)
 {
-    m_socket->write(toByteArray(response));
-}
+    Q_ASSERT(m_isWaitingForResponse);
+    m_isWaitingForResponse = false;
 
-bool Connection::hasExpired(const qint64 timeout) const
-{
-    return (m_socket->bytesAvailable() == 0)
-        && (m_socket->bytesToWrite() == 0)
-        && m_idleTimer.hasExpired(timeout);
+    response.headers[HEADER_CONNECTION] = u"keep-alive"_s;
+    if (m_isHeadRequest)
+    {
+        if (response.contentStream)
+        {
+            // the length of streamed content is unknown beforehand
+            response.headers[HEADER_TRANSFER_ENCODING] = u"chunked"_s;
+            response.contentStream.reset();
+        }
+        else
+        {
+            response.headers[HEADER_CONTENT_LENGTH] = QString::number(response.content.length());
+        }
+        response.content.clear();
+    }
+    else if (m_acceptsGzipEncoding && !response.headers.contains(HEADER_CONTENT_ENCODING))
+    {
+        // content that is already encoded by request handler is sent as is
+        if (response.contentStream)
+        {
+            // each chunk is flushed by the compressor, so streamed events aren't held back until more data arrives
+            auto compressor = std::make_unique<Utils::Gzip::StreamCompressor>();
+            if (compressor->isValid())
+            {
+                m_contentCompressor = std::move(compressor);
+                response.headers[HEADER_CONTENT_ENCODING] = u"gzip"_s;
+            }
+        }
+        else
+        {
+            compressContent(response);
+        }
+    }
+
+    writeResponse(response);
+
+    // process the requests that were received in the meantime
+    processReceivedData();
 }
 
-bool Connection::acceptsGzipEncoding(QString codings)
+void Connection::sendContent(const QByteArray &data, const bool atEnd)
 {
-    // [rfc7231] 5.3.4. Accept-Encoding
+    m_isWaitingForContent = false;
+    if (!m_contentStream)
+        return;
 
-    const auto isCodingAvailable = [](const QList<QStringView> &list, const QStringView encoding) -> bool
+    QByteArray chunkData = data;
+    if (m_contentCompressor)
     {
-        for (const QStringView &str : list)
+        chunkData = m_contentCompressor->compress(chunkData);
+        if (atEnd)
+        {
+            chunkData += m_contentCompressor->finish();
+        }
+        else if (!m_contentCompressor->isValid()) [[unlikely]]
         {
-            if (!str.startsWith(encoding))
-                continue;
+            // the response can't be completed anymore
+            m_contentStream.reset();
+            m_contentCompressor.reset();
+            m_socket->abort();
+            return;
+        }
+    }
 
-            // without quality values
-            if (str == encoding)
-                return true;
+    if (!chunkData.isEmpty())
+        m_socket->write(toChunk(chunkData));
 
-            // [rfc7231] 5.3.1. Quality Values
-            const QStringView substr = str.mid(encoding.size() + 3);  // ex. skip over "gzip;q="
+    if (atEnd)
+    {
+        m_socket->write(toChunk({}));
+        m_contentStream.reset();
+        m_contentCompressor.reset();
 
-            bool ok = false;
-            const double qvalue = substr.toDouble(&ok);
-            if (!ok || (qvalue <= 0))
-                return false;
+        // process the requests that were received while streaming the content
+        processReceivedData();
+        return;
+    }
 
-            return true;
-        }
-        return false;
-    };
+    requestContent();
+}
 
-    const QList<QStringView> list = QStringView(codings.remove(u' ').remove(u'\t')).split(u',', Qt::SkipEmptyParts);
-    if (list.isEmpty())
-        return false;
+void Connection::writeResponse(const Response &response)
+{
+    m_contentStream = response.contentStream;
+    m_socket->write(toByteArray(response));
+    if (m_contentStream)
+        requestContent();
+}
 
-    const bool canGzip = isCodingAvailable(list, u"gzip"_s);
-    if (canGzip)
-        return true;
+void Connection::requestContent()
+{
+    // generate the content only as fast as the peer is able to receive it
+    if (!m_contentStream || m_isWaitingForContent || (m_socket->bytesToWrite() >= CONTENT_STREAM_BUFFER_SIZE))
+        return;
 
-    const bool canAny = isCodingAvailable(list, u"*"_s);
-    if (canAny)
-        return true;
+    m_isWaitingForContent = true;
+    emit contentRequested(m_contentStream);
+}
 
-    return false;
+bool Connection::hasExpired(const qint64 timeout) const
+{
+    return (m_socket->bytesAvailable() == 0)
+        && (m_socket->bytesToWrite() == 0)
+        && !m_isWaitingForResponse
+        && !m_contentStream
+        && m_idleTimer.hasExpired(timeout);
 }
@@ -30,14 +30,23 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QElapsedTimer>
 #include <QObject>
 
 class QTcpSocket;
 
+namespace Utils::Gzip
+{
+    class StreamCompressor;
+}
+
 namespace Http
 {
-    class IRequestHandler;
+    class IContentStream;
+    struct Environment;
+    struct Request;
     struct Response;
 
     class Connection : public QObject
@@ -46,21 +55,38 @@ namespace Http
         Q_DISABLE_COPY_MOVE(Connection)
 
     public:
-        Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObject *parent = nullptr);
+        explicit Connection(QTcpSocket *socket, QObject *parent = nullptr);
+        ~Connection() override;
 
         bool hasExpired(qint64 timeout) const;
 
+        // Sends the response to the request received last
+        void sendResponse(Response response);
+        // Sends the piece of streamed content that was requested last
+        void sendContent(const QByteArray &data, bool atEnd);
+
     signals:
         void closed();
+        // The request should be answered with `sendResponse()`,
+        // no other requests are received until then
+        void requestReceived(const Request &request, const Environment &env);
+        // The content should be read from the stream and passed to `sendContent()`
+        void contentRequested(const std::shared_ptr<IContentStream> &contentStream);
 
     private:
-        static bool acceptsGzipEncoding(QString codings);
         void read();
-        void sendResponse(const Response &response) const;
+        void processReceivedData();
+        void writeResponse(const Response &response);
+        void requestContent();
 
         QTcpSocket *m_socket = nullptr;
-        IRequestHandler *m_requestHandler = nullptr;
         QByteArray m_receivedData;
         QElapsedTimer m_idleTimer;
+        bool m_isWaitingForResponse = false;
+        bool m_isHeadRequest = false;
+        bool m_acceptsGzipEncoding = false;
+        std::shared_ptr<IContentStream> m_contentStream;
+        std::unique_ptr<Utils::Gzip::StreamCompressor> m_contentCompressor;
+        bool m_isWaitingForContent = false;
     };
 }
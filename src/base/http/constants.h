@@ -38,6 +38,7 @@ namespace Http
     inline const QString METHOD_GET = u"GET"_s;
     inline const QString METHOD_POST = u"POST"_s;
 
+    inline const QString HEADER_ACCEPT = u"accept"_s;
     inline const QString HEADER_AUTHORIZATION = u"authorization"_s;
     inline const QString HEADER_CACHE_CONTROL = u"cache-control"_s;
     inline const QString HEADER_CONNECTION = u"connection"_s;
@@ -49,11 +50,15 @@ namespace Http
     inline const QString HEADER_COOKIE = u"cookie"_s;
     inline const QString HEADER_CROSS_ORIGIN_OPENER_POLICY  = u"cross-origin-opener-policy"_s;
     inline const QString HEADER_DATE = u"date"_s;
+    inline const QString HEADER_ETAG = u"etag"_s;
     inline const QString HEADER_HOST = u"host"_s;
+    inline const QString HEADER_IF_NONE_MATCH = u"if-none-match"_s;
     inline const QString HEADER_ORIGIN = u"origin"_s;
     inline const QString HEADER_REFERER = u"referer"_s;
     inline const QString HEADER_REFERRER_POLICY = u"referrer-policy"_s;
     inline const QString HEADER_SET_COOKIE = u"set-cookie"_s;
+    inline const QString HEADER_TRANSFER_ENCODING = u"transfer-encoding"_s;
+    inline const QString HEADER_VARY = u"vary"_s;
     inline const QString HEADER_X_CONTENT_TYPE_OPTIONS = u"x-content-type-options"_s;
     inline const QString HEADER_X_FORWARDED_FOR = u"x-forwarded-for"_s;
     inline const QString HEADER_X_FORWARDED_HOST = u"x-forwarded-host"_s;
@@ -71,6 +76,8 @@ namespace Http
     inline const QString CONTENT_TYPE_JPEG = u"image/jpeg"_s;
     inline const QString CONTENT_TYPE_JS = u"text/javascript"_s;
     inline const QString CONTENT_TYPE_JSON = u"application/json"_s;
+    inline const QString CONTENT_TYPE_CBOR = u"application/cbor"_s;
+    inline const QString CONTENT_TYPE_EVENT_STREAM = u"text/event-stream"_s;
     inline const QString CONTENT_TYPE_GIF = u"image/gif"_s;
     inline const QString CONTENT_TYPE_PNG = u"image/png"_s;
     inline const QString CONTENT_TYPE_WEBP = u"image/webp"_s;
@@ -35,7 +35,6 @@
 #include <optional>
 #include <utility>
 
-#include <QByteArrayList>
 #include <QByteArrayView>
 #include <QDebug>
 #include <QUrl>
@@ -114,7 +113,7 @@ RequestParser::ParseResult RequestParser::doParse(const QByteArrayView data)
 
     // handle supported methods
     if ((m_request.method == HEADER_REQUEST_METHOD_GET) || (m_request.method == HEADER_REQUEST_METHOD_HEAD))
-        return {ParseStatus::OK, m_request, headerLength};
+        return {ParseStatus::OK, std::move(m_request), headerLength};
 
     if (m_request.method == HEADER_REQUEST_METHOD_POST)
     {
@@ -156,41 +155,37 @@ RequestParser::ParseResult RequestParser::doParse(const QByteArrayView data)
             }
         }
 
-        return {ParseStatus::OK, m_request, (headerLength + contentLength)};
+        return {ParseStatus::OK, std::move(m_request), (headerLength + contentLength)};
     }
 
-    return {ParseStatus::BadMethod, m_request, 0};
+    return {ParseStatus::BadMethod, std::move(m_request), 0};
 }
 
 bool RequestParser::parseStartLines(const QByteArrayView data)
 {
     // we don't handle malformed request which uses `LF` for newline
     const QList<QByteArrayView> lines = splitToViews(data, CRLF, Qt::SkipEmptyParts);
+    if (lines.isEmpty())
+        return false;
+
+    if (!parseRequestLine(lines[0]))
+        return false;
 
     // [rfc7230] 3.2.2. Field Order
-    QByteArrayList requestLines;
-    for (const auto &line : lines)
+    // Lines are parsed in place, only the obsolete folded header lines have to be joined
+    QByteArray foldedLine;
+    for (qsizetype i = 1; i < lines.size(); ++i)
     {
-        if (QChar::fromLatin1(line.at(0)).isSpace() && !requestLines.isEmpty())
+        QByteArrayView line = lines[i];
+        if (((i + 1) < lines.size()) && QChar::fromLatin1(lines[i + 1].at(0)).isSpace())
         {
-            // continuation of previous line
-            requestLines.last() += line;
+            foldedLine = line.toByteArray();
+            while (((i + 1) < lines.size()) && QChar::fromLatin1(lines[i + 1].at(0)).isSpace())
+                foldedLine += lines[++i];
+            line = foldedLine;
         }
-        else
-        {
-            requestLines += line.toByteArray();
-        }
-    }
 
-    if (requestLines.isEmpty())
-        return false;
-
-    if (!parseRequestLine(requestLines[0]))
-        return false;
-
-    for (auto i = ++(requestLines.begin()); i != requestLines.end(); ++i)
-    {
-        const std::optional<QStringPair> header = parseHeaderLine(*i);
+        const std::optional<QStringPair> header = parseHeaderLine(line);
         if (!header.has_value())
             return false;
 
@@ -244,6 +239,7 @@ bool RequestParser::parseRequestLine(const QByteArrayView line)
             const QByteArrayView valueComponent = param.sliced(eqCharPos + 1);
             const QString paramName = QString::fromUtf8(
                 QByteArray::fromPercentEncoding(asQByteArray(nameComponent)).replace('+', ' '));
+            // Values are kept undecoded since they may contain binary data (e.g. "info_hash" of tracker requests)
             const QByteArray paramValue = QByteArray::fromPercentEncoding(asQByteArray(valueComponent)).replace('+', ' ');
 
             m_request.query[paramName] = paramValue;
@@ -29,6 +29,9 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+
 #include <QByteArray>
 #include <QString>
 
@@ -36,6 +39,21 @@
 
 namespace Http
 {
+    // Produces message body piece by piece so that a large body doesn't need to be held in memory at once
+    class IContentStream
+    {
+    public:
+        virtual ~IContentStream() = default;
+
+        virtual bool atEnd() const = 0;
+        virtual QByteArray read() = 0;
+
+        // Stream that produces content over time (e.g. event stream) can have nothing to read for a while.
+        // Then it is read again only after it invokes the handler.
+        virtual bool isReadyRead() const { return true; }
+        virtual void setReadyReadHandler([[maybe_unused]] std::function<void ()> handler) {}
+    };
+
     struct ResponseStatus
     {
         int code = 0;
@@ -47,5 +65,7 @@ namespace Http
         ResponseStatus status {};
         HeaderMap headers {};
         QByteArray content {};
+        // if set, it is used instead of `content` and the body is sent using chunked transfer encoding
+        std::shared_ptr<IContentStream> contentStream {};
     };
 }
@@ -37,11 +37,23 @@
 
 QByteArray Http::toByteArray(Response response)
 {
-    compressContent(response);
-
     response.headers[HEADER_DATE] = httpDate();
-    if (QString &value = response.headers[HEADER_CONTENT_LENGTH]; value.isEmpty())
-        value = QString::number(response.content.length());
+    if (response.contentStream)
+    {
+        // the body is sent afterwards in chunks, compression is applied to it on the fly
+        response.headers.remove(HEADER_CONTENT_LENGTH);
+        response.headers[HEADER_TRANSFER_ENCODING] = u"chunked"_s;
+        response.content.clear();
+    }
+    else
+    {
+        // response to HEAD request for streamed content has no length
+        if (!response.headers.contains(HEADER_TRANSFER_ENCODING))
+        {
+            if (QString &value = response.headers[HEADER_CONTENT_LENGTH]; value.isEmpty())
+                value = QString::number(response.content.length());
+        }
+    }
 
     QByteArray buf;
     buf.reserve(1024 + response.content.length());
@@ -71,6 +83,20 @@ QByteArray Http::toByteArray(Response response)
     return buf;
 }
 
+QByteArray Http::toChunk(const QByteArray &data)
+{
+    // [RFC 7230] 4.1. Chunked Transfer Coding
+    // zero sized chunk is the last one
+
+    QByteArray buf;
+    buf.reserve(16 + data.size());
+    buf.append(QByteArray::number(data.size(), 16))
+        .append(CRLF)
+        .append(data)
+        .append(CRLF);
+    return buf;
+}
+
 QString Http::httpDate()
 {
     // [RFC 7231] 7.1.1.1. Date/Time Formats
@@ -82,11 +108,6 @@ QString Http::httpDate()
 
 void Http::compressContent(Response &response)
 {
-    if (response.headers.value(HEADER_CONTENT_ENCODING) != u"gzip")
-        return;
-
-    response.headers.remove(HEADER_CONTENT_ENCODING);
-
     // for very small files, compressing them only wastes cpu cycles
     const qsizetype contentSize = response.content.size();
     if (contentSize <= 1024)  // 1 kb
@@ -111,3 +132,72 @@ void Http::compressContent(Response &response)
     response.content = compressedData;
     response.headers[HEADER_CONTENT_ENCODING] = u"gzip"_s;
 }
+
+bool Http::acceptsGzipEncoding(QString codings)
+{
+    // [rfc7231] 5.3.4. Accept-Encoding
+
+    const auto isCodingAvailable = [](const QList<QStringView> &list, const QStringView encoding) -> bool
+    {
+        for (const QStringView &str : list)
+        {
+            if (!str.startsWith(encoding))
+                continue;
+
+            // without quality values
+            if (str == encoding)
+                return true;
+
+            // [rfc7231] 5.3.1. Quality Values
+            const QStringView substr = str.mid(encoding.size() + 3);  // ex. skip over "gzip;q="
+
+            bool ok = false;
+            const double qvalue = substr.toDouble(&ok);
+            if (!ok || (qvalue <= 0))
+                return false;
+
+            return true;
+        }
+        return false;
+    };
+
+    const QList<QStringView> list = QStringView(codings.remove(u' ').remove(u'\t')).split(u',', Qt::SkipEmptyParts);
+    if (list.isEmpty())
+        return false;
+
+    const bool canGzip = isCodingAvailable(list, u"gzip"_s);
+    if (canGzip)
+        return true;
+
+    const bool canAny = isCodingAvailable(list, u"*"_s);
+    if (canAny)
+        return true;
+
+    return false;
+}
+
+bool Http::acceptsMediaType(QString mediaTypes, const QStringView mediaType)
+{
+    // [rfc7231] 5.3.2. Accept
+
+    const QList<QStringView> list = QStringView(mediaTypes.remove(u' ').remove(u'\t')).split(u',', Qt::SkipEmptyParts);
+    for (const QStringView &str : list)
+    {
+        const QList<QStringView> params = str.split(u';');
+        if (params.first().compare(mediaType, Qt::CaseInsensitive) != 0)
+            continue;
+
+        for (const QStringView &param : params.sliced(1))
+        {
+            if (!param.startsWith(u"q="))
+                continue;
+
+            // [rfc7231] 5.3.1. Quality Values
+            bool ok = false;
+            const double qvalue = param.sliced(2).toDouble(&ok);
+            return (ok && (qvalue > 0));
+        }
+        return true;
+    }
+    return false;
+}
@@ -32,12 +32,18 @@
 
 class QByteArray;
 class QString;
+class QStringView;
 
 namespace Http
 {
     struct Response;
 
     QByteArray toByteArray(Response response);
+    QByteArray toChunk(const QByteArray &data);
     QString httpDate();
+    // Compresses content using gzip unless it isn't worth it
     void compressContent(Response &response);
+    bool acceptsGzipEncoding(QString codings);
+    // Returns true only if `mediaType` is listed explicitly, wildcards are not taken into account
+    bool acceptsMediaType(QString mediaTypes, QStringView mediaType);
 }
@@ -34,20 +34,28 @@
 #include <chrono>
 #include <memory>
 #include <new>
+#include <optional>
 
 #include <QtLogging>
+#include <QHash>
+#include <QMetaObject>
 #include <QNetworkProxy>
 #include <QSslCertificate>
 #include <QSslCipher>
 #include <QSslKey>
 #include <QSslSocket>
 #include <QStringList>
+#include <QThread>
 #include <QTimer>
 
 #include "base/global.h"
 #include "base/utils/net.h"
 #include "base/utils/sslkey.h"
 #include "connection.h"
+#include "environment.h"
+#include "irequesthandler.h"
+#include "request.h"
+#include "response.h"
 
 using namespace std::chrono_literals;
 
@@ -56,6 +64,7 @@ namespace
     const int KEEP_ALIVE_DURATION = std::chrono::milliseconds(7s).count();
     const int CONNECTIONS_LIMIT = 500;
     const std::chrono::seconds CONNECTIONS_SCAN_INTERVAL {2};
+    const int MAX_IO_THREADS = 4;
 
     QList<QSslCipher> safeCipherList()
     {
@@ -98,72 +107,203 @@ namespace
 
 using namespace Http;
 
-Server::Server(IRequestHandler *requestHandler, QObject *parent)
-    : QTcpServer(parent)
-    , m_requestHandler(requestHandler)
-    , m_sslConfig {QSslConfiguration::defaultConfiguration()}
+// Serves connections in its own thread. Request handler is only called in the thread of the server,
+// so it doesn't need to be thread-safe, while the I/O, TLS, parsing and compression are done here.
+class Server::Worker final : public QObject
 {
-    setProxy(QNetworkProxy::NoProxy);
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(Worker)
 
-    m_sslConfig.setCiphers(safeCipherList());
-    m_sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);
+public:
+    Worker(IRequestHandler *requestHandler, Server *server);
 
-    auto *dropConnectionTimer = new QTimer(this);
-    connect(dropConnectionTimer, &QTimer::timeout, this, &Server::dropTimedOutConnection);
-    dropConnectionTimer->start(CONNECTIONS_SCAN_INTERVAL);
-}
+    void addConnection(qintptr socketDescriptor, const std::optional<QSslConfiguration> &sslConfig);
 
-void Server::incomingConnection(const qintptr socketDescriptor)
+signals:
+    void connectionClosed();
+
+private:
+    void removeConnection(quint64 connectionID);
+    void dropTimedOutConnections();
+    void processRequest(quint64 connectionID, const Request &request, const Environment &env);
+    void readContent(quint64 connectionID, const std::shared_ptr<IContentStream> &contentStream);
+
+    IRequestHandler *m_requestHandler = nullptr;
+    Server *m_server = nullptr;
+    QTimer *m_dropConnectionTimer = nullptr;
+    QHash<quint64, Connection *> m_connections;  // for tracking persistent connections
+    quint64 m_lastConnectionID = 0;
+};
+
+Server::Worker::Worker(IRequestHandler *requestHandler, Server *server)
+    : m_requestHandler {requestHandler}
+    , m_server {server}
+    , m_dropConnectionTimer {new QTimer(this)}
 {
-    std::unique_ptr<QTcpSocket> serverSocket = isHttps() ? std::make_unique<QSslSocket>(this) : std::make_unique<QTcpSocket>(this);
-    if (!serverSocket->setSocketDescriptor(socketDescriptor))
-        return;
+    m_dropConnectionTimer->setInterval(CONNECTIONS_SCAN_INTERVAL);
+    connect(m_dropConnectionTimer, &QTimer::timeout, this, &Worker::dropTimedOutConnections);
+}
 
-    if (m_connections.size() >= CONNECTIONS_LIMIT)
-    {
-        qWarning("Too many connections. Exceeded CONNECTIONS_LIMIT (%d). Connection closed.", CONNECTIONS_LIMIT);
-        return;
-    }
+void Server::Worker::addConnection(const qintptr socketDescriptor, const std::optional<QSslConfiguration> &sslConfig)
+{
+    if (!m_dropConnectionTimer->isActive())
+        m_dropConnectionTimer->start();
 
     try
     {
-        if (isHttps())
+        std::unique_ptr<QTcpSocket> serverSocket = sslConfig ? std::make_unique<QSslSocket>() : std::make_unique<QTcpSocket>();
+        if (!serverSocket->setSocketDescriptor(socketDescriptor))
+        {
+            emit connectionClosed();
+            return;
+        }
+
+        if (sslConfig)
         {
             auto *sslSocket = static_cast<QSslSocket *>(serverSocket.get());
-            sslSocket->setSslConfiguration(m_sslConfig);
+            sslSocket->setSslConfiguration(*sslConfig);
             sslSocket->startServerEncryption();
         }
 
-        auto *connection = new Connection(serverSocket.release(), m_requestHandler, this);
-        m_connections.insert(connection);
-        connect(connection, &Connection::closed, this, [this, connection] { removeConnection(connection); });
+        const quint64 connectionID = ++m_lastConnectionID;
+        auto *connection = new Connection(serverSocket.release(), this);
+        m_connections.insert(connectionID, connection);
+        connect(connection, &Connection::closed, this, [this, connectionID] { removeConnection(connectionID); });
+        connect(connection, &Connection::requestReceived, this, [this, connectionID](const Request &request, const Environment &env)
+        {
+            processRequest(connectionID, request, env);
+        });
+        connect(connection, &Connection::contentRequested, this, [this, connectionID](const std::shared_ptr<IContentStream> &contentStream)
+        {
+            readContent(connectionID, contentStream);
+        });
     }
     catch (const std::bad_alloc &exception)
     {
         // drop the connection instead of throwing exception and crash
         qWarning("Failed to allocate memory for HTTP connection. Connection closed.");
-        return;
+        emit connectionClosed();
     }
 }
 
-void Server::removeConnection(Connection *connection)
+void Server::Worker::removeConnection(const quint64 connectionID)
 {
-    m_connections.remove(connection);
+    Connection *connection = m_connections.take(connectionID);
+    if (!connection)
+        return;
+
     connection->deleteLater();
+    emit connectionClosed();
 }
 
-void Server::dropTimedOutConnection()
+void Server::Worker::dropTimedOutConnections()
 {
-    m_connections.removeIf([](Connection *connection)
+    m_connections.removeIf([this](const QHash<quint64, Connection *>::iterator iter)
     {
+        Connection *connection = iter.value();
         if (!connection->hasExpired(KEEP_ALIVE_DURATION))
             return false;
 
         connection->deleteLater();
+        emit connectionClosed();
         return true;
     });
 }
 
+void Server::Worker::processRequest(const quint64 connectionID, const Request &request, const Environment &env)
+{
+    // The worker is owned by the server so it remains valid as long as the server processes events
+    QMetaObject::invokeMethod(m_server, [this, connectionID, request, env]
+    {
+        const Response response = m_requestHandler->processRequest(request, env);
+        QMetaObject::invokeMethod(this, [this, connectionID, response]
+        {
+            if (Connection *connection = m_connections.value(connectionID))
+                connection->sendResponse(response);
+        });
+    });
+}
+
+void Server::Worker::readContent(const quint64 connectionID, const std::shared_ptr<IContentStream> &contentStream)
+{
+    // Streamed content is generated from the data of request handler so it is read in the thread of the server
+    QMetaObject::invokeMethod(m_server, [this, connectionID, contentStream]
+    {
+        if (!contentStream->isReadyRead())
+        {
+            // the connection keeps waiting for the content until the stream has some
+            contentStream->setReadyReadHandler([this, connectionID, weakContentStream = std::weak_ptr(contentStream)]
+            {
+                if (const std::shared_ptr<IContentStream> stream = weakContentStream.lock())
+                    readContent(connectionID, stream);
+            });
+            return;
+        }
+
+        const QByteArray data = contentStream->read();
+        const bool atEnd = contentStream->atEnd();
+        QMetaObject::invokeMethod(this, [this, connectionID, data, atEnd]
+        {
+            if (Connection *connection = m_connections.value(connectionID))
+                connection->sendContent(data, atEnd);
+        });
+    });
+}
+
+Server::Server(IRequestHandler *requestHandler, QObject *parent)
+    : QTcpServer(parent)
+    , m_sslConfig {QSslConfiguration::defaultConfiguration()}
+{
+    setProxy(QNetworkProxy::NoProxy);
+
+    m_sslConfig.setCiphers(safeCipherList());
+    m_sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);
+
+    const int ioThreadsCount = std::clamp(QThread::idealThreadCount(), 1, MAX_IO_THREADS);
+    for (int i = 0; i < ioThreadsCount; ++i)
+    {
+        auto *ioThread = new QThread;
+        auto *worker = new Worker(requestHandler, this);
+        worker->moveToThread(ioThread);
+        connect(ioThread, &QThread::finished, worker, &QObject::deleteLater);
+        connect(worker, &Worker::connectionClosed, this, [this] { --m_connectionsCount; });
+        ioThread->setObjectName("Http::Server m_ioThread");
+        ioThread->start();
+
+        m_ioThreads.emplace_back(ioThread);
+        m_workers.append(worker);
+    }
+}
+
+Server::~Server()
+{
+    // stop serving connections before the request handler can be destroyed
+    m_ioThreads.clear();
+}
+
+void Server::incomingConnection(const qintptr socketDescriptor)
+{
+    if (m_connectionsCount >= CONNECTIONS_LIMIT)
+    {
+        qWarning("Too many connections. Exceeded CONNECTIONS_LIMIT (%d). Connection closed.", CONNECTIONS_LIMIT);
+        // let the socket take ownership of the descriptor so it gets closed
+        QTcpSocket socket;
+        socket.setSocketDescriptor(socketDescriptor);
+        return;
+    }
+
+    ++m_connectionsCount;
+
+    Worker *worker = m_workers[m_nextWorkerIndex];
+    m_nextWorkerIndex = (m_nextWorkerIndex + 1) % m_workers.size();
+
+    const std::optional<QSslConfiguration> sslConfig = isHttps() ? std::optional(m_sslConfig) : std::nullopt;
+    QMetaObject::invokeMethod(worker, [worker, socketDescriptor, sslConfig]
+    {
+        worker->addConnection(socketDescriptor, sslConfig);
+    });
+}
+
 bool Server::setupHttps(const QByteArray &certificates, const QByteArray &privateKey)
 {
     const QList<QSslCertificate> certs {Utils::Net::loadSSLCertificate(certificates)};
@@ -192,3 +332,5 @@ bool Server::isHttps() const
 {
     return m_https;
 }
+
+#include "server.moc"
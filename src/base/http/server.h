@@ -30,14 +30,17 @@
 
 #pragma once
 
-#include <QSet>
+#include <vector>
+
+#include <QList>
 #include <QSslConfiguration>
 #include <QTcpServer>
 
+#include "base/utils/thread.h"
+
 namespace Http
 {
     class IRequestHandler;
-    class Connection;
 
     class Server final : public QTcpServer
     {
@@ -46,20 +49,22 @@ namespace Http
 
     public:
         explicit Server(IRequestHandler *requestHandler, QObject *parent = nullptr);
+        ~Server() override;
 
         bool setupHttps(const QByteArray &certificates, const QByteArray &privateKey);
         void disableHttps();
         bool isHttps() const;
 
-    private slots:
-        void dropTimedOutConnection();
-
     private:
+        class Worker;
+
         void incomingConnection(qintptr socketDescriptor) override;
-        void removeConnection(Connection *connection);
 
-        IRequestHandler *m_requestHandler = nullptr;
-        QSet<Connection *> m_connections;  // for tracking persistent connections
+        // Connections are served by I/O threads while requests are processed in the thread of the server
+        std::vector<Utils::Thread::UniquePtr> m_ioThreads;
+        QList<Worker *> m_workers;
+        qsizetype m_nextWorkerIndex = 0;
+        int m_connectionsCount = 0;
 
         bool m_https = false;
         QSslConfiguration m_sslConfig;
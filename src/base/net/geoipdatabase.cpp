@@ -28,11 +28,17 @@
 
 #include "geoipdatabase.h"
 
+#include <algorithm>
+#include <limits>
+#include <optional>
+
 #include <QByteArray>
 #include <QDateTime>
 #include <QDebug>
 #include <QFile>
+#include <QHash>
 #include <QHostAddress>
+#include <QtEndian>
 #include <QVariant>
 
 #include "base/global.h"
@@ -44,6 +50,8 @@ namespace
     const quint32 MAX_METADATA_SIZE = 131072; // 128KB
     const QByteArray METADATA_BEGIN_MARK = QByteArrayLiteral("\xab\xcd\xefMaxMind.com");
     const char DATA_SECTION_SEPARATOR[16] = {0};
+    // marks the ranges that are looked up in IPv4 address space
+    const quint16 IPV4_ALIAS_INDEX = std::numeric_limits<quint16>::max();
 
     enum class DataType
     {
@@ -107,7 +115,7 @@ GeoIPDatabase *GeoIPDatabase::load(const Path &filename, QString &error)
     }
 
 
-    if (!db->parseMetadata(db->readMetadata(), error) || !db->loadDB(error))
+    if (!db->parseMetadata(db->readMetadata(), error) || !db->loadDB(error) || !db->compileLookupTable(error))
     {
         delete db;
         return nullptr;
@@ -128,7 +136,7 @@ GeoIPDatabase *GeoIPDatabase::load(const QByteArray &data, QString &error)
 
     memcpy(reinterpret_cast<char *>(db->m_data), data.constData(), db->m_size);
 
-    if (!db->parseMetadata(db->readMetadata(), error) || !db->loadDB(error))
+    if (!db->parseMetadata(db->readMetadata(), error) || !db->loadDB(error) || !db->compileLookupTable(error))
     {
         delete db;
         return nullptr;
@@ -159,50 +167,227 @@ QDateTime GeoIPDatabase::buildEpoch() const
 
 QString GeoIPDatabase::lookup(const QHostAddress &hostAddr) const
 {
-    Q_IPV6ADDR addr = hostAddr.toIPv6Address();
+    bool isIPv4 = false;
+    const quint32 ipv4Addr = hostAddr.toIPv4Address(&isIPv4);
+    if (isIPv4)
+        return lookupIPv4(ipv4Addr);
+
+    const Q_IPV6ADDR addr = hostAddr.toIPv6Address();
+    return lookupIPv6(qFromBigEndian<quint64>(addr.c), qFromBigEndian<quint64>(addr.c + 8));
+}
+
+QStringList GeoIPDatabase::lookup(const QList<QHostAddress> &hostAddrs) const
+{
+    QStringList countries;
+    countries.reserve(hostAddrs.size());
+    for (const QHostAddress &hostAddr : hostAddrs)
+        countries.append(lookup(hostAddr));
+    return countries;
+}
+
+QString GeoIPDatabase::lookupIPv4(const quint32 addr) const
+{
+    const auto iter = std::upper_bound(m_ipv4Ranges.cbegin(), m_ipv4Ranges.cend(), addr
+            , [](const quint32 value, const IPv4Range &range) { return value < range.start; });
+    if (iter == m_ipv4Ranges.cbegin())
+        return {};
+
+    return m_countries.at(std::prev(iter)->countryIndex);
+}
+
+QString GeoIPDatabase::lookupIPv6(const quint64 addrHigh, const quint64 addrLow) const
+{
+    const auto iter = std::upper_bound(m_ipv6Ranges.cbegin(), m_ipv6Ranges.cend(), std::pair(addrHigh, addrLow)
+            , [](const std::pair<quint64, quint64> &value, const IPv6Range &range)
+    {
+        return value < std::pair(range.startHigh, range.startLow);
+    });
+    if (iter == m_ipv6Ranges.cbegin())
+        return {};
 
-    const uchar *ptr = m_data;
+    const quint16 countryIndex = std::prev(iter)->countryIndex;
+    if (countryIndex != IPV4_ALIAS_INDEX)
+        return m_countries.at(countryIndex);
 
-    for (int i = 0; i < 16; ++i)
+    // IPv4 address follows the prefix of alias network
+    for (const IPv4Alias &alias : m_ipv4Aliases)
     {
-        for (int j = 0; j < 8; ++j)
+        const int length = alias.prefixLength;
+        const quint64 highMask = (length >= 64) ? ~0ULL : ((length == 0) ? 0 : (~0ULL << (64 - length)));
+        const quint64 lowMask = (length <= 64) ? 0 : (~0ULL << (128 - length));
+        if ((((addrHigh ^ alias.prefixHigh) & highMask) != 0) || (((addrLow ^ alias.prefixLow) & lowMask) != 0))
+            continue;
+
+        if (length > 96)
+            return {};
+
+        quint64 bits = addrHigh;
+        if (length >= 64)
+            bits = addrLow << (length - 64);
+        else if (length > 0)
+            bits = (addrHigh << length) | (addrLow >> (64 - length));
+        return lookupIPv4(static_cast<quint32>(bits >> 32));
+    }
+
+    return {};
+}
+
+quint32 GeoIPDatabase::readRecord(const quint32 node, const bool right) const
+{
+    // only 24-bit records are supported
+    const uchar *ptr = m_data + (node * m_nodeSize) + (right ? m_recordBytes : 0);
+    return (static_cast<quint32>(ptr[0]) << 16) | (static_cast<quint32>(ptr[1]) << 8) | ptr[2];
+}
+
+// Calls `addRange` for each leaf of the tree in the address order.
+// The tree covers address space of `bitCount` bits, the address is passed as 128-bit value.
+template <typename Func>
+bool GeoIPDatabase::walkTree(const quint32 rootRecord, const int bitCount, const quint32 ipv4RootNode, Func &&addRange, QString &error)
+{
+    struct Item
+    {
+        quint32 record = 0;
+        int depth = 0;
+        quint64 prefixHigh = 0;
+        quint64 prefixLow = 0;
+    };
+
+    QList<Item> stack {{.record = rootRecord}};
+    quint32 visitedNodeCount = 0;
+    while (!stack.isEmpty())
+    {
+        const Item item = stack.takeLast();
+        if ((item.record >= m_nodeCount) || (item.record == ipv4RootNode) || (item.depth == bitCount))
         {
-            const bool right = static_cast<bool>((addr[i] >> (7 - j)) & 1);
-            // Interpret the left/right record as number
-            if (right)
-                ptr += m_recordBytes;
-
-            quint32 id = 0;
-            auto *idPtr = reinterpret_cast<uchar *>(&id);
-            memcpy(&idPtr[4 - m_recordBytes], ptr, m_recordBytes);
-            fromBigEndian(idPtr, 4);
-
-            if (id == m_nodeCount)
-            {
-                return {};
-            }
-            if (id > m_nodeCount)
-            {
-                QString country = m_countries.value(id);
-                if (country.isEmpty())
-                {
-                    const quint32 offset = id - m_nodeCount - sizeof(DATA_SECTION_SEPARATOR);
-                    quint32 tmp = offset + m_indexSize + sizeof(DATA_SECTION_SEPARATOR);
-                    const QVariant val = readDataField(tmp);
-                    if (val.userType() == QMetaType::QVariantHash)
-                    {
-                        country = val.toHash()[u"country"_s].toHash()[u"iso_code"_s].toString();
-                        m_countries[id] = country;
-                    }
-                }
-                return country;
-            }
-
-            ptr = m_data + (id * m_nodeSize);
+            addRange(item.prefixHigh, item.prefixLow, item.depth, item.record);
+            continue;
         }
+
+        // each node of valid tree is visited once
+        if (++visitedNodeCount > m_nodeCount)
+        {
+            error = tr("Database corrupted: invalid search tree.");
+            return false;
+        }
+
+        Item right {.record = readRecord(item.record, true), .depth = (item.depth + 1)
+            , .prefixHigh = item.prefixHigh, .prefixLow = item.prefixLow};
+        const int bitPos = bitCount - 1 - item.depth;
+        if (bitPos >= 64)
+            right.prefixHigh |= (1ULL << (bitPos - 64));
+        else
+            right.prefixLow |= (1ULL << bitPos);
+
+        // left branch is visited first
+        stack.append(right);
+        stack.append({.record = readRecord(item.record, false), .depth = (item.depth + 1)
+            , .prefixHigh = item.prefixHigh, .prefixLow = item.prefixLow});
     }
 
-    return {};
+    return true;
+}
+
+bool GeoIPDatabase::compileLookupTable(QString &error)
+{
+    qDebug() << "Compiling IP geolocation lookup table...";
+
+    m_countries = {QString()};
+    QHash<quint32, quint16> countryIndexes;
+    const auto countryIndex = [this, &countryIndexes](const quint32 record) -> std::optional<quint16>
+    {
+        // "no data" record
+        if (record <= m_nodeCount)
+            return 0;
+
+        if (const auto iter = countryIndexes.constFind(record); iter != countryIndexes.cend())
+            return iter.value();
+
+        const quint32 offset = record - m_nodeCount - sizeof(DATA_SECTION_SEPARATOR);
+        quint32 tmp = offset + m_indexSize + sizeof(DATA_SECTION_SEPARATOR);
+        const QVariant val = readDataField(tmp);
+        const QString country = (val.userType() == QMetaType::QVariantHash)
+            ? val.toHash()[u"country"_s].toHash()[u"iso_code"_s].toString()
+            : QString();
+
+        qsizetype index = m_countries.indexOf(country);
+        if (index < 0)
+        {
+            if (m_countries.size() >= IPV4_ALIAS_INDEX)
+                return std::nullopt;
+
+            index = m_countries.size();
+            m_countries.append(country);
+        }
+
+        countryIndexes.insert(record, static_cast<quint16>(index));
+        return static_cast<quint16>(index);
+    };
+
+    // IPv4 addresses are looked up as IPv4-mapped IPv6 ones ("::ffff:0:0/96")
+    quint32 ipv4Root = 0;
+    for (int i = 0; (i < 96) && (ipv4Root < m_nodeCount); ++i)
+        ipv4Root = readRecord(ipv4Root, (i >= 80));
+    // records are 24-bit so the placeholder doesn't match any node
+    const quint32 ipv4RootNode = (ipv4Root < m_nodeCount) ? ipv4Root : std::numeric_limits<quint32>::max();
+
+    bool hasTooManyCountries = false;
+    const bool isIPv4Compiled = walkTree(ipv4Root, 32, std::numeric_limits<quint32>::max()
+            , [this, &countryIndex, &hasTooManyCountries](const quint64, const quint64 prefixLow, const int, const quint32 record)
+    {
+        const std::optional<quint16> index = countryIndex(record);
+        if (!index)
+        {
+            hasTooManyCountries = true;
+            return;
+        }
+
+        if (m_ipv4Ranges.isEmpty() || (m_ipv4Ranges.last().countryIndex != *index))
+            m_ipv4Ranges.append({.start = static_cast<quint32>(prefixLow), .countryIndex = *index});
+    }, error);
+    if (!isIPv4Compiled)
+        return false;
+
+    const bool isIPv6Compiled = walkTree(0, 128, ipv4RootNode
+            , [this, ipv4RootNode, &countryIndex, &hasTooManyCountries](const quint64 prefixHigh, const quint64 prefixLow, const int prefixLength, const quint32 record)
+    {
+        std::optional<quint16> index;
+        if (record == ipv4RootNode)
+        {
+            index = IPV4_ALIAS_INDEX;
+            m_ipv4Aliases.append({.prefixHigh = prefixHigh, .prefixLow = prefixLow, .prefixLength = prefixLength});
+        }
+        else
+        {
+            index = countryIndex(record);
+        }
+
+        if (!index)
+        {
+            hasTooManyCountries = true;
+            return;
+        }
+
+        if (m_ipv6Ranges.isEmpty() || (m_ipv6Ranges.last().countryIndex != *index))
+            m_ipv6Ranges.append({.startHigh = prefixHigh, .startLow = prefixLow, .countryIndex = *index});
+    }, error);
+    if (!isIPv6Compiled)
+        return false;
+
+    if (hasTooManyCountries)
+    {
+        error = tr("Database corrupted: too many data records.");
+        return false;
+    }
+
+    m_ipv4Ranges.squeeze();
+    m_ipv6Ranges.squeeze();
+
+    // the lookups don't need the raw data anymore
+    delete [] m_data;
+    m_data = nullptr;
+    m_size = 0;
+
+    return true;
 }
 
 #define CHECK_METADATA_REQ(key, type) \
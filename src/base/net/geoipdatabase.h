@@ -31,7 +31,8 @@
 #include <QtTypes>
 #include <QCoreApplication>
 #include <QDateTime>
-#include <QHash>
+#include <QList>
+#include <QStringList>
 #include <QVariant>
 
 #include "base/pathfwd.h"
@@ -56,14 +57,45 @@ public:
     QString type() const;
     quint16 ipVersion() const;
     QDateTime buildEpoch() const;
+    // Lookups use immutable data so they can be performed from any thread
     QString lookup(const QHostAddress &hostAddr) const;
+    QStringList lookup(const QList<QHostAddress> &hostAddrs) const;
 
 private:
+    // Address ranges are kept sorted by their start, each range ends where the next one starts
+    struct IPv4Range
+    {
+        quint32 start = 0;
+        quint16 countryIndex = 0;
+    };
+
+    struct IPv6Range
+    {
+        quint64 startHigh = 0;
+        quint64 startLow = 0;
+        quint16 countryIndex = 0;
+    };
+
+    // IPv6 network which is mapped to IPv4 address space (e.g. "::ffff:0:0/96")
+    struct IPv4Alias
+    {
+        quint64 prefixHigh = 0;
+        quint64 prefixLow = 0;
+        int prefixLength = 0;
+    };
+
     explicit GeoIPDatabase(quint32 size);
 
     bool parseMetadata(const QVariantHash &metadata, QString &error);
     bool loadDB(QString &error) const;
     QVariantHash readMetadata() const;
+    bool compileLookupTable(QString &error);
+    QString lookupIPv4(quint32 addr) const;
+    QString lookupIPv6(quint64 addrHigh, quint64 addrLow) const;
+
+    quint32 readRecord(quint32 node, bool right) const;
+    template <typename Func>
+    bool walkTree(quint32 rootRecord, int bitCount, quint32 ipv4RootNode, Func &&addRange, QString &error);
 
     QVariant readDataField(quint32 &offset) const;
     bool readDataFieldDescriptor(quint32 &offset, DataFieldDescriptor &out) const;
@@ -83,7 +115,11 @@ private:
     QDateTime m_buildEpoch;
     QString m_dbType;
     // Search data
-    mutable QHash<quint32, QString> m_countries;
+    QStringList m_countries;
+    QList<IPv4Range> m_ipv4Ranges;
+    QList<IPv6Range> m_ipv6Ranges;
+    QList<IPv4Alias> m_ipv4Aliases;
+    // Raw database is released once the lookup table is compiled
     quint32 m_size = 0;
     uchar *m_data = nullptr;
 };
@@ -142,6 +142,14 @@ QString GeoIPManager::lookup(const QHostAddress &hostAddr) const
     return {};
 }
 
+QStringList GeoIPManager::lookup(const QList<QHostAddress> &hostAddrs) const
+{
+    if (m_enabled && m_geoIPDatabase)
+        return m_geoIPDatabase->lookup(hostAddrs);
+
+    return QStringList(hostAddrs.size());
+}
+
 QString GeoIPManager::CountryName(const QString &countryISOCode)
 {
     static const QHash<QString, QString> countries =
@@ -29,7 +29,9 @@
 
 #pragma once
 
+#include <QList>
 #include <QObject>
+#include <QStringList>
 
 class QHostAddress;
 class QString;
@@ -51,6 +53,7 @@ namespace Net
         static GeoIPManager *instance();
 
         QString lookup(const QHostAddress &hostAddr) const;
+        QStringList lookup(const QList<QHostAddress> &hostAddrs) const;
 
         static QString CountryName(const QString &countryISOCode);
 
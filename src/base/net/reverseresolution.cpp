@@ -28,10 +28,12 @@
 
 #include "reverseresolution.h"
 
+#include <utility>
+
 #include <QHostInfo>
-#include <QString>
 
 const int CACHE_SIZE = 2048;
+const int NEGATIVE_CACHE_SIZE = 4096;
 
 using namespace Net;
 
@@ -48,7 +50,7 @@ ReverseResolution *ReverseResolution::m_instance = nullptr;
 void ReverseResolution::initInstance()
 {
     if (!m_instance)
-        m_instance = new ReverseResolution;
+        m_instance = new ReverseResolution({});
 }
 
 void ReverseResolution::freeInstance()
@@ -62,43 +64,146 @@ ReverseResolution *ReverseResolution::instance()
     return m_instance;
 }
 
-ReverseResolution::ReverseResolution()
+ReverseResolution::ReverseResolution(Options options, QObject *parent)
+    : QObject(parent)
+    , m_options {std::move(options)}
 {
+    if (!m_options.lookupHost || !m_options.abortHostLookup)
+    {
+        m_options.lookupHost = [this](const QHostAddress &ip, std::function<void (const QHostInfo &host)> handler)
+        {
+            return QHostInfo::lookupHost(ip.toString(), this, std::move(handler));
+        };
+        m_options.abortHostLookup = [](const int lookupId) { QHostInfo::abortHostLookup(lookupId); };
+    }
+
     m_cache.setMaxCost(CACHE_SIZE);
+    m_negativeCache.setMaxCost(NEGATIVE_CACHE_SIZE);
 }
 
 ReverseResolution::~ReverseResolution()
 {
     // abort on-going lookups instead of waiting them
     for (auto iter = m_lookups.cbegin(); iter != m_lookups.cend(); ++iter)
-        QHostInfo::abortHostLookup(iter.key());
+        m_options.abortHostLookup(iter.key());
 }
 
 QString ReverseResolution::resolve(const QHostAddress &ip)
 {
-    const QString *hostname = m_cache.object(ip);
-    if (hostname)
-        return *hostname;
-
-    // do reverse lookup: IP -> hostname
-    const int lookupId = QHostInfo::lookupHost(ip.toString(), this, &ReverseResolution::hostResolved);
-    m_lookups.insert(lookupId, ip);
-    return {};
+    QString hostname;
+    if (!findCached(ip, hostname))
+    {
+        enqueue(ip);
+        startLookups();
+    }
+
+    return hostname;
+}
+
+QHash<QHostAddress, QString> ReverseResolution::resolve(const QList<QHostAddress> &ips)
+{
+    QHash<QHostAddress, QString> hostnames;
+    hostnames.reserve(ips.size());
+
+    for (const QHostAddress &ip : ips)
+    {
+        QString hostname;
+        if (!findCached(ip, hostname))
+            enqueue(ip);
+        else if (!hostname.isEmpty())
+            hostnames.insert(ip, hostname);
+    }
+
+    startLookups();
+    return hostnames;
+}
+
+ReverseResolution::Statistics ReverseResolution::statistics() const
+{
+    Statistics statistics = m_statistics;
+    statistics.queueDepth = m_queue.size();
+    statistics.activeLookups = m_lookups.size();
+    return statistics;
 }
 
 void ReverseResolution::hostResolved(const QHostInfo &host)
 {
     const QHostAddress ip = m_lookups.take(host.lookupId());
+    m_pendingIPs.remove(ip);
 
+    QString hostname;
     if (host.error() != QHostInfo::NoError)
     {
-        emit ipResolved(ip, {});
-        return;
+        ++m_statistics.failedLookups;
+        const auto ttl = (host.error() == QHostInfo::HostNotFound) ? m_options.negativeTTL : m_options.failureTTL;
+        m_negativeCache.insert(ip, new QDeadlineTimer(ttl));
+    }
+    else if (!isUsefulHostName(host.hostName(), ip))
+    {
+        m_negativeCache.insert(ip, new QDeadlineTimer(m_options.negativeTTL));
+    }
+    else
+    {
+        hostname = host.hostName();
+        m_cache.insert(ip, new CacheEntry {.hostname = hostname, .expiration = QDeadlineTimer(m_options.positiveTTL)});
     }
 
-    const QString hostname = isUsefulHostName(host.hostName(), ip)
-        ? host.hostName()
-        : QString();
-    m_cache.insert(ip, new QString(hostname));
+    startLookups();
     emit ipResolved(ip, hostname);
 }
+
+bool ReverseResolution::findCached(const QHostAddress &ip, QString &hostname)
+{
+    if (const CacheEntry *entry = m_cache.object(ip))
+    {
+        if (!entry->expiration.hasExpired())
+        {
+            ++m_statistics.cacheHits;
+            hostname = entry->hostname;
+            return true;
+        }
+
+        m_cache.remove(ip);
+    }
+
+    if (const QDeadlineTimer *expiration = m_negativeCache.object(ip))
+    {
+        if (!expiration->hasExpired())
+        {
+            ++m_statistics.negativeCacheHits;
+            return true;
+        }
+
+        m_negativeCache.remove(ip);
+    }
+
+    ++m_statistics.cacheMisses;
+    return false;
+}
+
+void ReverseResolution::enqueue(const QHostAddress &ip)
+{
+    if (m_pendingIPs.contains(ip))
+        return;
+
+    // the address will be requested again on next refresh of the peer list
+    if (m_queue.size() >= m_options.maxQueueSize)
+    {
+        ++m_statistics.droppedRequests;
+        return;
+    }
+
+    m_queue.enqueue(ip);
+    m_pendingIPs.insert(ip);
+}
+
+void ReverseResolution::startLookups()
+{
+    while ((m_lookups.size() < m_options.maxConcurrentLookups) && !m_queue.isEmpty())
+    {
+        const QHostAddress ip = m_queue.dequeue();
+        const int lookupId = m_options.lookupHost(ip, [this](const QHostInfo &host) { hostResolved(host); });
+        m_lookups.insert(lookupId, ip);
+        ++m_statistics.lookups;
+    }
+}
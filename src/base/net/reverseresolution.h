@@ -28,40 +28,98 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
+
+#include <QtTypes>
 #include <QCache>
+#include <QDeadlineTimer>
+#include <QHash>
 #include <QHostAddress>
+#include <QList>
 #include <QObject>
+#include <QQueue>
+#include <QSet>
+#include <QString>
 
 class QHostInfo;
-class QString;
 
 namespace Net
 {
+    // Resolves host names of IP addresses with a limited number of concurrent lookups.
+    // Both found names and failures are cached for a while, an address is looked up once at a time.
     class ReverseResolution final : public QObject
     {
         Q_OBJECT
         Q_DISABLE_COPY_MOVE(ReverseResolution)
 
     public:
+        struct Statistics
+        {
+            quint64 cacheHits = 0;
+            quint64 negativeCacheHits = 0;
+            quint64 cacheMisses = 0;
+            quint64 lookups = 0;
+            quint64 failedLookups = 0;
+            quint64 droppedRequests = 0; // not queued since the queue was full
+            qsizetype queueDepth = 0;
+            qsizetype activeLookups = 0;
+        };
+
+        // Parameters of the resolver, the application-wide instance uses the defaults
+        struct Options
+        {
+            int maxConcurrentLookups = 8;
+            qsizetype maxQueueSize = 1024;
+            // QHostInfo doesn't provide TTL of the records so fixed values are used
+            std::chrono::milliseconds positiveTTL = std::chrono::hours(1);
+            std::chrono::milliseconds negativeTTL = std::chrono::minutes(30); // the address has no useful host name
+            std::chrono::milliseconds failureTTL = std::chrono::minutes(2); // lookup failed for some other reason, e.g. timeout
+            // Starts lookup of the address and returns its ID, `handler` is called with the result later.
+            // QHostInfo is used unless both functions are set.
+            std::function<int (const QHostAddress &ip, std::function<void (const QHostInfo &host)> handler)> lookupHost;
+            std::function<void (int lookupId)> abortHostLookup;
+        };
+
         static void initInstance();
         static void freeInstance();
         static ReverseResolution *instance();
 
+        explicit ReverseResolution(Options options, QObject *parent = nullptr);
+        ~ReverseResolution() override;
+
+        // Returns cached host name (empty if it is unknown yet or doesn't exist),
+        // lookup is scheduled if the address isn't cached and `ipResolved` is emitted once it is done
         QString resolve(const QHostAddress &ip);
+        // Same as above for a list of addresses, returns host names that are cached
+        QHash<QHostAddress, QString> resolve(const QList<QHostAddress> &ips);
+
+        Statistics statistics() const;
 
     signals:
         void ipResolved(const QHostAddress &ip, const QString &hostname);
 
-    private slots:
-        void hostResolved(const QHostInfo &host);
-
     private:
-        ReverseResolution();
-        ~ReverseResolution() override;
+        struct CacheEntry
+        {
+            QString hostname;
+            QDeadlineTimer expiration;
+        };
+
+        // Returns `false` if the address needs to be looked up
+        bool findCached(const QHostAddress &ip, QString &hostname);
+        void enqueue(const QHostAddress &ip);
+        void startLookups();
+        void hostResolved(const QHostInfo &host);
 
         static ReverseResolution *m_instance;
 
+        Options m_options;
         QHash<int, QHostAddress> m_lookups;  // <LookupID, IP>
-        QCache<QHostAddress, QString> m_cache;  // <IP, HostName>
+        QQueue<QHostAddress> m_queue;
+        QSet<QHostAddress> m_pendingIPs;  // queued or being looked up
+        QCache<QHostAddress, CacheEntry> m_cache;  // <IP, HostName>
+        QCache<QHostAddress, QDeadlineTimer> m_negativeCache;  // <IP, Expiration>
+        Statistics m_statistics;
     };
 }
@@ -145,6 +145,41 @@ bool TorrentFilter::setAnnounceStatus(const std::optional<TorrentAnnounceStatus>
     return false;
 }
 
+TorrentFilter::Status TorrentFilter::status() const
+{
+    return m_status;
+}
+
+const std::optional<TorrentIDSet> &TorrentFilter::torrentIDSet() const
+{
+    return m_idSet;
+}
+
+const std::optional<QString> &TorrentFilter::category() const
+{
+    return m_category;
+}
+
+const std::optional<Tag> &TorrentFilter::tag() const
+{
+    return m_tag;
+}
+
+std::optional<bool> TorrentFilter::isPrivate() const
+{
+    return m_private;
+}
+
+const std::optional<QString> &TorrentFilter::trackerHost() const
+{
+    return m_trackerHost;
+}
+
+const std::optional<TorrentAnnounceStatus> &TorrentFilter::announceStatus() const
+{
+    return m_announceStatus;
+}
+
 bool TorrentFilter::match(const Torrent *const torrent) const
 {
     Q_ASSERT(torrent);
@@ -157,18 +192,10 @@ bool TorrentFilter::match(const Torrent *const torrent) const
 
 bool TorrentFilter::matchStatus(const Torrent *const torrent) const
 {
-    const TorrentState state = torrent->state();
-
     switch (m_status)
     {
     case All:
         return true;
-    case Downloading:
-        return torrent->isDownloading();
-    case Seeding:
-        return torrent->isUploading();
-    case Completed:
-        return torrent->isCompleted();
     case Stopped:
         return torrent->isStopped();
     case Running:
@@ -177,6 +204,25 @@ bool TorrentFilter::matchStatus(const Torrent *const torrent) const
         return torrent->isActive();
     case Inactive:
         return torrent->isInactive();
+    default:
+        break;
+    }
+
+    const std::optional<bool> isMatched = matchState(m_status, torrent->state());
+    Q_ASSERT(isMatched.has_value());
+    return isMatched.value_or(false);
+}
+
+std::optional<bool> TorrentFilter::matchState(const Status status, const TorrentState state)
+{
+    switch (status)
+    {
+    case Downloading:
+        return isDownloadingState(state);
+    case Seeding:
+        return isUploadingState(state);
+    case Completed:
+        return isCompletedState(state);
     case Stalled:
         return (state == TorrentState::StalledUploading)
                 || (state == TorrentState::StalledDownloading);
@@ -185,19 +231,16 @@ bool TorrentFilter::matchStatus(const Torrent *const torrent) const
     case StalledDownloading:
         return state == TorrentState::StalledDownloading;
     case Checking:
-        return (state == TorrentState::CheckingUploading)
-                || (state == TorrentState::CheckingDownloading)
-                || (state == TorrentState::CheckingResumeData);
+        return isCheckingState(state);
     case Moving:
-        return torrent->isMoving();
+        return state == TorrentState::Moving;
     case Errored:
-        return torrent->isErrored();
+        return isErroredState(state);
     default:
-        Q_UNREACHABLE();
         break;
     }
 
-    return false;
+    return std::nullopt;
 }
 
 bool TorrentFilter::matchHash(const Torrent *const torrent) const
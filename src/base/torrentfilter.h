@@ -40,6 +40,7 @@
 namespace BitTorrent
 {
     class Torrent;
+    enum class TorrentState;
 }
 
 using TorrentIDSet = QSet<BitTorrent::TorrentID>;
@@ -92,8 +93,20 @@ public:
     bool setTrackerHost(const std::optional<QString> &trackerHost);
     bool setAnnounceStatus(const std::optional<BitTorrent::TorrentAnnounceStatus> &announceStatus);
 
+    Status status() const;
+    const std::optional<TorrentIDSet> &torrentIDSet() const;
+    const std::optional<QString> &category() const;
+    const std::optional<Tag> &tag() const;
+    std::optional<bool> isPrivate() const;
+    const std::optional<QString> &trackerHost() const;
+    const std::optional<BitTorrent::TorrentAnnounceStatus> &announceStatus() const;
+
     bool match(const BitTorrent::Torrent *torrent) const;
 
+    // Whether torrents in the given state match the status,
+    // or `std::nullopt` if the status doesn't depend on the state alone (e.g. Active)
+    static std::optional<bool> matchState(Status status, BitTorrent::TorrentState state);
+
 private:
     bool matchStatus(const BitTorrent::Torrent *torrent) const;
     bool matchHash(const BitTorrent::Torrent *torrent) const;
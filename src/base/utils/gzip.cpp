@@ -135,3 +135,79 @@ QByteArray Utils::Gzip::decompress(const QByteArray &data, bool *ok)
     if (ok) *ok = true;
     return output;
 }
+
+Utils::Gzip::StreamCompressor::StreamCompressor(const int level)
+    : m_stream {std::make_unique<z_stream>()}
+{
+    m_stream->zalloc = Z_NULL;
+    m_stream->zfree = Z_NULL;
+    m_stream->opaque = Z_NULL;
+
+    // windowBits = 15 + 16 to enable gzip
+    m_isValid = (deflateInit2(m_stream.get(), level, Z_DEFLATED, (15 + 16), 9, Z_DEFAULT_STRATEGY) == Z_OK);
+}
+
+Utils::Gzip::StreamCompressor::~StreamCompressor()
+{
+    if (m_isValid)
+        deflateEnd(m_stream.get());
+}
+
+bool Utils::Gzip::StreamCompressor::isValid() const
+{
+    return m_isValid;
+}
+
+QByteArray Utils::Gzip::StreamCompressor::compress(const QByteArray &data)
+{
+    if (!m_isValid || data.isEmpty())
+        return {};
+
+    m_stream->next_in = reinterpret_cast<const Bytef *>(data.constData());
+    m_stream->avail_in = static_cast<uInt>(data.size());
+    // Z_SYNC_FLUSH makes all the input available to the receiver without waiting for more data
+    return process(Z_SYNC_FLUSH);
+}
+
+QByteArray Utils::Gzip::StreamCompressor::finish()
+{
+    if (!m_isValid)
+        return {};
+
+    m_stream->next_in = Z_NULL;
+    m_stream->avail_in = 0;
+    const QByteArray output = process(Z_FINISH);
+
+    deflateEnd(m_stream.get());
+    m_isValid = false;
+    return output;
+}
+
+QByteArray Utils::Gzip::StreamCompressor::process(const int flush)
+{
+    const int BUFSIZE = 64 * 1024;
+    std::vector<char> tmpBuf(BUFSIZE);
+
+    QByteArray output;
+    while (true)
+    {
+        m_stream->next_out = reinterpret_cast<Bytef *>(tmpBuf.data());
+        m_stream->avail_out = BUFSIZE;
+
+        const int result = deflate(m_stream.get(), flush);
+        if ((result != Z_OK) && (result != Z_STREAM_END) && (result != Z_BUF_ERROR))
+        {
+            deflateEnd(m_stream.get());
+            m_isValid = false;
+            return {};
+        }
+
+        output.append(tmpBuf.data(), (BUFSIZE - m_stream->avail_out));
+
+        // the output buffer wasn't filled up so there is no pending output left
+        if ((m_stream->avail_out != 0) || (result == Z_STREAM_END))
+            break;
+    }
+
+    return output;
+}
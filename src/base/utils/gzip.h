@@ -29,10 +29,38 @@
 
 #pragma once
 
+#include <memory>
+
+#include <QtClassHelperMacros>
+
 class QByteArray;
 
+struct z_stream_s;
+
 namespace Utils::Gzip
 {
     QByteArray compress(const QByteArray &data, int level = 6, bool *ok = nullptr);
     QByteArray decompress(const QByteArray &data, bool *ok = nullptr);
+
+    // Compresses data that becomes available piece by piece into a single gzip stream
+    class StreamCompressor
+    {
+        Q_DISABLE_COPY_MOVE(StreamCompressor)
+
+    public:
+        explicit StreamCompressor(int level = 6);
+        ~StreamCompressor();
+
+        bool isValid() const;
+        // Returns the compressed data that is ready so far, it can be empty
+        QByteArray compress(const QByteArray &data);
+        // Returns the rest of compressed data including gzip trailer
+        QByteArray finish();
+
+    private:
+        QByteArray process(int flush);
+
+        std::unique_ptr<z_stream_s> m_stream;
+        bool m_isValid = false;
+    };
 }
@@ -57,7 +57,7 @@ DownloadedPiecesBar::DownloadedPiecesBar(QWidget *parent)
     updateColorsImpl();
 }
 
-QList<float> DownloadedPiecesBar::bitfieldToFloatVector(const QBitArray &vecin, int reqSize)
+QList<float> DownloadedPiecesBar::bitfieldToFloatVector(const BitTorrent::Bitfield &vecin, int reqSize)
 {
     QList<float> result(reqSize, 0.0);
     if (vecin.isEmpty()) return result;
@@ -109,9 +109,11 @@ QList<float> DownloadedPiecesBar::bitfieldToFloatVector(const QBitArray &vecin,
             }
 
             // subcase (16 >= x < 17)
-            for (; x2 < toCMinusOne; ++x2)
-                if (vecin[x2])
-                    value += 1.0;
+            if (x2 < toCMinusOne)
+            {
+                value += vecin.count(x2, toCMinusOne);
+                x2 = toCMinusOne;
+            }
 
             // subcase (17 >= x < 17.8)
             if (x2 == toCMinusOne)
@@ -177,7 +179,7 @@ QImage DownloadedPiecesBar::renderImage()
     return image;
 }
 
-void DownloadedPiecesBar::setProgress(const QBitArray &pieces, const QBitArray &downloadedPieces)
+void DownloadedPiecesBar::setProgress(const BitTorrent::Bitfield &pieces, const BitTorrent::Bitfield &downloadedPieces)
 {
     m_pieces = pieces;
     m_downloadedPieces = downloadedPieces;
@@ -29,9 +29,9 @@
 
 #pragma once
 
-#include <QBitArray>
 #include <QtContainerFwd>
 
+#include "base/bittorrent/bitfield.h"
 #include "piecesbar.h"
 
 class QWidget;
@@ -45,14 +45,14 @@ class DownloadedPiecesBar final : public PiecesBar
 public:
     DownloadedPiecesBar(QWidget *parent);
 
-    void setProgress(const QBitArray &pieces, const QBitArray &downloadedPieces);
+    void setProgress(const BitTorrent::Bitfield &pieces, const BitTorrent::Bitfield &downloadedPieces);
 
     // PiecesBar interface
     void clear() override;
 
 private:
     // scale bitfield vector to float vector
-    QList<float> bitfieldToFloatVector(const QBitArray &vecin, int reqSize);
+    QList<float> bitfieldToFloatVector(const BitTorrent::Bitfield &vecin, int reqSize);
     QImage renderImage() override;
     QString simpleToolTipText() const override;
     void updateColors() override;
@@ -62,6 +62,6 @@ private:
     QColor m_dlPieceColor;
     // last used bitfields, uses to better resize redraw
     // TODO: make a diff pieces to new pieces and update only changed pixels, speedup when update > 20x faster
-    QBitArray m_pieces;
-    QBitArray m_downloadedPieces;
+    BitTorrent::Bitfield m_pieces;
+    BitTorrent::Bitfield m_downloadedPieces;
 };
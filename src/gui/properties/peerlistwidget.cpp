@@ -34,6 +34,7 @@
 #include <QApplication>
 #include <QClipboard>
 #include <QFuture>
+#include <QHash>
 #include <QHeaderView>
 #include <QHostAddress>
 #include <QList>
@@ -426,6 +427,19 @@ void PeerListWidget::loadPeers(const BitTorrent::Torrent *torrent)
         for (auto i = m_peerItems.cbegin(); i != m_peerItems.cend(); ++i)
             existingPeers.insert(i.key());
 
+        QHash<QHostAddress, QString> hostNames;
+        if (m_resolveHostNames)
+        {
+            QList<QHostAddress> peerIPs;
+            peerIPs.reserve(peers.size());
+            for (const BitTorrent::PeerInfo &peer : peers)
+            {
+                if (!peer.useI2PSocket())
+                    peerIPs.append(peer.address().ip);
+            }
+            hostNames = Net::ReverseResolution::instance()->resolve(peerIPs);
+        }
+
         const Preferences *pref = Preferences::instance();
         const bool hideZeroValues = (pref->getHideZeroValues() && (pref->getHideZeroComboValues() == 0));
         for (const BitTorrent::PeerInfo &peer : peers)
@@ -465,7 +479,7 @@ void PeerListWidget::loadPeers(const BitTorrent::Torrent *torrent)
                 existingPeers.remove(peerEndpoint);
             }
 
-            updatePeer(row, torrent, peer, hideZeroValues);
+            updatePeer(row, torrent, peer, hostNames.value(peer.address().ip), hideZeroValues);
         }
 
         // Remove peers that are gone
@@ -487,7 +501,7 @@ void PeerListWidget::loadPeers(const BitTorrent::Torrent *torrent)
     });
 }
 
-void PeerListWidget::updatePeer(const int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer, const bool hideZeroValues)
+void PeerListWidget::updatePeer(const int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer, const QString &hostName, const bool hideZeroValues)
 {
     const Qt::Alignment intDataTextAlignment = Qt::AlignRight | Qt::AlignVCenter;
 
@@ -530,13 +544,8 @@ void PeerListWidget::updatePeer(const int row, const BitTorrent::Torrent *torren
     setModelData(m_listModel, row, PeerListColumns::DOWNLOADING_PIECE, downloadingFilesDisplayValue
             , downloadingFilesDisplayValue, {}, downloadingFiles.join(u'\n'));
 
-    if (!peer.useI2PSocket() && m_resolveHostNames)
-    {
-        const QHostAddress ipAddr = peer.address().ip;
-        const QString hostName = Net::ReverseResolution::instance()->resolve(ipAddr);
-        if (!hostName.isEmpty())
-            setModelData(m_listModel, row, PeerListColumns::IP, hostName, hostName, {}, ipAddr.toString());
-    }
+    if (!peer.useI2PSocket() && !hostName.isEmpty())
+        setModelData(m_listModel, row, PeerListColumns::IP, hostName, hostName, {}, peer.address().ip.toString());
 
     if (m_resolveCountries)
     {
@@ -94,7 +94,7 @@ private slots:
     void handleResolved(const QHostAddress &ip, const QString &hostname) const;
 
 private:
-    void updatePeer(int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer, bool hideZeroValues);
+    void updatePeer(int row, const BitTorrent::Torrent *torrent, const BitTorrent::PeerInfo &peer, const QString &hostName, bool hideZeroValues);
     int visibleColumnsCount() const;
 
     void wheelEvent(QWheelEvent *event) override;
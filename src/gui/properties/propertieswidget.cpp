@@ -42,6 +42,7 @@
 #include <QStackedWidget>
 #include <QUrl>
 
+#include "base/bittorrent/bitfield.h"
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/torrent.h"
@@ -499,7 +500,7 @@ void PropertiesWidget::loadDynamicData()
                 m_ui->labelProgressVal->setText(Utils::String::fromDouble(progress, 1) + u'%');
 
                 m_torrent->fetchDownloadingPieces().then(this
-                        , [this, torrent = QPointer(m_torrent)](const QBitArray &downloadingPieces)
+                        , [this, torrent = QPointer(m_torrent)](const BitTorrent::Bitfield &downloadingPieces)
                 {
                     if (m_torrent && (m_torrent == torrent))
                         m_downloadedPieces->setProgress(m_torrent->pieces(), downloadingPieces);
@@ -30,6 +30,9 @@
 
 #include <algorithm>
 
+#include <QTreeWidgetItem>
+
+#include "base/bittorrent/alertprofiler.h"
 #include "base/bittorrent/cachestatus.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/sessionstatus.h"
@@ -56,6 +59,13 @@ StatsDialog::StatsDialog(QWidget *parent)
 
     connect(m_ui->buttonBox, &QDialogButtonBox::accepted, this, &StatsDialog::close);
 
+    m_ui->checkBoxAlertProfiling->setChecked(BitTorrent::Session::instance()->alertProfiler() != nullptr);
+    connect(m_ui->checkBoxAlertProfiling, &QAbstractButton::toggled, this, [this](const bool checked)
+    {
+        BitTorrent::Session::instance()->setAlertProfilingEnabled(checked);
+        updateAlertStatistics();
+    });
+
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::statsUpdated
             , this, &StatsDialog::update);
     update();
@@ -117,4 +127,46 @@ void StatsDialog::update()
 
     // Tracker statistics
     m_ui->labelQueuedTrackerAnnounces->setText(QString::number(ss.queuedTrackerAnnounces));
+
+    updateAlertStatistics();
+}
+
+void StatsDialog::updateAlertStatistics()
+{
+    const BitTorrent::AlertProfiler *profiler = BitTorrent::Session::instance()->alertProfiler();
+    m_ui->treeAlertStatistics->setEnabled(profiler != nullptr);
+    if (!profiler)
+    {
+        m_ui->treeAlertStatistics->clear();
+        return;
+    }
+
+    setAlertStatisticsRow(0, tr("Alerts per batch"), profiler->batchSizes(), false);
+    setAlertStatisticsRow(1, tr("Torrent updates latency"), profiler->stateUpdateLatency(), true);
+    setAlertStatisticsRow(2, tr("Torrent updates handling"), profiler->torrentsUpdatedHandlers(), true);
+
+    int row = 3;
+    for (const BitTorrent::AlertProfiler::AlertTypeStatistics *statistics : asConst(profiler->alertTypes()))
+        setAlertStatisticsRow(row++, statistics->name, statistics->handlingTime, true);
+}
+
+void StatsDialog::setAlertStatisticsRow(const int row, const QString &event, const BitTorrent::LatencyHistogram &histogram, const bool isDuration)
+{
+    // durations are recorded in microseconds
+    const auto formatValue = [isDuration](const double value) -> QString
+    {
+        return isDuration
+            ? tr("%1 ms", "18 milliseconds").arg(Utils::String::fromDouble((value / 1000), 2))
+            : Utils::String::fromDouble(value, 1);
+    };
+
+    QTreeWidgetItem *item = m_ui->treeAlertStatistics->topLevelItem(row);
+    if (!item)
+        item = new QTreeWidgetItem(m_ui->treeAlertStatistics);
+
+    item->setText(0, event);
+    item->setText(1, QString::number(histogram.count()));
+    item->setText(2, formatValue(histogram.mean()));
+    item->setText(3, formatValue(static_cast<double>(histogram.valueAtPercentile(99))));
+    item->setText(4, formatValue(static_cast<double>(histogram.max())));
 }
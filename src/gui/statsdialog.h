@@ -32,6 +32,11 @@
 
 #include "base/settingvalue.h"
 
+namespace BitTorrent
+{
+    class LatencyHistogram;
+}
+
 namespace Ui
 {
     class StatsDialog;
@@ -50,6 +55,9 @@ private slots:
     void update();
 
 private:
+    void updateAlertStatistics();
+    void setAlertStatisticsRow(int row, const QString &event, const BitTorrent::LatencyHistogram &histogram, bool isDuration);
+
     Ui::StatsDialog *m_ui = nullptr;
     SettingValue<QSize> m_storeDialogSize;
 };
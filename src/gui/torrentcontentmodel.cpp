@@ -34,6 +34,7 @@
 #include <QFileIconProvider>
 #include <QFileInfo>
 #include <QFuture>
+#include <QHash>
 #include <QIcon>
 #include <QMimeData>
 #include <QPointer>
@@ -54,8 +55,6 @@
 #include "base/global.h"
 #include "base/path.h"
 #include "base/utils/fs.h"
-#include "torrentcontentmodelfile.h"
-#include "torrentcontentmodelfolder.h"
 #include "torrentcontentmodelitem.h"
 #include "uithememanager.h"
 
@@ -162,11 +161,17 @@ namespace
         }
     };
 #endif // Q_OS_WIN
+
+    TorrentContentTree::NodeID nodeID(const QModelIndex &index)
+    {
+        return index.isValid()
+            ? static_cast<TorrentContentTree::NodeID>(index.internalId())
+            : TorrentContentTree::ROOT_NODE;
+    }
 }
 
 TorrentContentModel::TorrentContentModel(QObject *parent)
     : QAbstractItemModel(parent)
-    , m_rootItem(new TorrentContentModelFolder(QList<QString>({ tr("Name"), tr("Total Size"), tr("Progress"), tr("Download Priority"), tr("Remaining"), tr("Availability") })))
 #if defined(Q_OS_WIN)
     , m_fileIconProvider {new QFileIconProvider}
 #elif defined(Q_OS_MACOS)
@@ -181,38 +186,44 @@ TorrentContentModel::TorrentContentModel(QObject *parent)
 TorrentContentModel::~TorrentContentModel()
 {
     delete m_fileIconProvider;
-    delete m_rootItem;
 }
 
-void TorrentContentModel::updateFilesProgress()
+QList<TorrentContentModel::NodeID> TorrentContentModel::updateFilesProgress()
 {
     Q_ASSERT(m_contentHandler && m_contentHandler->hasMetadata());
 
     const QList<qreal> &filesProgress = m_contentHandler->filesProgress();
-    Q_ASSERT(m_filesIndex.size() == filesProgress.size());
+    Q_ASSERT(m_tree.filesCount() == filesProgress.size());
     // XXX: Why is this necessary?
-    if (m_filesIndex.size() != filesProgress.size()) [[unlikely]]
-        return;
+    if (m_tree.filesCount() != filesProgress.size()) [[unlikely]]
+        return {};
 
-    for (qsizetype i = 0; i < filesProgress.size(); ++i)
-        m_filesIndex[i]->setProgress(filesProgress[i]);
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    m_rootItem->recalculateAvailability();
+    QList<NodeID> updatedNodes;
+    for (int i = 0; i < filesProgress.size(); ++i)
+    {
+        if (m_tree.setFileProgress(i, filesProgress[i]))
+            updatedNodes.append(m_tree.fileNode(i));
+    }
+    return updatedNodes;
 }
 
-void TorrentContentModel::updateFilesPriorities()
+QList<TorrentContentModel::NodeID> TorrentContentModel::updateFilesPriorities()
 {
     Q_ASSERT(m_contentHandler && m_contentHandler->hasMetadata());
 
     const QList<BitTorrent::DownloadPriority> fprio = m_contentHandler->filePriorities();
-    Q_ASSERT(m_filesIndex.size() == fprio.size());
+    Q_ASSERT(m_tree.filesCount() == fprio.size());
     // XXX: Why is this necessary?
-    if (m_filesIndex.size() != fprio.size())
-        return;
+    if (m_tree.filesCount() != fprio.size())
+        return {};
 
-    for (qsizetype i = 0; i < fprio.size(); ++i)
-        m_filesIndex[i]->setPriority(static_cast<BitTorrent::DownloadPriority>(fprio[i]));
+    QList<NodeID> updatedNodes;
+    for (int i = 0; i < fprio.size(); ++i)
+    {
+        if (m_tree.setFilePriority(i, fprio[i]))
+            updatedNodes.append(m_tree.fileNode(i));
+    }
+    return updatedNodes;
 }
 
 void TorrentContentModel::updateFilesAvailability()
@@ -225,10 +236,18 @@ void TorrentContentModel::updateFilesAvailability()
         if (!m_contentHandler || (m_contentHandler != handler))
             return;
 
-        for (qsizetype i = 0; i < m_filesIndex.size(); ++i)
-            m_filesIndex[i]->setAvailability(availableFileFractions.value(i, 0));
-        // Update folders progress in the tree
-        m_rootItem->recalculateProgress();
+        QList<NodeID> updatedNodes;
+        for (int i = 0; i < m_tree.filesCount(); ++i)
+        {
+            if (m_tree.setFileAvailability(i, availableFileFractions.value(i, 0)))
+                updatedNodes.append(m_tree.fileNode(i));
+        }
+
+        const QList<ColumnInterval> columns =
+        {
+            {TorrentContentModelItem::COL_AVAILABILITY, TorrentContentModelItem::COL_AVAILABILITY}
+        };
+        notifyItemsUpdated(updatedNodes, columns);
     });
 }
 
@@ -236,22 +255,16 @@ bool TorrentContentModel::setItemPriority(const QModelIndex &index, BitTorrent::
 {
     Q_ASSERT(index.isValid());
 
-    auto *item = static_cast<TorrentContentModelItem *>(index.internalPointer());
-    const BitTorrent::DownloadPriority currentPriority = item->priority();
-    if (currentPriority == priority)
+    if (!m_tree.setPriority(nodeID(index), priority))
         return false;
 
-    item->setPriority(priority);
-    m_contentHandler->prioritizeFiles(getFilePriorities());
-
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    m_rootItem->recalculateAvailability();
+    m_contentHandler->prioritizeFiles(m_tree.filePriorities());
 
+    // Progress of folders depends on priorities of their items
     const QList<ColumnInterval> columns =
     {
         {TorrentContentModelItem::COL_NAME, TorrentContentModelItem::COL_NAME},
-        {TorrentContentModelItem::COL_PRIO, TorrentContentModelItem::COL_PRIO}
+        {TorrentContentModelItem::COL_PROGRESS, TorrentContentModelItem::COL_AVAILABILITY}
     };
     notifySubtreeUpdated(index, columns);
 
@@ -260,11 +273,7 @@ bool TorrentContentModel::setItemPriority(const QModelIndex &index, BitTorrent::
 
 QList<BitTorrent::DownloadPriority> TorrentContentModel::getFilePriorities() const
 {
-    QList<BitTorrent::DownloadPriority> prio;
-    prio.reserve(m_filesIndex.size());
-    for (const TorrentContentModelFile *file : asConst(m_filesIndex))
-        prio.push_back(file->priority());
-    return prio;
+    return m_tree.filePriorities();
 }
 
 int TorrentContentModel::columnCount([[maybe_unused]] const QModelIndex &parent) const
@@ -291,13 +300,13 @@ bool TorrentContentModel::setData(const QModelIndex &index, const QVariant &valu
 
     if (role == Qt::EditRole)
     {
-        auto *item = static_cast<TorrentContentModelItem *>(index.internalPointer());
+        const NodeID node = nodeID(index);
 
         switch (index.column())
         {
         case TorrentContentModelItem::COL_NAME:
             {
-                const QString currentName = item->name();
+                const QString currentName = m_tree.name(node);
                 const QString newName = value.toString().trimmed();
 
                 if (currentName != newName)
@@ -314,10 +323,10 @@ bool TorrentContentModel::setData(const QModelIndex &index, const QVariant &valu
                         const Path oldPath = parentPath / Path(currentName);
                         const Path newPath = parentPath / Path(newName);
 
-                        if (item->itemType() == TorrentContentModelItem::FileType)
-                            m_contentHandler->renameFile(oldPath, newPath);
-                        else
+                        if (m_tree.isFolder(node))
                             m_contentHandler->renameFolder(oldPath, newPath);
+                        else
+                            m_contentHandler->renameFile(oldPath, newPath);
                     }
                     catch (const RuntimeError &error)
                     {
@@ -325,7 +334,7 @@ bool TorrentContentModel::setData(const QModelIndex &index, const QVariant &valu
                         return false;
                     }
 
-                    item->setName(newName);
+                    m_tree.setName(node, newName);
                     emit dataChanged(index, index);
                     return true;
                 }
@@ -349,24 +358,17 @@ bool TorrentContentModel::setData(const QModelIndex &index, const QVariant &valu
 
 TorrentContentModelItem::ItemType TorrentContentModel::itemType(const QModelIndex &index) const
 {
-    return static_cast<const TorrentContentModelItem *>(index.internalPointer())->itemType();
+    return TorrentContentModelItem(m_tree, nodeID(index)).itemType();
 }
 
 int TorrentContentModel::getFileIndex(const QModelIndex &index) const
 {
-    auto *item = static_cast<TorrentContentModelItem *>(index.internalPointer());
-    if (item->itemType() == TorrentContentModelItem::FileType)
-        return static_cast<TorrentContentModelFile *>(item)->fileIndex();
-
-    return -1;
+    return m_tree.fileIndex(nodeID(index));
 }
 
 Path TorrentContentModel::getItemPath(const QModelIndex &index) const
 {
-    Path path;
-    for (QModelIndex i = index; i.isValid(); i = i.parent())
-        path = Path(i.data().toString()) / path;
-    return path;
+    return m_tree.path(nodeID(index));
 }
 
 QVariant TorrentContentModel::data(const QModelIndex &index, const int role) const
@@ -374,7 +376,7 @@ QVariant TorrentContentModel::data(const QModelIndex &index, const int role) con
     if (!index.isValid())
         return {};
 
-    auto *item = static_cast<TorrentContentModelItem *>(index.internalPointer());
+    const NodeID node = nodeID(index);
 
     switch (role)
     {
@@ -382,34 +384,20 @@ QVariant TorrentContentModel::data(const QModelIndex &index, const int role) con
         if (index.column() != TorrentContentModelItem::COL_NAME)
             return {};
 
-        if (item->itemType() == TorrentContentModelItem::FolderType)
+        if (m_tree.isFolder(node))
             return m_fileIconProvider->icon(QFileIconProvider::Folder);
 
-        return m_fileIconProvider->icon(QFileInfo(item->name()));
+        return m_fileIconProvider->icon(QFileInfo(m_tree.name(node)));
 
     case Qt::CheckStateRole:
         if (index.column() != TorrentContentModelItem::COL_NAME)
             return {};
 
-        if (item->priority() == BitTorrent::DownloadPriority::Ignored)
+        if (m_tree.priority(node) == BitTorrent::DownloadPriority::Ignored)
             return Qt::Unchecked;
 
-        if (item->priority() == BitTorrent::DownloadPriority::Mixed)
-        {
-            Q_ASSERT(item->itemType() == TorrentContentModelItem::FolderType);
-
-            const auto *folder = static_cast<TorrentContentModelFolder *>(item);
-            const auto childItems = folder->children();
-            const bool hasIgnored = std::ranges::any_of(childItems
-                         , [](const TorrentContentModelItem *childItem)
-            {
-                const auto prio = childItem->priority();
-                return ((prio == BitTorrent::DownloadPriority::Ignored)
-                    || (prio == BitTorrent::DownloadPriority::Mixed));
-            });
-
-            return hasIgnored ? Qt::PartiallyChecked : Qt::Checked;
-        }
+        if (m_tree.hasIgnoredFiles(node))
+            return Qt::PartiallyChecked;
 
         return Qt::Checked;
 
@@ -424,10 +412,10 @@ QVariant TorrentContentModel::data(const QModelIndex &index, const int role) con
 
     case Qt::DisplayRole:
     case Qt::ToolTipRole:
-        return item->displayData(index.column());
+        return TorrentContentModelItem(m_tree, node).displayData(index.column());
 
     case Roles::UnderlyingDataRole:
-        return item->underlyingData(index.column());
+        return TorrentContentModelItem(m_tree, node).underlyingData(index.column());
 
     default:
         break;
@@ -458,7 +446,23 @@ QVariant TorrentContentModel::headerData(int section, Qt::Orientation orientatio
     switch (role)
     {
     case Qt::DisplayRole:
-        return m_rootItem->displayData(section);
+        switch (section)
+        {
+        case TorrentContentModelItem::COL_NAME:
+            return tr("Name");
+        case TorrentContentModelItem::COL_SIZE:
+            return tr("Total Size");
+        case TorrentContentModelItem::COL_PROGRESS:
+            return tr("Progress");
+        case TorrentContentModelItem::COL_PRIO:
+            return tr("Download Priority");
+        case TorrentContentModelItem::COL_REMAINING:
+            return tr("Remaining");
+        case TorrentContentModelItem::COL_AVAILABILITY:
+            return tr("Availability");
+        default:
+            return {};
+        }
 
     case Qt::TextAlignmentRole:
         if ((section == TorrentContentModelItem::COL_SIZE)
@@ -476,22 +480,15 @@ QVariant TorrentContentModel::headerData(int section, Qt::Orientation orientatio
 
 QModelIndex TorrentContentModel::index(const int row, const int column, const QModelIndex &parent) const
 {
-    if (column >= columnCount())
+    if ((row < 0) || (column < 0) || (column >= columnCount()) || m_tree.isEmpty())
         return {};
 
-    const TorrentContentModelFolder *parentItem = parent.isValid()
-        ? static_cast<TorrentContentModelFolder *>(parent.internalPointer())
-        : m_rootItem;
-    Q_ASSERT(parentItem);
-
-    if (row >= parentItem->childCount())
+    const NodeID parentNode = nodeID(parent);
+    if (row >= m_tree.childCount(parentNode))
         return {};
 
-    TorrentContentModelItem *childItem = parentItem->child(row);
-    if (childItem)
-        return createIndex(row, column, childItem);
-
-    return {};
+    m_accessedFolders[parentNode] = true;
+    return createIndex(row, column, static_cast<quintptr>(m_tree.child(parentNode, row)));
 }
 
 QModelIndex TorrentContentModel::parent(const QModelIndex &index) const
@@ -499,27 +496,19 @@ QModelIndex TorrentContentModel::parent(const QModelIndex &index) const
     if (!index.isValid())
         return {};
 
-    const auto *item = static_cast<TorrentContentModelItem *>(index.internalPointer());
-    if (!item)
-        return {};
-
-    TorrentContentModelItem *parentItem = item->parent();
-    if (parentItem == m_rootItem)
-        return {};
-
     // From https://doc.qt.io/qt-6/qabstractitemmodel.html#parent:
     // A common convention used in models that expose tree data structures is that only items
     // in the first column have children. For that case, when reimplementing this function in
     // a subclass the column of the returned QModelIndex would be 0.
-    return createIndex(parentItem->row(), 0, parentItem);
+    return nodeIndex(m_tree.parent(nodeID(index)));
 }
 
 int TorrentContentModel::rowCount(const QModelIndex &parent) const
 {
-    const TorrentContentModelFolder *parentItem = parent.isValid()
-        ? dynamic_cast<TorrentContentModelFolder *>(static_cast<TorrentContentModelItem *>(parent.internalPointer()))
-        : m_rootItem;
-    return parentItem ? parentItem->childCount() : 0;
+    if (m_tree.isEmpty())
+        return 0;
+
+    return m_tree.childCount(nodeID(parent));
 }
 
 QMimeData *TorrentContentModel::mimeData(const QModelIndexList &indexes) const
@@ -567,49 +556,8 @@ void TorrentContentModel::populate()
 {
     Q_ASSERT(m_contentHandler && m_contentHandler->hasMetadata());
 
-    const int filesCount = m_contentHandler->filesCount();
-    m_filesIndex.reserve(filesCount);
-
-    QHash<TorrentContentModelFolder *, QHash<QString, TorrentContentModelFolder *>> folderMap;
-    QList<QString> lastParentPath;
-    TorrentContentModelFolder *lastParent = m_rootItem;
-    // Iterate over files
-    for (int i = 0; i < filesCount; ++i)
-    {
-        const QString path = m_contentHandler->filePath(i).data();
-
-        // Iterate of parts of the path to create necessary folders
-        QList<QStringView> pathFolders = QStringView(path).split(u'/', Qt::SkipEmptyParts);
-        const QString fileName = pathFolders.takeLast().toString();
-
-        if (!std::ranges::equal(asConst(lastParentPath), asConst(pathFolders)))
-        {
-            lastParentPath.clear();
-            lastParentPath.reserve(pathFolders.size());
-
-            // rebuild the path from the root
-            lastParent = m_rootItem;
-            for (const QStringView pathPart : asConst(pathFolders))
-            {
-                const QString folderName = pathPart.toString();
-                lastParentPath.push_back(folderName);
-
-                TorrentContentModelFolder *&newParent = folderMap[lastParent][folderName];
-                if (!newParent)
-                {
-                    newParent = new TorrentContentModelFolder(folderName, lastParent);
-                    lastParent->appendChild(newParent);
-                }
-
-                lastParent = newParent;
-            }
-        }
-
-        // Actually create the file
-        auto *fileItem = new TorrentContentModelFile(fileName, m_contentHandler->fileSize(i), lastParent, i);
-        lastParent->appendChild(fileItem);
-        m_filesIndex.push_back(fileItem);
-    }
+    m_tree.build(*m_contentHandler);
+    m_accessedFolders.assign(m_tree.nodeCount(), false);
 
     updateFilesProgress();
     updateFilesPriorities();
@@ -623,8 +571,8 @@ void TorrentContentModel::setContentHandler(BitTorrent::TorrentContentHandler *c
 
     if (m_contentHandler)
     {
-        m_filesIndex.clear();
-        m_rootItem->deleteAllChildren();
+        m_tree.clear();
+        m_accessedFolders.clear();
     }
 
     m_contentHandler = contentHandler;
@@ -643,20 +591,18 @@ void TorrentContentModel::refresh()
     if (!m_contentHandler || !m_contentHandler->hasMetadata())
         return;
 
-    if (!m_filesIndex.isEmpty())
+    if (!m_tree.isEmpty())
     {
-        updateFilesProgress();
-        updateFilesPriorities();
+        QList<NodeID> updatedNodes = updateFilesProgress();
+        updatedNodes.append(updateFilesPriorities());
         updateFilesAvailability();
 
         const QList<ColumnInterval> columns =
         {
             {TorrentContentModelItem::COL_NAME, TorrentContentModelItem::COL_NAME},
-            {TorrentContentModelItem::COL_PROGRESS, TorrentContentModelItem::COL_PROGRESS},
-            {TorrentContentModelItem::COL_PRIO, TorrentContentModelItem::COL_PRIO},
-            {TorrentContentModelItem::COL_AVAILABILITY, TorrentContentModelItem::COL_AVAILABILITY}
+            {TorrentContentModelItem::COL_PROGRESS, TorrentContentModelItem::COL_AVAILABILITY}
         };
-        notifySubtreeUpdated(index(0, 0), columns);
+        notifyItemsUpdated(updatedNodes, columns);
     }
     else
     {
@@ -666,6 +612,49 @@ void TorrentContentModel::refresh()
     }
 }
 
+QModelIndex TorrentContentModel::nodeIndex(const NodeID node, const int column) const
+{
+    if (node == TorrentContentTree::ROOT_NODE)
+        return {};
+
+    return createIndex(m_tree.row(node), column, static_cast<quintptr>(node));
+}
+
+void TorrentContentModel::notifyItemsUpdated(const QList<NodeID> &nodes, const QList<ColumnInterval> &columns)
+{
+    using RowInterval = IndexInterval<int>;
+
+    // Updated items and their ancestors are collected as row intervals of their parent folders
+    // so only one signal per folder is emitted
+    QHash<NodeID, RowInterval> updatedRows;
+    for (const NodeID node : nodes)
+    {
+        for (NodeID id = node; id != TorrentContentTree::ROOT_NODE; id = m_tree.parent(id))
+        {
+            const NodeID parentNode = m_tree.parent(id);
+            const int row = m_tree.row(id);
+            if (const auto iter = updatedRows.find(parentNode); iter != updatedRows.end())
+            {
+                // ancestors of this folder are already collected
+                *iter = RowInterval(std::min(iter->first(), row), std::max(iter->last(), row));
+                break;
+            }
+
+            updatedRows.insert(parentNode, RowInterval(row, row));
+        }
+    }
+
+    for (auto iter = updatedRows.cbegin(); iter != updatedRows.cend(); ++iter)
+    {
+        if (!m_accessedFolders[iter.key()])
+            continue;
+
+        const QModelIndex parentIndex = nodeIndex(iter.key());
+        for (const ColumnInterval &column : columns)
+            emit dataChanged(index(iter->first(), column.first(), parentIndex), index(iter->last(), column.last(), parentIndex));
+    }
+}
+
 void TorrentContentModel::notifySubtreeUpdated(const QModelIndex &index, const QList<ColumnInterval> &columns)
 {
     // For best performance, `columns` entries should be arranged from left to right
@@ -685,34 +674,29 @@ void TorrentContentModel::notifySubtreeUpdated(const QModelIndex &index, const Q
         parentIndex = parent(parentIndex);
     }
 
-    // propagate down the model
-    QList<QModelIndex> parentIndexes;
-
-    if (hasChildren(index))
-        parentIndexes.push_back(index);
+    // propagate down the model, skipping folders whose children were never requested
+    QList<NodeID> folders;
+    if (m_tree.isFolder(nodeID(index)))
+        folders.push_back(nodeID(index));
 
-    while (!parentIndexes.isEmpty())
+    while (!folders.isEmpty())
     {
-        const QModelIndex parent = parentIndexes.takeLast();
+        const NodeID folder = folders.takeLast();
+        if (!m_accessedFolders[folder])
+            continue;
 
-        const int childCount = rowCount(parent);
-        const QModelIndex child = this->index(0, 0, parent);
+        const int childCount = m_tree.childCount(folder);
+        const QModelIndex folderIndex = nodeIndex(folder);
 
         // emit this generation
         for (const ColumnInterval &column : columns)
-        {
-            const QModelIndex childTopLeft = child.siblingAtColumn(column.first());
-            const QModelIndex childBottomRight = child.sibling((childCount - 1), column.last());
-            emit dataChanged(childTopLeft, childBottomRight);
-        }
+            emit dataChanged(this->index(0, column.first(), folderIndex), this->index((childCount - 1), column.last(), folderIndex));
 
         // check generations further down
-        parentIndexes.reserve(childCount);
         for (int i = 0; i < childCount; ++i)
         {
-            const QModelIndex sibling = child.siblingAtRow(i);
-            if (hasChildren(sibling))
-                parentIndexes.push_back(sibling);
+            if (const NodeID child = m_tree.child(folder, i); m_tree.isFolder(child))
+                folders.push_back(child);
         }
     }
 }
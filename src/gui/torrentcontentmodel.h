@@ -29,20 +29,21 @@
 
 #pragma once
 
+#include <vector>
+
 #include <QAbstractItemModel>
 #include <QList>
 
 #include "base/indexrange.h"
 #include "base/pathfwd.h"
 #include "torrentcontentmodelitem.h"
+#include "torrentcontenttree.h"
 
 class QFileIconProvider;
 class QMimeData;
 class QModelIndex;
 class QVariant;
 
-class TorrentContentModelFile;
-
 namespace BitTorrent
 {
     class TorrentContentHandler;
@@ -86,18 +87,22 @@ signals:
 
 private:
     using ColumnInterval = IndexInterval<int>;
+    using NodeID = TorrentContentTree::NodeID;
 
     QMimeData *mimeData(const QModelIndexList &indexes) const override;
     QStringList mimeTypes() const override;
     void populate();
-    void updateFilesProgress();
-    void updateFilesPriorities();
+    QList<NodeID> updateFilesProgress();
+    QList<NodeID> updateFilesPriorities();
     void updateFilesAvailability();
     bool setItemPriority(const QModelIndex &index, BitTorrent::DownloadPriority priority);
+    QModelIndex nodeIndex(NodeID node, int column = 0) const;
+    void notifyItemsUpdated(const QList<NodeID> &nodes, const QList<ColumnInterval> &columns);
     void notifySubtreeUpdated(const QModelIndex &index, const QList<ColumnInterval> &columns);
 
     BitTorrent::TorrentContentHandler *m_contentHandler = nullptr;
-    TorrentContentModelFolder *m_rootItem = nullptr;
-    QList<TorrentContentModelFile *> m_filesIndex;
+    TorrentContentTree m_tree;
+    // Folders whose children were requested by views, others don't need to be notified about changes
+    mutable std::vector<bool> m_accessedFolders;
     QFileIconProvider *m_fileIconProvider = nullptr;
 };
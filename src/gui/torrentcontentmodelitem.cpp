@@ -33,81 +33,26 @@
 #include "base/unicodestrings.h"
 #include "base/utils/misc.h"
 #include "base/utils/string.h"
-#include "torrentcontentmodelfolder.h"
 
-TorrentContentModelItem::TorrentContentModelItem(TorrentContentModelFolder *parent)
-    : m_parentItem(parent)
+TorrentContentModelItem::TorrentContentModelItem(const TorrentContentTree &tree, const TorrentContentTree::NodeID node)
+    : m_tree {tree}
+    , m_node {node}
 {
 }
 
-TorrentContentModelItem::~TorrentContentModelItem() = default;
-
-bool TorrentContentModelItem::isRootItem() const
-{
-    return !m_parentItem;
-}
-
-QString TorrentContentModelItem::name() const
-{
-    Q_ASSERT(!isRootItem());
-    return m_name;
-}
-
-void TorrentContentModelItem::setName(const QString &name)
-{
-    Q_ASSERT(!isRootItem());
-    m_name = name;
-}
-
-qulonglong TorrentContentModelItem::size() const
-{
-    Q_ASSERT(!isRootItem());
-
-    return m_size;
-}
-
-qreal TorrentContentModelItem::progress() const
-{
-    Q_ASSERT(!isRootItem());
-
-    return (m_size > 0) ? m_progress : 1;
-}
-
-qulonglong TorrentContentModelItem::remaining() const
-{
-    Q_ASSERT(!isRootItem());
-    return (m_priority == BitTorrent::DownloadPriority::Ignored) ? 0 : m_remaining;
-}
-
-qreal TorrentContentModelItem::availability() const
-{
-    Q_ASSERT(!isRootItem());
-
-    return (m_size > 0) ? m_availability : 0;
-}
-
-BitTorrent::DownloadPriority TorrentContentModelItem::priority() const
+TorrentContentModelItem::ItemType TorrentContentModelItem::itemType() const
 {
-    Q_ASSERT(!isRootItem());
-    return m_priority;
-}
-
-int TorrentContentModelItem::columnCount() const
-{
-    return NB_COL;
+    return m_tree.isFolder(m_node) ? FolderType : FileType;
 }
 
 QString TorrentContentModelItem::displayData(const int column) const
 {
-    if (isRootItem())
-        return m_itemData.value(column);
-
     switch (column)
     {
     case COL_NAME:
-        return m_name;
+        return m_tree.name(m_node);
     case COL_PRIO:
-        switch (m_priority)
+        switch (m_tree.priority(m_node))
         {
         case BitTorrent::DownloadPriority::Mixed:
             return tr("Mixed", "Mixed (priorities");
@@ -121,16 +66,19 @@ QString TorrentContentModelItem::displayData(const int column) const
             return tr("Normal", "Normal (priority)");
         }
     case COL_PROGRESS:
-        return (m_progress >= 1)
-               ? u"100%"_s
-               : (Utils::String::fromDouble((m_progress * 100), 1) + u'%');
+        {
+            const qreal progress = m_tree.progress(m_node);
+            return (progress >= 1)
+                   ? u"100%"_s
+                   : (Utils::String::fromDouble((progress * 100), 1) + u'%');
+        }
     case COL_SIZE:
-        return Utils::Misc::friendlyUnit(m_size);
+        return Utils::Misc::friendlyUnit(m_tree.size(m_node));
     case COL_REMAINING:
-        return Utils::Misc::friendlyUnit(remaining());
+        return Utils::Misc::friendlyUnit(m_tree.remaining(m_node));
     case COL_AVAILABILITY:
         {
-            const qreal avail = availability();
+            const qreal avail = m_tree.availability(m_node);
             if (avail < 0)
                 return tr("N/A");
 
@@ -149,23 +97,20 @@ QString TorrentContentModelItem::displayData(const int column) const
 
 QVariant TorrentContentModelItem::underlyingData(const int column) const
 {
-    if (isRootItem())
-        return m_itemData.value(column);
-
     switch (column)
     {
     case COL_NAME:
-        return m_name;
+        return m_tree.name(m_node);
     case COL_PRIO:
-        return static_cast<int>(m_priority);
+        return static_cast<int>(m_tree.priority(m_node));
     case COL_PROGRESS:
-        return progress() * 100;
+        return m_tree.progress(m_node) * 100;
     case COL_SIZE:
-        return m_size;
+        return m_tree.size(m_node);
     case COL_REMAINING:
-        return remaining();
+        return m_tree.remaining(m_node);
     case COL_AVAILABILITY:
-        return availability();
+        return m_tree.availability(m_node);
     default:
         Q_UNREACHABLE();
         break;
@@ -173,15 +118,3 @@ QVariant TorrentContentModelItem::underlyingData(const int column) const
 
     return {};
 }
-
-int TorrentContentModelItem::row() const
-{
-    if (m_parentItem)
-        return m_parentItem->children().indexOf(const_cast<TorrentContentModelItem *>(this));
-    return 0;
-}
-
-TorrentContentModelFolder *TorrentContentModelItem::parent() const
-{
-    return m_parentItem;
-}
@@ -29,14 +29,12 @@
 #pragma once
 
 #include <QCoreApplication>
-#include <QList>
 
-#include "base/bittorrent/downloadpriority.h"
+#include "torrentcontenttree.h"
 
 class QVariant;
 
-class TorrentContentModelFolder;
-
+// Lightweight view of a single item of TorrentContentTree
 class TorrentContentModelItem
 {
     Q_DECLARE_TR_FUNCTIONS(TorrentContentModelItem)
@@ -59,39 +57,14 @@ public:
         FolderType
     };
 
-    explicit TorrentContentModelItem(TorrentContentModelFolder *parent);
-    virtual ~TorrentContentModelItem();
-
-    bool isRootItem() const;
-    TorrentContentModelFolder *parent() const;
-    virtual ItemType itemType() const = 0;
-
-    QString name() const;
-    void setName(const QString &name);
-
-    qulonglong size() const;
-    qreal progress() const;
-    qulonglong remaining() const;
-
-    qreal availability() const;
+    TorrentContentModelItem(const TorrentContentTree &tree, TorrentContentTree::NodeID node);
 
-    BitTorrent::DownloadPriority priority() const;
-    virtual void setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent = true) = 0;
+    ItemType itemType() const;
 
-    int columnCount() const;
     QString displayData(int column) const;
     QVariant underlyingData(int column) const;
-    int row() const;
 
-protected:
-    TorrentContentModelFolder *m_parentItem = nullptr;
-    // Root item members
-    QList<QString> m_itemData;
-    // Non-root item members
-    QString m_name;
-    qulonglong m_size = 0;
-    qulonglong m_remaining = 0;
-    BitTorrent::DownloadPriority m_priority = BitTorrent::DownloadPriority::Normal;
-    qreal m_progress = 0;
-    qreal m_availability = -1;
+private:
+    const TorrentContentTree &m_tree;
+    TorrentContentTree::NodeID m_node;
 };
@@ -0,0 +1,405 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "torrentcontenttree.h"
+
+#include <QHash>
+
+#include "base/bittorrent/abstractfilestorage.h"
+#include "base/path.h"
+
+void TorrentContentTree::build(const BitTorrent::AbstractFileStorage &fileStorage)
+{
+    clear();
+
+    const int filesCount = fileStorage.filesCount();
+    m_nodes.reserve(filesCount + 1);
+    m_fileNodes.reserve(filesCount);
+
+    int folderCount = 0;
+    addNode(-1, {}, true, folderCount++, 0);
+
+    // Folders are looked up by their path, but only when it differs from the path of the previous file
+    QHash<QString, NodeID> folders;
+    QString lastFolderPath;
+    NodeID lastFolder = ROOT_NODE;
+    for (int i = 0; i < filesCount; ++i)
+    {
+        const QString filePath = fileStorage.filePath(i).data();
+        const qsizetype separatorPos = filePath.lastIndexOf(u'/');
+        const QStringView folderPath = (separatorPos >= 0) ? QStringView(filePath).first(separatorPos) : QStringView();
+        const QStringView fileName = QStringView(filePath).sliced(separatorPos + 1);
+
+        if (folderPath != lastFolderPath)
+        {
+            lastFolderPath = folderPath.toString();
+            lastFolder = ROOT_NODE;
+
+            qsizetype partStart = 0;
+            while (partStart < lastFolderPath.size())
+            {
+                qsizetype partEnd = lastFolderPath.indexOf(u'/', partStart);
+                if (partEnd < 0)
+                    partEnd = lastFolderPath.size();
+
+                if (partEnd > partStart)
+                {
+                    NodeID &folder = folders[lastFolderPath.first(partEnd)];
+                    if (folder == ROOT_NODE) // i.e. not created yet
+                    {
+                        const QStringView folderName = QStringView(lastFolderPath).sliced(partStart, (partEnd - partStart));
+                        folder = addNode(lastFolder, folderName, true, folderCount++, 0);
+                    }
+                    lastFolder = folder;
+                }
+
+                partStart = partEnd + 1;
+            }
+        }
+
+        const qint64 fileSize = fileStorage.fileSize(i);
+        m_fileNodes.push_back(addNode(lastFolder, fileName, false, i, fileSize));
+        for (NodeID folder = lastFolder; folder >= 0; folder = m_nodes[folder].parent)
+            m_nodes[folder].size += fileSize;
+    }
+
+    // Lay out children of each folder as a contiguous range, in order of appearance
+    int childrenOffset = 0;
+    for (Node &node : m_nodes)
+    {
+        node.firstChild = childrenOffset;
+        childrenOffset += node.childCount;
+        node.childCount = 0;
+    }
+
+    m_children.resize(childrenOffset);
+    for (NodeID id = ROOT_NODE + 1; id < nodeCount(); ++id)
+    {
+        Node &node = m_nodes[id];
+        Node &parentNode = m_nodes[node.parent];
+        node.row = parentNode.childCount++;
+        m_children[parentNode.firstChild + node.row] = id;
+    }
+
+    m_namePool.squeeze();
+    m_filesProgress.assign(filesCount, 0);
+    m_filesAvailability.assign(filesCount, -1);
+    m_filePriorities.assign(filesCount, BitTorrent::DownloadPriority::Normal);
+    m_folderStats.assign(folderCount, {});
+}
+
+void TorrentContentTree::clear()
+{
+    m_nodes.clear();
+    m_children.clear();
+    m_namePool.clear();
+    m_fileNodes.clear();
+    m_filesProgress.clear();
+    m_filesAvailability.clear();
+    m_filePriorities.clear();
+    m_folderStats.clear();
+}
+
+bool TorrentContentTree::isEmpty() const
+{
+    return m_fileNodes.empty();
+}
+
+int TorrentContentTree::nodeCount() const
+{
+    return static_cast<int>(m_nodes.size());
+}
+
+int TorrentContentTree::filesCount() const
+{
+    return static_cast<int>(m_fileNodes.size());
+}
+
+TorrentContentTree::NodeID TorrentContentTree::parent(const NodeID node) const
+{
+    return m_nodes[node].parent;
+}
+
+int TorrentContentTree::row(const NodeID node) const
+{
+    return m_nodes[node].row;
+}
+
+int TorrentContentTree::childCount(const NodeID node) const
+{
+    return m_nodes[node].childCount;
+}
+
+TorrentContentTree::NodeID TorrentContentTree::child(const NodeID node, const int row) const
+{
+    Q_ASSERT((row >= 0) && (row < m_nodes[node].childCount));
+    return m_children[m_nodes[node].firstChild + row];
+}
+
+bool TorrentContentTree::isFolder(const NodeID node) const
+{
+    return m_nodes[node].isFolder;
+}
+
+int TorrentContentTree::fileIndex(const NodeID node) const
+{
+    const Node &item = m_nodes[node];
+    return item.isFolder ? -1 : item.index;
+}
+
+TorrentContentTree::NodeID TorrentContentTree::fileNode(const int fileIndex) const
+{
+    return m_fileNodes[fileIndex];
+}
+
+QString TorrentContentTree::name(const NodeID node) const
+{
+    const Node &item = m_nodes[node];
+    return m_namePool.sliced(item.nameOffset, item.nameLength);
+}
+
+void TorrentContentTree::setName(const NodeID node, const QString &name)
+{
+    // The old name is left in the pool since renaming is rare
+    Node &item = m_nodes[node];
+    item.nameOffset = static_cast<qint32>(m_namePool.size());
+    item.nameLength = static_cast<qint32>(name.size());
+    m_namePool.append(name);
+}
+
+Path TorrentContentTree::path(const NodeID node) const
+{
+    Path path;
+    for (NodeID id = node; id > ROOT_NODE; id = m_nodes[id].parent)
+        path = Path(name(id)) / path;
+    return path;
+}
+
+qint64 TorrentContentTree::size(const NodeID node) const
+{
+    return m_nodes[node].size;
+}
+
+qreal TorrentContentTree::progress(const NodeID node) const
+{
+    const Node &item = m_nodes[node];
+    if (item.size <= 0)
+        return 1;
+
+    return item.isFolder ? folderStats(node).progress : m_filesProgress[item.index];
+}
+
+qint64 TorrentContentTree::remaining(const NodeID node) const
+{
+    if (priority(node) == BitTorrent::DownloadPriority::Ignored)
+        return 0;
+
+    const Node &item = m_nodes[node];
+    return item.isFolder
+        ? folderStats(node).remaining
+        : static_cast<qint64>(item.size * (1.0 - m_filesProgress[item.index]));
+}
+
+qreal TorrentContentTree::availability(const NodeID node) const
+{
+    const Node &item = m_nodes[node];
+    if (item.size <= 0)
+        return 0;
+
+    return item.isFolder ? folderStats(node).availability : m_filesAvailability[item.index];
+}
+
+BitTorrent::DownloadPriority TorrentContentTree::priority(const NodeID node) const
+{
+    const Node &item = m_nodes[node];
+    return item.isFolder ? folderStats(node).priority : m_filePriorities[item.index];
+}
+
+bool TorrentContentTree::hasIgnoredFiles(const NodeID node) const
+{
+    const Node &item = m_nodes[node];
+    return item.isFolder
+        ? folderStats(node).hasIgnoredFiles
+        : (m_filePriorities[item.index] == BitTorrent::DownloadPriority::Ignored);
+}
+
+bool TorrentContentTree::setFileProgress(const int fileIndex, const qreal progress)
+{
+    Q_ASSERT(progress <= 1.);
+
+    if (m_filesProgress[fileIndex] == progress)
+        return false;
+
+    m_filesProgress[fileIndex] = progress;
+    invalidateAncestors(m_fileNodes[fileIndex]);
+    return true;
+}
+
+bool TorrentContentTree::setFileAvailability(const int fileIndex, const qreal availability)
+{
+    Q_ASSERT(availability <= 1.);
+
+    if (m_filesAvailability[fileIndex] == availability)
+        return false;
+
+    m_filesAvailability[fileIndex] = availability;
+    invalidateAncestors(m_fileNodes[fileIndex]);
+    return true;
+}
+
+bool TorrentContentTree::setFilePriority(const int fileIndex, const BitTorrent::DownloadPriority priority)
+{
+    Q_ASSERT(priority != BitTorrent::DownloadPriority::Mixed);
+
+    if (m_filePriorities[fileIndex] == priority)
+        return false;
+
+    m_filePriorities[fileIndex] = priority;
+    invalidateAncestors(m_fileNodes[fileIndex]);
+    return true;
+}
+
+bool TorrentContentTree::setPriority(const NodeID node, const BitTorrent::DownloadPriority priority)
+{
+    if (!m_nodes[node].isFolder)
+        return setFilePriority(m_nodes[node].index, priority);
+
+    // Priority of a folder is derived from its files
+    if (priority == BitTorrent::DownloadPriority::Mixed)
+        return false;
+
+    bool isChanged = false;
+    std::vector<NodeID> folders {node};
+    while (!folders.empty())
+    {
+        const Node &folder = m_nodes[folders.back()];
+        folders.pop_back();
+
+        for (int i = folder.firstChild; i < (folder.firstChild + folder.childCount); ++i)
+        {
+            const Node &child = m_nodes[m_children[i]];
+            if (child.isFolder)
+                folders.push_back(m_children[i]);
+            else if (setFilePriority(child.index, priority))
+                isChanged = true;
+        }
+    }
+
+    return isChanged;
+}
+
+QList<BitTorrent::DownloadPriority> TorrentContentTree::filePriorities() const
+{
+    return {m_filePriorities.cbegin(), m_filePriorities.cend()};
+}
+
+TorrentContentTree::NodeID TorrentContentTree::addNode(const NodeID parent, const QStringView name
+        , const bool isFolder, const int index, const qint64 size)
+{
+    const auto nameOffset = static_cast<qint32>(m_namePool.size());
+    m_namePool.append(name);
+    m_nodes.push_back({.parent = parent, .nameOffset = nameOffset, .nameLength = static_cast<qint32>(name.size())
+            , .index = index, .isFolder = isFolder, .size = size});
+    if (parent >= 0)
+        ++m_nodes[parent].childCount;
+
+    return (nodeCount() - 1);
+}
+
+void TorrentContentTree::invalidateAncestors(const NodeID node)
+{
+    // Stats of a folder are only valid if stats of all its subfolders are valid,
+    // so there is no need to go up further than the first invalid one
+    for (NodeID id = m_nodes[node].parent; id >= 0; id = m_nodes[id].parent)
+    {
+        FolderStats &stats = m_folderStats[m_nodes[id].index];
+        if (!stats.isValid)
+            break;
+
+        stats.isValid = false;
+    }
+}
+
+const TorrentContentTree::FolderStats &TorrentContentTree::folderStats(const NodeID node) const
+{
+    const Node &folder = m_nodes[node];
+    Q_ASSERT(folder.isFolder);
+
+    FolderStats &stats = m_folderStats[folder.index];
+    if (stats.isValid)
+        return stats;
+
+    const int childrenBegin = folder.firstChild;
+    const int childrenEnd = folder.firstChild + folder.childCount;
+
+    // If all children have the same priority then the folder has the same priority
+    stats.priority = priority(m_children[childrenBegin]);
+    stats.hasIgnoredFiles = false;
+    for (int i = childrenBegin; i < childrenEnd; ++i)
+    {
+        const NodeID child = m_children[i];
+        if (priority(child) != stats.priority)
+            stats.priority = BitTorrent::DownloadPriority::Mixed;
+        if (hasIgnoredFiles(child))
+            stats.hasIgnoredFiles = true;
+    }
+
+    // Ignored items don't affect progress of the folder unless it is ignored as a whole
+    const bool isIgnored = (stats.priority == BitTorrent::DownloadPriority::Ignored);
+    qreal totalProgress = 0;
+    qreal totalAvailability = 0;
+    qint64 totalSize = 0;
+    qint64 totalRemaining = 0;
+    bool foundAnyAvailability = false;
+    for (int i = childrenBegin; i < childrenEnd; ++i)
+    {
+        const NodeID child = m_children[i];
+        if (!isIgnored && (priority(child) == BitTorrent::DownloadPriority::Ignored))
+            continue;
+
+        const qint64 childSize = size(child);
+        totalProgress += progress(child) * childSize;
+        totalRemaining += remaining(child);
+        totalSize += childSize;
+
+        // -1 means "no data"
+        if (const qreal childAvailability = availability(child); childAvailability >= 0)
+        {
+            totalAvailability += childAvailability * childSize;
+            foundAnyAvailability = true;
+        }
+    }
+
+    stats.progress = (totalSize > 0) ? (totalProgress / totalSize) : 1;
+    stats.remaining = (totalSize > 0) ? totalRemaining : 0;
+    stats.availability = ((totalSize > 0) && foundAnyAvailability) ? (totalAvailability / totalSize) : -1;
+    Q_ASSERT(stats.progress <= 1.);
+
+    stats.isValid = true;
+    return stats;
+}
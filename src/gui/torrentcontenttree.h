@@ -0,0 +1,129 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <QtTypes>
+#include <QList>
+#include <QString>
+
+#include "base/bittorrent/downloadpriority.h"
+#include "base/pathfwd.h"
+
+namespace BitTorrent
+{
+    class AbstractFileStorage;
+}
+
+// Flat file tree of torrent content.
+// Nodes live in a single array and refer to each other by index, children of a folder
+// occupy a contiguous range of the child list and all names share one string pool.
+// Folder progress, availability and priority are computed on demand and cached
+// until any file below the folder changes.
+class TorrentContentTree
+{
+public:
+    using NodeID = int;
+
+    static constexpr NodeID ROOT_NODE = 0;
+
+    void build(const BitTorrent::AbstractFileStorage &fileStorage);
+    void clear();
+    bool isEmpty() const;
+
+    int nodeCount() const;
+    int filesCount() const;
+
+    NodeID parent(NodeID node) const;
+    int row(NodeID node) const;
+    int childCount(NodeID node) const;
+    NodeID child(NodeID node, int row) const;
+    bool isFolder(NodeID node) const;
+    int fileIndex(NodeID node) const; // -1 for folders
+    NodeID fileNode(int fileIndex) const;
+
+    QString name(NodeID node) const;
+    void setName(NodeID node, const QString &name);
+    Path path(NodeID node) const;
+
+    qint64 size(NodeID node) const;
+    qreal progress(NodeID node) const;
+    qint64 remaining(NodeID node) const;
+    qreal availability(NodeID node) const;
+    BitTorrent::DownloadPriority priority(NodeID node) const;
+    bool hasIgnoredFiles(NodeID node) const;
+
+    // Return whether the value was changed
+    bool setFileProgress(int fileIndex, qreal progress);
+    bool setFileAvailability(int fileIndex, qreal availability);
+    bool setFilePriority(int fileIndex, BitTorrent::DownloadPriority priority);
+    bool setPriority(NodeID node, BitTorrent::DownloadPriority priority);
+
+    QList<BitTorrent::DownloadPriority> filePriorities() const;
+
+private:
+    struct Node
+    {
+        NodeID parent = -1;
+        int row = 0;
+        qint32 nameOffset = 0;
+        qint32 nameLength = 0;
+        int firstChild = 0; // offset in m_children
+        int childCount = 0;
+        int index = -1; // file index for files, folder index for folders
+        bool isFolder = false;
+        qint64 size = 0;
+    };
+
+    struct FolderStats
+    {
+        qreal progress = 0;
+        qint64 remaining = 0;
+        qreal availability = -1;
+        BitTorrent::DownloadPriority priority = BitTorrent::DownloadPriority::Normal;
+        bool hasIgnoredFiles = false;
+        bool isValid = false;
+    };
+
+    NodeID addNode(NodeID parent, QStringView name, bool isFolder, int index, qint64 size);
+    void invalidateAncestors(NodeID node);
+    const FolderStats &folderStats(NodeID node) const;
+
+    std::vector<Node> m_nodes;
+    std::vector<NodeID> m_children;
+    QString m_namePool;
+
+    std::vector<NodeID> m_fileNodes;
+    std::vector<qreal> m_filesProgress;
+    std::vector<qreal> m_filesAvailability;
+    std::vector<BitTorrent::DownloadPriority> m_filePriorities;
+
+    mutable std::vector<FolderStats> m_folderStats;
+};
@@ -0,0 +1,301 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "transferlistsortkeys.h"
+
+#include <limits>
+#include <type_traits>
+
+#include <QDateTime>
+#include <QVariant>
+
+#include "base/bittorrent/infohash.h"
+#include "transferlistmodel.h"
+
+namespace
+{
+    template <typename T>
+    int threeWayCompare(const T &left, const T &right)
+    {
+        if (left == right)
+            return 0;
+        return (left < right) ? -1 : 1;
+    }
+
+    template <typename T>
+    int customCompare(const T left, const T right)
+    {
+        static_assert(std::is_arithmetic_v<T>);
+
+        const bool isLeftValid = (left >= 0);
+        const bool isRightValid = (right >= 0);
+
+        if (isLeftValid && isRightValid)
+            return threeWayCompare(left, right);
+        if (!isLeftValid && !isRightValid)
+            return 0;
+        return isLeftValid ? -1 : 1;
+    }
+
+    int customCompare(const TagSet &left, const TagSet &right, const Utils::Compare::NaturalCompare<Qt::CaseInsensitive> &compare)
+    {
+        for (auto leftIter = left.cbegin(), rightIter = right.cbegin();
+             (leftIter != left.cend()) && (rightIter != right.cend());
+             ++leftIter, ++rightIter)
+        {
+            const int result = compare(leftIter->toString(), rightIter->toString());
+            if (result != 0)
+                return result;
+        }
+        return threeWayCompare(left.size(), right.size());
+    }
+
+    // Invalid dates come last
+    qint64 dateTimeKey(const QDateTime &dateTime)
+    {
+        return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+    }
+
+    // Unknown values come last
+    qint64 boolKey(const QVariant &value)
+    {
+        return value.isValid() ? (value.toBool() ? 1 : 0) : 2;
+    }
+
+    // Active peers/seeds take precedence over total peers/seeds
+    qint64 peersKey(const QVariant &active, const QVariant &total)
+    {
+        return (static_cast<qint64>(active.toInt()) << 32) | static_cast<quint32>(total.toInt());
+    }
+}
+
+TransferListSortKeys::TransferListSortKeys(const int column)
+    : m_column {column}
+{
+    switch (m_column)
+    {
+    case TransferListModel::TR_CATEGORY:
+    case TransferListModel::TR_DOWNLOAD_PATH:
+    case TransferListModel::TR_NAME:
+    case TransferListModel::TR_SAVE_PATH:
+    case TransferListModel::TR_TRACKER:
+        m_keyType = KeyType::NaturalString;
+        break;
+
+    case TransferListModel::TR_INFOHASH_V1:
+    case TransferListModel::TR_INFOHASH_V2:
+        m_keyType = KeyType::OrdinalString;
+        break;
+
+    case TransferListModel::TR_TAGS:
+        m_keyType = KeyType::Tags;
+        break;
+
+    case TransferListModel::TR_AMOUNT_DOWNLOADED:
+    case TransferListModel::TR_AMOUNT_DOWNLOADED_SESSION:
+    case TransferListModel::TR_AMOUNT_LEFT:
+    case TransferListModel::TR_AMOUNT_UPLOADED:
+    case TransferListModel::TR_AMOUNT_UPLOADED_SESSION:
+    case TransferListModel::TR_COMPLETED:
+    case TransferListModel::TR_ETA:
+    case TransferListModel::TR_LAST_ACTIVITY:
+    case TransferListModel::TR_REANNOUNCE:
+    case TransferListModel::TR_SIZE:
+    case TransferListModel::TR_TIME_ELAPSED:
+    case TransferListModel::TR_TOTAL_SIZE:
+    case TransferListModel::TR_DLLIMIT:
+    case TransferListModel::TR_DLSPEED:
+    case TransferListModel::TR_QUEUE_POSITION:
+    case TransferListModel::TR_UPLIMIT:
+    case TransferListModel::TR_UPSPEED:
+        m_keyType = KeyType::OptionalInteger;
+        break;
+
+    case TransferListModel::TR_AVAILABILITY:
+    case TransferListModel::TR_PROGRESS:
+    case TransferListModel::TR_RATIO:
+    case TransferListModel::TR_RATIO_LIMIT:
+    case TransferListModel::TR_POPULARITY:
+        m_keyType = KeyType::OptionalReal;
+        break;
+
+    case TransferListModel::TR_STATUS:
+    case TransferListModel::TR_CREATE_DATE:
+    case TransferListModel::TR_ADD_DATE:
+    case TransferListModel::TR_SEED_DATE:
+    case TransferListModel::TR_SEEN_COMPLETE_DATE:
+    case TransferListModel::TR_PRIVATE:
+    case TransferListModel::TR_PEERS:
+    case TransferListModel::TR_SEEDS:
+        m_keyType = KeyType::Integer;
+        break;
+
+    default:
+        Q_ASSERT_X(false, Q_FUNC_INFO, "Missing comparison case");
+        break;
+    }
+}
+
+int TransferListSortKeys::column() const
+{
+    return m_column;
+}
+
+qsizetype TransferListSortKeys::size() const
+{
+    switch (m_keyType)
+    {
+    case KeyType::NaturalString:
+    case KeyType::OrdinalString:
+        return static_cast<qsizetype>(m_strings.size());
+    case KeyType::Tags:
+        return static_cast<qsizetype>(m_tags.size());
+    case KeyType::Integer:
+    case KeyType::OptionalInteger:
+        return static_cast<qsizetype>(m_integers.size());
+    case KeyType::OptionalReal:
+        return static_cast<qsizetype>(m_reals.size());
+    }
+
+    return 0;
+}
+
+template <typename Func>
+void TransferListSortKeys::visitKeys(Func func)
+{
+    switch (m_keyType)
+    {
+    case KeyType::NaturalString:
+    case KeyType::OrdinalString:
+        func(m_strings);
+        break;
+    case KeyType::Tags:
+        func(m_tags);
+        break;
+    case KeyType::Integer:
+    case KeyType::OptionalInteger:
+        func(m_integers);
+        break;
+    case KeyType::OptionalReal:
+        func(m_reals);
+        break;
+    }
+}
+
+void TransferListSortKeys::insertRows(const qsizetype first, const qsizetype count)
+{
+    Q_ASSERT((first >= 0) && (first <= size()) && (count >= 0));
+
+    visitKeys([first, count](auto &keys)
+    {
+        using KeyT = typename std::remove_reference_t<decltype(keys)>::value_type;
+        keys.insert((keys.begin() + first), static_cast<std::size_t>(count), KeyT {});
+    });
+}
+
+void TransferListSortKeys::removeRows(const qsizetype first, const qsizetype count)
+{
+    Q_ASSERT((first >= 0) && (count >= 0) && ((first + count) <= size()));
+
+    visitKeys([first, count](auto &keys)
+    {
+        keys.erase((keys.begin() + first), (keys.begin() + first + count));
+    });
+}
+
+void TransferListSortKeys::setKey(const qsizetype row, const QVariant &value, const QVariant &additionalValue)
+{
+    Q_ASSERT((row >= 0) && (row < size()));
+
+    switch (m_column)
+    {
+    case TransferListModel::TR_INFOHASH_V1:
+        m_strings[row] = value.value<SHA1Hash>().toString();
+        break;
+    case TransferListModel::TR_INFOHASH_V2:
+        m_strings[row] = value.value<SHA256Hash>().toString();
+        break;
+    case TransferListModel::TR_TAGS:
+        m_tags[row] = value.value<TagSet>();
+        break;
+    case TransferListModel::TR_CREATE_DATE:
+    case TransferListModel::TR_ADD_DATE:
+    case TransferListModel::TR_SEED_DATE:
+    case TransferListModel::TR_SEEN_COMPLETE_DATE:
+        m_integers[row] = dateTimeKey(value.toDateTime());
+        break;
+    case TransferListModel::TR_PRIVATE:
+        m_integers[row] = boolKey(value);
+        break;
+    case TransferListModel::TR_PEERS:
+    case TransferListModel::TR_SEEDS:
+        m_integers[row] = peersKey(value, additionalValue);
+        break;
+    default:
+        switch (m_keyType)
+        {
+        case KeyType::NaturalString:
+        case KeyType::OrdinalString:
+            m_strings[row] = value.toString();
+            break;
+        case KeyType::Integer:
+        case KeyType::OptionalInteger:
+            m_integers[row] = value.toLongLong();
+            break;
+        case KeyType::OptionalReal:
+            m_reals[row] = value.toReal();
+            break;
+        case KeyType::Tags:
+            break;
+        }
+        break;
+    }
+}
+
+int TransferListSortKeys::compare(const qsizetype leftRow, const qsizetype rightRow) const
+{
+    Q_ASSERT((leftRow >= 0) && (leftRow < size()) && (rightRow >= 0) && (rightRow < size()));
+
+    switch (m_keyType)
+    {
+    case KeyType::NaturalString:
+        return m_naturalCompare(m_strings[leftRow], m_strings[rightRow]);
+    case KeyType::OrdinalString:
+        return threeWayCompare(m_strings[leftRow], m_strings[rightRow]);
+    case KeyType::Tags:
+        return customCompare(m_tags[leftRow], m_tags[rightRow], m_naturalCompare);
+    case KeyType::Integer:
+        return threeWayCompare(m_integers[leftRow], m_integers[rightRow]);
+    case KeyType::OptionalInteger:
+        return customCompare(m_integers[leftRow], m_integers[rightRow]);
+    case KeyType::OptionalReal:
+        return customCompare(m_reals[leftRow], m_reals[rightRow]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <QtTypes>
+#include <QString>
+
+#include "base/tagset.h"
+#include "base/utils/compare.h"
+
+class QVariant;
+
+// Sort keys of a single TransferListModel column, stored by source row in arrays of their
+// natural type, so comparing two rows doesn't convert QVariants or copy strings.
+class TransferListSortKeys
+{
+public:
+    explicit TransferListSortKeys(int column);
+
+    int column() const;
+    qsizetype size() const;
+
+    void insertRows(qsizetype first, qsizetype count);
+    void removeRows(qsizetype first, qsizetype count);
+    // `value` and `additionalValue` are the row data of `UnderlyingDataRole` and `AdditionalUnderlyingDataRole`
+    void setKey(qsizetype row, const QVariant &value, const QVariant &additionalValue = {});
+
+    int compare(qsizetype leftRow, qsizetype rightRow) const;
+
+private:
+    enum class KeyType
+    {
+        NaturalString,
+        OrdinalString,
+        Tags,
+        Integer,
+        OptionalInteger, // negative values mean "not available" and come last
+        OptionalReal // negative values mean "not available" and come last
+    };
+
+    template <typename Func>
+    void visitKeys(Func func);
+
+    int m_column = -1;
+    KeyType m_keyType = KeyType::Integer;
+    std::vector<QString> m_strings;
+    std::vector<TagSet> m_tags;
+    std::vector<qint64> m_integers;
+    std::vector<double> m_reals;
+
+    Utils::Compare::NaturalCompare<Qt::CaseInsensitive> m_naturalCompare;
+};
@@ -28,74 +28,15 @@
 
 #include "transferlistsortmodel.h"
 
-#include <type_traits>
+#include <algorithm>
 
 #include <QtVersionChecks>
-#include <QDateTime>
 
-#include "base/bittorrent/infohash.h"
 #include "base/bittorrent/torrent.h"
 #include "transferlistmodel.h"
 
 namespace
 {
-    template <typename T>
-    int threeWayCompare(const T &left, const T &right)
-    {
-        if (left == right)
-            return 0;
-        return (left < right) ? -1 : 1;
-    }
-
-    int customCompare(const QDateTime &left, const QDateTime &right)
-    {
-        const bool isLeftValid = left.isValid();
-        const bool isRightValid = right.isValid();
-
-        if (isLeftValid == isRightValid)
-            return threeWayCompare(left, right);
-        return isLeftValid ? -1 : 1;
-    }
-
-    int customCompare(const TagSet &left, const TagSet &right, const Utils::Compare::NaturalCompare<Qt::CaseInsensitive> &compare)
-    {
-        for (auto leftIter = left.cbegin(), rightIter = right.cbegin();
-             (leftIter != left.cend()) && (rightIter != right.cend());
-             ++leftIter, ++rightIter)
-        {
-            const int result = compare(leftIter->toString(), rightIter->toString());
-            if (result != 0)
-                return result;
-        }
-        return threeWayCompare(left.size(), right.size());
-    }
-
-    template <typename T>
-    int customCompare(const T left, const T right)
-    {
-        static_assert(std::is_arithmetic_v<T>);
-
-        const bool isLeftValid = (left >= 0);
-        const bool isRightValid = (right >= 0);
-
-        if (isLeftValid && isRightValid)
-            return threeWayCompare(left, right);
-        if (!isLeftValid && !isRightValid)
-            return 0;
-        return isLeftValid ? -1 : 1;
-    }
-
-    int compareAsBool(const QVariant &left, const QVariant &right)
-    {
-        const bool leftValid = left.isValid();
-        const bool rightValid = right.isValid();
-        if (leftValid && rightValid)
-            return threeWayCompare(left.toBool(), right.toBool());
-        if (!leftValid && !rightValid)
-            return 0;
-        return leftValid ? -1 : 1;
-    }
-
     int adjustSubSortColumn(const int column)
     {
         return ((column >= 0) && (column < TransferListModel::NB_COLUMNS))
@@ -109,6 +50,37 @@ TransferListSortModel::TransferListSortModel(QObject *parent)
     , m_subSortOrder {u"TransferList/SubSortOrder"_s, 0}
 {
     setSortRole(TransferListModel::UnderlyingDataRole);
+    m_sortKeys.reserve(2);
+}
+
+void TransferListSortModel::setSourceModel(TransferListModel *model)
+{
+    if (model == m_model)
+        return;
+
+    if (m_model)
+        m_model->disconnect(this);
+
+    m_model = model;
+    m_sortKeys.clear();
+
+    // Connect before QSortFilterProxyModel does, so the keys are up to date when it re-sorts the changed rows
+    if (m_model)
+    {
+        connect(m_model, &QAbstractItemModel::dataChanged, this, &TransferListSortModel::handleSourceDataChanged);
+        connect(m_model, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &, const int first, const int last)
+        {
+            handleSourceRowsInserted(first, last);
+        });
+        connect(m_model, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex &, const int first, const int last)
+        {
+            handleSourceRowsRemoved(first, last);
+        });
+        connect(m_model, &QAbstractItemModel::modelReset, this, [this] { m_sortKeys.clear(); });
+        connect(m_model, &QAbstractItemModel::layoutChanged, this, [this] { m_sortKeys.clear(); });
+    }
+
+    QSortFilterProxyModel::setSourceModel(m_model);
 }
 
 void TransferListSortModel::sort(const int column, const Qt::SortOrder order)
@@ -121,6 +93,11 @@ void TransferListSortModel::sort(const int column, const Qt::SortOrder order)
     m_lastSortColumn = column;
     m_lastSortOrder = ((order == Qt::AscendingOrder) ? 0 : 1);
 
+    std::erase_if(m_sortKeys, [this, column](const TransferListSortKeys &keys)
+    {
+        return (keys.column() != column) && (keys.column() != m_subSortColumn);
+    });
+
     QSortFilterProxyModel::sort(column, order);
 }
 
@@ -210,88 +187,75 @@ void TransferListSortModel::setAnnounceStatusFilter(const std::optional<BitTorre
 
 int TransferListSortModel::compare(const QModelIndex &left, const QModelIndex &right) const
 {
-    const int compareColumn = left.column();
-    const QVariant leftValue = left.data(TransferListModel::UnderlyingDataRole);
-    const QVariant rightValue = right.data(TransferListModel::UnderlyingDataRole);
+    return sortKeys(left.column()).compare(left.row(), right.row());
+}
+
+const TransferListSortKeys &TransferListSortModel::sortKeys(const int column) const
+{
+    const int rowCount = m_model ? m_model->rowCount() : 0;
+
+    const auto iter = std::ranges::find_if(m_sortKeys, [column](const TransferListSortKeys &keys)
+    {
+        return keys.column() == column;
+    });
+    if ((iter != m_sortKeys.end()) && (iter->size() == rowCount))
+        return *iter;
+
+    TransferListSortKeys &keys = (iter != m_sortKeys.end()) ? *iter : m_sortKeys.emplace_back(column);
+    keys.removeRows(0, keys.size());
+    keys.insertRows(0, rowCount);
+    updateSortKeys(keys, 0, (rowCount - 1));
+    return keys;
+}
+
+void TransferListSortModel::updateSortKeys(TransferListSortKeys &keys, const int first, const int last) const
+{
+    const bool hasAdditionalData = (keys.column() == TransferListModel::TR_PEERS) || (keys.column() == TransferListModel::TR_SEEDS);
+    for (int row = first; row <= last; ++row)
+    {
+        const QModelIndex index = m_model->index(row, keys.column());
+        keys.setKey(row, index.data(TransferListModel::UnderlyingDataRole)
+                , (hasAdditionalData ? index.data(TransferListModel::AdditionalUnderlyingDataRole) : QVariant()));
+    }
+}
+
+void TransferListSortModel::handleSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    if (!roles.isEmpty() && !roles.contains(TransferListModel::UnderlyingDataRole)
+            && !roles.contains(TransferListModel::AdditionalUnderlyingDataRole))
+    {
+        return;
+    }
 
-    switch (compareColumn)
+    for (TransferListSortKeys &keys : m_sortKeys)
     {
-    case TransferListModel::TR_CATEGORY:
-    case TransferListModel::TR_DOWNLOAD_PATH:
-    case TransferListModel::TR_NAME:
-    case TransferListModel::TR_SAVE_PATH:
-    case TransferListModel::TR_TRACKER:
-        return m_naturalCompare(leftValue.toString(), rightValue.toString());
-
-    case TransferListModel::TR_INFOHASH_V1:
-        return threeWayCompare(leftValue.value<SHA1Hash>(), rightValue.value<SHA1Hash>());
-
-    case TransferListModel::TR_INFOHASH_V2:
-        return threeWayCompare(leftValue.value<SHA256Hash>(), rightValue.value<SHA256Hash>());
-
-    case TransferListModel::TR_TAGS:
-        return customCompare(leftValue.value<TagSet>(), rightValue.value<TagSet>(), m_naturalCompare);
-
-    case TransferListModel::TR_AMOUNT_DOWNLOADED:
-    case TransferListModel::TR_AMOUNT_DOWNLOADED_SESSION:
-    case TransferListModel::TR_AMOUNT_LEFT:
-    case TransferListModel::TR_AMOUNT_UPLOADED:
-    case TransferListModel::TR_AMOUNT_UPLOADED_SESSION:
-    case TransferListModel::TR_COMPLETED:
-    case TransferListModel::TR_ETA:
-    case TransferListModel::TR_LAST_ACTIVITY:
-    case TransferListModel::TR_REANNOUNCE:
-    case TransferListModel::TR_SIZE:
-    case TransferListModel::TR_TIME_ELAPSED:
-    case TransferListModel::TR_TOTAL_SIZE:
-        return customCompare(leftValue.toLongLong(), rightValue.toLongLong());
-
-    case TransferListModel::TR_AVAILABILITY:
-    case TransferListModel::TR_PROGRESS:
-    case TransferListModel::TR_RATIO:
-    case TransferListModel::TR_RATIO_LIMIT:
-    case TransferListModel::TR_POPULARITY:
-        return customCompare(leftValue.toReal(), rightValue.toReal());
-
-    case TransferListModel::TR_STATUS:
-        return threeWayCompare(leftValue.toInt(), rightValue.toInt());
-
-    case TransferListModel::TR_CREATE_DATE:
-    case TransferListModel::TR_ADD_DATE:
-    case TransferListModel::TR_SEED_DATE:
-    case TransferListModel::TR_SEEN_COMPLETE_DATE:
-        return customCompare(leftValue.toDateTime(), rightValue.toDateTime());
-
-    case TransferListModel::TR_DLLIMIT:
-    case TransferListModel::TR_DLSPEED:
-    case TransferListModel::TR_QUEUE_POSITION:
-    case TransferListModel::TR_UPLIMIT:
-    case TransferListModel::TR_UPSPEED:
-        return customCompare(leftValue.toInt(), rightValue.toInt());
-
-    case TransferListModel::TR_PRIVATE:
-        return compareAsBool(leftValue, rightValue);
-
-    case TransferListModel::TR_PEERS:
-    case TransferListModel::TR_SEEDS:
+        if ((keys.column() >= topLeft.column()) && (keys.column() <= bottomRight.column())
+                && (keys.size() == m_model->rowCount()))
         {
-            // Active peers/seeds take precedence over total peers/seeds
-            const auto activeL = leftValue.toInt();
-            const auto activeR = rightValue.toInt();
-            if (activeL != activeR)
-                return threeWayCompare(activeL, activeR);
-
-            const auto totalL = left.data(TransferListModel::AdditionalUnderlyingDataRole).toInt();
-            const auto totalR = right.data(TransferListModel::AdditionalUnderlyingDataRole).toInt();
-            return threeWayCompare(totalL, totalR);
+            updateSortKeys(keys, topLeft.row(), bottomRight.row());
         }
+    }
+}
 
-    default:
-        Q_ASSERT_X(false, Q_FUNC_INFO, "Missing comparison case");
-        break;
+void TransferListSortModel::handleSourceRowsInserted(const int first, const int last)
+{
+    for (TransferListSortKeys &keys : m_sortKeys)
+    {
+        if ((first > keys.size()) || ((keys.size() + (last - first + 1)) != m_model->rowCount()))
+            continue; // out of sync, will be rebuilt on next use
+
+        keys.insertRows(first, (last - first + 1));
+        updateSortKeys(keys, first, last);
     }
+}
 
-    return 0;
+void TransferListSortModel::handleSourceRowsRemoved(const int first, const int last)
+{
+    for (TransferListSortKeys &keys : m_sortKeys)
+    {
+        if ((last < keys.size()) && ((keys.size() - (last - first + 1)) == m_model->rowCount()))
+            keys.removeRows(first, (last - first + 1));
+    }
 }
 
 bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
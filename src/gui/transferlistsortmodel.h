@@ -28,17 +28,21 @@
 
 #pragma once
 
+#include <vector>
+
 #include <QSortFilterProxyModel>
 
 #include "base/settingvalue.h"
 #include "base/torrentfilter.h"
-#include "base/utils/compare.h"
+#include "transferlistsortkeys.h"
 
 namespace BitTorrent
 {
     class InfoHash;
 }
 
+class TransferListModel;
+
 class TransferListSortModel final : public QSortFilterProxyModel
 {
     Q_OBJECT
@@ -47,6 +51,7 @@ class TransferListSortModel final : public QSortFilterProxyModel
 public:
     explicit TransferListSortModel(QObject *parent = nullptr);
 
+    void setSourceModel(TransferListModel *model);
     void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
 
     void setStatusFilter(TorrentFilter::Status status);
@@ -58,7 +63,14 @@ public:
     void setAnnounceStatusFilter(const std::optional<BitTorrent::TorrentAnnounceStatus> &announceStatus);
 
 private:
+    using QSortFilterProxyModel::setSourceModel;
+
     int compare(const QModelIndex &left, const QModelIndex &right) const;
+    const TransferListSortKeys &sortKeys(int column) const;
+    void updateSortKeys(TransferListSortKeys &keys, int first, int last) const;
+    void handleSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+    void handleSourceRowsInserted(int first, int last);
+    void handleSourceRowsRemoved(int first, int last);
 
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
@@ -70,5 +82,7 @@ private:
     int m_lastSortColumn = -1;
     int m_lastSortOrder = 0;
 
-    Utils::Compare::NaturalCompare<Qt::CaseInsensitive> m_naturalCompare;
+    TransferListModel *m_model = nullptr;
+    // Keys of the sort and sub-sort columns, built on first use and kept up to date with the source model
+    mutable std::vector<TransferListSortKeys> m_sortKeys;
 };
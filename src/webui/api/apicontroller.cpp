@@ -33,14 +33,62 @@
 #include <QHash>
 #include <QJsonDocument>
 #include <QList>
-#include <QMetaObject>
+#include <QMetaMethod>
 
 #include "base/global.h"
+#include "base/http/constants.h"
 #include "apierror.h"
+#include "jsonstream.h"
+
+APIParams::APIParams(const StringMap *posts)
+    : m_posts {posts}
+{
+}
+
+APIParams::APIParams(const DataMap *query)
+    : m_query {query}
+{
+}
+
+bool APIParams::contains(const QString &name) const
+{
+    if (m_posts)
+        return m_posts->contains(name);
+    if (m_query)
+        return m_query->contains(name);
+    return false;
+}
+
+QString APIParams::value(const QString &name, const QString &defaultValue) const
+{
+    return optionalValue(name).value_or(defaultValue);
+}
+
+std::optional<QString> APIParams::optionalValue(const QString &name) const
+{
+    if (m_posts)
+    {
+        if (const auto iter = m_posts->constFind(name); iter != m_posts->cend())
+            return iter.value();
+    }
+    else if (m_query)
+    {
+        if (const auto iter = m_query->constFind(name); iter != m_query->cend())
+            return QString::fromUtf8(iter.value());
+    }
+
+    return std::nullopt;
+}
+
+QString APIParams::operator[](const QString &name) const
+{
+    return value(name);
+}
 
 void APIResult::clear()
 {
     data.clear();
+    contentStream.reset();
     mimeType.clear();
     filename.clear();
     status = APIStatus::Ok;
@@ -51,20 +99,19 @@ APIController::APIController(IApplication *app, QObject *parent)
 {
 }
 
-APIResult APIController::run(const QString &action, const StringMap &params, const DataMap &data)
+APIResult APIController::run(const QMetaMethod &action, const APIParams &params, const DataMap &data)
 {
     m_result.clear(); // clear result
     m_params = params;
     m_data = data;
 
-    const QByteArray methodName = action.toLatin1() + "Action";
-    if (!QMetaObject::invokeMethod(this, methodName.constData()))
+    if (!action.invoke(this, Qt::DirectConnection))
         throw APIError(APIErrorType::NotFound, tr("Endpoint does not exist"));
 
     return m_result;
 }
 
-const StringMap &APIController::params() const
+const APIParams &APIController::params() const
 {
     return m_params;
 }
@@ -111,6 +158,18 @@ void APIController::setResult(const QByteArray &result, const QString &mimeType,
     m_result.filename = filename;
 }
 
+void APIController::setResult(std::shared_ptr<JSONStream> result)
+{
+    m_result.contentStream = std::move(result);
+    m_result.mimeType = Http::CONTENT_TYPE_JSON;
+}
+
+void APIController::setResult(std::shared_ptr<Http::IContentStream> result, const QString &mimeType)
+{
+    m_result.contentStream = std::move(result);
+    m_result.mimeType = mimeType;
+}
+
 void APIController::setStatus(const APIStatus status)
 {
     m_result.status = status;
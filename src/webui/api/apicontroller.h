@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
+
 #include <QtContainerFwd>
 #include <QObject>
 #include <QString>
@@ -36,12 +39,41 @@
 #include "base/applicationcomponent.h"
 #include "apistatus.h"
 
+namespace Http
+{
+    class IContentStream;
+}
+
+class JSONStream;
+class QMetaMethod;
+
 using DataMap = QHash<QString, QByteArray>;
 using StringMap = QHash<QString, QString>;
 
+// Refers to the parameters of the request being processed without copying them.
+// Query values are stored as raw bytes and are decoded only when they are read.
+class APIParams
+{
+public:
+    APIParams() = default;
+    explicit APIParams(const StringMap *posts);
+    explicit APIParams(const DataMap *query);
+
+    bool contains(const QString &name) const;
+    QString value(const QString &name, const QString &defaultValue = {}) const;
+    std::optional<QString> optionalValue(const QString &name) const;
+    QString operator[](const QString &name) const;
+
+private:
+    const StringMap *m_posts = nullptr;
+    const DataMap *m_query = nullptr;
+};
+
 struct APIResult
 {
     QVariant data;
+    // large content that is generated while it is being sent, used instead of `data`
+    std::shared_ptr<Http::IContentStream> contentStream;
     QString mimeType;
     QString filename;
     APIStatus status = APIStatus::Ok;
@@ -57,10 +89,10 @@ class APIController : public ApplicationComponent<QObject>
 public:
     explicit APIController(IApplication *app, QObject *parent = nullptr);
 
-    APIResult run(const QString &action, const StringMap &params, const DataMap &data = {});
+    APIResult run(const QMetaMethod &action, const APIParams &params, const DataMap &data = {});
 
 protected:
-    const StringMap &params() const;
+    const APIParams &params() const;
     const DataMap &data() const;
     void requireParams(const QList<QString> &requiredParams) const;
 
@@ -68,11 +100,13 @@ protected:
     void setResult(const QJsonArray &result);
     void setResult(const QJsonObject &result);
     void setResult(const QByteArray &result, const QString &mimeType = {}, const QString &filename = {});
+    void setResult(std::shared_ptr<JSONStream> result);
+    void setResult(std::shared_ptr<Http::IContentStream> result, const QString &mimeType);
 
     void setStatus(APIStatus status);
 
 private:
-    StringMap m_params;
+    APIParams m_params;
     DataMap m_data;
     APIResult m_result;
 };
@@ -0,0 +1,211 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "jsonstream.h"
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace
+{
+    // generate items until the chunk reaches this size
+    const qsizetype CHUNK_SIZE = 64 * 1024;
+
+    // floating point values are encoded as half or single precision ones when it is lossless
+    const QCborValue::EncodingOptions CBOR_ENCODING_OPTIONS = QCborValue::UseFloat | QCborValue::UseFloat16;
+
+    // initial bytes of indefinite length containers, RFC 8949 3.2.2
+    const char CBOR_INDEFINITE_ARRAY = '\x9F';
+    const char CBOR_INDEFINITE_MAP = '\xBF';
+    const char CBOR_BREAK = '\xFF';
+
+    QByteArray toJSON(const QJsonObject &object)
+    {
+        return QJsonDocument(object).toJson(QJsonDocument::Compact);
+    }
+
+    QByteArray toJSON(const QString &str)
+    {
+        // QJsonDocument cannot hold plain string so strip the enclosing array
+        const QByteArray array = QJsonDocument(QJsonArray {str}).toJson(QJsonDocument::Compact);
+        return array.mid(1, (array.size() - 2));
+    }
+
+    QByteArray toCBOR(const QJsonObject &object)
+    {
+        return QCborMap::fromJsonObject(object).toCborValue().toCbor(CBOR_ENCODING_OPTIONS);
+    }
+
+    QByteArray toCBOR(const QString &str)
+    {
+        return QCborValue(str).toCbor();
+    }
+}
+
+JSONStream::JSONStream(const bool isArray, QJsonObject object, QString key, const qsizetype itemCount, MemberGenerator itemGenerator)
+    : m_isArray {isArray}
+    , m_object {std::move(object)}
+    , m_key {std::move(key)}
+    , m_itemGenerator {std::move(itemGenerator)}
+    , m_itemCount {itemCount}
+{
+}
+
+std::shared_ptr<JSONStream> JSONStream::createArray(const qsizetype size, ElementGenerator elementGenerator)
+{
+    auto itemGenerator = [elementGenerator = std::move(elementGenerator)](const qsizetype index) -> std::optional<std::pair<QString, QJsonObject>>
+    {
+        std::optional<QJsonObject> element = elementGenerator(index);
+        if (!element)
+            return std::nullopt;
+        return std::pair {QString(), std::move(*element)};
+    };
+    return std::shared_ptr<JSONStream>(new JSONStream(true, {}, {}, size, std::move(itemGenerator)));
+}
+
+std::shared_ptr<JSONStream> JSONStream::createObject(const QJsonObject &object, const QString &key
+        , const qsizetype size, MemberGenerator memberGenerator)
+{
+    return std::shared_ptr<JSONStream>(new JSONStream(false, object, key, size, std::move(memberGenerator)));
+}
+
+QByteArray JSONStream::serialize(const QJsonDocument &document, const Format format)
+{
+    if (format == Format::CBOR)
+    {
+        return document.isArray()
+            ? QCborArray::fromJsonArray(document.array()).toCborValue().toCbor(CBOR_ENCODING_OPTIONS)
+            : toCBOR(document.object());
+    }
+
+    return document.toJson(QJsonDocument::Compact);
+}
+
+JSONStream::Format JSONStream::format() const
+{
+    return m_format;
+}
+
+void JSONStream::setFormat(const Format format)
+{
+    Q_ASSERT(!m_isStarted);
+    m_format = format;
+}
+
+bool JSONStream::atEnd() const
+{
+    return m_atEnd;
+}
+
+QByteArray JSONStream::read()
+{
+    if (m_atEnd)
+        return {};
+
+    // object without generated members is serialized as is
+    if (!m_isArray && (m_itemCount <= 0))
+    {
+        m_atEnd = true;
+        return (m_format == Format::CBOR) ? toCBOR(m_object) : toJSON(m_object);
+    }
+
+    QByteArray chunk;
+    if (!m_isStarted)
+    {
+        chunk = prefix();
+        m_isStarted = true;
+    }
+
+    while ((m_nextItem < m_itemCount) && (chunk.size() < CHUNK_SIZE))
+    {
+        const std::optional<std::pair<QString, QJsonObject>> item = m_itemGenerator(m_nextItem++);
+        if (!item)
+            continue;
+
+        if (m_hasItems && (m_format == Format::JSON))
+            chunk.append(',');
+        chunk.append(serializeItem(*item));
+        m_hasItems = true;
+    }
+
+    if (m_nextItem >= m_itemCount)
+    {
+        chunk.append(suffix());
+        m_atEnd = true;
+    }
+
+    return chunk;
+}
+
+QByteArray JSONStream::prefix() const
+{
+    if (m_format == Format::CBOR)
+    {
+        if (m_isArray)
+            return QByteArray(1, CBOR_INDEFINITE_ARRAY);
+
+        QByteArray prefix(1, CBOR_INDEFINITE_MAP);
+        for (auto iter = m_object.constBegin(); iter != m_object.constEnd(); ++iter)
+        {
+            prefix.append(toCBOR(iter.key()));
+            prefix.append(QCborValue::fromJsonValue(iter.value()).toCbor(CBOR_ENCODING_OPTIONS));
+        }
+        prefix.append(toCBOR(m_key)).append(CBOR_INDEFINITE_MAP);
+        return prefix;
+    }
+
+    if (m_isArray)
+        return "[";
+
+    QByteArray prefix = toJSON(m_object);
+    prefix.chop(1);  // '}'
+    if (!m_object.isEmpty())
+        prefix.append(',');
+    prefix.append(toJSON(m_key)).append(":{");
+    return prefix;
+}
+
+QByteArray JSONStream::suffix() const
+{
+    if (m_format == Format::CBOR)
+        return m_isArray ? QByteArray(1, CBOR_BREAK) : QByteArray(2, CBOR_BREAK);
+
+    return m_isArray ? "]" : "}}";
+}
+
+QByteArray JSONStream::serializeItem(const std::pair<QString, QJsonObject> &item) const
+{
+    const auto &[key, value] = item;
+    if (m_format == Format::CBOR)
+        return m_isArray ? toCBOR(value) : (toCBOR(key) + toCBOR(value));
+
+    return m_isArray ? toJSON(value) : (toJSON(key) + ':' + toJSON(value));
+}
@@ -0,0 +1,92 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+#include "base/http/response.h"
+
+class QJsonDocument;
+
+// Serializes JSON content piece by piece as it is being sent.
+// The content consists of fixed prefix, sequence of items generated on demand and fixed suffix,
+// so only a few items have to be held in memory at once no matter how many of them there are.
+// The same content can be serialized as CBOR (RFC 8949) using indefinite length containers.
+class JSONStream final : public Http::IContentStream
+{
+public:
+    enum class Format
+    {
+        JSON,
+        CBOR
+    };
+
+    using ElementGenerator = std::function<std::optional<QJsonObject> (qsizetype index)>;
+    using MemberGenerator = std::function<std::optional<std::pair<QString, QJsonObject>> (qsizetype index)>;
+
+    // Creates stream of JSON array of generated elements
+    static std::shared_ptr<JSONStream> createArray(qsizetype size, ElementGenerator elementGenerator);
+    // Creates stream of `object` having additional member `key` which is JSON object of generated members
+    static std::shared_ptr<JSONStream> createObject(const QJsonObject &object, const QString &key
+            , qsizetype size, MemberGenerator memberGenerator);
+
+    static QByteArray serialize(const QJsonDocument &document, Format format);
+
+    Format format() const;
+    // Can be changed only before the stream is read
+    void setFormat(Format format);
+
+    bool atEnd() const override;
+    QByteArray read() override;
+
+private:
+    JSONStream(bool isArray, QJsonObject object, QString key, qsizetype itemCount, MemberGenerator itemGenerator);
+
+    QByteArray prefix() const;
+    QByteArray suffix() const;
+    QByteArray serializeItem(const std::pair<QString, QJsonObject> &item) const;
+
+    bool m_isArray = false;
+    QJsonObject m_object;
+    QString m_key;
+    MemberGenerator m_itemGenerator;
+    qsizetype m_itemCount = 0;
+    qsizetype m_nextItem = 0;
+    Format m_format = Format::JSON;
+    bool m_isStarted = false;
+    bool m_hasItems = false;
+    bool m_atEnd = false;
+};
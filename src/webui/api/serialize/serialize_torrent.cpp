@@ -28,7 +28,11 @@
 
 #include "serialize_torrent.h"
 
+#include <functional>
+
 #include <QDateTime>
+#include <QJsonObject>
+#include <QJsonValue>
 #include <QList>
 
 #include "base/bittorrent/infohash.h"
@@ -85,9 +89,184 @@ namespace
             return u"unknown"_s;
         }
     }
+
+    template <typename T>
+    QJsonValue toJsonValue(const T &value)
+    {
+        return QJsonValue(value);
+    }
+
+    QJsonValue toJsonValue(const std::optional<bool> &value)
+    {
+        return value.has_value() ? QJsonValue(*value) : QJsonValue(QJsonValue::Null);
+    }
+
+    QJsonValue toJsonValue(const BitTorrent::TorrentState state)
+    {
+        return torrentStateToString(state);
+    }
+
+    QJsonValue toJsonValue(const BitTorrent::ShareLimitsMode mode)
+    {
+        return Utils::String::fromEnum(mode);
+    }
+
+    QJsonValue toJsonValue(const BitTorrent::ShareLimitAction action)
+    {
+        return Utils::String::fromEnum(action);
+    }
+
+    template <typename T>
+    QVariant toVariant(const T &value)
+    {
+        return QVariant::fromValue(value);
+    }
+
+    QVariant toVariant(const std::optional<bool> &value)
+    {
+        return value.has_value() ? QVariant(*value) : QVariant();
+    }
+
+    QVariant toVariant(const BitTorrent::TorrentState state)
+    {
+        return torrentStateToString(state);
+    }
+
+    QVariant toVariant(const BitTorrent::ShareLimitsMode mode)
+    {
+        return Utils::String::fromEnum(mode);
+    }
+
+    QVariant toVariant(const BitTorrent::ShareLimitAction action)
+    {
+        return Utils::String::fromEnum(action);
+    }
+
+    template <typename T>
+    bool lessThan(const T &left, const T &right)
+    {
+        return left < right;
+    }
+
+    bool lessThan(const BitTorrent::TorrentState left, const BitTorrent::TorrentState right)
+    {
+        return torrentStateToString(left) < torrentStateToString(right);
+    }
+
+    bool lessThan(const BitTorrent::ShareLimitsMode left, const BitTorrent::ShareLimitsMode right)
+    {
+        return Utils::String::fromEnum(left) < Utils::String::fromEnum(right);
+    }
+
+    bool lessThan(const BitTorrent::ShareLimitAction left, const BitTorrent::ShareLimitAction right)
+    {
+        return Utils::String::fromEnum(left) < Utils::String::fromEnum(right);
+    }
+
+    template <typename Func>
+    void forEachSnapshotField(Func &&func)
+    {
+        func(KEY_TORRENT_INFOHASHV1, &TorrentSnapshot::infoHashV1);
+        func(KEY_TORRENT_INFOHASHV2, &TorrentSnapshot::infoHashV2);
+        func(KEY_TORRENT_NAME, &TorrentSnapshot::name);
+
+        func(KEY_TORRENT_HAS_METADATA, &TorrentSnapshot::hasMetadata);
+        func(KEY_TORRENT_CREATED_BY, &TorrentSnapshot::createdBy);
+        func(KEY_TORRENT_CREATION_DATE, &TorrentSnapshot::creationDate);
+        func(KEY_TORRENT_PRIVATE, &TorrentSnapshot::isPrivate);
+        func(KEY_TORRENT_TOTAL_SIZE, &TorrentSnapshot::totalSize);
+        func(KEY_TORRENT_PIECES_NUM, &TorrentSnapshot::piecesCount);
+        func(KEY_TORRENT_PIECE_SIZE, &TorrentSnapshot::pieceSize);
+
+        func(KEY_TORRENT_MAGNET_URI, &TorrentSnapshot::magnetURI);
+        func(KEY_TORRENT_SIZE, &TorrentSnapshot::size);
+        func(KEY_TORRENT_PROGRESS, &TorrentSnapshot::progress);
+        func(KEY_TORRENT_TOTAL_WASTED, &TorrentSnapshot::totalWasted);
+        func(KEY_TORRENT_PIECES_HAVE, &TorrentSnapshot::piecesHave);
+        func(KEY_TORRENT_DLSPEED, &TorrentSnapshot::dlSpeed);
+        func(KEY_TORRENT_UPSPEED, &TorrentSnapshot::upSpeed);
+        func(KEY_TORRENT_QUEUE_POSITION, &TorrentSnapshot::queuePosition);
+        func(KEY_TORRENT_SEEDS, &TorrentSnapshot::seeds);
+        func(KEY_TORRENT_NUM_COMPLETE, &TorrentSnapshot::numComplete);
+        func(KEY_TORRENT_LEECHS, &TorrentSnapshot::leechs);
+        func(KEY_TORRENT_NUM_INCOMPLETE, &TorrentSnapshot::numIncomplete);
+
+        func(KEY_TORRENT_STATE, &TorrentSnapshot::state);
+        func(KEY_TORRENT_ETA, &TorrentSnapshot::eta);
+        func(KEY_TORRENT_SEQUENTIAL_DOWNLOAD, &TorrentSnapshot::isSequentialDownload);
+        func(KEY_TORRENT_FIRST_LAST_PIECE_PRIO, &TorrentSnapshot::hasFirstLastPiecePriority);
+
+        func(KEY_TORRENT_CATEGORY, &TorrentSnapshot::category);
+        func(KEY_TORRENT_TAGS, &TorrentSnapshot::tags);
+        func(KEY_TORRENT_SUPER_SEEDING, &TorrentSnapshot::isSuperSeeding);
+        func(KEY_TORRENT_FORCE_START, &TorrentSnapshot::isForced);
+        func(KEY_TORRENT_SAVE_PATH, &TorrentSnapshot::savePath);
+        func(KEY_TORRENT_DOWNLOAD_PATH, &TorrentSnapshot::downloadPath);
+        func(KEY_TORRENT_CONTENT_PATH, &TorrentSnapshot::contentPath);
+        func(KEY_TORRENT_ROOT_PATH, &TorrentSnapshot::rootPath);
+        func(KEY_TORRENT_ADDED_ON, &TorrentSnapshot::addedOn);
+        func(KEY_TORRENT_COMPLETION_ON, &TorrentSnapshot::completionOn);
+        func(KEY_TORRENT_TRACKER, &TorrentSnapshot::tracker);
+        func(KEY_TORRENT_TRACKERS_COUNT, &TorrentSnapshot::trackersCount);
+        func(KEY_TORRENT_DL_LIMIT, &TorrentSnapshot::dlLimit);
+        func(KEY_TORRENT_UP_LIMIT, &TorrentSnapshot::upLimit);
+        func(KEY_TORRENT_AMOUNT_DOWNLOADED, &TorrentSnapshot::downloaded);
+        func(KEY_TORRENT_AMOUNT_UPLOADED, &TorrentSnapshot::uploaded);
+        func(KEY_TORRENT_AMOUNT_DOWNLOADED_SESSION, &TorrentSnapshot::downloadedSession);
+        func(KEY_TORRENT_AMOUNT_UPLOADED_SESSION, &TorrentSnapshot::uploadedSession);
+        func(KEY_TORRENT_AMOUNT_LEFT, &TorrentSnapshot::amountLeft);
+        func(KEY_TORRENT_AMOUNT_COMPLETED, &TorrentSnapshot::completed);
+        func(KEY_TORRENT_CONNECTIONS_COUNT, &TorrentSnapshot::connectionsCount);
+        func(KEY_TORRENT_CONNECTIONS_LIMIT, &TorrentSnapshot::connectionsLimit);
+        func(KEY_TORRENT_MAX_RATIO, &TorrentSnapshot::maxRatio);
+        func(KEY_TORRENT_MAX_SEEDING_TIME, &TorrentSnapshot::maxSeedingTime);
+        func(KEY_TORRENT_MAX_INACTIVE_SEEDING_TIME, &TorrentSnapshot::maxInactiveSeedingTime);
+        func(KEY_TORRENT_RATIO, &TorrentSnapshot::ratio);
+        func(KEY_TORRENT_RATIO_LIMIT, &TorrentSnapshot::ratioLimit);
+        func(KEY_TORRENT_POPULARITY, &TorrentSnapshot::popularity);
+        func(KEY_TORRENT_SEEDING_TIME_LIMIT, &TorrentSnapshot::seedingTimeLimit);
+        func(KEY_TORRENT_INACTIVE_SEEDING_TIME_LIMIT, &TorrentSnapshot::inactiveSeedingTimeLimit);
+        func(KEY_TORRENT_SHARE_LIMITS_MODE, &TorrentSnapshot::shareLimitsMode);
+        func(KEY_TORRENT_SHARE_LIMIT_ACTION, &TorrentSnapshot::shareLimitAction);
+        func(KEY_TORRENT_LAST_SEEN_COMPLETE_TIME, &TorrentSnapshot::seenComplete);
+        func(KEY_TORRENT_AUTO_TORRENT_MANAGEMENT, &TorrentSnapshot::isAutoTMMEnabled);
+        func(KEY_TORRENT_TIME_ACTIVE, &TorrentSnapshot::timeActive);
+        func(KEY_TORRENT_SEEDING_TIME, &TorrentSnapshot::seedingTime);
+        func(KEY_TORRENT_LAST_ACTIVITY_TIME, &TorrentSnapshot::lastActivity);
+        func(KEY_TORRENT_AVAILABILITY, &TorrentSnapshot::availability);
+        func(KEY_TORRENT_REANNOUNCE, &TorrentSnapshot::reannounce);
+        func(KEY_TORRENT_COMMENT, &TorrentSnapshot::comment);
+    }
+
+    struct SnapshotFieldInfo
+    {
+        QString key;
+        std::function<bool (const TorrentSnapshot &, const TorrentSnapshot &)> lessThan;
+    };
+
+    const QList<SnapshotFieldInfo> &snapshotFieldInfos()
+    {
+        static const QList<SnapshotFieldInfo> fieldInfos = []
+        {
+            QList<SnapshotFieldInfo> result;
+            result.reserve(TORRENT_SNAPSHOT_FIELD_COUNT);
+            forEachSnapshotField([&result](const QString &key, const auto member)
+            {
+                result.append({key, [member](const TorrentSnapshot &left, const TorrentSnapshot &right)
+                {
+                    return lessThan(left.*member, right.*member);
+                }});
+            });
+            Q_ASSERT(result.size() == TORRENT_SNAPSHOT_FIELD_COUNT);
+
+            return result;
+        }();
+
+        return fieldInfos;
+    }
 }
 
-QVariantMap serialize(const BitTorrent::Torrent &torrent)
+TorrentSnapshot makeTorrentSnapshot(const BitTorrent::Torrent &torrent)
 {
     const auto adjustQueuePosition = [](const int position) -> int
     {
@@ -112,76 +291,140 @@ QVariantMap serialize(const BitTorrent::Torrent &torrent)
     const BitTorrent::ShareLimits effectiveShareLimits = torrent.effectiveShareLimits();
 
     return {
-        {KEY_TORRENT_ID, torrent.id().toString()},
-        {KEY_TORRENT_INFOHASHV1, torrent.infoHash().v1().toString()},
-        {KEY_TORRENT_INFOHASHV2, torrent.infoHash().v2().toString()},
-        {KEY_TORRENT_NAME, torrent.name()},
-
-        {KEY_TORRENT_HAS_METADATA, hasMetadata},
-        {KEY_TORRENT_CREATED_BY, torrent.creator()},
-        {KEY_TORRENT_CREATION_DATE, Utils::DateTime::toSecsSinceEpoch(torrent.creationDate())},
-        {KEY_TORRENT_PRIVATE, (hasMetadata ? torrent.isPrivate() : QVariant())},
-        {KEY_TORRENT_TOTAL_SIZE, torrent.totalSize()},
-        {KEY_TORRENT_PIECES_NUM, torrent.piecesCount()},
-        {KEY_TORRENT_PIECE_SIZE, torrent.pieceLength()},
-
-        {KEY_TORRENT_MAGNET_URI, torrent.createMagnetURI()},
-        {KEY_TORRENT_SIZE, torrent.wantedSize()},
-        {KEY_TORRENT_PROGRESS, torrent.progress()},
-        {KEY_TORRENT_TOTAL_WASTED, torrent.wastedSize()},
-        {KEY_TORRENT_PIECES_HAVE, torrent.piecesHave()},
-        {KEY_TORRENT_DLSPEED, torrent.downloadPayloadRate()},
-        {KEY_TORRENT_UPSPEED, torrent.uploadPayloadRate()},
-        {KEY_TORRENT_QUEUE_POSITION, adjustQueuePosition(torrent.queuePosition())},
-        {KEY_TORRENT_SEEDS, torrent.seedsCount()},
-        {KEY_TORRENT_NUM_COMPLETE, torrent.totalSeedsCount()},
-        {KEY_TORRENT_LEECHS, torrent.leechsCount()},
-        {KEY_TORRENT_NUM_INCOMPLETE, torrent.totalLeechersCount()},
-
-        {KEY_TORRENT_STATE, torrentStateToString(torrent.state())},
-        {KEY_TORRENT_ETA, torrent.eta()},
-        {KEY_TORRENT_SEQUENTIAL_DOWNLOAD, torrent.isSequentialDownload()},
-        {KEY_TORRENT_FIRST_LAST_PIECE_PRIO, torrent.hasFirstLastPiecePriority()},
-
-        {KEY_TORRENT_CATEGORY, torrent.category()},
-        {KEY_TORRENT_TAGS, Utils::String::joinIntoString(torrent.tags(), u", "_s)},
-        {KEY_TORRENT_SUPER_SEEDING, torrent.superSeeding()},
-        {KEY_TORRENT_FORCE_START, torrent.isForced()},
-        {KEY_TORRENT_SAVE_PATH, torrent.savePath().toString()},
-        {KEY_TORRENT_DOWNLOAD_PATH, torrent.downloadPath().toString()},
-        {KEY_TORRENT_CONTENT_PATH, torrent.contentPath().toString()},
-        {KEY_TORRENT_ROOT_PATH, torrent.rootPath().toString()},
-        {KEY_TORRENT_ADDED_ON, Utils::DateTime::toSecsSinceEpoch(torrent.addedTime())},
-        {KEY_TORRENT_COMPLETION_ON, Utils::DateTime::toSecsSinceEpoch(torrent.completedTime())},
-        {KEY_TORRENT_TRACKER, torrent.currentTracker()},
-        {KEY_TORRENT_TRACKERS_COUNT, torrent.trackers().size()},
-        {KEY_TORRENT_DL_LIMIT, torrent.downloadLimit()},
-        {KEY_TORRENT_UP_LIMIT, torrent.uploadLimit()},
-        {KEY_TORRENT_AMOUNT_DOWNLOADED, torrent.totalDownload()},
-        {KEY_TORRENT_AMOUNT_UPLOADED, torrent.totalUpload()},
-        {KEY_TORRENT_AMOUNT_DOWNLOADED_SESSION, torrent.totalPayloadDownload()},
-        {KEY_TORRENT_AMOUNT_UPLOADED_SESSION, torrent.totalPayloadUpload()},
-        {KEY_TORRENT_AMOUNT_LEFT, torrent.remainingSize()},
-        {KEY_TORRENT_AMOUNT_COMPLETED, torrent.completedSize()},
-        {KEY_TORRENT_CONNECTIONS_COUNT, torrent.connectionsCount()},
-        {KEY_TORRENT_CONNECTIONS_LIMIT, torrent.connectionsLimit()},
-        {KEY_TORRENT_MAX_RATIO, effectiveShareLimits.ratioLimit},
-        {KEY_TORRENT_MAX_SEEDING_TIME, effectiveShareLimits.seedingTimeLimit},
-        {KEY_TORRENT_MAX_INACTIVE_SEEDING_TIME, effectiveShareLimits.inactiveSeedingTimeLimit},
-        {KEY_TORRENT_RATIO, adjustRatio(torrent.realRatio())},
-        {KEY_TORRENT_RATIO_LIMIT, shareLimits.ratioLimit},
-        {KEY_TORRENT_POPULARITY, torrent.popularity()},
-        {KEY_TORRENT_SEEDING_TIME_LIMIT, shareLimits.seedingTimeLimit},
-        {KEY_TORRENT_INACTIVE_SEEDING_TIME_LIMIT, shareLimits.inactiveSeedingTimeLimit},
-        {KEY_TORRENT_SHARE_LIMITS_MODE, Utils::String::fromEnum(shareLimits.mode)},
-        {KEY_TORRENT_SHARE_LIMIT_ACTION, Utils::String::fromEnum(shareLimits.action)},
-        {KEY_TORRENT_LAST_SEEN_COMPLETE_TIME, Utils::DateTime::toSecsSinceEpoch(torrent.lastSeenComplete())},
-        {KEY_TORRENT_AUTO_TORRENT_MANAGEMENT, torrent.isAutoTMMEnabled()},
-        {KEY_TORRENT_TIME_ACTIVE, torrent.activeTime()},
-        {KEY_TORRENT_SEEDING_TIME, torrent.finishedTime()},
-        {KEY_TORRENT_LAST_ACTIVITY_TIME, getLastActivityTime()},
-        {KEY_TORRENT_AVAILABILITY, torrent.distributedCopies()},
-        {KEY_TORRENT_REANNOUNCE, torrent.nextAnnounce()},
-        {KEY_TORRENT_COMMENT, torrent.comment()}
+        .infoHashV1 = torrent.infoHash().v1().toString(),
+        .infoHashV2 = torrent.infoHash().v2().toString(),
+        .name = torrent.name(),
+        .hasMetadata = hasMetadata,
+        .createdBy = torrent.creator(),
+        .creationDate = Utils::DateTime::toSecsSinceEpoch(torrent.creationDate()),
+        .isPrivate = (hasMetadata ? std::optional<bool>(torrent.isPrivate()) : std::nullopt),
+        .totalSize = torrent.totalSize(),
+        .piecesCount = torrent.piecesCount(),
+        .pieceSize = torrent.pieceLength(),
+        .magnetURI = torrent.createMagnetURI(),
+        .size = torrent.wantedSize(),
+        .progress = torrent.progress(),
+        .totalWasted = torrent.wastedSize(),
+        .piecesHave = torrent.piecesHave(),
+        .dlSpeed = torrent.downloadPayloadRate(),
+        .upSpeed = torrent.uploadPayloadRate(),
+        .queuePosition = adjustQueuePosition(torrent.queuePosition()),
+        .seeds = torrent.seedsCount(),
+        .numComplete = torrent.totalSeedsCount(),
+        .leechs = torrent.leechsCount(),
+        .numIncomplete = torrent.totalLeechersCount(),
+        .state = torrent.state(),
+        .eta = torrent.eta(),
+        .isSequentialDownload = torrent.isSequentialDownload(),
+        .hasFirstLastPiecePriority = torrent.hasFirstLastPiecePriority(),
+        .category = torrent.category(),
+        .tags = Utils::String::joinIntoString(torrent.tags(), u", "_s),
+        .isSuperSeeding = torrent.superSeeding(),
+        .isForced = torrent.isForced(),
+        .savePath = torrent.savePath().toString(),
+        .downloadPath = torrent.downloadPath().toString(),
+        .contentPath = torrent.contentPath().toString(),
+        .rootPath = torrent.rootPath().toString(),
+        .addedOn = Utils::DateTime::toSecsSinceEpoch(torrent.addedTime()),
+        .completionOn = Utils::DateTime::toSecsSinceEpoch(torrent.completedTime()),
+        .tracker = torrent.currentTracker(),
+        .trackersCount = torrent.trackers().size(),
+        .dlLimit = torrent.downloadLimit(),
+        .upLimit = torrent.uploadLimit(),
+        .downloaded = torrent.totalDownload(),
+        .uploaded = torrent.totalUpload(),
+        .downloadedSession = torrent.totalPayloadDownload(),
+        .uploadedSession = torrent.totalPayloadUpload(),
+        .amountLeft = torrent.remainingSize(),
+        .completed = torrent.completedSize(),
+        .connectionsCount = torrent.connectionsCount(),
+        .connectionsLimit = torrent.connectionsLimit(),
+        .maxRatio = effectiveShareLimits.ratioLimit,
+        .maxSeedingTime = effectiveShareLimits.seedingTimeLimit,
+        .maxInactiveSeedingTime = effectiveShareLimits.inactiveSeedingTimeLimit,
+        .ratio = adjustRatio(torrent.realRatio()),
+        .ratioLimit = shareLimits.ratioLimit,
+        .popularity = torrent.popularity(),
+        .seedingTimeLimit = shareLimits.seedingTimeLimit,
+        .inactiveSeedingTimeLimit = shareLimits.inactiveSeedingTimeLimit,
+        .shareLimitsMode = shareLimits.mode,
+        .shareLimitAction = shareLimits.action,
+        .seenComplete = Utils::DateTime::toSecsSinceEpoch(torrent.lastSeenComplete()),
+        .isAutoTMMEnabled = torrent.isAutoTMMEnabled(),
+        .timeActive = torrent.activeTime(),
+        .seedingTime = torrent.finishedTime(),
+        .lastActivity = getLastActivityTime(),
+        .availability = torrent.distributedCopies(),
+        .reannounce = torrent.nextAnnounce(),
+        .comment = torrent.comment()
     };
 }
+
+TorrentSnapshotFields changedSnapshotFields(const TorrentSnapshot &prevSnapshot, const TorrentSnapshot &snapshot)
+{
+    TorrentSnapshotFields fields;
+    int index = 0;
+    forEachSnapshotField([&prevSnapshot, &snapshot, &fields, &index]([[maybe_unused]] const QString &key, const auto member)
+    {
+        if (snapshot.*member != prevSnapshot.*member)
+            fields.set(index);
+        ++index;
+    });
+    Q_ASSERT(index == TORRENT_SNAPSHOT_FIELD_COUNT);
+
+    return fields;
+}
+
+void serializeSnapshot(const TorrentSnapshot &snapshot, QJsonObject &jsonObject)
+{
+    forEachSnapshotField([&snapshot, &jsonObject](const QString &key, const auto member)
+    {
+        jsonObject.insert(key, toJsonValue(snapshot.*member));
+    });
+}
+
+void serializeSnapshot(const TorrentSnapshot &snapshot, const TorrentSnapshotFields &fields, QJsonObject &jsonObject)
+{
+    int index = 0;
+    forEachSnapshotField([&snapshot, &fields, &jsonObject, &index](const QString &key, const auto member)
+    {
+        if (fields.test(index))
+            jsonObject.insert(key, toJsonValue(snapshot.*member));
+        ++index;
+    });
+}
+
+int snapshotFieldIndex(const QString &key)
+{
+    const QList<SnapshotFieldInfo> &fieldInfos = snapshotFieldInfos();
+    for (int i = 0; i < fieldInfos.size(); ++i)
+    {
+        if (fieldInfos[i].key == key)
+            return i;
+    }
+
+    return -1;
+}
+
+bool isSnapshotFieldLess(const int fieldIndex, const TorrentSnapshot &left, const TorrentSnapshot &right)
+{
+    return snapshotFieldInfos()[fieldIndex].lessThan(left, right);
+}
+
+QVariantMap snapshotToVariantMap(const TorrentSnapshot &snapshot)
+{
+    QVariantMap result;
+    forEachSnapshotField([&snapshot, &result](const QString &key, const auto member)
+    {
+        result.insert(key, toVariant(snapshot.*member));
+    });
+
+    return result;
+}
+
+QVariantMap serialize(const BitTorrent::Torrent &torrent)
+{
+    QVariantMap result = snapshotToVariantMap(makeTorrentSnapshot(torrent));
+    result.insert(KEY_TORRENT_ID, torrent.id().toString());
+    return result;
+}
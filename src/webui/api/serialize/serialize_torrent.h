@@ -28,14 +28,20 @@
 
 #pragma once
 
+#include <algorithm>
+#include <bitset>
+#include <optional>
+
+#include <QList>
+#include <QSet>
+#include <QString>
 #include <QVariant>
 
+#include "base/bittorrent/sharelimits.h"
+#include "base/bittorrent/torrent.h"
 #include "base/global.h"
 
-namespace BitTorrent
-{
-    class Torrent;
-}
+class QJsonObject;
 
 // Torrent keys
 // TODO: Rename it to `id`.
@@ -107,4 +113,136 @@ inline const QString KEY_TORRENT_PIECES_HAVE = u"pieces_have"_s;
 inline const QString KEY_TORRENT_CREATED_BY = u"created_by"_s;
 inline const QString KEY_TORRENT_CREATION_DATE = u"creation_date"_s;
 
+// Typed copy of the serializable torrent fields.
+// It allows to find out changed fields by cheap comparisons instead of
+// building and comparing QVariantMap for each torrent.
+struct TorrentSnapshot
+{
+    QString infoHashV1;
+    QString infoHashV2;
+    QString name;
+    bool hasMetadata = false;
+    QString createdBy;
+    qint64 creationDate = 0;
+    std::optional<bool> isPrivate;
+    qlonglong totalSize = 0;
+    int piecesCount = 0;
+    qlonglong pieceSize = 0;
+    QString magnetURI;
+    qlonglong size = 0;
+    qreal progress = 0;
+    qlonglong totalWasted = 0;
+    int piecesHave = 0;
+    int dlSpeed = 0;
+    int upSpeed = 0;
+    int queuePosition = 0;
+    int seeds = 0;
+    int numComplete = 0;
+    int leechs = 0;
+    int numIncomplete = 0;
+    BitTorrent::TorrentState state = BitTorrent::TorrentState::Unknown;
+    qlonglong eta = 0;
+    bool isSequentialDownload = false;
+    bool hasFirstLastPiecePriority = false;
+    QString category;
+    QString tags;
+    bool isSuperSeeding = false;
+    bool isForced = false;
+    QString savePath;
+    QString downloadPath;
+    QString contentPath;
+    QString rootPath;
+    qint64 addedOn = 0;
+    qint64 completionOn = 0;
+    QString tracker;
+    qsizetype trackersCount = 0;
+    int dlLimit = 0;
+    int upLimit = 0;
+    qlonglong downloaded = 0;
+    qlonglong uploaded = 0;
+    qlonglong downloadedSession = 0;
+    qlonglong uploadedSession = 0;
+    qlonglong amountLeft = 0;
+    qlonglong completed = 0;
+    int connectionsCount = 0;
+    int connectionsLimit = 0;
+    qreal maxRatio = 0;
+    int maxSeedingTime = 0;
+    int maxInactiveSeedingTime = 0;
+    qreal ratio = 0;
+    qreal ratioLimit = 0;
+    qreal popularity = 0;
+    int seedingTimeLimit = 0;
+    int inactiveSeedingTimeLimit = 0;
+    BitTorrent::ShareLimitsMode shareLimitsMode = BitTorrent::ShareLimitsMode::Default;
+    BitTorrent::ShareLimitAction shareLimitAction = BitTorrent::ShareLimitAction::Default;
+    qint64 seenComplete = 0;
+    bool isAutoTMMEnabled = false;
+    qlonglong timeActive = 0;
+    qlonglong seedingTime = 0;
+    qlonglong lastActivity = 0;
+    qreal availability = 0;
+    qlonglong reannounce = 0;
+    QString comment;
+};
+
+inline constexpr int TORRENT_SNAPSHOT_FIELD_COUNT = 66;
+using TorrentSnapshotFields = std::bitset<TORRENT_SNAPSHOT_FIELD_COUNT>;
+
+TorrentSnapshot makeTorrentSnapshot(const BitTorrent::Torrent &torrent);
+TorrentSnapshotFields changedSnapshotFields(const TorrentSnapshot &prevSnapshot, const TorrentSnapshot &snapshot);
+// Writes the snapshot fields (torrent ID isn't a part of it) into `jsonObject`
+void serializeSnapshot(const TorrentSnapshot &snapshot, QJsonObject &jsonObject);
+void serializeSnapshot(const TorrentSnapshot &snapshot, const TorrentSnapshotFields &fields, QJsonObject &jsonObject);
+// Returns index of the snapshot field serialized using `key` or -1 if there is no such field
+int snapshotFieldIndex(const QString &key);
+// Compares the given field of snapshots in the same way as their serialized values
+bool isSnapshotFieldLess(int fieldIndex, const TorrentSnapshot &left, const TorrentSnapshot &right);
+
+// Returns comparator ordering torrent IDs by the given snapshot field.
+// `getSnapshot` returns snapshot of the torrent having the given ID.
+template <typename GetSnapshot>
+auto snapshotFieldLessThan(const int fieldIndex, GetSnapshot getSnapshot)
+{
+    return [fieldIndex, getSnapshot](const BitTorrent::TorrentID &left, const BitTorrent::TorrentID &right)
+    {
+        const TorrentSnapshot &leftSnapshot = getSnapshot(left);
+        const TorrentSnapshot &rightSnapshot = getSnapshot(right);
+        if (isSnapshotFieldLess(fieldIndex, leftSnapshot, rightSnapshot))
+            return true;
+        if (isSnapshotFieldLess(fieldIndex, rightSnapshot, leftSnapshot))
+            return false;
+        // keep the order of torrents having equal values stable
+        return left < right;
+    };
+}
+
+// Updates torrent IDs sorted by the given snapshot field.
+// Only the changed (or added) torrents are sorted and merged into the rest, the removed ones are dropped.
+template <typename GetSnapshot>
+void updateSnapshotSortOrder(const int fieldIndex, QList<BitTorrent::TorrentID> &sortedTorrentIDs
+        , const QSet<BitTorrent::TorrentID> &changedTorrentIDs, const QSet<BitTorrent::TorrentID> &removedTorrentIDs
+        , GetSnapshot getSnapshot)
+{
+    if (changedTorrentIDs.isEmpty() && removedTorrentIDs.isEmpty())
+        return;
+
+    sortedTorrentIDs.removeIf([&changedTorrentIDs, &removedTorrentIDs](const BitTorrent::TorrentID &torrentID)
+    {
+        return changedTorrentIDs.contains(torrentID) || removedTorrentIDs.contains(torrentID);
+    });
+
+    const qsizetype unchangedCount = sortedTorrentIDs.size();
+    sortedTorrentIDs.reserve(unchangedCount + changedTorrentIDs.size());
+    for (const BitTorrent::TorrentID &torrentID : changedTorrentIDs)
+        sortedTorrentIDs.append(torrentID);
+
+    const auto lessThan = snapshotFieldLessThan(fieldIndex, getSnapshot);
+    const auto middle = sortedTorrentIDs.begin() + unchangedCount;
+    std::sort(middle, sortedTorrentIDs.end(), lessThan);
+    std::inplace_merge(sortedTorrentIDs.begin(), middle, sortedTorrentIDs.end(), lessThan);
+}
+
+// Writes all the snapshot fields (torrent ID isn't a part of it) into QVariantMap in the same way as serialize() does
+QVariantMap snapshotToVariantMap(const TorrentSnapshot &snapshot);
 QVariantMap serialize(const BitTorrent::Torrent &torrent);
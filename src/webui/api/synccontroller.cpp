@@ -28,36 +28,31 @@
 
 #include "synccontroller.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include <QFuture>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QMetaObject>
 
-#include "base/algorithm.h"
-#include "base/bittorrent/cachestatus.h"
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
-#include "base/bittorrent/sessionstatus.h"
 #include "base/bittorrent/torrent.h"
 #include "base/bittorrent/torrentinfo.h"
-#include "base/bittorrent/trackerentrystatus.h"
 #include "base/global.h"
+#include "base/http/constants.h"
 #include "base/net/geoipmanager.h"
 #include "base/net/reverseresolution.h"
 #include "base/preferences.h"
-#include "base/utils/string.h"
 #include "apierror.h"
-#include "serialize/serialize_torrent.h"
+#include "synceventstream.h"
+#include "webui/maindatachangelog.h"
 
 namespace
 {
-    // Sync main data keys
-    const QString KEY_SYNC_MAINDATA_QUEUEING = u"queueing"_s;
-    const QString KEY_SYNC_MAINDATA_REFRESH_INTERVAL = u"refresh_interval"_s;
-    const QString KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS = u"use_alt_speed_limits"_s;
-
     // Sync torrent peers keys
     const QString KEY_SYNC_TORRENT_PEERS_SHOW_FLAGS = u"show_flags"_s;
 
@@ -81,125 +76,19 @@ namespace
     const QString KEY_PEER_TOT_UP = u"uploaded"_s;
     const QString KEY_PEER_UP_SPEED = u"up_speed"_s;
 
-    // TransferInfo keys
-    const QString KEY_TRANSFER_CONNECTION_STATUS = u"connection_status"_s;
-    const QString KEY_TRANSFER_DHT_NODES = u"dht_nodes"_s;
-    const QString KEY_TRANSFER_DLDATA = u"dl_info_data"_s;
-    const QString KEY_TRANSFER_DLRATELIMIT = u"dl_rate_limit"_s;
-    const QString KEY_TRANSFER_DLSPEED = u"dl_info_speed"_s;
-    const QString KEY_TRANSFER_FREESPACEONDISK = u"free_space_on_disk"_s;
-    const QString KEY_TRANSFER_LAST_EXTERNAL_ADDRESS_V4 = u"last_external_address_v4"_s;
-    const QString KEY_TRANSFER_LAST_EXTERNAL_ADDRESS_V6 = u"last_external_address_v6"_s;
-    const QString KEY_TRANSFER_UPDATA = u"up_info_data"_s;
-    const QString KEY_TRANSFER_UPRATELIMIT = u"up_rate_limit"_s;
-    const QString KEY_TRANSFER_UPSPEED = u"up_info_speed"_s;
-
-    // Statistics keys
-    const QString KEY_TRANSFER_ALLTIME_DL = u"alltime_dl"_s;
-    const QString KEY_TRANSFER_ALLTIME_UL = u"alltime_ul"_s;
-    const QString KEY_TRANSFER_AVERAGE_TIME_QUEUE = u"average_time_queue"_s;
-    const QString KEY_TRANSFER_GLOBAL_RATIO = u"global_ratio"_s;
-    const QString KEY_TRANSFER_QUEUED_IO_JOBS = u"queued_io_jobs"_s;
-    const QString KEY_TRANSFER_READ_CACHE_HITS = u"read_cache_hits"_s;
-    const QString KEY_TRANSFER_READ_CACHE_OVERLOAD = u"read_cache_overload"_s;
-    const QString KEY_TRANSFER_TOTAL_BUFFERS_SIZE = u"total_buffers_size"_s;
-    const QString KEY_TRANSFER_TOTAL_PEER_CONNECTIONS = u"total_peer_connections"_s;
-    const QString KEY_TRANSFER_TOTAL_QUEUED_SIZE = u"total_queued_size"_s;
-    const QString KEY_TRANSFER_TOTAL_WASTE_SESSION = u"total_wasted_session"_s;
-    const QString KEY_TRANSFER_WRITE_CACHE_OVERLOAD = u"write_cache_overload"_s;
-    const QString KEY_TRANSFER_QUEUED_TRACKER_ANNOUNCES = u"queued_tracker_announces"_s;
-
     const QString KEY_SUFFIX_REMOVED = u"_removed"_s;
 
-    const QString KEY_CATEGORIES = u"categories"_s;
-    const QString KEY_CATEGORIES_REMOVED = KEY_CATEGORIES + KEY_SUFFIX_REMOVED;
-    const QString KEY_TAGS = u"tags"_s;
-    const QString KEY_TAGS_REMOVED = KEY_TAGS + KEY_SUFFIX_REMOVED;
-    const QString KEY_TORRENTS = u"torrents"_s;
-    const QString KEY_TORRENTS_REMOVED = KEY_TORRENTS + KEY_SUFFIX_REMOVED;
-    const QString KEY_TRACKERS = u"trackers"_s;
-    const QString KEY_TRACKERS_REMOVED = KEY_TRACKERS + KEY_SUFFIX_REMOVED;
-    const QString KEY_SERVER_STATE = u"server_state"_s;
     const QString KEY_FULL_UPDATE = u"full_update"_s;
     const QString KEY_RESPONSE_ID = u"rid"_s;
 
-    const QString KEY_TORRENT_HAS_TRACKER_WARNING = u"has_tracker_warning"_s;
-    const QString KEY_TORRENT_HAS_TRACKER_ERROR = u"has_tracker_error"_s;
-    const QString KEY_TORRENT_HAS_OTHER_ANNOUNCE_ERROR = u"has_other_announce_error"_s;
-
-    QStringList asStrings(const QSet<BitTorrent::TorrentID> &torrentIDs)
-    {
-        QStringList result;
-        result.reserve(torrentIDs.size());
-        for (const BitTorrent::TorrentID &torrentID : torrentIDs)
-            result.emplaceBack(torrentID.toString());
-
-        return result;
-    }
-
-    bool hasWarningMessage(const BitTorrent::TrackerEntryStatus &status)
-    {
-        return std::ranges::any_of(status.endpoints, [](const BitTorrent::TrackerEndpointStatus &endpointEntry)
-        {
-            return (endpointEntry.state == BitTorrent::TrackerEndpointState::Working) && !endpointEntry.message.isEmpty();
-        });
-    }
+    // lower values would make the events to be prepared on almost every change
+    const std::chrono::milliseconds MIN_EVENTS_INTERVAL {100};
 
     QVariantMap processMap(const QVariantMap &prevData, const QVariantMap &data);
     std::pair<QVariantMap, QVariantList> processHash(QVariantHash prevData, const QVariantHash &data);
     std::pair<QVariantList, QVariantList> processList(QVariantList prevData, const QVariantList &data);
     QJsonObject generateSyncData(int acceptedResponseId, const QVariantMap &data, QVariantMap &lastAcceptedData, QVariantMap &lastData);
 
-    QVariantMap getTransferInfo()
-    {
-        QVariantMap map;
-        const auto *session = BitTorrent::Session::instance();
-
-        const BitTorrent::SessionStatus &sessionStatus = session->status();
-        const BitTorrent::CacheStatus &cacheStatus = session->cacheStatus();
-        map[KEY_TRANSFER_DLSPEED] = sessionStatus.payloadDownloadRate;
-        map[KEY_TRANSFER_DLDATA] = sessionStatus.totalPayloadDownload;
-        map[KEY_TRANSFER_UPSPEED] = sessionStatus.payloadUploadRate;
-        map[KEY_TRANSFER_UPDATA] = sessionStatus.totalPayloadUpload;
-        map[KEY_TRANSFER_DLRATELIMIT] = session->downloadSpeedLimit();
-        map[KEY_TRANSFER_UPRATELIMIT] = session->uploadSpeedLimit();
-
-        const qint64 atd = sessionStatus.allTimeDownload;
-        const qint64 atu = sessionStatus.allTimeUpload;
-        map[KEY_TRANSFER_ALLTIME_DL] = atd;
-        map[KEY_TRANSFER_ALLTIME_UL] = atu;
-        map[KEY_TRANSFER_TOTAL_WASTE_SESSION] = sessionStatus.totalWasted;
-        map[KEY_TRANSFER_GLOBAL_RATIO] = ((atd > 0) && (atu > 0)) ? Utils::String::fromDouble(static_cast<qreal>(atu) / atd, 2) : u"-"_s;
-        map[KEY_TRANSFER_TOTAL_PEER_CONNECTIONS] = sessionStatus.peersCount;
-
-        const qreal readRatio = cacheStatus.readRatio;  // TODO: remove when LIBTORRENT_VERSION_NUM >= 20000
-        map[KEY_TRANSFER_READ_CACHE_HITS] = (readRatio > 0) ? Utils::String::fromDouble(100 * readRatio, 2) : u"0"_s;
-        map[KEY_TRANSFER_TOTAL_BUFFERS_SIZE] = cacheStatus.totalUsedBuffers * 16 * 1024;
-
-        map[KEY_TRANSFER_WRITE_CACHE_OVERLOAD] = ((sessionStatus.diskWriteQueue > 0) && (sessionStatus.peersCount > 0))
-            ? Utils::String::fromDouble((100. * sessionStatus.diskWriteQueue / sessionStatus.peersCount), 2)
-            : u"0"_s;
-        map[KEY_TRANSFER_READ_CACHE_OVERLOAD] = ((sessionStatus.diskReadQueue > 0) && (sessionStatus.peersCount > 0))
-            ? Utils::String::fromDouble((100. * sessionStatus.diskReadQueue / sessionStatus.peersCount), 2)
-            : u"0"_s;
-
-        map[KEY_TRANSFER_QUEUED_IO_JOBS] = cacheStatus.jobQueueLength;
-        map[KEY_TRANSFER_AVERAGE_TIME_QUEUE] = cacheStatus.averageJobTime;
-        map[KEY_TRANSFER_TOTAL_QUEUED_SIZE] = cacheStatus.queuedBytes;
-
-        map[KEY_TRANSFER_LAST_EXTERNAL_ADDRESS_V4] = session->lastExternalIPv4Address();
-        map[KEY_TRANSFER_LAST_EXTERNAL_ADDRESS_V6] = session->lastExternalIPv6Address();
-        map[KEY_TRANSFER_DHT_NODES] = sessionStatus.dhtNodes;
-        map[KEY_TRANSFER_CONNECTION_STATUS] = session->isListening()
-            ? (sessionStatus.hasIncomingConnections ? u"connected"_s : u"firewalled"_s)
-            : u"disconnected"_s;
-
-        // Tracker statistics
-        map[KEY_TRANSFER_QUEUED_TRACKER_ANNOUNCES] = sessionStatus.queuedTrackerAnnounces;
-
-        return map;
-    }
-
     // Compare two structures (prevData, data) and calculate difference (syncData).
     // Structures encoded as map.
     QVariantMap processMap(const QVariantMap &prevData, const QVariantMap &data)
@@ -412,44 +301,12 @@ namespace
 
         return QJsonObject::fromVariantMap(syncData);
     }
-
-    void addAnnounceStats(QVariantMap &serializedTorrent, const BitTorrent::Torrent *torrent)
-    {
-        bool hasTrackerWarning = false;
-        bool hasTrackerError = false;
-        bool hasOtherAnnounceError = false;
-        for (const BitTorrent::TrackerEntryStatus &status : asConst(torrent->trackers()))
-        {
-            switch (status.state)
-            {
-            case BitTorrent::TrackerEndpointState::Working:
-                if (!hasTrackerWarning && hasWarningMessage(status))
-                    hasTrackerWarning = true;
-                break;
-            case BitTorrent::TrackerEndpointState::TrackerError:
-                hasTrackerError = true;
-                break;
-            case BitTorrent::TrackerEndpointState::NotWorking:
-            case BitTorrent::TrackerEndpointState::Unreachable:
-                hasOtherAnnounceError = true;
-                break;
-            default:
-                break;
-            }
-
-            if (hasTrackerWarning && hasTrackerError && hasOtherAnnounceError)
-                break;
-        }
-
-        serializedTorrent[KEY_TORRENT_HAS_TRACKER_WARNING] = hasTrackerWarning;
-        serializedTorrent[KEY_TORRENT_HAS_TRACKER_ERROR] = hasTrackerError;
-        serializedTorrent[KEY_TORRENT_HAS_OTHER_ANNOUNCE_ERROR] = hasOtherAnnounceError;
-    }
 }
 
-void SyncController::updateFreeDiskSpace(const qint64 freeDiskSpace)
+SyncController::SyncController(MaindataChangeLog *maindataChangeLog, IApplication *app, QObject *parent)
+    : APIController(app, parent)
+    , m_maindataChangeLog {maindataChangeLog}
 {
-    m_freeDiskSpace = freeDiskSpace;
 }
 
 // The function returns the changed data from the server to synchronize with the web client.
@@ -523,306 +380,44 @@ void SyncController::updateFreeDiskSpace(const qint64 freeDiskSpace)
 //   - rid (int): last response id
 void SyncController::maindataAction()
 {
-    if (m_maindataAcceptedID < 0)
-    {
-        makeMaindataSnapshot();
-
-        const auto *btSession = BitTorrent::Session::instance();
-        connect(btSession, &BitTorrent::Session::categoryAdded, this, &SyncController::onCategoryAdded);
-        connect(btSession, &BitTorrent::Session::categoryRemoved, this, &SyncController::onCategoryRemoved);
-        connect(btSession, &BitTorrent::Session::categoryOptionsChanged, this, &SyncController::onCategoryOptionsChanged);
-        connect(btSession, &BitTorrent::Session::subcategoriesSupportChanged, this, &SyncController::onSubcategoriesSupportChanged);
-        connect(btSession, &BitTorrent::Session::tagAdded, this, &SyncController::onTagAdded);
-        connect(btSession, &BitTorrent::Session::tagRemoved, this, &SyncController::onTagRemoved);
-        connect(btSession, &BitTorrent::Session::torrentAdded, this, &SyncController::onTorrentAdded);
-        connect(btSession, &BitTorrent::Session::torrentAboutToBeRemoved, this, &SyncController::onTorrentAboutToBeRemoved);
-        connect(btSession, &BitTorrent::Session::torrentCategoryChanged, this, &SyncController::onTorrentCategoryChanged);
-        connect(btSession, &BitTorrent::Session::torrentMetadataReceived, this, &SyncController::onTorrentMetadataReceived);
-        connect(btSession, &BitTorrent::Session::torrentStopped, this, &SyncController::onTorrentStopped);
-        connect(btSession, &BitTorrent::Session::torrentStarted, this, &SyncController::onTorrentStarted);
-        connect(btSession, &BitTorrent::Session::torrentSavePathChanged, this, &SyncController::onTorrentSavePathChanged);
-        connect(btSession, &BitTorrent::Session::torrentSavingModeChanged, this, &SyncController::onTorrentSavingModeChanged);
-        connect(btSession, &BitTorrent::Session::torrentTagAdded, this, &SyncController::onTorrentTagAdded);
-        connect(btSession, &BitTorrent::Session::torrentTagRemoved, this, &SyncController::onTorrentTagRemoved);
-        connect(btSession, &BitTorrent::Session::torrentsUpdated, this, &SyncController::onTorrentsUpdated);
-        connect(btSession, &BitTorrent::Session::trackersAdded, this, &SyncController::onTorrentTrackersChanged);
-        connect(btSession, &BitTorrent::Session::trackersRemoved, this, &SyncController::onTorrentTrackersChanged);
-        connect(btSession, &BitTorrent::Session::trackersReset, this, &SyncController::onTorrentTrackersChanged);
-        connect(btSession, &BitTorrent::Session::trackerEntryStatusesUpdated, this, &SyncController::onTorrentTrackerEntryStatusesUpdated);
-    }
-
+    // Only the data that was sent to this client can be used as a base for the changes
     const int acceptedID = params()[u"rid"_s].toInt();
-    bool fullUpdate = true;
-    if ((acceptedID > 0) && (m_maindataLastSentID > 0))
-    {
-        if (m_maindataLastSentID == acceptedID)
-        {
-            m_maindataAcceptedID = acceptedID;
-            m_maindataSyncBuf = {};
-        }
+    if ((acceptedID > 0) && ((acceptedID == m_maindataLastSentID) || (acceptedID == m_maindataAcceptedID)))
+        m_maindataAcceptedID = acceptedID;
+    else
+        m_maindataAcceptedID = 0;
 
-        if (m_maindataAcceptedID == acceptedID)
-        {
-            // We are still able to send changes for the current state of the data having by client.
-            fullUpdate = false;
-        }
-    }
-
-    const int id = (m_maindataLastSentID % 1000000) + 1;  // cycle between 1 and 1000000
-    setResult(generateMaindataSyncData(id, fullUpdate));
-    m_maindataLastSentID = id;
+    setResult(m_maindataChangeLog->syncData(m_maindataAcceptedID));
+    m_maindataLastSentID = m_maindataChangeLog->revision();
 }
 
-void SyncController::makeMaindataSnapshot()
-{
-    m_knownTrackers.clear();
-    m_maindataAcceptedID = 0;
-    m_maindataSnapshot = {};
-
-    const auto *session = BitTorrent::Session::instance();
-
-    for (const BitTorrent::Torrent *torrent : asConst(session->torrents()))
-    {
-        const BitTorrent::TorrentID torrentID = torrent->id();
-
-        QVariantMap serializedTorrent = serialize(*torrent);
-        serializedTorrent.remove(KEY_TORRENT_ID);
-        addAnnounceStats(serializedTorrent, torrent);
-
-        for (const BitTorrent::TrackerEntryStatus &status : asConst(torrent->trackers()))
-            m_knownTrackers[status.url].insert(torrentID);
-
-        m_maindataSnapshot.torrents[torrentID.toString()] = serializedTorrent;
-    }
-
-    const QStringList categoriesList = session->categories();
-    for (const auto &categoryName : categoriesList)
-    {
-        const BitTorrent::CategoryOptions categoryOptions = session->categoryOptions(categoryName);
-        QJsonObject category = categoryOptions.toJSON();
-        // adjust it to be compatible with existing WebAPI
-        category[u"savePath"_s] = category.take(u"save_path"_s);
-        category.insert(u"name"_s, categoryName);
-        m_maindataSnapshot.categories[categoryName] = category.toVariantMap();
-    }
-
-    for (const Tag &tag : asConst(session->tags()))
-        m_maindataSnapshot.tags.append(tag.toString());
-
-    for (const auto &[tracker, torrentIDs] : asConst(m_knownTrackers).asKeyValueRange())
-        m_maindataSnapshot.trackers[tracker] = asStrings(torrentIDs);
-
-    m_maindataSnapshot.serverState = getTransferInfo();
-    m_maindataSnapshot.serverState[KEY_TRANSFER_FREESPACEONDISK] = m_freeDiskSpace;
-    m_maindataSnapshot.serverState[KEY_SYNC_MAINDATA_QUEUEING] = session->isQueueingSystemEnabled();
-    m_maindataSnapshot.serverState[KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS] = session->isAltGlobalSpeedLimitEnabled();
-    m_maindataSnapshot.serverState[KEY_SYNC_MAINDATA_REFRESH_INTERVAL] = session->refreshInterval();
-}
-
-QJsonObject SyncController::generateMaindataSyncData(const int id, const bool fullUpdate)
+// Pushes the same data as "maindata" as Server-Sent Events ("text/event-stream").
+// Each event is named "maindata", its "id" is the response ID and its "data" is the map
+// described above. The first event is relative to the given response ID, the next ones
+// contain the changes since the previous event.
+// GET params:
+//   - rid (int): last response id
+//   - interval (int): minimum interval between events in milliseconds (default: WebUI refresh interval)
+void SyncController::eventsAction()
 {
-    // if need to update existing sync data
-    for (const QString &category : asConst(m_updatedCategories))
-        m_maindataSyncBuf.removedCategories.removeOne(category);
-    for (const QString &category : asConst(m_removedCategories))
-        m_maindataSyncBuf.categories.remove(category);
-
-    for (const QString &tag : asConst(m_addedTags))
-        m_maindataSyncBuf.removedTags.removeOne(tag);
-    for (const QString &tag : asConst(m_removedTags))
-        m_maindataSyncBuf.tags.removeOne(tag);
-
-    for (const BitTorrent::TorrentID &torrentID : asConst(m_updatedTorrents))
-        m_maindataSyncBuf.removedTorrents.removeOne(torrentID.toString());
-
-    for (const BitTorrent::TorrentID &torrentID : asConst(m_removedTorrents))
-    {
-        const QString torrentIDStr = torrentID.toString();
-        m_maindataSyncBuf.torrents.remove(torrentIDStr);
-    }
-
-    for (const QString &tracker : asConst(m_updatedTrackers))
-        m_maindataSyncBuf.removedTrackers.removeOne(tracker);
-    for (const QString &tracker : asConst(m_removedTrackers))
-        m_maindataSyncBuf.trackers.remove(tracker);
-
-    const auto *session = BitTorrent::Session::instance();
-
-    for (const QString &categoryName : asConst(m_updatedCategories))
-    {
-        const BitTorrent::CategoryOptions categoryOptions = session->categoryOptions(categoryName);
-        auto category = categoryOptions.toJSON().toVariantMap();
-        // adjust it to be compatible with existing WebAPI
-        category[u"savePath"_s] = category.take(u"save_path"_s);
-        category.insert(u"name"_s, categoryName);
-
-        auto &categorySnapshot = m_maindataSnapshot.categories[categoryName];
-        if (const QVariantMap syncData = processMap(categorySnapshot, category); !syncData.isEmpty())
-        {
-            m_maindataSyncBuf.categories[categoryName] = syncData;
-            categorySnapshot = category;
-        }
-    }
-    m_updatedCategories.clear();
-
-    for (const QString &category : asConst(m_removedCategories))
-    {
-        m_maindataSyncBuf.removedCategories.append(category);
-        m_maindataSnapshot.categories.remove(category);
-    }
-    m_removedCategories.clear();
-
-    for (const QString &tag : asConst(m_addedTags))
-    {
-        m_maindataSyncBuf.tags.append(tag);
-        m_maindataSnapshot.tags.append(tag);
-    }
-    m_addedTags.clear();
-
-    for (const QString &tag : asConst(m_removedTags))
-    {
-        m_maindataSyncBuf.removedTags.append(tag);
-        m_maindataSnapshot.tags.removeOne(tag);
-    }
-    m_removedTags.clear();
-
-    for (const BitTorrent::TorrentID &torrentID : asConst(m_updatedTorrents))
-    {
-        const BitTorrent::Torrent *torrent = session->getTorrent(torrentID);
-        Q_ASSERT(torrent);
-
-        QVariantMap serializedTorrent = serialize(*torrent);
-        serializedTorrent.remove(KEY_TORRENT_ID);
-
-        const QString torrentIDStr = torrentID.toString();
-        auto &torrentSnapshot = m_maindataSnapshot.torrents[torrentIDStr];
-
-        if (m_announcedTorrents.contains(torrentID))
-        {
-            addAnnounceStats(serializedTorrent, torrent);
-        }
-        else
-        {
-            serializedTorrent[KEY_TORRENT_HAS_TRACKER_WARNING] = torrentSnapshot[KEY_TORRENT_HAS_TRACKER_WARNING];
-            serializedTorrent[KEY_TORRENT_HAS_TRACKER_ERROR] = torrentSnapshot[KEY_TORRENT_HAS_TRACKER_ERROR];
-            serializedTorrent[KEY_TORRENT_HAS_OTHER_ANNOUNCE_ERROR] = torrentSnapshot[KEY_TORRENT_HAS_OTHER_ANNOUNCE_ERROR];
-        }
-
-        if (const QVariantMap syncData = processMap(torrentSnapshot, serializedTorrent); !syncData.isEmpty())
-        {
-            m_maindataSyncBuf.torrents[torrentIDStr] = syncData;
-            torrentSnapshot = serializedTorrent;
-        }
-    }
-
-    for (const BitTorrent::TorrentID &torrentID : asConst(m_announcedTorrents))
-    {
-        if (m_updatedTorrents.contains(torrentID))
-            continue;
-
-        const BitTorrent::Torrent *torrent = session->getTorrent(torrentID);
-        Q_ASSERT(torrent);
-
-        const QString torrentIDStr = torrentID.toString();
-        auto &torrentSnapshot = m_maindataSnapshot.torrents[torrentIDStr];
-
-        // Only announce stats are changed so don't need to serialize torrent again
-        QVariantMap serializedTorrent = torrentSnapshot;
-        addAnnounceStats(serializedTorrent, torrent);
-
-        if (const QVariantMap syncData = processMap(torrentSnapshot, serializedTorrent); !syncData.isEmpty())
-        {
-            m_maindataSyncBuf.torrents[torrentIDStr] = syncData;
-            torrentSnapshot = serializedTorrent;
-        }
-    }
-
-    m_updatedTorrents.clear();
-    m_announcedTorrents.clear();
-
-    for (const BitTorrent::TorrentID &torrentID : asConst(m_removedTorrents))
-    {
-        const QString torrentIDStr = torrentID.toString();
-
-        m_maindataSyncBuf.removedTorrents.append(torrentIDStr);
-        m_maindataSnapshot.torrents.remove(torrentIDStr);
-    }
-    m_removedTorrents.clear();
-
-    for (const QString &tracker : asConst(m_updatedTrackers))
-    {
-        const QStringList serializedTorrentIDs = asStrings(m_knownTrackers[tracker]);
-
-        m_maindataSyncBuf.trackers[tracker] = serializedTorrentIDs;
-        m_maindataSnapshot.trackers[tracker] = serializedTorrentIDs;
-    }
-    m_updatedTrackers.clear();
-
-    for (const QString &tracker : asConst(m_removedTrackers))
-    {
-        m_maindataSyncBuf.removedTrackers.append(tracker);
-        m_maindataSnapshot.trackers.remove(tracker);
-    }
-    m_removedTrackers.clear();
-
-    QVariantMap serverState = getTransferInfo();
-    serverState[KEY_TRANSFER_FREESPACEONDISK] = m_freeDiskSpace;
-    serverState[KEY_SYNC_MAINDATA_QUEUEING] = session->isQueueingSystemEnabled();
-    serverState[KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS] = session->isAltGlobalSpeedLimitEnabled();
-    serverState[KEY_SYNC_MAINDATA_REFRESH_INTERVAL] = session->refreshInterval();
-    if (const QVariantMap syncData = processMap(m_maindataSnapshot.serverState, serverState); !syncData.isEmpty())
-    {
-        m_maindataSyncBuf.serverState = syncData;
-        m_maindataSnapshot.serverState = serverState;
-    }
-
-    QJsonObject syncData;
-    syncData[KEY_RESPONSE_ID] = id;
-    if (fullUpdate)
-    {
-        m_maindataSyncBuf = m_maindataSnapshot;
-        syncData[KEY_FULL_UPDATE] = true;
-    }
-
-    if (!m_maindataSyncBuf.categories.isEmpty())
-    {
-        QJsonObject categories;
-        for (auto it = m_maindataSyncBuf.categories.cbegin(); it != m_maindataSyncBuf.categories.cend(); ++it)
-            categories[it.key()] = QJsonObject::fromVariantMap(it.value());
-        syncData[KEY_CATEGORIES] = categories;
-    }
-    if (!m_maindataSyncBuf.removedCategories.isEmpty())
-        syncData[KEY_CATEGORIES_REMOVED] = QJsonArray::fromStringList(m_maindataSyncBuf.removedCategories);
-
-    if (!m_maindataSyncBuf.tags.isEmpty())
-        syncData[KEY_TAGS] = QJsonArray::fromVariantList(m_maindataSyncBuf.tags);
-    if (!m_maindataSyncBuf.removedTags.isEmpty())
-        syncData[KEY_TAGS_REMOVED] = QJsonArray::fromStringList(m_maindataSyncBuf.removedTags);
-
-    if (!m_maindataSyncBuf.torrents.isEmpty())
-    {
-        QJsonObject torrents;
-        for (auto it = m_maindataSyncBuf.torrents.cbegin(); it != m_maindataSyncBuf.torrents.cend(); ++it)
-            torrents[it.key()] = QJsonObject::fromVariantMap(it.value());
-        syncData[KEY_TORRENTS] = torrents;
-    }
-    if (!m_maindataSyncBuf.removedTorrents.isEmpty())
-        syncData[KEY_TORRENTS_REMOVED] = QJsonArray::fromStringList(m_maindataSyncBuf.removedTorrents);
+    const int acceptedID = params()[u"rid"_s].toInt();
+    if ((acceptedID > 0) && ((acceptedID == m_maindataLastSentID) || (acceptedID == m_maindataAcceptedID)))
+        m_maindataAcceptedID = acceptedID;
+    else
+        m_maindataAcceptedID = 0;
 
-    if (!m_maindataSyncBuf.trackers.isEmpty())
+    std::chrono::milliseconds interval {BitTorrent::Session::instance()->refreshInterval()};
+    if (const QString intervalParam = params()[u"interval"_s]; !intervalParam.isEmpty())
     {
-        QJsonObject trackers;
-        for (auto it = m_maindataSyncBuf.trackers.cbegin(); it != m_maindataSyncBuf.trackers.cend(); ++it)
-            trackers[it.key()] = QJsonArray::fromStringList(it.value());
-        syncData[KEY_TRACKERS] = trackers;
+        bool ok = false;
+        const int value = intervalParam.toInt(&ok);
+        if (!ok || (value < 0))
+            throw APIError(APIErrorType::BadParams, tr("'interval' parameter is invalid"));
+        interval = std::chrono::milliseconds(value);
     }
-    if (!m_maindataSyncBuf.removedTrackers.isEmpty())
-        syncData[KEY_TRACKERS_REMOVED] = QJsonArray::fromStringList(m_maindataSyncBuf.removedTrackers);
-
-    if (!m_maindataSyncBuf.serverState.isEmpty())
-        syncData[KEY_SERVER_STATE] = QJsonObject::fromVariantMap(m_maindataSyncBuf.serverState);
 
-    return syncData;
+    setResult(SyncEventStream::create(m_maindataChangeLog, m_maindataAcceptedID, std::max(interval, MIN_EVENTS_INTERVAL))
+            , Http::CONTENT_TYPE_EVENT_STREAM);
 }
 
 // GET param:
@@ -838,14 +433,29 @@ void SyncController::torrentPeersAction()
     QVariantMap data;
     QVariantHash peers;
 
-    const QList<BitTorrent::PeerInfo> peersList = torrent->fetchPeerInfo().takeResult();
+    QList<BitTorrent::PeerInfo> peersList = torrent->fetchPeerInfo().takeResult();
 
     const auto *pref = Preferences::instance();
     const bool resolvePeerHostNames = pref->resolvePeerHostNames();
     const bool resolvePeerCountries = pref->resolvePeerCountries();
+    if (resolvePeerCountries)
+        BitTorrent::PeerInfo::resolveCountries(peersList);
 
     data[KEY_SYNC_TORRENT_PEERS_SHOW_FLAGS] = resolvePeerCountries;
 
+    QHash<QHostAddress, QString> hostNames;
+    if (resolvePeerHostNames)
+    {
+        QList<QHostAddress> peerIPs;
+        peerIPs.reserve(peersList.size());
+        for (const BitTorrent::PeerInfo &pi : asConst(peersList))
+        {
+            if (!pi.useI2PSocket())
+                peerIPs.append(pi.address().ip);
+        }
+        hostNames = Net::ReverseResolution::instance()->resolve(peerIPs);
+    }
+
     for (const BitTorrent::PeerInfo &pi : peersList)
     {
         const BitTorrent::PeerAddress address = pi.address();
@@ -890,9 +500,7 @@ void SyncController::torrentPeersAction()
             peer[KEY_PEER_IP] = address.ip.toString();
             peer[KEY_PEER_PORT] = address.port;
 
-            peer[KEY_PEER_HOST_NAME] = resolvePeerHostNames
-                ? Net::ReverseResolution::instance()->resolve(address.ip)
-                : QString();
+            peer[KEY_PEER_HOST_NAME] = hostNames.value(address.ip);
 
             if (resolvePeerCountries)
             {
@@ -914,200 +522,3 @@ void SyncController::torrentPeersAction()
     const int acceptedResponseId = params()[u"rid"_s].toInt();
     setResult(generateSyncData(acceptedResponseId, data, m_lastAcceptedPeersResponse, m_lastPeersResponse));
 }
-
-void SyncController::onCategoryAdded(const QString &categoryName)
-{
-    m_removedCategories.remove(categoryName);
-    m_updatedCategories.insert(categoryName);
-}
-
-void SyncController::onCategoryRemoved(const QString &categoryName)
-{
-    m_updatedCategories.remove(categoryName);
-    m_removedCategories.insert(categoryName);
-}
-
-void SyncController::onCategoryOptionsChanged(const QString &categoryName)
-{
-    Q_ASSERT(!m_removedCategories.contains(categoryName));
-
-    m_updatedCategories.insert(categoryName);
-}
-
-void SyncController::onSubcategoriesSupportChanged()
-{
-    const QStringList categoriesList = BitTorrent::Session::instance()->categories();
-    for (const auto &categoryName : categoriesList)
-    {
-        if (!m_maindataSnapshot.categories.contains(categoryName))
-        {
-            m_removedCategories.remove(categoryName);
-            m_updatedCategories.insert(categoryName);
-        }
-    }
-}
-
-void SyncController::onTagAdded(const Tag &tag)
-{
-    m_removedTags.remove(tag.toString());
-    m_addedTags.insert(tag.toString());
-}
-
-void SyncController::onTagRemoved(const Tag &tag)
-{
-    m_addedTags.remove(tag.toString());
-    m_removedTags.insert(tag.toString());
-}
-
-void SyncController::onTorrentAdded(BitTorrent::Torrent *torrent)
-{
-    const BitTorrent::TorrentID torrentID = torrent->id();
-
-    m_removedTorrents.remove(torrentID);
-    m_updatedTorrents.insert(torrentID);
-    m_announcedTorrents.insert(torrentID);
-
-    for (const BitTorrent::TrackerEntryStatus &status : asConst(torrent->trackers()))
-    {
-        m_knownTrackers[status.url].insert(torrentID);
-        m_updatedTrackers.insert(status.url);
-        m_removedTrackers.remove(status.url);
-    }
-}
-
-void SyncController::onTorrentAboutToBeRemoved(BitTorrent::Torrent *torrent)
-{
-    const BitTorrent::TorrentID torrentID = torrent->id();
-
-    m_announcedTorrents.remove(torrentID);
-    m_updatedTorrents.remove(torrentID);
-    m_removedTorrents.insert(torrentID);
-
-    for (const BitTorrent::TrackerEntryStatus &status : asConst(torrent->trackers()))
-    {
-        const auto iter = m_knownTrackers.find(status.url);
-        Q_ASSERT(iter != m_knownTrackers.end());
-        if (iter == m_knownTrackers.end()) [[unlikely]]
-            continue;
-
-        QSet<BitTorrent::TorrentID> &torrentIDs = iter.value();
-        torrentIDs.remove(torrentID);
-        if (torrentIDs.isEmpty())
-        {
-            m_knownTrackers.erase(iter);
-            m_updatedTrackers.remove(status.url);
-            m_removedTrackers.insert(status.url);
-        }
-        else
-        {
-            m_updatedTrackers.insert(status.url);
-        }
-    }
-}
-
-void SyncController::onTorrentCategoryChanged(BitTorrent::Torrent *torrent
-        , [[maybe_unused]] const QString &oldCategory)
-{
-    m_updatedTorrents.insert(torrent->id());
-}
-
-void SyncController::onTorrentMetadataReceived(BitTorrent::Torrent *torrent)
-{
-    m_updatedTorrents.insert(torrent->id());
-}
-
-void SyncController::onTorrentStopped(BitTorrent::Torrent *torrent)
-{
-    m_updatedTorrents.insert(torrent->id());
-    m_announcedTorrents.insert(torrent->id());
-}
-
-void SyncController::onTorrentStarted(BitTorrent::Torrent *torrent)
-{
-    m_updatedTorrents.insert(torrent->id());
-}
-
-void SyncController::onTorrentSavePathChanged(BitTorrent::Torrent *torrent)
-{
-    m_updatedTorrents.insert(torrent->id());
-}
-
-void SyncController::onTorrentSavingModeChanged(BitTorrent::Torrent *torrent)
-{
-    m_updatedTorrents.insert(torrent->id());
-}
-
-void SyncController::onTorrentTagAdded(BitTorrent::Torrent *torrent, [[maybe_unused]] const Tag &tag)
-{
-    m_updatedTorrents.insert(torrent->id());
-}
-
-void SyncController::onTorrentTagRemoved(BitTorrent::Torrent *torrent, [[maybe_unused]] const Tag &tag)
-{
-    m_updatedTorrents.insert(torrent->id());
-}
-
-void SyncController::onTorrentsUpdated(const QList<BitTorrent::Torrent *> &torrents)
-{
-    for (const BitTorrent::Torrent *torrent : torrents)
-        m_updatedTorrents.insert(torrent->id());
-}
-
-void SyncController::onTorrentTrackersChanged(BitTorrent::Torrent *torrent)
-{
-    using namespace BitTorrent;
-
-    const QList<TrackerEntryStatus> trackers = torrent->trackers();
-
-    QSet<QString> currentTrackers;
-    currentTrackers.reserve(trackers.size());
-    for (const TrackerEntryStatus &status : trackers)
-        currentTrackers.insert(status.url);
-
-    const TorrentID torrentID = torrent->id();
-    Algorithm::removeIf(m_knownTrackers
-        , [this, torrentID, currentTrackers](const QString &knownTracker, QSet<TorrentID> &torrentIDs)
-    {
-        if (auto idIter = torrentIDs.find(torrentID)
-                ; (idIter != torrentIDs.end()) && !currentTrackers.contains(knownTracker))
-        {
-            torrentIDs.erase(idIter);
-            if (torrentIDs.isEmpty())
-            {
-                m_updatedTrackers.remove(knownTracker);
-                m_removedTrackers.insert(knownTracker);
-                return true;
-            }
-
-            m_updatedTrackers.insert(knownTracker);
-            return false;
-        }
-
-        if (currentTrackers.contains(knownTracker) && !torrentIDs.contains(torrentID))
-        {
-            torrentIDs.insert(torrentID);
-            m_updatedTrackers.insert(knownTracker);
-            return false;
-        }
-
-        return false;
-    });
-
-    for (const QString &currentTracker : asConst(currentTrackers))
-    {
-        if (!m_knownTrackers.contains(currentTracker))
-        {
-            m_knownTrackers.insert(currentTracker, {torrentID});
-            m_updatedTrackers.insert(currentTracker);
-            m_removedTrackers.remove(currentTracker);
-        }
-    }
-
-    m_announcedTorrents.insert(torrentID);
-}
-
-void SyncController::onTorrentTrackerEntryStatusesUpdated(const BitTorrent::Torrent *torrent
-        , [[maybe_unused]] const QHash<QString, BitTorrent::TrackerEntryStatus> &updatedTrackers)
-{
-    m_announcedTorrents.insert(torrent->id());
-}
@@ -0,0 +1,157 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "synceventstream.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QTimer>
+
+#include "base/global.h"
+#include "webui/maindatachangelog.h"
+#include "jsonstream.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    // keeps the connection from being dropped by proxies when there are no changes for long
+    const std::chrono::seconds HEARTBEAT_INTERVAL {30};
+}
+
+std::shared_ptr<SyncEventStream> SyncEventStream::create(MaindataChangeLog *changeLog, const int revision
+        , const std::chrono::milliseconds minInterval)
+{
+    // the stream can be released in the thread serving the connection while it must be deleted in its own thread
+    return {new SyncEventStream(changeLog, revision, minInterval), [](SyncEventStream *stream) { stream->deleteLater(); }};
+}
+
+SyncEventStream::SyncEventStream(MaindataChangeLog *changeLog, const int revision, const std::chrono::milliseconds minInterval)
+    : m_changeLog {changeLog}
+    , m_revision {revision}
+    , m_minInterval {minInterval}
+    , m_eventTimer {new QTimer(this)}
+    , m_heartbeatTimer {new QTimer(this)}
+{
+    m_eventTimer->setSingleShot(true);
+    connect(m_eventTimer, &QTimer::timeout, this, &SyncEventStream::prepareEvent);
+
+    m_heartbeatTimer->setInterval(HEARTBEAT_INTERVAL);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, &SyncEventStream::sendHeartbeat);
+    m_heartbeatTimer->start();
+
+    connect(changeLog, &MaindataChangeLog::changed, this, &SyncEventStream::scheduleEvent);
+    connect(changeLog, &QObject::destroyed, this, &SyncEventStream::notifyReadyRead);
+
+    // the first event is sent immediately
+    scheduleEvent();
+}
+
+bool SyncEventStream::atEnd() const
+{
+    return !m_changeLog && !m_eventData && m_pendingData.isEmpty();
+}
+
+QByteArray SyncEventStream::read()
+{
+    QByteArray data = std::exchange(m_pendingData, {});
+    if (m_eventData)
+    {
+        data += m_eventData->read();
+        if (m_eventData->atEnd())
+        {
+            data += "\n\n";
+            m_eventData.reset();
+            m_heartbeatTimer->start();
+
+            if (m_hasChanges)
+                scheduleEvent();
+        }
+    }
+
+    return data;
+}
+
+bool SyncEventStream::isReadyRead() const
+{
+    return m_eventData || !m_pendingData.isEmpty() || atEnd();
+}
+
+void SyncEventStream::setReadyReadHandler(std::function<void ()> handler)
+{
+    m_readyReadHandler = std::move(handler);
+}
+
+void SyncEventStream::scheduleEvent()
+{
+    m_hasChanges = true;
+
+    // changes made while an event is being sent are sent with the next one
+    if (m_eventData || m_eventTimer->isActive())
+        return;
+
+    const auto elapsed = m_lastEventTimer.isValid() ? std::chrono::milliseconds(m_lastEventTimer.elapsed()) : m_minInterval;
+    m_eventTimer->start(std::max(0ms, (m_minInterval - elapsed)));
+}
+
+void SyncEventStream::prepareEvent()
+{
+    if (!m_changeLog)
+        return;
+
+    m_hasChanges = false;
+
+    std::shared_ptr<JSONStream> eventData = m_changeLog->syncData(m_revision);
+    const int revision = m_changeLog->revision();
+    // changes could be reverted in the meantime
+    if (m_lastEventTimer.isValid() && (revision == m_revision))
+        return;
+
+    m_revision = revision;
+    m_eventData = std::move(eventData);
+    m_pendingData += u"id: %1\nevent: maindata\ndata: "_s.arg(revision).toUtf8();
+    m_lastEventTimer.start();
+
+    notifyReadyRead();
+}
+
+void SyncEventStream::sendHeartbeat()
+{
+    if (m_eventData || !m_pendingData.isEmpty())
+        return;
+
+    m_pendingData = ": heartbeat\n\n";
+    notifyReadyRead();
+}
+
+void SyncEventStream::notifyReadyRead()
+{
+    if (m_readyReadHandler)
+        std::exchange(m_readyReadHandler, {})();
+}
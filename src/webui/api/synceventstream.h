@@ -0,0 +1,83 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+
+#include "base/http/response.h"
+
+class QTimer;
+
+class JSONStream;
+class MaindataChangeLog;
+
+// Pushes the changes of "sync/maindata" data as Server-Sent Events.
+// Changes are coalesced so that events are sent no more often than the given interval,
+// and the next event is prepared only after the previous one is completely read by the connection.
+class SyncEventStream final : public QObject, public Http::IContentStream
+{
+    Q_DISABLE_COPY_MOVE(SyncEventStream)
+
+public:
+    // Data of the first event is relative to `revision` or full data if it is outdated
+    static std::shared_ptr<SyncEventStream> create(MaindataChangeLog *changeLog, int revision
+            , std::chrono::milliseconds minInterval);
+
+    bool atEnd() const override;
+    QByteArray read() override;
+    bool isReadyRead() const override;
+    void setReadyReadHandler(std::function<void ()> handler) override;
+
+private:
+    SyncEventStream(MaindataChangeLog *changeLog, int revision, std::chrono::milliseconds minInterval);
+
+    void scheduleEvent();
+    void prepareEvent();
+    void sendHeartbeat();
+    void notifyReadyRead();
+
+    QPointer<MaindataChangeLog> m_changeLog;
+    int m_revision = 0;
+    std::chrono::milliseconds m_minInterval;
+    QTimer *m_eventTimer = nullptr;
+    QTimer *m_heartbeatTimer = nullptr;
+    QElapsedTimer m_lastEventTimer;
+    bool m_hasChanges = false;
+
+    QByteArray m_pendingData;
+    std::shared_ptr<JSONStream> m_eventData;
+    std::function<void ()> m_readyReadHandler;
+};
@@ -53,6 +53,7 @@ const QString KEY_SOURCE = u"source"_s;
 const QString KEY_SOURCE_PATH = u"sourcePath"_s;
 const QString KEY_STATUS = u"status"_s;
 const QString KEY_TASK_ID = u"taskID"_s;
+const QString KEY_THROUGHPUT = u"throughput"_s;
 const QString KEY_TIME_ADDED = u"timeAdded"_s;
 const QString KEY_TIME_FINISHED = u"timeFinished"_s;
 const QString KEY_TIME_STARTED = u"timeStarted"_s;
@@ -219,6 +220,7 @@ void TorrentCreatorController::statusAction()
         else if (task->isRunning())
         {
             taskJson[KEY_PROGRESS] = task->progress();
+            taskJson[KEY_THROUGHPUT] = task->throughput();
         }
 
         statusArray.append(taskJson);
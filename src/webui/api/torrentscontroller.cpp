@@ -31,8 +31,10 @@
 #include <algorithm>
 #include <chrono>
 #include <concepts>
+#include <numeric>
+#include <utility>
+#include <vector>
 
-#include <QBitArray>
 #include <QFileInfo>
 #include <QFuture>
 #include <QJsonArray>
@@ -42,6 +44,7 @@
 #include <QUrl>
 
 #include "base/addtorrentmanager.h"
+#include "base/bittorrent/bitfield.h"
 #include "base/bittorrent/categoryoptions.h"
 #include "base/bittorrent/downloadpriority.h"
 #include "base/bittorrent/infohash.h"
@@ -68,7 +71,9 @@
 #include "base/utils/string.h"
 #include "apierror.h"
 #include "apistatus.h"
+#include "jsonstream.h"
 #include "serialize/serialize_torrent.h"
+#include "webui/maindatachangelog.h"
 
 // Tracker keys
 const QString KEY_TRACKER_URL = u"url"_s;
@@ -146,6 +151,12 @@ const QString KEY_FILE_IS_SEED = u"is_seed"_s;
 const QString KEY_FILE_PIECE_RANGE = u"piece_range"_s;
 const QString KEY_FILE_AVAILABILITY = u"availability"_s;
 
+// Files sync data keys
+const QString KEY_FILES = u"files"_s;
+const QString KEY_FILES_FULL_UPDATE = u"full_update"_s;
+const QString KEY_FILES_RID = u"rid"_s;
+const QString KEY_FILES_TOTAL = u"total"_s;
+
 // Torrent info
 const QString KEY_TORRENTINFO_FILE_LENGTH = u"length"_s;
 const QString KEY_TORRENTINFO_FILE_PATH = u"path"_s;
@@ -185,22 +196,18 @@ namespace
         }
     }
 
-    std::optional<QString> getOptionalString(const StringMap &params, const QString &name)
+    std::optional<QString> getOptionalString(const APIParams &params, const QString &name)
     {
-        const auto it = params.constFind(name);
-        if (it == params.cend())
-            return std::nullopt;
-
-        return it.value();
+        return params.optionalValue(name);
     }
 
-    std::optional<Tag> getOptionalTag(const StringMap &params, const QString &name)
+    std::optional<Tag> getOptionalTag(const APIParams &params, const QString &name)
     {
-        const auto it = params.constFind(name);
-        if (it == params.cend())
+        const std::optional<QString> value = params.optionalValue(name);
+        if (!value)
             return std::nullopt;
 
-        return Tag(it.value());
+        return Tag(*value);
     }
 
     QJsonArray getStickyTrackers(const BitTorrent::Torrent *const torrent)
@@ -331,43 +338,52 @@ namespace
         return trackerList;
     }
 
-    QJsonArray getFiles(const BitTorrent::Torrent *const torrent, QList<int> fileIndexes = {})
+    // The data shared by all the files of torrent, it allows to serialize each file separately
+    struct TorrentFilesData
+    {
+        QList<BitTorrent::DownloadPriority> priorities;
+        QList<qreal> progress;
+        QList<qreal> availability;
+        BitTorrent::TorrentInfo info;
+    };
+
+    TorrentFilesData getFilesData(const BitTorrent::Torrent *const torrent)
+    {
+        return {
+            .priorities = torrent->filePriorities(),
+            .progress = torrent->filesProgress(),
+            .availability = torrent->fetchAvailableFileFractions().takeResult(),
+            .info = torrent->info()
+        };
+    }
+
+    QJsonObject serializeFile(const BitTorrent::Torrent *const torrent, const TorrentFilesData &filesData, const int index)
+    {
+        const BitTorrent::TorrentInfo::PieceRange idx = filesData.info.filePieces(index);
+
+        return {
+            {KEY_FILE_INDEX, index},
+            {KEY_FILE_PROGRESS, filesData.progress[index]},
+            {KEY_FILE_PRIORITY, static_cast<int>(filesData.priorities[index])},
+            {KEY_FILE_SIZE, torrent->fileSize(index)},
+            {KEY_FILE_AVAILABILITY, filesData.availability[index]},
+            // need to provide paths using a platform-independent separator format
+            {KEY_FILE_NAME, torrent->filePath(index).data()},
+            {KEY_FILE_PIECE_RANGE, QJsonArray {idx.first(), idx.last()}}
+        };
+    }
+
+    QJsonArray getFiles(const BitTorrent::Torrent *const torrent)
     {
         Q_ASSERT(torrent->hasMetadata());
         if (!torrent->hasMetadata()) [[unlikely]]
             return {};
 
-        if (fileIndexes.isEmpty())
-        {
-            const int filesCount = torrent->filesCount();
-            fileIndexes.reserve(filesCount);
-            for (int i = 0; i < filesCount; ++i)
-                fileIndexes.append(i);
-        }
-
         QJsonArray fileList;
-        const QList<BitTorrent::DownloadPriority> priorities = torrent->filePriorities();
-        const QList<qreal> fp = torrent->filesProgress();
-        const QList<qreal> fileAvailability = torrent->fetchAvailableFileFractions().takeResult();
-        const BitTorrent::TorrentInfo info = torrent->info();
-        for (const int index : asConst(fileIndexes))
-        {
-            const BitTorrent::TorrentInfo::PieceRange idx = info.filePieces(index);
-
-            const QJsonObject fileDict =
-            {
-                {KEY_FILE_INDEX, index},
-                {KEY_FILE_PROGRESS, fp[index]},
-                {KEY_FILE_PRIORITY, static_cast<int>(priorities[index])},
-                {KEY_FILE_SIZE, torrent->fileSize(index)},
-                {KEY_FILE_AVAILABILITY, fileAvailability[index]},
-                // need to provide paths using a platform-independent separator format
-                {KEY_FILE_NAME, torrent->filePath(index).data()},
-                {KEY_FILE_PIECE_RANGE, QJsonArray {idx.first(), idx.last()}}
-            };
-
-            fileList.append(fileDict);
-        }
+        const TorrentFilesData filesData = getFilesData(torrent);
+        const int filesCount = torrent->filesCount();
+        for (int index = 0; index < filesCount; ++index)
+            fileList.append(serializeFile(torrent, filesData, index));
 
         return fileList;
     }
@@ -549,17 +565,39 @@ namespace
 
         return TorrentFilter::All;
     }
+
+    TorrentFilter parseTorrentFilter(const APIParams &params)
+    {
+        const QStringList hashes {params[u"hashes"_s].split(u'|', Qt::SkipEmptyParts)};
+        std::optional<TorrentIDSet> idSet;
+        if (!hashes.isEmpty())
+        {
+            idSet = TorrentIDSet();
+            for (const QString &hash : hashes)
+                idSet->insert(BitTorrent::TorrentID::fromString(hash));
+        }
+
+        return {parseTorrentStatus(params[u"filter"_s]), idSet, getOptionalString(params, u"category"_s)
+                , getOptionalTag(params, u"tag"_s), parseBool(params[u"private"_s])};
+    }
 }
 
-TorrentsController::TorrentsController(IApplication *app, QObject *parent)
+TorrentsController::TorrentsController(MaindataChangeLog *maindataChangeLog, IApplication *app, QObject *parent)
     : APIController(app, parent)
+    , m_maindataChangeLog {maindataChangeLog}
 {
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::metadataDownloaded, this, &TorrentsController::onMetadataDownloaded);
 }
 
+// Accepts the same filtering parameters as "torrents/info"
 void TorrentsController::countAction()
 {
-    setResult(QString::number(BitTorrent::Session::instance()->torrentsCount()));
+    const auto *session = BitTorrent::Session::instance();
+    const TorrentFilter torrentFilter = parseTorrentFilter(params());
+    const qsizetype count = ((torrentFilter.status() == TorrentFilter::All) && !torrentFilter.torrentIDSet()
+            && !torrentFilter.category() && !torrentFilter.tag() && !torrentFilter.isPrivate())
+        ? session->torrentsCount() : session->torrents(torrentFilter).size();
+    setResult(QString::number(count));
 }
 
 // Returns all the torrents in JSON format.
@@ -597,90 +635,51 @@ void TorrentsController::countAction()
 //   - offset (int): set offset (if less than 0 - offset from end)
 void TorrentsController::infoAction()
 {
-    const QString filter {params()[u"filter"_s]};
-    const std::optional<QString> category = getOptionalString(params(), u"category"_s);
-    const std::optional<Tag> tag = getOptionalTag(params(), u"tag"_s);
     const QString sortedColumn {params()[u"sort"_s]};
     const bool reverse {parseBool(params()[u"reverse"_s]).value_or(false)};
     int limit {params()[u"limit"_s].toInt()};
     int offset {params()[u"offset"_s].toInt()};
-    const QStringList hashes {params()[u"hashes"_s].split(u'|', Qt::SkipEmptyParts)};
-    const std::optional<bool> isPrivate = parseBool(params()[u"private"_s]);
     const bool includeFiles = parseBool(params()[u"includeFiles"_s]).value_or(false);
     const bool includeTrackers = parseBool(params()[u"includeTrackers"_s]).value_or(false);
 
-    std::optional<TorrentIDSet> idSet;
-    if (!hashes.isEmpty())
-    {
-        idSet = TorrentIDSet();
-        for (const QString &hash : hashes)
-            idSet->insert(BitTorrent::TorrentID::fromString(hash));
-    }
-
-    const TorrentFilter torrentFilter {parseTorrentStatus(filter), idSet, category, tag, isPrivate};
-    QVariantList torrentList;
-    for (const BitTorrent::Torrent *torrent : asConst(BitTorrent::Session::instance()->torrents()))
-    {
-        if (!torrentFilter.match(torrent))
-            continue;
-
-        QVariantMap serializedTorrent = serialize(*torrent);
+    const TorrentFilter torrentFilter = parseTorrentFilter(params());
+    const auto *session = BitTorrent::Session::instance();
 
-        if (includeFiles && torrent->hasMetadata())
-            serializedTorrent.insert(KEY_PROP_FILES, getFiles(torrent));
-        if (includeTrackers)
-            serializedTorrent.insert(KEY_PROP_TRACKERS, getTrackers(torrent));
+    const int sortFieldIndex = sortedColumn.isEmpty() ? -1 : snapshotFieldIndex(sortedColumn);
+    if (!sortedColumn.isEmpty() && (sortFieldIndex < 0) && (sortedColumn != KEY_TORRENT_ID))
+        throw APIError(APIErrorType::BadParams, tr("'sort' parameter is invalid"));
 
-        torrentList.append(serializedTorrent);
-    }
-
-    if (torrentList.isEmpty())
+    QList<BitTorrent::TorrentID> torrentIDs;
+    if (sortFieldIndex >= 0)
     {
-        setResult(QJsonArray {});
-        return;
+        // Sorted order is maintained incrementally so there is no need to serialize all the torrents to sort them.
+        // The page starting at non-negative offset is known as soon as `offset + limit` matching torrents are found,
+        // otherwise all of them are required to find out where the page starts.
+        const qsizetype neededCount = ((offset >= 0) && (limit > 0)) ? (qsizetype(offset) + limit) : -1;
+        const QList<BitTorrent::TorrentID> sortedTorrentIDs = m_maindataChangeLog->sortedTorrents(sortFieldIndex);
+        const qsizetype sortedCount = sortedTorrentIDs.size();
+        for (qsizetype i = 0; (i < sortedCount) && (torrentIDs.size() != neededCount); ++i)
+        {
+            const BitTorrent::TorrentID &torrentID = sortedTorrentIDs[reverse ? (sortedCount - i - 1) : i];
+            const BitTorrent::Torrent *torrent = session->getTorrent(torrentID);
+            if (torrent && torrentFilter.match(torrent))
+                torrentIDs.append(torrentID);
+        }
     }
-
-    if (!sortedColumn.isEmpty())
+    else
     {
-        if (!torrentList[0].toMap().contains(sortedColumn))
-            throw APIError(APIErrorType::BadParams, tr("'sort' parameter is invalid"));
-
-        const auto lessThan = [](const QVariant &left, const QVariant &right) -> bool
-        {
-            Q_ASSERT(left.userType() == right.userType());
+        const QList<BitTorrent::Torrent *> torrents = session->torrents(torrentFilter);
+        torrentIDs.reserve(torrents.size());
+        for (const BitTorrent::Torrent *torrent : torrents)
+            torrentIDs.append(torrent->id());
 
-            switch (left.userType())
-            {
-            case QMetaType::Bool:
-                return left.value<bool>() < right.value<bool>();
-            case QMetaType::Double:
-                return left.value<double>() < right.value<double>();
-            case QMetaType::Float:
-                return left.value<float>() < right.value<float>();
-            case QMetaType::Int:
-                return left.value<int>() < right.value<int>();
-            case QMetaType::LongLong:
-                return left.value<qlonglong>() < right.value<qlonglong>();
-            case QMetaType::QString:
-                return left.value<QString>() < right.value<QString>();
-            default:
-                qWarning("Unhandled QVariant comparison, type: %d, name: %s"
-                        , left.userType(), left.metaType().name());
-                break;
-            }
-            return false;
-        };
-
-        std::ranges::sort(torrentList
-            , [reverse, &sortedColumn, &lessThan](const QVariant &torrent1, const QVariant &torrent2)
-        {
-            const QVariant value1 {torrent1.toMap().value(sortedColumn)};
-            const QVariant value2 {torrent2.toMap().value(sortedColumn)};
-            return reverse ? lessThan(value2, value1) : lessThan(value1, value2);
-        });
+        if (sortedColumn == KEY_TORRENT_ID)
+            std::sort(torrentIDs.begin(), torrentIDs.end());
+        if (reverse)
+            std::ranges::reverse(torrentIDs);
     }
 
-    const qsizetype size = torrentList.size();
+    const qsizetype size = torrentIDs.size();
     // normalize offset
     if (offset < 0)
         offset = size + offset;
@@ -689,9 +688,27 @@ void TorrentsController::infoAction()
         limit = -1; // unlimited
 
     if ((limit > 0) || (offset > 0))
-        torrentList = torrentList.mid(offset, limit);
+        torrentIDs = torrentIDs.mid(offset, limit);
 
-    setResult(QJsonArray::fromVariantList(torrentList));
+    // Serialize torrents only when they are about to be sent, so the response doesn't have to be held in memory at once
+    const auto serializeTorrent = [torrentIDs, includeFiles, includeTrackers](const qsizetype index) -> std::optional<QJsonObject>
+    {
+        // torrent could be removed while the response is being sent
+        const BitTorrent::Torrent *torrent = BitTorrent::Session::instance()->getTorrent(torrentIDs[index]);
+        if (!torrent)
+            return std::nullopt;
+
+        QVariantMap serializedTorrent = serialize(*torrent);
+
+        if (includeFiles && torrent->hasMetadata())
+            serializedTorrent.insert(KEY_PROP_FILES, getFiles(torrent));
+        if (includeTrackers)
+            serializedTorrent.insert(KEY_PROP_TRACKERS, getTrackers(torrent));
+
+        return QJsonObject::fromVariantMap(serializedTorrent);
+    };
+
+    setResult(JSONStream::createArray(torrentIDs.size(), serializeTorrent));
 }
 
 // Returns the properties for a torrent in JSON format.
@@ -958,23 +975,52 @@ void TorrentsController::removeWebSeedsAction()
 //   - "is_seed": Flag indicating if torrent is seeding/complete
 //   - "piece_range": Piece index range, the first number is the starting piece index
 //        and the second number is the ending piece index (inclusive)
+// GET params:
+//   - hash (string): torrent hash (ID)
+//   - indexes (string): only files with given indexes separated by "|" are returned
+//   - folder (string): only files inside given folder are returned
+//   - offset (int): offset in the list of the matching files (if less than 0 - offset from end)
+//   - limit (int): limit number of files returned (if greater than 0, otherwise - unlimited)
+//   - rid (int): response ID, if present the return value is a JSON-formatted dictionary:
+//       - "rid": response ID to pass with the next request
+//       - "full_update": false if only files changed since given response ID are included
+//       - "total": number of files matching "indexes" and "folder" params
+//       - "is_seed": Flag indicating if torrent is seeding/complete
+//       - "files": dictionary of file dictionaries keyed by file index
 void TorrentsController::filesAction()
 {
     requireParams({u"hash"_s});
 
     const auto id = BitTorrent::TorrentID::fromString(params()[u"hash"_s]);
-    const BitTorrent::Torrent *const torrent = BitTorrent::Session::instance()->getTorrent(id);
+    BitTorrent::Torrent *const torrent = BitTorrent::Session::instance()->getTorrent(id);
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
+
+    const std::optional<QString> ridParam = params().optionalValue(u"rid"_s);
+    const bool isSyncRequested = ridParam.has_value();
+    // invalid response ID results in full update
+    const quint64 rid = isSyncRequested ? ridParam->toULongLong() : 0;
+
     if (!torrent->hasMetadata())
+    {
+        if (isSyncRequested)
+        {
+            return setResult(QJsonObject {
+                {KEY_FILES_RID, 0},
+                {KEY_FILES_FULL_UPDATE, true},
+                {KEY_FILES_TOTAL, 0},
+                {KEY_FILES, QJsonObject()}
+            });
+        }
+
         return setResult(QJsonArray{});
+    }
 
+    const int filesCount = torrent->filesCount();
     QList<int> fileIndexes;
-    const auto idxIt = params().constFind(u"indexes"_s);
-    if (idxIt != params().cend())
+    if (const std::optional<QString> indexesParam = params().optionalValue(u"indexes"_s))
     {
-        const int filesCount = torrent->filesCount();
-        const QStringList indexStrings = idxIt.value().split(u'|');
+        const QStringList indexStrings = indexesParam->split(u'|');
         fileIndexes.reserve(indexStrings.size());
         for (const QString &indexString : indexStrings)
         {
@@ -987,16 +1033,94 @@ void TorrentsController::filesAction()
             fileIndexes.push_back(index);
         }
     }
+    else
+    {
+        fileIndexes.resize(filesCount);
+        std::iota(fileIndexes.begin(), fileIndexes.end(), 0);
+    }
+
+    if (const Path folderPath {params()[u"folder"_s]}; !folderPath.isEmpty())
+    {
+        const PathList filePaths = torrent->filePaths();
+        fileIndexes.removeIf([&filePaths, &folderPath](const int index)
+        {
+            return !filePaths[index].hasAncestor(folderPath);
+        });
+    }
+
+    const qsizetype totalFilesCount = fileIndexes.size();
+    qsizetype offset = params()[u"offset"_s].toInt();
+    qsizetype limit = params()[u"limit"_s].toInt();
+    // normalize offset
+    if (offset < 0)
+        offset = std::max<qsizetype>((totalFilesCount + offset), 0);
+    // normalize limit
+    if (limit <= 0)
+        limit = -1; // unlimited
+
+    if ((limit > 0) || (offset > 0))
+        fileIndexes = fileIndexes.mid(offset, limit);
+
+    const bool isSeed = torrent->isFinished();
 
-    QJsonArray fileList = getFiles(torrent, fileIndexes);
-    if (!fileList.isEmpty())
+    if (!isSyncRequested)
     {
-        QJsonObject firstFile = fileList[0].toObject();
-        firstFile[KEY_FILE_IS_SEED] = torrent->isFinished();
-        fileList[0] = firstFile;
+        // Serialize files only when they are about to be sent, so the response doesn't have to be held in memory at once
+        const auto serializeFileAt = [id, fileIndexes, isSeed, filesData = getFilesData(torrent)](const qsizetype i) -> std::optional<QJsonObject>
+        {
+            // torrent could be removed while the response is being sent
+            const BitTorrent::Torrent *torrent = BitTorrent::Session::instance()->getTorrent(id);
+            if (!torrent)
+                return std::nullopt;
+
+            QJsonObject file = serializeFile(torrent, filesData, fileIndexes[i]);
+            if (i == 0)
+                file[KEY_FILE_IS_SEED] = isSeed;
+            return file;
+        };
+
+        return setResult(JSONStream::createArray(fileIndexes.size(), serializeFileAt));
     }
 
-    setResult(fileList);
+    TorrentFilesData filesData = getFilesData(torrent);
+    torrent->updateFilesAvailability(filesData.availability);
+
+    // Only files whose progress, availability, priority or name changed since the previous response are sent,
+    // unless the client has no valid previous response
+    bool isFullUpdate = true;
+    if (rid > 0)
+    {
+        if (const std::optional<QList<int>> updatedFiles = torrent->updatedFiles(rid))
+        {
+            std::vector<bool> isUpdated(filesCount, false);
+            for (const int index : *updatedFiles)
+                isUpdated[index] = true;
+
+            fileIndexes.removeIf([&isUpdated](const int index) { return !isUpdated[index]; });
+            isFullUpdate = false;
+        }
+    }
+
+    const QJsonObject syncData {
+        {KEY_FILES_RID, static_cast<qint64>(torrent->filesRevision())},
+        {KEY_FILES_FULL_UPDATE, isFullUpdate},
+        {KEY_FILES_TOTAL, static_cast<qint64>(totalFilesCount)},
+        {KEY_FILE_IS_SEED, isSeed}
+    };
+
+    const auto serializeFileMember = [id, fileIndexes, filesData = std::move(filesData)](const qsizetype i)
+            -> std::optional<std::pair<QString, QJsonObject>>
+    {
+        // torrent could be removed while the response is being sent
+        const BitTorrent::Torrent *torrent = BitTorrent::Session::instance()->getTorrent(id);
+        if (!torrent)
+            return std::nullopt;
+
+        const int index = fileIndexes[i];
+        return std::pair {QString::number(index), serializeFile(torrent, filesData, index)};
+    };
+
+    setResult(JSONStream::createObject(syncData, KEY_FILES, fileIndexes.size(), serializeFileMember));
 }
 
 // Returns an array of hashes (of each pieces respectively) for a torrent in JSON format.
@@ -1035,16 +1159,17 @@ void TorrentsController::pieceStatesAction()
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
 
-    QJsonArray pieceStates;
-    const QBitArray states = torrent->pieces();
-    for (qsizetype i = 0; i < states.size(); ++i)
-        pieceStates.append(static_cast<int>(states[i]) * 2);
+    const BitTorrent::Bitfield states = torrent->pieces();
+    const BitTorrent::Bitfield dlstates = torrent->fetchDownloadingPieces().takeResult();
+    const qsizetype dlstatesSize = dlstates.size();
 
-    const QBitArray dlstates = torrent->fetchDownloadingPieces().takeResult();
+    QJsonArray pieceStates;
     for (qsizetype i = 0; i < states.size(); ++i)
     {
-        if (dlstates[i])
-            pieceStates[i] = 1;
+        if ((i < dlstatesSize) && dlstates[i])
+            pieceStates.append(1);
+        else
+            pieceStates.append(static_cast<int>(states[i]) * 2);
     }
 
     setResult(pieceStates);
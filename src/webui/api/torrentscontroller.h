@@ -35,6 +35,7 @@
 #include "apicontroller.h"
 
 class QByteArray;
+class MaindataChangeLog;
 
 namespace BitTorrent
 {
@@ -54,7 +55,7 @@ class TorrentsController : public APIController
     Q_DISABLE_COPY_MOVE(TorrentsController)
 
 public:
-    explicit TorrentsController(IApplication *app, QObject *parent = nullptr);
+    TorrentsController(MaindataChangeLog *maindataChangeLog, IApplication *app, QObject *parent = nullptr);
 
 private slots:
     void countAction();
@@ -126,6 +127,7 @@ private:
     void cacheTorrentFile(const QString &source, const QByteArray &data);
     void cacheMagnetURI(const QString &source, const BitTorrent::TorrentDescriptor &torrentDescr);
 
+    MaindataChangeLog *m_maindataChangeLog = nullptr;
     QHash<QString, BitTorrent::InfoHash> m_torrentSourceCache;
     QHash<BitTorrent::TorrentID, BitTorrent::TorrentDescriptor> m_torrentMetadataCache;
     QSet<QString> m_requestedTorrentSource;
@@ -28,13 +28,21 @@
 
 #include "transfercontroller.h"
 
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+#include <QDateTime>
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QList>
 
+#include "base/bittorrent/alertprofiler.h"
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/sessionstatus.h"
+#include "base/bittorrent/transferhistory.h"
 #include "base/global.h"
 #include "base/utils/string.h"
 #include "apierror.h"
@@ -50,6 +58,36 @@ const QString KEY_TRANSFER_LAST_EXTERNAL_ADDRESS_V6 = u"last_external_address_v6
 const QString KEY_TRANSFER_DHT_NODES = u"dht_nodes"_s;
 const QString KEY_TRANSFER_CONNECTION_STATUS = u"connection_status"_s;
 
+const QString KEY_HISTORY_RESOLUTION = u"resolution"_s;
+const QString KEY_HISTORY_START = u"start"_s;
+const QString KEY_HISTORY_DOWNLOADED = u"downloaded"_s;
+const QString KEY_HISTORY_UPLOADED = u"uploaded"_s;
+
+const QString KEY_ALERTS_ENABLED = u"enabled"_s;
+const QString KEY_ALERTS_DURATION = u"duration"_s;
+const QString KEY_ALERTS_BATCH_SIZE = u"batch_size"_s;
+const QString KEY_ALERTS_STATE_UPDATE_LATENCY = u"state_update_latency"_s;
+const QString KEY_ALERTS_TORRENTS_UPDATED_HANDLERS = u"torrents_updated_handlers"_s;
+const QString KEY_ALERTS_TYPES = u"alerts"_s;
+const QString KEY_ALERT_TYPE = u"type"_s;
+const QString KEY_ALERT_NAME = u"name"_s;
+
+namespace
+{
+    QJsonObject serialize(const BitTorrent::LatencyHistogram &histogram)
+    {
+        return {
+            {u"count"_s, static_cast<qint64>(histogram.count())},
+            {u"min"_s, static_cast<qint64>(histogram.min())},
+            {u"mean"_s, histogram.mean()},
+            {u"p50"_s, static_cast<qint64>(histogram.valueAtPercentile(50))},
+            {u"p90"_s, static_cast<qint64>(histogram.valueAtPercentile(90))},
+            {u"p99"_s, static_cast<qint64>(histogram.valueAtPercentile(99))},
+            {u"max"_s, static_cast<qint64>(histogram.max())}
+        };
+    }
+}
+
 // Returns the global transfer information in JSON format.
 // The return value is a JSON-formatted dictionary.
 // The dictionary keys are:
@@ -160,3 +198,138 @@ void TransferController::banPeersAction()
 
     setResult(QString());
 }
+
+// Returns the history of transferred payload data in JSON format.
+// Params:
+//   - "resolution": seconds per sample, one of 1, 60 or 3600 (defaults to 60)
+//   - "from", "to": UNIX timestamps of the range (defaults to the whole stored history)
+//   - "hash" or "category": limits history to the torrent or category
+// The return value is a JSON-formatted dictionary.
+// The dictionary keys are:
+//   - "resolution": seconds per sample
+//   - "start": UNIX timestamp of the first sample
+//   - "downloaded": bytes downloaded in each sample
+//   - "uploaded": bytes uploaded in each sample
+void TransferController::historyAction()
+{
+    auto *btSession = BitTorrent::Session::instance();
+
+    const int resolution = Utils::String::parseInt(params().value(u"resolution"_s)).value_or(BitTorrent::TransferHistory::MINUTE);
+    if ((resolution != BitTorrent::TransferHistory::SECOND) && (resolution != BitTorrent::TransferHistory::MINUTE)
+        && (resolution != BitTorrent::TransferHistory::HOUR))
+    {
+        throw APIError(APIErrorType::BadParams, tr("'resolution': invalid argument"));
+    }
+
+    const auto parseTimestamp = [this](const QString &name, const qint64 defaultValue) -> qint64
+    {
+        const QString value = params().value(name);
+        if (value.isEmpty())
+            return defaultValue;
+
+        bool ok = false;
+        const qint64 timestamp = value.toLongLong(&ok);
+        if (!ok || (timestamp < 0))
+            throw APIError(APIErrorType::BadParams, tr("'%1': invalid argument").arg(name));
+        return timestamp;
+    };
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const qint64 to = std::min(parseTimestamp(u"to"_s, now), now);
+    const qint64 from = parseTimestamp(u"from"_s, 0);
+
+    BitTorrent::TransferHistory *transferHistory = btSession->transferHistory();
+    BitTorrent::TransferHistoryRange range;
+    if (const QString hash = params().value(u"hash"_s); !hash.isEmpty())
+    {
+        const auto id = BitTorrent::TorrentID::fromString(hash);
+        if (!btSession->getTorrent(id))
+            throw APIError(APIErrorType::NotFound);
+
+        range = transferHistory->torrentHistory(id, resolution, from, to);
+    }
+    else if (const QString category = params().value(u"category"_s); !category.isEmpty())
+    {
+        if (!btSession->categories().contains(category))
+            throw APIError(APIErrorType::NotFound);
+
+        range = transferHistory->categoryHistory(category, resolution, from, to);
+    }
+    else
+    {
+        range = transferHistory->sessionHistory(resolution, from, to);
+    }
+
+    QJsonArray downloaded;
+    QJsonArray uploaded;
+    for (const BitTorrent::TransferHistorySample &sample : asConst(range.samples))
+    {
+        downloaded.append(static_cast<qint64>(sample.downloaded));
+        uploaded.append(static_cast<qint64>(sample.uploaded));
+    }
+
+    setResult(QJsonObject {
+        {KEY_HISTORY_RESOLUTION, resolution},
+        {KEY_HISTORY_START, (range.samples.isEmpty() ? from : range.start)},
+        {KEY_HISTORY_DOWNLOADED, downloaded},
+        {KEY_HISTORY_UPLOADED, uploaded}
+    });
+}
+
+// Returns timings of the alert handling in JSON format.
+// The return value is a JSON-formatted dictionary.
+// The dictionary keys are:
+//   - "enabled": whether profiling is enabled, other keys are present only if it is
+//   - "duration": seconds since profiling was enabled
+//   - "batch_size": number of alerts handled at once
+//   - "state_update_latency": microseconds between requesting torrent updates and receiving them
+//   - "torrents_updated_handlers": microseconds spent by handlers of updated torrents
+//   - "alerts": list of handling times in microseconds per alert type, each has "type" and "name" keys
+// Each of the statistics is a dictionary with "count", "min", "mean", "p50", "p90", "p99" and "max" keys.
+void TransferController::alertStatisticsAction()
+{
+    const BitTorrent::AlertProfiler *profiler = BitTorrent::Session::instance()->alertProfiler();
+    if (!profiler)
+    {
+        setResult(QJsonObject {{KEY_ALERTS_ENABLED, false}});
+        return;
+    }
+
+    QJsonArray alertTypes;
+    for (const BitTorrent::AlertProfiler::AlertTypeStatistics *statistics : asConst(profiler->alertTypes()))
+    {
+        QJsonObject alertType = serialize(statistics->handlingTime);
+        alertType.insert(KEY_ALERT_TYPE, statistics->type);
+        alertType.insert(KEY_ALERT_NAME, statistics->name);
+        alertTypes.append(alertType);
+    }
+
+    const auto duration = std::chrono::duration_cast<std::chrono::seconds>(
+        BitTorrent::AlertProfiler::Clock::now() - profiler->startTime());
+
+    setResult(QJsonObject {
+        {KEY_ALERTS_ENABLED, true},
+        {KEY_ALERTS_DURATION, static_cast<qint64>(duration.count())},
+        {KEY_ALERTS_BATCH_SIZE, serialize(profiler->batchSizes())},
+        {KEY_ALERTS_STATE_UPDATE_LATENCY, serialize(profiler->stateUpdateLatency())},
+        {KEY_ALERTS_TORRENTS_UPDATED_HANDLERS, serialize(profiler->torrentsUpdatedHandlers())},
+        {KEY_ALERTS_TYPES, alertTypes}
+    });
+}
+
+// Enabling discards previously collected statistics.
+// Params:
+//   - "enabled": "true" or "false"
+void TransferController::setAlertProfilingEnabledAction()
+{
+    requireParams({u"enabled"_s});
+
+    const std::optional<bool> enabled = Utils::String::parseBool(params()[u"enabled"_s]);
+    if (!enabled)
+        throw APIError(APIErrorType::BadParams, tr("'enabled': invalid argument"));
+
+    auto *session = BitTorrent::Session::instance();
+    session->setAlertProfilingEnabled(false);
+    session->setAlertProfilingEnabled(*enabled);
+
+    setResult(QString());
+}
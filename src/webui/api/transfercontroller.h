@@ -48,4 +48,7 @@ private slots:
     void setUploadLimitAction();
     void setDownloadLimitAction();
     void banPeersAction();
+    void historyAction();
+    void alertStatisticsAction();
+    void setAlertProfilingEnabledAction();
 };
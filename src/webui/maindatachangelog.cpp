@@ -0,0 +1,877 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "maindatachangelog.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QPointer>
+
+#include "base/algorithm.h"
+#include "base/bittorrent/cachestatus.h"
+#include "base/bittorrent/categoryoptions.h"
+#include "base/bittorrent/session.h"
+#include "base/bittorrent/sessionstatus.h"
+#include "base/bittorrent/torrent.h"
+#include "base/bittorrent/trackerentrystatus.h"
+#include "base/global.h"
+#include "base/utils/string.h"
+#include "api/jsonstream.h"
+
+namespace
+{
+    // Drop information about removed items when there are too many of them.
+    // Clients that are not up to date will receive full update then.
+    const qsizetype MAX_REMOVED_ITEMS = 10000;
+
+    const qsizetype MAX_SORT_INDEXES = 8;
+
+    // Sync main data keys
+    const QString KEY_SYNC_MAINDATA_QUEUEING = u"queueing"_s;
+    const QString KEY_SYNC_MAINDATA_REFRESH_INTERVAL = u"refresh_interval"_s;
+    const QString KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS = u"use_alt_speed_limits"_s;
+
+    // TransferInfo keys
+    const QString KEY_TRANSFER_CONNECTION_STATUS = u"connection_status"_s;
+    const QString KEY_TRANSFER_DHT_NODES = u"dht_nodes"_s;
+    const QString KEY_TRANSFER_DLDATA = u"dl_info_data"_s;
+    const QString KEY_TRANSFER_DLRATELIMIT = u"dl_rate_limit"_s;
+    const QString KEY_TRANSFER_DLSPEED = u"dl_info_speed"_s;
+    const QString KEY_TRANSFER_FREESPACEONDISK = u"free_space_on_disk"_s;
+    const QString KEY_TRANSFER_LAST_EXTERNAL_ADDRESS_V4 = u"last_external_address_v4"_s;
+    const QString KEY_TRANSFER_LAST_EXTERNAL_ADDRESS_V6 = u"last_external_address_v6"_s;
+    const QString KEY_TRANSFER_UPDATA = u"up_info_data"_s;
+    const QString KEY_TRANSFER_UPRATELIMIT = u"up_rate_limit"_s;
+    const QString KEY_TRANSFER_UPSPEED = u"up_info_speed"_s;
+
+    // Statistics keys
+    const QString KEY_TRANSFER_ALLTIME_DL = u"alltime_dl"_s;
+    const QString KEY_TRANSFER_ALLTIME_UL = u"alltime_ul"_s;
+    const QString KEY_TRANSFER_AVERAGE_TIME_QUEUE = u"average_time_queue"_s;
+    const QString KEY_TRANSFER_GLOBAL_RATIO = u"global_ratio"_s;
+    const QString KEY_TRANSFER_QUEUED_IO_JOBS = u"queued_io_jobs"_s;
+    const QString KEY_TRANSFER_READ_CACHE_HITS = u"read_cache_hits"_s;
+    const QString KEY_TRANSFER_READ_CACHE_OVERLOAD = u"read_cache_overload"_s;
+    const QString KEY_TRANSFER_TOTAL_BUFFERS_SIZE = u"total_buffers_size"_s;
+    const QString KEY_TRANSFER_TOTAL_PEER_CONNECTIONS = u"total_peer_connections"_s;
+    const QString KEY_TRANSFER_TOTAL_QUEUED_SIZE = u"total_queued_size"_s;
+    const QString KEY_TRANSFER_TOTAL_WASTE_SESSION = u"total_wasted_session"_s;
+    const QString KEY_TRANSFER_WRITE_CACHE_OVERLOAD = u"write_cache_overload"_s;
+    const QString KEY_TRANSFER_QUEUED_TRACKER_ANNOUNCES = u"queued_tracker_announces"_s;
+
+    const QString KEY_SUFFIX_REMOVED = u"_removed"_s;
+
+    const QString KEY_CATEGORIES = u"categories"_s;
+    const QString KEY_CATEGORIES_REMOVED = KEY_CATEGORIES + KEY_SUFFIX_REMOVED;
+    const QString KEY_TAGS = u"tags"_s;
+    const QString KEY_TAGS_REMOVED = KEY_TAGS + KEY_SUFFIX_REMOVED;
+    const QString KEY_TORRENTS = u"torrents"_s;
+    const QString KEY_TORRENTS_REMOVED = KEY_TORRENTS + KEY_SUFFIX_REMOVED;
+    const QString KEY_TRACKERS = u"trackers"_s;
+    const QString KEY_TRACKERS_REMOVED = KEY_TRACKERS + KEY_SUFFIX_REMOVED;
+    const QString KEY_SERVER_STATE = u"server_state"_s;
+    const QString KEY_FULL_UPDATE = u"full_update"_s;
+    const QString KEY_RESPONSE_ID = u"rid"_s;
+
+    const QString KEY_TORRENT_HAS_TRACKER_WARNING = u"has_tracker_warning"_s;
+    const QString KEY_TORRENT_HAS_TRACKER_ERROR = u"has_tracker_error"_s;
+    const QString KEY_TORRENT_HAS_OTHER_ANNOUNCE_ERROR = u"has_other_announce_error"_s;
+
+    QStringList asStrings(const QSet<BitTorrent::TorrentID> &torrentIDs)
+    {
+        QStringList result;
+        result.reserve(torrentIDs.size());
+        for (const BitTorrent::TorrentID &torrentID : torrentIDs)
+            result.emplaceBack(torrentID.toString());
+
+        return result;
+    }
+
+    bool hasWarningMessage(const BitTorrent::TrackerEntryStatus &status)
+    {
+        return std::ranges::any_of(status.endpoints, [](const BitTorrent::TrackerEndpointStatus &endpointEntry)
+        {
+            return (endpointEntry.state == BitTorrent::TrackerEndpointState::Working) && !endpointEntry.message.isEmpty();
+        });
+    }
+
+    QJsonObject serializeCategory(const QString &categoryName)
+    {
+        const BitTorrent::CategoryOptions categoryOptions = BitTorrent::Session::instance()->categoryOptions(categoryName);
+        QJsonObject category = categoryOptions.toJSON();
+        // adjust it to be compatible with existing WebAPI
+        category[u"savePath"_s] = category.take(u"save_path"_s);
+        category.insert(u"name"_s, categoryName);
+        return category;
+    }
+
+    QVariantMap getTransferInfo()
+    {
+        QVariantMap map;
+        const auto *session = BitTorrent::Session::instance();
+
+        const BitTorrent::SessionStatus &sessionStatus = session->status();
+        const BitTorrent::CacheStatus &cacheStatus = session->cacheStatus();
+        map[KEY_TRANSFER_DLSPEED] = sessionStatus.payloadDownloadRate;
+        map[KEY_TRANSFER_DLDATA] = sessionStatus.totalPayloadDownload;
+        map[KEY_TRANSFER_UPSPEED] = sessionStatus.payloadUploadRate;
+        map[KEY_TRANSFER_UPDATA] = sessionStatus.totalPayloadUpload;
+        map[KEY_TRANSFER_DLRATELIMIT] = session->downloadSpeedLimit();
+        map[KEY_TRANSFER_UPRATELIMIT] = session->uploadSpeedLimit();
+
+        const qint64 atd = sessionStatus.allTimeDownload;
+        const qint64 atu = sessionStatus.allTimeUpload;
+        map[KEY_TRANSFER_ALLTIME_DL] = atd;
+        map[KEY_TRANSFER_ALLTIME_UL] = atu;
+        map[KEY_TRANSFER_TOTAL_WASTE_SESSION] = sessionStatus.totalWasted;
+        map[KEY_TRANSFER_GLOBAL_RATIO] = ((atd > 0) && (atu > 0)) ? Utils::String::fromDouble(static_cast<qreal>(atu) / atd, 2) : u"-"_s;
+        map[KEY_TRANSFER_TOTAL_PEER_CONNECTIONS] = sessionStatus.peersCount;
+
+        const qreal readRatio = cacheStatus.readRatio;  // TODO: remove when LIBTORRENT_VERSION_NUM >= 20000
+        map[KEY_TRANSFER_READ_CACHE_HITS] = (readRatio > 0) ? Utils::String::fromDouble(100 * readRatio, 2) : u"0"_s;
+        map[KEY_TRANSFER_TOTAL_BUFFERS_SIZE] = cacheStatus.totalUsedBuffers * 16 * 1024;
+
+        map[KEY_TRANSFER_WRITE_CACHE_OVERLOAD] = ((sessionStatus.diskWriteQueue > 0) && (sessionStatus.peersCount > 0))
+            ? Utils::String::fromDouble((100. * sessionStatus.diskWriteQueue / sessionStatus.peersCount), 2)
+            : u"0"_s;
+        map[KEY_TRANSFER_READ_CACHE_OVERLOAD] = ((sessionStatus.diskReadQueue > 0) && (sessionStatus.peersCount > 0))
+            ? Utils::String::fromDouble((100. * sessionStatus.diskReadQueue / sessionStatus.peersCount), 2)
+            : u"0"_s;
+
+        map[KEY_TRANSFER_QUEUED_IO_JOBS] = cacheStatus.jobQueueLength;
+        map[KEY_TRANSFER_AVERAGE_TIME_QUEUE] = cacheStatus.averageJobTime;
+        map[KEY_TRANSFER_TOTAL_QUEUED_SIZE] = cacheStatus.queuedBytes;
+
+        map[KEY_TRANSFER_LAST_EXTERNAL_ADDRESS_V4] = session->lastExternalIPv4Address();
+        map[KEY_TRANSFER_LAST_EXTERNAL_ADDRESS_V6] = session->lastExternalIPv6Address();
+        map[KEY_TRANSFER_DHT_NODES] = sessionStatus.dhtNodes;
+        map[KEY_TRANSFER_CONNECTION_STATUS] = session->isListening()
+            ? (sessionStatus.hasIncomingConnections ? u"connected"_s : u"firewalled"_s)
+            : u"disconnected"_s;
+
+        // Tracker statistics
+        map[KEY_TRANSFER_QUEUED_TRACKER_ANNOUNCES] = sessionStatus.queuedTrackerAnnounces;
+
+        return map;
+    }
+}
+
+MaindataChangeLog::MaindataChangeLog(QObject *parent)
+    : QObject(parent)
+{
+}
+
+int MaindataChangeLog::revision() const
+{
+    return m_revision;
+}
+
+std::shared_ptr<JSONStream> MaindataChangeLog::syncData(const int revision)
+{
+    if (!m_isStarted)
+        start();
+
+    commitChanges();
+
+    const bool fullUpdate = (revision < m_minRevision) || (revision > m_revision);
+    // all the stored items have revision greater than zero
+    const int sinceRevision = fullUpdate ? 0 : revision;
+
+    QJsonObject syncData;
+    syncData[KEY_RESPONSE_ID] = m_revision;
+    if (fullUpdate)
+        syncData[KEY_FULL_UPDATE] = true;
+
+    QJsonObject categories;
+    m_categoryRevisions.forEachSince(sinceRevision, [this, &categories](const QString &categoryName)
+    {
+        categories[categoryName] = m_categories.value(categoryName);
+    });
+    if (!categories.isEmpty())
+        syncData[KEY_CATEGORIES] = categories;
+
+    QStringList tags;
+    if (fullUpdate)
+    {
+        tags = m_tags;
+    }
+    else
+    {
+        m_tagRevisions.forEachSince(sinceRevision, [&tags](const QString &tag)
+        {
+            tags.append(tag);
+        });
+    }
+    if (!tags.isEmpty())
+        syncData[KEY_TAGS] = QJsonArray::fromStringList(tags);
+
+    // Torrents make up the most of the data so they are serialized only when they are about to be sent
+    QList<BitTorrent::TorrentID> torrentIDs;
+    m_torrentRevisions.forEachSince(sinceRevision, [&torrentIDs](const BitTorrent::TorrentID &torrentID)
+    {
+        torrentIDs.append(torrentID);
+    });
+
+    QJsonObject trackers;
+    m_trackerRevisions.forEachSince(sinceRevision, [this, &trackers](const QString &tracker)
+    {
+        trackers[tracker] = QJsonArray::fromStringList(m_trackers.value(tracker));
+    });
+    if (!trackers.isEmpty())
+        syncData[KEY_TRACKERS] = trackers;
+
+    if (!fullUpdate)
+    {
+        const auto collectRemoved = [sinceRevision](const RevisionIndex<QString> &index)
+        {
+            QJsonArray removedItems;
+            index.forEachSince(sinceRevision, [&removedItems](const QString &item)
+            {
+                removedItems.append(item);
+            });
+            return removedItems;
+        };
+
+        if (const QJsonArray removedCategories = collectRemoved(m_removedCategoryRevisions); !removedCategories.isEmpty())
+            syncData[KEY_CATEGORIES_REMOVED] = removedCategories;
+        if (const QJsonArray removedTags = collectRemoved(m_removedTagRevisions); !removedTags.isEmpty())
+            syncData[KEY_TAGS_REMOVED] = removedTags;
+        if (const QJsonArray removedTrackers = collectRemoved(m_removedTrackerRevisions); !removedTrackers.isEmpty())
+            syncData[KEY_TRACKERS_REMOVED] = removedTrackers;
+
+        QJsonArray removedTorrents;
+        m_removedTorrentRevisions.forEachSince(sinceRevision, [&removedTorrents](const BitTorrent::TorrentID &torrentID)
+        {
+            removedTorrents.append(torrentID.toString());
+        });
+        if (!removedTorrents.isEmpty())
+            syncData[KEY_TORRENTS_REMOVED] = removedTorrents;
+    }
+
+    QJsonObject serverState;
+    for (auto it = m_serverState.cbegin(); it != m_serverState.cend(); ++it)
+    {
+        if (m_serverStateRevisions.value(it.key()) > sinceRevision)
+            serverState[it.key()] = QJsonValue::fromVariant(it.value());
+    }
+    if (!serverState.isEmpty())
+        syncData[KEY_SERVER_STATE] = serverState;
+
+    const auto serializeTorrent = [self = QPointer<const MaindataChangeLog>(this), torrentIDs, sinceRevision](const qsizetype index)
+            -> std::optional<std::pair<QString, QJsonObject>>
+    {
+        if (!self)
+            return std::nullopt;
+
+        // torrent could be removed while the response is being sent
+        const BitTorrent::TorrentID &torrentID = torrentIDs[index];
+        const auto torrentIter = self->m_torrents.constFind(torrentID);
+        if (torrentIter == self->m_torrents.cend())
+            return std::nullopt;
+
+        const TorrentData &torrentData = torrentIter.value();
+
+        TorrentSnapshotFields fields;
+        for (int i = 0; i < TORRENT_SNAPSHOT_FIELD_COUNT; ++i)
+            fields.set(i, (torrentData.fieldRevisions[i] > sinceRevision));
+
+        QJsonObject serializedTorrent;
+        serializeSnapshot(torrentData.snapshot, fields, serializedTorrent);
+        if (torrentData.announceStatsRevision > sinceRevision)
+            serializeAnnounceStats(torrentData.announceStats, serializedTorrent);
+
+        return std::make_pair(torrentID.toString(), serializedTorrent);
+    };
+
+    return JSONStream::createObject(syncData, KEY_TORRENTS, torrentIDs.size(), serializeTorrent);
+}
+
+QList<BitTorrent::TorrentID> MaindataChangeLog::sortedTorrents(const int fieldIndex)
+{
+    Q_ASSERT((fieldIndex >= 0) && (fieldIndex < TORRENT_SNAPSHOT_FIELD_COUNT));
+
+    if (!m_isStarted)
+        start();
+
+    commitChanges();
+
+    m_sortIndexUsage.removeOne(fieldIndex);
+    m_sortIndexUsage.append(fieldIndex);
+    if (m_sortIndexUsage.size() > MAX_SORT_INDEXES)
+        m_sortIndexes.remove(m_sortIndexUsage.takeFirst());
+
+    SortIndex &sortIndex = m_sortIndexes[fieldIndex];
+    updateSortIndex(fieldIndex, sortIndex);
+    return sortIndex.torrentIDs;
+}
+
+MaindataChangeLog::AnnounceStats MaindataChangeLog::getAnnounceStats(const BitTorrent::Torrent *torrent)
+{
+    AnnounceStats announceStats;
+    for (const BitTorrent::TrackerEntryStatus &status : asConst(torrent->trackers()))
+    {
+        switch (status.state)
+        {
+        case BitTorrent::TrackerEndpointState::Working:
+            if (!announceStats.hasTrackerWarning && hasWarningMessage(status))
+                announceStats.hasTrackerWarning = true;
+            break;
+        case BitTorrent::TrackerEndpointState::TrackerError:
+            announceStats.hasTrackerError = true;
+            break;
+        case BitTorrent::TrackerEndpointState::NotWorking:
+        case BitTorrent::TrackerEndpointState::Unreachable:
+            announceStats.hasOtherAnnounceError = true;
+            break;
+        default:
+            break;
+        }
+
+        if (announceStats.hasTrackerWarning && announceStats.hasTrackerError && announceStats.hasOtherAnnounceError)
+            break;
+    }
+
+    return announceStats;
+}
+
+void MaindataChangeLog::serializeAnnounceStats(const AnnounceStats &announceStats, QJsonObject &jsonObject)
+{
+    jsonObject[KEY_TORRENT_HAS_TRACKER_WARNING] = announceStats.hasTrackerWarning;
+    jsonObject[KEY_TORRENT_HAS_TRACKER_ERROR] = announceStats.hasTrackerError;
+    jsonObject[KEY_TORRENT_HAS_OTHER_ANNOUNCE_ERROR] = announceStats.hasOtherAnnounceError;
+}
+
+void MaindataChangeLog::start()
+{
+    Q_ASSERT(!m_isStarted);
+
+    auto *session = BitTorrent::Session::instance();
+
+    // The initial state is collected as a regular set of changes
+    for (const BitTorrent::Torrent *torrent : asConst(session->torrents()))
+    {
+        const BitTorrent::TorrentID torrentID = torrent->id();
+        m_updatedTorrents.insert(torrentID);
+        m_announcedTorrents.insert(torrentID);
+
+        for (const BitTorrent::TrackerEntryStatus &status : asConst(torrent->trackers()))
+        {
+            m_knownTrackers[status.url].insert(torrentID);
+            m_updatedTrackers.insert(status.url);
+        }
+    }
+
+    for (const QString &categoryName : asConst(session->categories()))
+        m_updatedCategories.insert(categoryName);
+
+    for (const Tag &tag : asConst(session->tags()))
+        m_addedTags.insert(tag.toString());
+
+    m_freeDiskSpace = session->freeDiskSpace();
+
+    connect(session, &BitTorrent::Session::categoryAdded, this, &MaindataChangeLog::onCategoryAdded);
+    connect(session, &BitTorrent::Session::categoryRemoved, this, &MaindataChangeLog::onCategoryRemoved);
+    connect(session, &BitTorrent::Session::categoryOptionsChanged, this, &MaindataChangeLog::onCategoryOptionsChanged);
+    connect(session, &BitTorrent::Session::subcategoriesSupportChanged, this, &MaindataChangeLog::onSubcategoriesSupportChanged);
+    connect(session, &BitTorrent::Session::tagAdded, this, &MaindataChangeLog::onTagAdded);
+    connect(session, &BitTorrent::Session::tagRemoved, this, &MaindataChangeLog::onTagRemoved);
+    connect(session, &BitTorrent::Session::torrentAdded, this, &MaindataChangeLog::onTorrentAdded);
+    connect(session, &BitTorrent::Session::torrentAboutToBeRemoved, this, &MaindataChangeLog::onTorrentAboutToBeRemoved);
+    connect(session, &BitTorrent::Session::torrentCategoryChanged, this, &MaindataChangeLog::onTorrentChanged);
+    connect(session, &BitTorrent::Session::torrentMetadataReceived, this, &MaindataChangeLog::onTorrentChanged);
+    connect(session, &BitTorrent::Session::torrentStopped, this, &MaindataChangeLog::onTorrentStopped);
+    connect(session, &BitTorrent::Session::torrentStarted, this, &MaindataChangeLog::onTorrentChanged);
+    connect(session, &BitTorrent::Session::torrentSavePathChanged, this, &MaindataChangeLog::onTorrentChanged);
+    connect(session, &BitTorrent::Session::torrentSavingModeChanged, this, &MaindataChangeLog::onTorrentChanged);
+    connect(session, &BitTorrent::Session::torrentTagAdded, this, &MaindataChangeLog::onTorrentChanged);
+    connect(session, &BitTorrent::Session::torrentTagRemoved, this, &MaindataChangeLog::onTorrentChanged);
+    connect(session, &BitTorrent::Session::torrentsUpdated, this, &MaindataChangeLog::onTorrentsUpdated);
+    connect(session, &BitTorrent::Session::trackersAdded, this, &MaindataChangeLog::onTorrentTrackersChanged);
+    connect(session, &BitTorrent::Session::trackersRemoved, this, &MaindataChangeLog::onTorrentTrackersChanged);
+    connect(session, &BitTorrent::Session::trackersReset, this, &MaindataChangeLog::onTorrentTrackersChanged);
+    connect(session, &BitTorrent::Session::trackerEntryStatusesUpdated, this, &MaindataChangeLog::onTorrentTrackerEntryStatusesUpdated);
+    connect(session, &BitTorrent::Session::freeDiskSpaceChecked, this, &MaindataChangeLog::onFreeDiskSpaceChecked);
+    connect(session, &BitTorrent::Session::statsUpdated, this, &MaindataChangeLog::onStatsUpdated);
+
+    m_isStarted = true;
+    m_minRevision = 1;
+}
+
+void MaindataChangeLog::commitChanges()
+{
+    m_isChangedNotified = false;
+
+    const int revision = m_revision + 1;
+    bool hasChanges = false;
+
+    for (const QString &categoryName : asConst(m_updatedCategories))
+    {
+        QJsonObject category = serializeCategory(categoryName);
+        if (QJsonObject &storedCategory = m_categories[categoryName]; storedCategory != category)
+        {
+            storedCategory = std::move(category);
+            m_categoryRevisions.update(categoryName, revision);
+            m_removedCategoryRevisions.remove(categoryName);
+            hasChanges = true;
+        }
+    }
+    m_updatedCategories.clear();
+
+    for (const QString &categoryName : asConst(m_removedCategories))
+    {
+        if (m_categories.remove(categoryName))
+        {
+            m_categoryRevisions.remove(categoryName);
+            m_removedCategoryRevisions.update(categoryName, revision);
+            hasChanges = true;
+        }
+    }
+    m_removedCategories.clear();
+
+    for (const QString &tag : asConst(m_addedTags))
+    {
+        if (!m_tags.contains(tag))
+        {
+            m_tags.append(tag);
+            m_tagRevisions.update(tag, revision);
+            m_removedTagRevisions.remove(tag);
+            hasChanges = true;
+        }
+    }
+    m_addedTags.clear();
+
+    for (const QString &tag : asConst(m_removedTags))
+    {
+        if (m_tags.removeOne(tag))
+        {
+            m_tagRevisions.remove(tag);
+            m_removedTagRevisions.update(tag, revision);
+            hasChanges = true;
+        }
+    }
+    m_removedTags.clear();
+
+    const auto *session = BitTorrent::Session::instance();
+
+    for (const BitTorrent::TorrentID &torrentID : asConst(m_updatedTorrents))
+    {
+        const BitTorrent::Torrent *torrent = session->getTorrent(torrentID);
+        Q_ASSERT(torrent);
+
+        TorrentSnapshot snapshot = makeTorrentSnapshot(*torrent);
+
+        const auto torrentDataIter = m_torrents.find(torrentID);
+        if (torrentDataIter == m_torrents.end())
+        {
+            TorrentData torrentData {.snapshot = std::move(snapshot), .announceStats = getAnnounceStats(torrent)};
+            torrentData.fieldRevisions.fill(revision);
+            torrentData.announceStatsRevision = revision;
+            m_torrents.insert(torrentID, torrentData);
+
+            m_torrentRevisions.update(torrentID, revision);
+            m_removedTorrentRevisions.remove(torrentID);
+            hasChanges = true;
+            continue;
+        }
+
+        TorrentData &torrentData = torrentDataIter.value();
+
+        const TorrentSnapshotFields changedFields = changedSnapshotFields(torrentData.snapshot, snapshot);
+        bool isChanged = changedFields.any();
+        for (int i = 0; i < TORRENT_SNAPSHOT_FIELD_COUNT; ++i)
+        {
+            if (changedFields.test(i))
+                torrentData.fieldRevisions[i] = revision;
+        }
+        torrentData.snapshot = std::move(snapshot);
+
+        if (m_announcedTorrents.contains(torrentID))
+        {
+            if (const AnnounceStats announceStats = getAnnounceStats(torrent)
+                    ; announceStats != torrentData.announceStats)
+            {
+                torrentData.announceStats = announceStats;
+                torrentData.announceStatsRevision = revision;
+                isChanged = true;
+            }
+        }
+
+        if (isChanged)
+        {
+            m_torrentRevisions.update(torrentID, revision);
+            hasChanges = true;
+        }
+    }
+
+    for (const BitTorrent::TorrentID &torrentID : asConst(m_announcedTorrents))
+    {
+        if (m_updatedTorrents.contains(torrentID))
+            continue;
+
+        const BitTorrent::Torrent *torrent = session->getTorrent(torrentID);
+        Q_ASSERT(torrent);
+
+        const auto torrentDataIter = m_torrents.find(torrentID);
+        Q_ASSERT(torrentDataIter != m_torrents.end());
+        if (torrentDataIter == m_torrents.end()) [[unlikely]]
+            continue;
+
+        // Only announce stats are changed so don't need to serialize torrent again
+        TorrentData &torrentData = torrentDataIter.value();
+        if (const AnnounceStats announceStats = getAnnounceStats(torrent)
+                ; announceStats != torrentData.announceStats)
+        {
+            torrentData.announceStats = announceStats;
+            torrentData.announceStatsRevision = revision;
+            m_torrentRevisions.update(torrentID, revision);
+            hasChanges = true;
+        }
+    }
+
+    m_updatedTorrents.clear();
+    m_announcedTorrents.clear();
+
+    for (const BitTorrent::TorrentID &torrentID : asConst(m_removedTorrents))
+    {
+        if (m_torrents.remove(torrentID))
+        {
+            m_torrentRevisions.remove(torrentID);
+            m_removedTorrentRevisions.update(torrentID, revision);
+            hasChanges = true;
+        }
+    }
+    m_removedTorrents.clear();
+
+    for (const QString &tracker : asConst(m_updatedTrackers))
+    {
+        m_trackers[tracker] = asStrings(m_knownTrackers.value(tracker));
+        m_trackerRevisions.update(tracker, revision);
+        m_removedTrackerRevisions.remove(tracker);
+        hasChanges = true;
+    }
+    m_updatedTrackers.clear();
+
+    for (const QString &tracker : asConst(m_removedTrackers))
+    {
+        if (m_trackers.remove(tracker))
+        {
+            m_trackerRevisions.remove(tracker);
+            m_removedTrackerRevisions.update(tracker, revision);
+            hasChanges = true;
+        }
+    }
+    m_removedTrackers.clear();
+
+    QVariantMap serverState = getTransferInfo();
+    serverState[KEY_TRANSFER_FREESPACEONDISK] = m_freeDiskSpace;
+    serverState[KEY_SYNC_MAINDATA_QUEUEING] = session->isQueueingSystemEnabled();
+    serverState[KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS] = session->isAltGlobalSpeedLimitEnabled();
+    serverState[KEY_SYNC_MAINDATA_REFRESH_INTERVAL] = session->refreshInterval();
+    for (auto it = serverState.cbegin(); it != serverState.cend(); ++it)
+    {
+        if (QVariant &storedValue = m_serverState[it.key()]; storedValue != it.value())
+        {
+            storedValue = it.value();
+            m_serverStateRevisions[it.key()] = revision;
+            hasChanges = true;
+        }
+    }
+
+    if (hasChanges)
+        m_revision = revision;
+
+    dropRemovedItems();
+}
+
+void MaindataChangeLog::dropRemovedItems()
+{
+    const qsizetype removedItemsCount = m_removedCategoryRevisions.size() + m_removedTagRevisions.size()
+            + m_removedTorrentRevisions.size() + m_removedTrackerRevisions.size();
+    if (removedItemsCount <= MAX_REMOVED_ITEMS)
+        return;
+
+    m_removedCategoryRevisions.clear();
+    m_removedTagRevisions.clear();
+    m_removedTorrentRevisions.clear();
+    m_removedTrackerRevisions.clear();
+    m_minRevision = m_revision;
+}
+
+void MaindataChangeLog::updateSortIndex(const int fieldIndex, SortIndex &sortIndex) const
+{
+    const auto getSnapshot = [this](const BitTorrent::TorrentID &torrentID) -> const TorrentSnapshot &
+    {
+        return m_torrents.constFind(torrentID)->snapshot;
+    };
+
+    if ((sortIndex.revision == 0) || (sortIndex.revision < m_minRevision))
+    {
+        sortIndex.torrentIDs = m_torrents.keys();
+        std::ranges::sort(sortIndex.torrentIDs, snapshotFieldLessThan(fieldIndex, getSnapshot));
+        sortIndex.revision = m_revision;
+        return;
+    }
+
+    if (sortIndex.revision == m_revision)
+        return;
+
+    // Only torrents whose sort field was changed (or which were added/removed) need to be repositioned
+    QSet<BitTorrent::TorrentID> changedTorrents;
+    m_torrentRevisions.forEachSince(sortIndex.revision, [this, fieldIndex, &sortIndex, &changedTorrents](const BitTorrent::TorrentID &torrentID)
+    {
+        if (m_torrents.constFind(torrentID)->fieldRevisions[fieldIndex] > sortIndex.revision)
+            changedTorrents.insert(torrentID);
+    });
+    QSet<BitTorrent::TorrentID> removedTorrents;
+    m_removedTorrentRevisions.forEachSince(sortIndex.revision, [&removedTorrents](const BitTorrent::TorrentID &torrentID)
+    {
+        removedTorrents.insert(torrentID);
+    });
+
+    sortIndex.revision = m_revision;
+    updateSnapshotSortOrder(fieldIndex, sortIndex.torrentIDs, changedTorrents, removedTorrents, getSnapshot);
+}
+
+void MaindataChangeLog::notifyChanged()
+{
+    // the changes are accumulated until they are requested so it is enough to notify about the first one
+    if (m_isChangedNotified)
+        return;
+
+    m_isChangedNotified = true;
+    emit changed();
+}
+
+void MaindataChangeLog::onCategoryAdded(const QString &categoryName)
+{
+    m_removedCategories.remove(categoryName);
+    m_updatedCategories.insert(categoryName);
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onCategoryRemoved(const QString &categoryName)
+{
+    m_updatedCategories.remove(categoryName);
+    m_removedCategories.insert(categoryName);
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onCategoryOptionsChanged(const QString &categoryName)
+{
+    Q_ASSERT(!m_removedCategories.contains(categoryName));
+
+    m_updatedCategories.insert(categoryName);
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onSubcategoriesSupportChanged()
+{
+    const QStringList categoriesList = BitTorrent::Session::instance()->categories();
+    for (const auto &categoryName : categoriesList)
+    {
+        if (!m_categories.contains(categoryName))
+        {
+            m_removedCategories.remove(categoryName);
+            m_updatedCategories.insert(categoryName);
+        }
+    }
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onTagAdded(const Tag &tag)
+{
+    m_removedTags.remove(tag.toString());
+    m_addedTags.insert(tag.toString());
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onTagRemoved(const Tag &tag)
+{
+    m_addedTags.remove(tag.toString());
+    m_removedTags.insert(tag.toString());
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onTorrentAdded(BitTorrent::Torrent *torrent)
+{
+    const BitTorrent::TorrentID torrentID = torrent->id();
+
+    m_removedTorrents.remove(torrentID);
+    m_updatedTorrents.insert(torrentID);
+    m_announcedTorrents.insert(torrentID);
+
+    for (const BitTorrent::TrackerEntryStatus &status : asConst(torrent->trackers()))
+    {
+        m_knownTrackers[status.url].insert(torrentID);
+        m_updatedTrackers.insert(status.url);
+        m_removedTrackers.remove(status.url);
+    }
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onTorrentAboutToBeRemoved(BitTorrent::Torrent *torrent)
+{
+    const BitTorrent::TorrentID torrentID = torrent->id();
+
+    m_announcedTorrents.remove(torrentID);
+    m_updatedTorrents.remove(torrentID);
+    m_removedTorrents.insert(torrentID);
+
+    for (const BitTorrent::TrackerEntryStatus &status : asConst(torrent->trackers()))
+    {
+        const auto iter = m_knownTrackers.find(status.url);
+        Q_ASSERT(iter != m_knownTrackers.end());
+        if (iter == m_knownTrackers.end()) [[unlikely]]
+            continue;
+
+        QSet<BitTorrent::TorrentID> &torrentIDs = iter.value();
+        torrentIDs.remove(torrentID);
+        if (torrentIDs.isEmpty())
+        {
+            m_knownTrackers.erase(iter);
+            m_updatedTrackers.remove(status.url);
+            m_removedTrackers.insert(status.url);
+        }
+        else
+        {
+            m_updatedTrackers.insert(status.url);
+        }
+    }
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onTorrentChanged(BitTorrent::Torrent *torrent)
+{
+    m_updatedTorrents.insert(torrent->id());
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onTorrentStopped(BitTorrent::Torrent *torrent)
+{
+    m_updatedTorrents.insert(torrent->id());
+    m_announcedTorrents.insert(torrent->id());
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onTorrentsUpdated(const QList<BitTorrent::Torrent *> &torrents)
+{
+    for (const BitTorrent::Torrent *torrent : torrents)
+        m_updatedTorrents.insert(torrent->id());
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onTorrentTrackersChanged(BitTorrent::Torrent *torrent)
+{
+    using namespace BitTorrent;
+
+    const QList<TrackerEntryStatus> trackers = torrent->trackers();
+
+    QSet<QString> currentTrackers;
+    currentTrackers.reserve(trackers.size());
+    for (const TrackerEntryStatus &status : trackers)
+        currentTrackers.insert(status.url);
+
+    const TorrentID torrentID = torrent->id();
+    Algorithm::removeIf(m_knownTrackers
+        , [this, torrentID, currentTrackers](const QString &knownTracker, QSet<TorrentID> &torrentIDs)
+    {
+        if (auto idIter = torrentIDs.find(torrentID)
+                ; (idIter != torrentIDs.end()) && !currentTrackers.contains(knownTracker))
+        {
+            torrentIDs.erase(idIter);
+            if (torrentIDs.isEmpty())
+            {
+                m_updatedTrackers.remove(knownTracker);
+                m_removedTrackers.insert(knownTracker);
+                return true;
+            }
+
+            m_updatedTrackers.insert(knownTracker);
+            return false;
+        }
+
+        if (currentTrackers.contains(knownTracker) && !torrentIDs.contains(torrentID))
+        {
+            torrentIDs.insert(torrentID);
+            m_updatedTrackers.insert(knownTracker);
+            return false;
+        }
+
+        return false;
+    });
+
+    for (const QString &currentTracker : asConst(currentTrackers))
+    {
+        if (!m_knownTrackers.contains(currentTracker))
+        {
+            m_knownTrackers.insert(currentTracker, {torrentID});
+            m_updatedTrackers.insert(currentTracker);
+            m_removedTrackers.remove(currentTracker);
+        }
+    }
+
+    m_announcedTorrents.insert(torrentID);
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onTorrentTrackerEntryStatusesUpdated(const BitTorrent::Torrent *torrent
+        , [[maybe_unused]] const QHash<QString, BitTorrent::TrackerEntryStatus> &updatedTrackers)
+{
+    m_announcedTorrents.insert(torrent->id());
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onFreeDiskSpaceChecked(const qint64 freeDiskSpace)
+{
+    m_freeDiskSpace = freeDiskSpace;
+
+    notifyChanged();
+}
+
+void MaindataChangeLog::onStatsUpdated()
+{
+    // server state is only collected when changes are committed
+    notifyChanged();
+}
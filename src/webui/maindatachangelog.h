@@ -0,0 +1,216 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+
+#include <QHash>
+#include <QJsonObject>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QVariantMap>
+
+#include "base/bittorrent/infohash.h"
+#include "base/tag.h"
+#include "api/serialize/serialize_torrent.h"
+
+namespace BitTorrent
+{
+    class Torrent;
+    struct TrackerEntryStatus;
+}
+
+class JSONStream;
+
+// Session-wide versioned storage of the data reported by "sync/maindata".
+// It is shared by all WebUI sessions so each change is processed only once
+// while clients only need to keep the revision they have received last.
+// It also maintains the orderings of torrents used by "torrents/info".
+class MaindataChangeLog final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(MaindataChangeLog)
+
+public:
+    explicit MaindataChangeLog(QObject *parent = nullptr);
+
+    int revision() const;
+    // Returns the changes made after `revision` or full data if they cannot be provided
+    std::shared_ptr<JSONStream> syncData(int revision);
+    // Returns IDs of all the torrents sorted by the given snapshot field
+    QList<BitTorrent::TorrentID> sortedTorrents(int fieldIndex);
+
+signals:
+    // Emitted once there are changes since the data was requested last
+    void changed();
+
+private:
+    // Keeps items ordered by revision of their latest change
+    template <typename Key>
+    class RevisionIndex
+    {
+    public:
+        void update(const Key &key, const int revision)
+        {
+            remove(key);
+            m_revisions.insert(key, revision);
+            m_keysByRevision[revision].insert(key);
+        }
+
+        void remove(const Key &key)
+        {
+            const auto iter = m_revisions.constFind(key);
+            if (iter == m_revisions.cend())
+                return;
+
+            const auto bucketIter = m_keysByRevision.find(iter.value());
+            bucketIter->remove(key);
+            if (bucketIter->isEmpty())
+                m_keysByRevision.erase(bucketIter);
+            m_revisions.erase(iter);
+        }
+
+        qsizetype size() const
+        {
+            return m_revisions.size();
+        }
+
+        void clear()
+        {
+            m_revisions.clear();
+            m_keysByRevision.clear();
+        }
+
+        template <typename Func>
+        void forEachSince(const int revision, Func &&func) const
+        {
+            for (auto it = m_keysByRevision.upperBound(revision); it != m_keysByRevision.cend(); ++it)
+            {
+                for (const Key &key : it.value())
+                    func(key);
+            }
+        }
+
+    private:
+        QHash<Key, int> m_revisions;
+        QMap<int, QSet<Key>> m_keysByRevision;
+    };
+
+    struct AnnounceStats
+    {
+        bool hasTrackerWarning = false;
+        bool hasTrackerError = false;
+        bool hasOtherAnnounceError = false;
+
+        friend bool operator==(const AnnounceStats &, const AnnounceStats &) = default;
+    };
+
+    struct TorrentData
+    {
+        TorrentSnapshot snapshot;
+        AnnounceStats announceStats;
+        std::array<int, TORRENT_SNAPSHOT_FIELD_COUNT> fieldRevisions {};
+        int announceStatsRevision = 0;
+    };
+
+    struct SortIndex
+    {
+        QList<BitTorrent::TorrentID> torrentIDs;
+        int revision = 0;
+    };
+
+    static AnnounceStats getAnnounceStats(const BitTorrent::Torrent *torrent);
+    static void serializeAnnounceStats(const AnnounceStats &announceStats, QJsonObject &jsonObject);
+
+    void start();
+    void commitChanges();
+    void dropRemovedItems();
+    void updateSortIndex(int fieldIndex, SortIndex &sortIndex) const;
+    void notifyChanged();
+
+    void onCategoryAdded(const QString &categoryName);
+    void onCategoryRemoved(const QString &categoryName);
+    void onCategoryOptionsChanged(const QString &categoryName);
+    void onSubcategoriesSupportChanged();
+    void onTagAdded(const Tag &tag);
+    void onTagRemoved(const Tag &tag);
+    void onTorrentAdded(BitTorrent::Torrent *torrent);
+    void onTorrentAboutToBeRemoved(BitTorrent::Torrent *torrent);
+    void onTorrentChanged(BitTorrent::Torrent *torrent);
+    void onTorrentStopped(BitTorrent::Torrent *torrent);
+    void onTorrentsUpdated(const QList<BitTorrent::Torrent *> &torrents);
+    void onTorrentTrackersChanged(BitTorrent::Torrent *torrent);
+    void onTorrentTrackerEntryStatusesUpdated(const BitTorrent::Torrent *torrent
+            , const QHash<QString, BitTorrent::TrackerEntryStatus> &updatedTrackers);
+    void onFreeDiskSpaceChecked(qint64 freeDiskSpace);
+    void onStatsUpdated();
+
+    bool m_isStarted = false;
+    bool m_isChangedNotified = false;
+    int m_revision = 0;
+    // Changes made before this revision cannot be provided anymore
+    int m_minRevision = 0;
+    qint64 m_freeDiskSpace = 0;
+
+    // Current state
+    QHash<QString, QJsonObject> m_categories;
+    QStringList m_tags;
+    QHash<BitTorrent::TorrentID, TorrentData> m_torrents;
+    QHash<QString, QSet<BitTorrent::TorrentID>> m_knownTrackers;
+    QHash<QString, QStringList> m_trackers;
+    QVariantMap m_serverState;
+    QHash<QString, int> m_serverStateRevisions;
+
+    RevisionIndex<QString> m_categoryRevisions;
+    RevisionIndex<QString> m_removedCategoryRevisions;
+    RevisionIndex<QString> m_tagRevisions;
+    RevisionIndex<QString> m_removedTagRevisions;
+    RevisionIndex<BitTorrent::TorrentID> m_torrentRevisions;
+    RevisionIndex<BitTorrent::TorrentID> m_removedTorrentRevisions;
+    RevisionIndex<QString> m_trackerRevisions;
+    RevisionIndex<QString> m_removedTrackerRevisions;
+
+    QHash<int, SortIndex> m_sortIndexes;
+    // Field indexes of sort indexes, most recently used last
+    QList<int> m_sortIndexUsage;
+
+    // Pending changes
+    QSet<QString> m_updatedCategories;
+    QSet<QString> m_removedCategories;
+    QSet<QString> m_addedTags;
+    QSet<QString> m_removedTags;
+    QSet<QString> m_updatedTrackers;
+    QSet<QString> m_removedTrackers;
+    QSet<BitTorrent::TorrentID> m_updatedTorrents;
+    QSet<BitTorrent::TorrentID> m_announcedTorrents;
+    QSet<BitTorrent::TorrentID> m_removedTorrents;
+};
@@ -29,6 +29,10 @@
 
 #include "webapplication.h"
 
+#include <algorithm>
+#include <memory>
+
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
@@ -43,9 +47,11 @@
 #include <QUrl>
 
 #include "base/algorithm.h"
+#include "base/bittorrent/metricsexporter.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/torrentcreationmanager.h"
 #include "base/http/httperror.h"
+#include "base/http/responsegenerator.h"
 #include "base/logger.h"
 #include "base/preferences.h"
 #include "base/types.h"
@@ -60,6 +66,7 @@
 #include "api/appcontroller.h"
 #include "api/authcontroller.h"
 #include "api/clientdatacontroller.h"
+#include "api/jsonstream.h"
 #include "api/logcontroller.h"
 #include "api/rsscontroller.h"
 #include "api/searchcontroller.h"
@@ -68,6 +75,7 @@
 #include "api/torrentscontroller.h"
 #include "api/transfercontroller.h"
 #include "clientdatastorage.h"
+#include "maindatachangelog.h"
 #include "websession.h"
 
 const int MAX_ALLOWED_FILESIZE = 10 * 1024 * 1024;
@@ -82,6 +90,7 @@ const QString BASIC_AUTH = u"Basic"_s;
 const QString BEARER_AUTH = u"Bearer"_s;
 
 const QString API_PATH = u"/api/v2/"_s;
+const QString METRICS_PATH = u"/metrics"_s;
 
 namespace
 {
@@ -104,15 +113,6 @@ namespace
         return ret;
     }
 
-    std::tuple<QString, QString> parseAPIEndpoint(const QString &endpoint)
-    {
-        const QRegularExpression apiEndpointPattern {u"^(?<scope>[A-Za-z_][A-Za-z_0-9]*)/(?<action>[A-Za-z_][A-Za-z_0-9]*)$"_s};
-        if (const QRegularExpressionMatch match = apiEndpointPattern.match(endpoint); match.hasMatch())
-            return std::make_tuple(match.captured(u"scope"), match.captured(u"action"));
-
-        return {};
-    }
-
     std::tuple<QString, QString> parseAuthorizationHeader(const QString &authHeader)
     {
         const QRegularExpression authHeaderPattern {u"^(?<scheme>\\S+)\\s+(?<value>.+)$"_s, QRegularExpression::DotMatchesEverythingOption};
@@ -145,6 +145,21 @@ namespace
         return u"no-store"_s;
     }
 
+    bool matchesETag(const QString &ifNoneMatch, const QString &eTag)
+    {
+        // [RFC 9110] 13.1.2. If-None-Match
+        // weak comparison is used so "W/" prefix is ignored
+
+        const QList<QStringView> tags = QStringView(ifNoneMatch).split(u',', Qt::SkipEmptyParts);
+        return std::ranges::any_of(tags, [&eTag](QStringView tag)
+        {
+            tag = tag.trimmed();
+            if (tag.startsWith(u"W/"))
+                tag = tag.sliced(2);
+            return (tag == u"*") || (tag == eTag);
+        });
+    }
+
     QString createLanguagesOptionsHtml()
     {
         // List language files
@@ -172,9 +187,21 @@ WebApplication::WebApplication(IApplication *app, QObject *parent)
     , m_authController {new AuthController(this, app, this)}
     , m_torrentCreationManager {new BitTorrent::TorrentCreationManager(app, this)}
     , m_clientDataStorage {new ClientDataStorage(this)}
+    , m_maindataChangeLog {new MaindataChangeLog(this)}
 {
     declarePublicAPI(u"auth/login"_s);
 
+    registerAPIRoutes(u"app"_s, AppController::staticMetaObject);
+    registerAPIRoutes(u"auth"_s, AuthController::staticMetaObject);
+    registerAPIRoutes(u"clientdata"_s, ClientDataController::staticMetaObject);
+    registerAPIRoutes(u"log"_s, LogController::staticMetaObject);
+    registerAPIRoutes(u"torrentcreator"_s, TorrentCreatorController::staticMetaObject);
+    registerAPIRoutes(u"rss"_s, RSSController::staticMetaObject);
+    registerAPIRoutes(u"search"_s, SearchController::staticMetaObject);
+    registerAPIRoutes(u"torrents"_s, TorrentsController::staticMetaObject);
+    registerAPIRoutes(u"transfer"_s, TransferController::staticMetaObject);
+    registerAPIRoutes(u"sync"_s, SyncController::staticMetaObject);
+
     configure();
     connect(Preferences::instance(), &Preferences::changed, this, &WebApplication::configure);
 }
@@ -317,30 +344,30 @@ void WebApplication::setPasswordHash(const QByteArray &passwordHash)
 
 void WebApplication::processAPIRequest(const QString &endpoint)
 {
-    const auto [scope, action] = parseAPIEndpoint(endpoint);
-    if (scope.isEmpty())
-        throw NotFoundHTTPError();
-
     // Check public/private scope
-    if (!session() && !isPublicAPI(scope, action))
+    if (!session() && !isPublicAPI(endpoint))
         throw ForbiddenHTTPError();
 
     // Find matching API
+    const auto routeIter = m_apiRoutes.constFind(endpoint);
+    if (routeIter == m_apiRoutes.cend())
+        throw NotFoundHTTPError();
+
+    const APIRoute &route = routeIter.value();
     APIController *controller = nullptr;
     if (m_currentSession)
-        controller = m_currentSession->getAPIController(scope);
+        controller = m_currentSession->getAPIController(route.scope);
 
     if (!controller)
     {
-        if (scope == u"auth")
+        if (route.scope == u"auth")
             controller = m_authController;
         else
             throw NotFoundHTTPError();
     }
 
     // Filter HTTP methods
-    const auto allowedMethodIter = m_allowedMethod.constFind({scope, action});
-    if (allowedMethodIter == m_allowedMethod.cend())
+    if (route.httpMethod.isEmpty())
     {
         // by default allow both GET, POST methods
         if ((m_request.method != Http::METHOD_GET) && (m_request.method != Http::METHOD_POST))
@@ -348,22 +375,13 @@ void WebApplication::processAPIRequest(const QString &endpoint)
     }
     else
     {
-        if (*allowedMethodIter != m_request.method)
+        if (route.httpMethod != m_request.method)
             throw MethodNotAllowedHTTPError();
     }
 
-    QHash<QString, QString> params;
-    if ((m_request.method == Http::HEADER_REQUEST_METHOD_GET)
-        || (m_request.method == Http::HEADER_REQUEST_METHOD_HEAD))
-    {
-        params.reserve(m_request.query.size());
-        for (auto iter = m_request.query.cbegin(); iter != m_request.query.cend(); ++iter)
-            params.insert(iter.key(), QString::fromUtf8(iter.value()));
-    }
-    else
-    {
-        params = m_request.posts;
-    }
+    const bool isGetRequest = (m_request.method == Http::HEADER_REQUEST_METHOD_GET)
+        || (m_request.method == Http::HEADER_REQUEST_METHOD_HEAD);
+    const APIParams params = isGetRequest ? APIParams(&m_request.query) : APIParams(&m_request.posts);
 
     DataMap data;
     for (const Http::UploadedFile &torrent : request().files)
@@ -371,8 +389,9 @@ void WebApplication::processAPIRequest(const QString &endpoint)
 
     try
     {
-        const APIResult result = controller->run(action, params, data);
-        if (result.data.isNull())
+        const APIResult result = controller->run(route.action, params, data);
+        const bool acceptsCBOR = Http::acceptsMediaType(m_request.headers.value(Http::HEADER_ACCEPT), Http::CONTENT_TYPE_CBOR);
+        if (result.data.isNull() && !result.contentStream)
         {
             m_response.status = {.code = 204};
         }
@@ -388,26 +407,44 @@ void WebApplication::processAPIRequest(const QString &endpoint)
                 break;
             }
 
-            switch (result.data.userType())
+            if (result.contentStream)
             {
-            case QMetaType::QJsonDocument:
-                m_response.headers.insert(Http::HEADER_CONTENT_TYPE, Http::CONTENT_TYPE_JSON);
-                m_response.content = result.data.toJsonDocument().toJson(QJsonDocument::Compact);
-                break;
-            case QMetaType::QByteArray:
+                QString mimeType = result.mimeType;
+                if (const auto jsonStream = std::dynamic_pointer_cast<JSONStream>(result.contentStream); jsonStream && acceptsCBOR)
                 {
-                    const auto resultData = result.data.toByteArray();
-                    m_response.headers.insert(Http::HEADER_CONTENT_TYPE, (!result.mimeType.isEmpty() ? result.mimeType : Http::CONTENT_TYPE_TXT));
-                    if (!result.filename.isEmpty())
-                        m_response.headers.insert(Http::HEADER_CONTENT_DISPOSITION, u"attachment; filename=\"%1\""_s.arg(result.filename));
-                    m_response.content = resultData;
+                    jsonStream->setFormat(JSONStream::Format::CBOR);
+                    mimeType = Http::CONTENT_TYPE_CBOR;
+                }
+
+                m_response.headers.insert(Http::HEADER_CONTENT_TYPE, mimeType);
+                m_response.contentStream = result.contentStream;
+            }
+            else
+            {
+                switch (result.data.userType())
+                {
+                case QMetaType::QJsonDocument:
+                    {
+                        const auto format = acceptsCBOR ? JSONStream::Format::CBOR : JSONStream::Format::JSON;
+                        m_response.headers.insert(Http::HEADER_CONTENT_TYPE, (acceptsCBOR ? Http::CONTENT_TYPE_CBOR : Http::CONTENT_TYPE_JSON));
+                        m_response.content = JSONStream::serialize(result.data.toJsonDocument(), format);
+                    }
+                    break;
+                case QMetaType::QByteArray:
+                    {
+                        const auto resultData = result.data.toByteArray();
+                        m_response.headers.insert(Http::HEADER_CONTENT_TYPE, (!result.mimeType.isEmpty() ? result.mimeType : Http::CONTENT_TYPE_TXT));
+                        if (!result.filename.isEmpty())
+                            m_response.headers.insert(Http::HEADER_CONTENT_DISPOSITION, u"attachment; filename=\"%1\""_s.arg(result.filename));
+                        m_response.content = resultData;
+                    }
+                    break;
+                case QMetaType::QString:
+                default:
+                    m_response.headers.insert(Http::HEADER_CONTENT_TYPE, Http::CONTENT_TYPE_TXT);
+                    m_response.content = result.data.toString().toUtf8();
+                    break;
                 }
-                break;
-            case QMetaType::QString:
-            default:
-                m_response.headers.insert(Http::HEADER_CONTENT_TYPE, Http::CONTENT_TYPE_TXT);
-                m_response.content = result.data.toString().toUtf8();
-                break;
             }
         }
     }
@@ -435,6 +472,19 @@ void WebApplication::processAPIRequest(const QString &endpoint)
     }
 }
 
+void WebApplication::processMetricsRequest()
+{
+    if (!session())
+        throw ForbiddenHTTPError();
+
+    if ((m_request.method != Http::HEADER_REQUEST_METHOD_GET) && (m_request.method != Http::HEADER_REQUEST_METHOD_HEAD))
+        throw MethodNotAllowedHTTPError();
+
+    m_response.status = {.code = 200};
+    m_response.headers.insert(Http::HEADER_CONTENT_TYPE, u"text/plain; version=0.0.4; charset=utf-8"_s);
+    m_response.content = BitTorrent::Session::instance()->metricsExporter()->text();
+}
+
 void WebApplication::configure()
 {
     const auto *pref = Preferences::instance();
@@ -445,7 +495,7 @@ void WebApplication::configure()
     {
         m_isAltUIUsed = isAltUIUsed;
         m_rootFolder = rootFolder;
-        m_translatedFiles.clear();
+        m_cachedFiles.clear();
         if (!m_isAltUIUsed)
             LogMsg(tr("Using built-in WebUI."));
         else
@@ -456,7 +506,7 @@ void WebApplication::configure()
     if (m_currentLocale != newLocale)
     {
         m_currentLocale = newLocale;
-        m_translatedFiles.clear();
+        m_cachedFiles.clear();
 
         m_translationFileLoaded = m_translator.load((m_rootFolder / Path(u"translations/webui_"_s) + newLocale).data());
         if (m_translationFileLoaded)
@@ -577,21 +627,68 @@ void WebApplication::declarePublicAPI(const QString &apiPath)
     m_publicAPIs << apiPath;
 }
 
+void WebApplication::registerAPIRoutes(const QString &scope, const QMetaObject &controllerMetaObject)
+{
+    const QByteArrayView suffix = "Action";
+
+    for (int i = 0; i < controllerMetaObject.methodCount(); ++i)
+    {
+        const QMetaMethod method = controllerMetaObject.method(i);
+        if ((method.methodType() != QMetaMethod::Slot) || (method.parameterCount() != 0))
+            continue;
+
+        const QByteArray methodName = method.name();
+        if (!methodName.endsWith(suffix))
+            continue;
+
+        const QString action = QString::fromLatin1(methodName.chopped(suffix.size()));
+        m_apiRoutes.insert((scope + u'/' + action)
+                , {.scope = scope, .action = method, .httpMethod = m_allowedMethod.value({scope, action})});
+    }
+}
+
 void WebApplication::sendFile(const Path &path)
 {
     const QDateTime lastModified = Utils::Fs::lastModified(path);
 
-    // find translated file in cache
-    if (const auto it = m_translatedFiles.constFind(path);
-        (it != m_translatedFiles.constEnd()) && (lastModified <= it->lastModified))
+    // find file in cache
+    auto it = m_cachedFiles.constFind(path);
+    if ((it == m_cachedFiles.constEnd()) || (lastModified > it->lastModified))
+        it = m_cachedFiles.insert(path, loadFile(path, lastModified));
+
+    const CachedFile &cachedFile = it.value();
+    const bool useGzip = !cachedFile.gzipData.isEmpty()
+        && Http::acceptsGzipEncoding(request().headers.value(u"accept-encoding"_s));
+    // representations with different encodings must have different strong validators
+    const QString eTag = useGzip ? (cachedFile.eTag.chopped(1) + u"-gzip\""_s) : cachedFile.eTag;
+
+    m_response.headers.insert(Http::HEADER_CONTENT_TYPE, cachedFile.mimeType);
+    m_response.headers.insert(Http::HEADER_CACHE_CONTROL, getCachingInterval(cachedFile.mimeType));
+    m_response.headers.insert(Http::HEADER_ETAG, eTag);
+    if (!cachedFile.gzipData.isEmpty())
+        m_response.headers.insert(Http::HEADER_VARY, u"accept-encoding"_s);
+
+    if (matchesETag(request().headers.value(Http::HEADER_IF_NONE_MATCH), eTag))
     {
-        m_response.status = {.code = 200};
-        m_response.headers.insert(Http::HEADER_CONTENT_TYPE, it->mimeType);
-        m_response.headers.insert(Http::HEADER_CACHE_CONTROL, getCachingInterval(it->mimeType));
-        m_response.content = it->data;
+        m_response.status = {.code = 304, .text = u"Not Modified"_s};
         return;
     }
 
+    m_response.status = {.code = 200};
+    if (useGzip)
+    {
+        // the content is shared with the cache so it isn't copied
+        m_response.headers.insert(Http::HEADER_CONTENT_ENCODING, u"gzip"_s);
+        m_response.content = cachedFile.gzipData;
+    }
+    else
+    {
+        m_response.content = cachedFile.data;
+    }
+}
+
+WebApplication::CachedFile WebApplication::loadFile(const Path &path, const QDateTime &lastModified) const
+{
     const auto readResult = Utils::IO::readFile(path, MAX_ALLOWED_FILESIZE);
     if (!readResult)
     {
@@ -633,13 +730,21 @@ void WebApplication::sendFile(const Path &path)
             dataStr.replace(u"${LANGUAGE_OPTIONS}"_s, createLanguagesOptionsHtml());
 
         data = dataStr.toUtf8();
-        m_translatedFiles[path] = {data, mimeType.name(), lastModified}; // caching translated file
     }
 
-    m_response.status = {.code = 200};
-    m_response.headers.insert(Http::HEADER_CONTENT_TYPE, mimeType.name());
-    m_response.headers.insert(Http::HEADER_CACHE_CONTROL, getCachingInterval(mimeType.name()));
-    m_response.content = data;
+    // compress the file only once instead of doing it for each response
+    Http::Response compressedFile {.headers = {{Http::HEADER_CONTENT_TYPE, mimeType.name()}}, .content = data};
+    Http::compressContent(compressedFile);
+    const bool isCompressed = compressedFile.headers.contains(Http::HEADER_CONTENT_ENCODING);
+
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+    return {
+        .data = data,
+        .gzipData = (isCompressed ? compressedFile.content : QByteArray()),
+        .eTag = u"\"%1\""_s.arg(QString::fromLatin1(hash)),
+        .mimeType = mimeType.name(),
+        .lastModified = lastModified
+    };
 }
 
 Http::Response WebApplication::processRequest(const Http::Request &request, const Http::Environment &env)
@@ -672,7 +777,11 @@ Http::Response WebApplication::processRequest(const Http::Request &request, cons
         else
             cookieSessionInitialize(authScheme, authData);
 
-        if (request.path.startsWith(API_PATH))
+        if (request.path == METRICS_PATH)
+        {
+            processMetricsRequest();
+        }
+        else if (request.path.startsWith(API_PATH))
         {
             const QString endpoint = request.path.sliced(API_PATH.size());
 
@@ -824,9 +933,9 @@ bool WebApplication::isAuthNeeded()
     return true;
 }
 
-bool WebApplication::isPublicAPI(const QString &scope, const QString &action) const
+bool WebApplication::isPublicAPI(const QString &endpoint) const
 {
-    return m_publicAPIs.contains(u"%1/%2"_s.arg(scope, action));
+    return m_publicAPIs.contains(endpoint);
 }
 
 void WebApplication::sessionStart()
@@ -859,14 +968,9 @@ void WebApplication::sessionStartImpl(const QString &sessionId, const WebSession
     m_currentSession->registerAPIController(u"torrentcreator"_s, new TorrentCreatorController(m_torrentCreationManager, app(), m_currentSession));
     m_currentSession->registerAPIController(u"rss"_s, new RSSController(app(), m_currentSession));
     m_currentSession->registerAPIController(u"search"_s, new SearchController(app(), m_currentSession));
-    m_currentSession->registerAPIController(u"torrents"_s, new TorrentsController(app(), m_currentSession));
+    m_currentSession->registerAPIController(u"torrents"_s, new TorrentsController(m_maindataChangeLog, app(), m_currentSession));
     m_currentSession->registerAPIController(u"transfer"_s, new TransferController(app(), m_currentSession));
-
-    const auto *btSession = BitTorrent::Session::instance();
-    auto *syncController = new SyncController(app(), m_currentSession);
-    syncController->updateFreeDiskSpace(btSession->freeDiskSpace());
-    connect(btSession, &BitTorrent::Session::freeDiskSpaceChecked, syncController, &SyncController::updateFreeDiskSpace);
-    m_currentSession->registerAPIController(u"sync"_s, syncController);
+    m_currentSession->registerAPIController(u"sync"_s, new SyncController(m_maindataChangeLog, app(), m_currentSession));
 }
 
 void WebApplication::sessionEnd()
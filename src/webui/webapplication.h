@@ -39,6 +39,7 @@
 #include <QHostAddress>
 #include <QList>
 #include <QMap>
+#include <QMetaMethod>
 #include <QObject>
 #include <QRegularExpression>
 #include <QSet>
@@ -58,13 +59,14 @@
 using namespace std::chrono_literals;
 using namespace Qt::Literals::StringLiterals;
 
-inline const Utils::Version<3, 2> API_VERSION {2, 15, 3};
+inline const Utils::Version<3, 2> API_VERSION {2, 15, 4};
 
 class QNetworkCookie;
 
 class APIController;
 class AuthController;
 class ClientDataStorage;
+class MaindataChangeLog;
 class WebSession;
 
 enum class WebSessionType : qint8;
@@ -93,6 +95,22 @@ public:
     void setPasswordHash(const QByteArray &passwordHash);
 
 private:
+    struct APIRoute
+    {
+        QString scope;
+        QMetaMethod action;
+        QString httpMethod;  // empty if both GET and POST methods are allowed
+    };
+
+    struct CachedFile
+    {
+        QByteArray data;
+        QByteArray gzipData;  // empty if the file isn't worth compressing
+        QString eTag;
+        QString mimeType;
+        QDateTime lastModified;
+    };
+
     QString clientId() const;
     ISession *session() override;
     void sessionStart() override;
@@ -100,12 +118,15 @@ private:
     void sessionEnd() override;
 
     void processAPIRequest(const QString &endpoint);
+    void processMetricsRequest();
     void configure();
 
     void declarePublicAPI(const QString &apiPath);
+    void registerAPIRoutes(const QString &scope, const QMetaObject &controllerMetaObject);
 
     void sendFile(const Path &path);
     void sendWebUIFile();
+    CachedFile loadFile(const Path &path, const QDateTime &lastModified) const;
 
     void translateDocument(QString &data) const;
 
@@ -115,7 +136,7 @@ private:
     void cookieSessionInitialize(const QString &authScheme, const QString &authData);
     void apiKeySessionInitialize(const QString &apiKey);
     bool isAuthNeeded();
-    bool isPublicAPI(const QString &scope, const QString &action) const;
+    bool isPublicAPI(const QString &endpoint) const;
 
     bool isOriginTrustworthy() const;
     bool isCrossSiteRequest(const Http::Request &request) const;
@@ -141,6 +162,9 @@ private:
     const QString m_cacheID;
 
     QSet<QString> m_publicAPIs;
+    // "<scope>/<action>" -> route, it is built once on startup
+    QHash<QString, APIRoute> m_apiRoutes;
+    // used only to build the routes
     const QHash<std::pair<QString, QString>, QString> m_allowedMethod =
     {
         // <<controller name, action name>, HTTP method>
@@ -213,6 +237,7 @@ private:
         {{u"torrents"_s, u"setSuperSeeding"_s}, Http::METHOD_POST},
         {{u"torrents"_s, u"setTags"_s}, Http::METHOD_POST},
         {{u"torrents"_s, u"setUploadLimit"_s}, Http::METHOD_POST},
+        {{u"transfer"_s, u"setAlertProfilingEnabled"_s}, Http::METHOD_POST},
         {{u"transfer"_s, u"setDownloadLimit"_s}, Http::METHOD_POST},
         {{u"transfer"_s, u"setSpeedLimitsMode"_s}, Http::METHOD_POST},
         {{u"transfer"_s, u"setUploadLimit"_s}, Http::METHOD_POST},
@@ -226,13 +251,7 @@ private:
     bool m_isAltUIUsed = false;
     Path m_rootFolder;
 
-    struct TranslatedFile
-    {
-        QByteArray data;
-        QString mimeType;
-        QDateTime lastModified;
-    };
-    QHash<Path, TranslatedFile> m_translatedFiles;
+    QHash<Path, CachedFile> m_cachedFiles;
     QString m_currentLocale;
     QTranslator m_translator;
     bool m_translationFileLoaded = false;
@@ -263,6 +282,7 @@ private:
 
     BitTorrent::TorrentCreationManager *m_torrentCreationManager = nullptr;
     ClientDataStorage *m_clientDataStorage = nullptr;
+    MaindataChangeLog *m_maindataChangeLog = nullptr;
 
     struct FailedLogin
     {
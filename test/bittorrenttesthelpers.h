@@ -0,0 +1,102 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QString>
+#include <QTemporaryDir>
+
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/loadtorrentparams.h"
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/path.h"
+#include "base/preferences.h"
+#include "base/profile.h"
+#include "base/settingsstorage.h"
+
+// Helpers shared by BitTorrent tests
+namespace TestHelpers
+{
+    // Returns distinct valid torrent ID for each index
+    inline BitTorrent::TorrentID makeTorrentID(const int index)
+    {
+        const QByteArray hash = QCryptographicHash::hash(QByteArray::number(index), QCryptographicHash::Sha1);
+        return BitTorrent::TorrentID::fromString(QString::fromLatin1(hash.toHex()));
+    }
+
+    // Returns minimal parameters of torrent as they are stored by resume data storages
+    inline BitTorrent::LoadTorrentParams makeLoadTorrentParams(const BitTorrent::TorrentID &id, const int index)
+    {
+        BitTorrent::LoadTorrentParams params;
+        params.name = u"Torrent %1"_s.arg(index);
+        params.category = u"category"_s;
+        params.savePath = Path(u"/downloads"_s);
+        params.ltAddTorrentParams.save_path = "/downloads";
+#ifdef QBT_USES_LIBTORRENT2
+        params.ltAddTorrentParams.info_hashes = lt::info_hash_t(static_cast<lt::sha1_hash>(id));
+#else
+        params.ltAddTorrentParams.info_hash = id;
+#endif
+        return params;
+    }
+
+    // Initializes application-wide instances (profile, settings, preferences and logger) in a temporary folder
+    // and frees them when it is destroyed. Resume data storages rely on them, e.g. to log errors.
+    class TestProfile
+    {
+        Q_DISABLE_COPY_MOVE(TestProfile)
+
+    public:
+        TestProfile()
+        {
+            Profile::initInstance(Path(m_profileDir.path()), {}, false);
+            SettingsStorage::initInstance();
+            Preferences::initInstance();
+            Logger::initInstance();
+        }
+
+        ~TestProfile()
+        {
+            Logger::freeInstance();
+            Preferences::freeInstance();
+            SettingsStorage::freeInstance();
+            Profile::freeInstance();
+        }
+
+        bool isValid() const
+        {
+            return m_profileDir.isValid();
+        }
+
+    private:
+        QTemporaryDir m_profileDir;
+    };
+}
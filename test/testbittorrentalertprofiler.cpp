@@ -0,0 +1,162 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <chrono>
+#include <limits>
+
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/alertprofiler.h"
+#include "base/global.h"
+
+using namespace std::chrono_literals;
+
+using BitTorrent::AlertProfiler;
+using BitTorrent::LatencyHistogram;
+
+class TestBitTorrentAlertProfiler final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBitTorrentAlertProfiler)
+
+public:
+    TestBitTorrentAlertProfiler() = default;
+
+private slots:
+    void testEmptyHistogram() const
+    {
+        const LatencyHistogram histogram;
+        QCOMPARE(histogram.count(), 0);
+        QCOMPARE(histogram.min(), 0);
+        QCOMPARE(histogram.max(), 0);
+        QCOMPARE(histogram.mean(), 0.0);
+        QCOMPARE(histogram.valueAtPercentile(99), 0);
+    }
+
+    void testHistogram() const
+    {
+        LatencyHistogram histogram;
+        for (quint64 value = 1; value <= 10000; ++value)
+            histogram.record(value);
+
+        QCOMPARE(histogram.count(), 10000);
+        QCOMPARE(histogram.min(), 1);
+        QCOMPARE(histogram.max(), 10000);
+        QCOMPARE(histogram.mean(), 5000.5);
+        QCOMPARE(histogram.valueAtPercentile(0), 1);
+        QCOMPARE(histogram.valueAtPercentile(100), 10000);
+
+        // small values are exact, larger ones are within bucket precision
+        QCOMPARE(histogram.valueAtPercentile(0.1), 10);
+        for (const double percentile : {50.0, 90.0, 99.0, 99.9})
+        {
+            const auto exact = static_cast<quint64>(percentile * 100);
+            const quint64 value = histogram.valueAtPercentile(percentile);
+            QVERIFY(value >= exact);
+            QVERIFY(value <= (exact + (exact / 16)));
+        }
+
+        histogram.reset();
+        QCOMPARE(histogram.count(), 0);
+        QCOMPARE(histogram.valueAtPercentile(50), 0);
+    }
+
+    void testHistogramClampsLargeValues() const
+    {
+        LatencyHistogram histogram;
+        histogram.record(std::numeric_limits<quint64>::max());
+        QCOMPARE(histogram.max(), LatencyHistogram::MAX_VALUE);
+        QCOMPARE(histogram.valueAtPercentile(50), LatencyHistogram::MAX_VALUE);
+    }
+
+    void testAlertTypes() const
+    {
+        AlertProfiler profiler;
+        profiler.recordAlert(67, "state_update", 3ms);
+        profiler.recordAlert(12, "tracker_reply", 10us);
+        profiler.recordAlert(67, "state_update", 5ms);
+        profiler.recordAlert(-1, "invalid", 1ms);
+
+        const QList<const AlertProfiler::AlertTypeStatistics *> alertTypes = profiler.alertTypes();
+        QCOMPARE(alertTypes.size(), 2);
+        QCOMPARE(alertTypes[0]->type, 12);
+        QCOMPARE(alertTypes[0]->name, u"tracker_reply"_s);
+        QCOMPARE(alertTypes[0]->handlingTime.max(), 10);
+        QCOMPARE(alertTypes[1]->type, 67);
+        QCOMPARE(alertTypes[1]->handlingTime.count(), 2);
+        QCOMPARE(alertTypes[1]->handlingTime.mean(), 4000.0);
+
+        profiler.reset();
+        QVERIFY(profiler.alertTypes().isEmpty());
+    }
+
+    void testStateUpdateLatency() const
+    {
+        AlertProfiler profiler;
+        const auto start = AlertProfiler::Clock::now();
+
+        // update that wasn't requested while profiling isn't counted
+        profiler.torrentUpdatesReceived(start);
+        QCOMPARE(profiler.stateUpdateLatency().count(), 0);
+
+        // repeated requests are answered by a single update, latency is measured from the first one
+        profiler.torrentUpdatesPosted(start);
+        profiler.torrentUpdatesPosted(start + 5ms);
+        profiler.torrentUpdatesReceived(start + 20ms);
+        profiler.torrentUpdatesReceived(start + 30ms);
+        QCOMPARE(profiler.stateUpdateLatency().count(), 1);
+        QCOMPARE(profiler.stateUpdateLatency().max(), 20000);
+    }
+
+    void testBatches() const
+    {
+        AlertProfiler profiler;
+        profiler.recordBatch(0);
+        profiler.recordBatch(100);
+        profiler.recordTorrentsUpdatedHandlers(2ms);
+
+        QCOMPARE(profiler.batchSizes().count(), 2);
+        QCOMPARE(profiler.batchSizes().max(), 100);
+        QCOMPARE(profiler.torrentsUpdatedHandlers().max(), 2000);
+    }
+
+    void benchmarkRecord() const
+    {
+        LatencyHistogram histogram;
+        quint64 value = 1;
+        QBENCHMARK
+        {
+            histogram.record(value);
+            value = (value * 31) % 1000003;
+        }
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBitTorrentAlertProfiler)
+#include "testbittorrentalertprofiler.moc"
@@ -0,0 +1,226 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <vector>
+
+#include <libtorrent/bitfield.hpp>
+
+#include <QBitArray>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "base/bittorrent/bitfield.h"
+#include "base/global.h"
+
+namespace
+{
+    const int BENCHMARK_PIECE_COUNT = 100000;
+    const int BENCHMARK_PEER_COUNT = 500;
+
+    lt::bitfield randomNativeBitfield(QRandomGenerator &generator, const int size, const int density)
+    {
+        lt::bitfield bits {size};
+        for (int i = 0; i < size; ++i)
+        {
+            if (static_cast<int>(generator.bounded(100)) < density)
+                bits.set_bit(i);
+        }
+        return bits;
+    }
+
+    QBitArray toQBitArray(const lt::bitfield &bits)
+    {
+        QBitArray result {bits.size()};
+        for (int i = 0; i < bits.size(); ++i)
+            result.setBit(i, bits.get_bit(i));
+        return result;
+    }
+}
+
+class TestBitTorrentBitfield final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBitTorrentBitfield)
+
+public:
+    TestBitTorrentBitfield() = default;
+
+private slots:
+    void testConstruct() const
+    {
+        const BitTorrent::Bitfield empty;
+        QVERIFY(empty.isEmpty());
+        QCOMPARE(empty.count(true), 0);
+
+        BitTorrent::Bitfield filled {13, true};
+        QCOMPARE(filled.size(), 13);
+        QCOMPARE(filled.count(true), 13);
+        QCOMPARE(filled.count(false), 0);
+
+        filled.clearBit(12);
+        QVERIFY(!filled.at(12));
+        filled.fill(false);
+        QCOMPARE(filled.count(true), 0);
+        filled.setBit(3);
+        QVERIFY(filled[3]);
+        QCOMPARE(filled.count(true), 1);
+    }
+
+    void testNativeBitOrder() const
+    {
+        QRandomGenerator generator {1};
+        for (const int size : {0, 1, 7, 8, 9, 31, 32, 33, 255, 1000})
+        {
+            const lt::bitfield nativeBits = randomNativeBitfield(generator, size, 50);
+            const BitTorrent::Bitfield bits {nativeBits};
+            QCOMPARE(bits.size(), size);
+            for (int i = 0; i < size; ++i)
+                QCOMPARE(bits.at(i), nativeBits.get_bit(i));
+            QCOMPARE(bits.count(true), nativeBits.count());
+        }
+    }
+
+    void testCount() const
+    {
+        QRandomGenerator generator {2};
+        const lt::bitfield nativeBits = randomNativeBitfield(generator, 1000, 30);
+        const BitTorrent::Bitfield bits {nativeBits};
+
+        for (int n = 0; n < 200; ++n)
+        {
+            const int from = generator.bounded(1000);
+            const int to = from + generator.bounded(1001 - from);
+
+            qsizetype expected = 0;
+            for (int i = from; i < to; ++i)
+                expected += nativeBits.get_bit(i) ? 1 : 0;
+            QCOMPARE(bits.count(from, to), expected);
+        }
+    }
+
+    void testCountAndNot() const
+    {
+        QRandomGenerator generator {3};
+        for (const int size : {0, 5, 64, 100, 257, 4099})
+        {
+            const lt::bitfield peerBits = randomNativeBitfield(generator, size, 60);
+            const lt::bitfield localBits = randomNativeBitfield(generator, size, 40);
+
+            const QBitArray expected = toQBitArray(peerBits) & ~toQBitArray(localBits);
+            const BitTorrent::Bitfield local {localBits};
+            QCOMPARE(BitTorrent::Bitfield(peerBits).countAndNot(local), expected.count(true));
+            QCOMPARE(BitTorrent::countAndNot(peerBits, local), expected.count(true));
+        }
+    }
+
+    void testNextSetBit() const
+    {
+        BitTorrent::Bitfield bits {300};
+        QCOMPARE(bits.nextSetBit(0), -1);
+
+        bits.setBit(5);
+        bits.setBit(200);
+        bits.setBit(299);
+        QCOMPARE(bits.nextSetBit(0), 5);
+        QCOMPARE(bits.nextSetBit(5), 5);
+        QCOMPARE(bits.nextSetBit(6), 200);
+        QCOMPARE(bits.nextSetBit(201), 299);
+        QCOMPARE(bits.nextSetBit(300), -1);
+    }
+
+    void testXor() const
+    {
+        BitTorrent::Bitfield left {20};
+        left.setBit(1);
+        left.setBit(2);
+        BitTorrent::Bitfield right {20};
+        right.setBit(2);
+        right.setBit(19);
+
+        const BitTorrent::Bitfield result = left ^ right;
+        QCOMPARE(result.size(), 20);
+        QCOMPARE(result.count(true), 2);
+        QVERIFY(result.at(1));
+        QVERIFY(result.at(19));
+
+        // shorter operand is padded with unset bits
+        QCOMPARE((left ^ BitTorrent::Bitfield()), left);
+    }
+
+    void benchmarkRelevance() const
+    {
+        QRandomGenerator generator {4};
+        const BitTorrent::Bitfield allPieces {randomNativeBitfield(generator, BENCHMARK_PIECE_COUNT, 50)};
+        std::vector<lt::bitfield> peers;
+        for (int i = 0; i < BENCHMARK_PEER_COUNT; ++i)
+            peers.push_back(randomNativeBitfield(generator, BENCHMARK_PIECE_COUNT, 70));
+
+        QBENCHMARK
+        {
+            const qsizetype localMissing = allPieces.count(false);
+            qreal total = 0;
+            for (const lt::bitfield &peerPieces : peers)
+                total += static_cast<qreal>(BitTorrent::countAndNot(peerPieces, allPieces)) / localMissing;
+            QVERIFY(total > 0);
+        }
+    }
+
+    void benchmarkRelevanceQBitArray() const
+    {
+        QRandomGenerator generator {4};
+        const QBitArray allPieces = toQBitArray(randomNativeBitfield(generator, BENCHMARK_PIECE_COUNT, 50));
+        std::vector<QBitArray> peers;
+        for (int i = 0; i < BENCHMARK_PEER_COUNT; ++i)
+            peers.push_back(toQBitArray(randomNativeBitfield(generator, BENCHMARK_PIECE_COUNT, 70)));
+
+        QBENCHMARK
+        {
+            const qsizetype localMissing = allPieces.count(false);
+            qreal total = 0;
+            for (const QBitArray &peerPieces : peers)
+                total += static_cast<qreal>((peerPieces & (~allPieces)).count(true)) / localMissing;
+            QVERIFY(total > 0);
+        }
+    }
+
+    void benchmarkCount() const
+    {
+        QRandomGenerator generator {5};
+        const BitTorrent::Bitfield bits {randomNativeBitfield(generator, BENCHMARK_PIECE_COUNT, 50)};
+
+        QBENCHMARK
+        {
+            for (int i = 0; i < BENCHMARK_PEER_COUNT; ++i)
+                QVERIFY(bits.count(true) > 0);
+        }
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBitTorrentBitfield)
+#include "testbittorrentbitfield.moc"
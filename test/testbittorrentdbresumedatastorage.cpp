@@ -0,0 +1,185 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <memory>
+
+#include <QObject>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "base/bittorrent/dbresumedatastorage.h"
+#include "base/exceptions.h"
+#include "base/global.h"
+#include "base/path.h"
+#include "bittorrenttesthelpers.h"
+
+using BitTorrent::DBResumeDataStorage;
+using BitTorrent::TorrentID;
+using TestHelpers::makeLoadTorrentParams;
+using TestHelpers::makeTorrentID;
+
+namespace
+{
+    const int BENCHMARK_TORRENTS_COUNT = 10'000;
+    const int STORE_TIMEOUT = 120'000;
+
+    // Changes DB version as if the database was created by another version of qBittorrent
+    bool setDBVersion(const Path &dbPath, const int version)
+    {
+        const QString connectionName = u"TestBitTorrentDBResumeDataStorage"_s;
+        bool isUpdated = false;
+        {
+            auto db = QSqlDatabase::addDatabase(u"QSQLITE"_s, connectionName);
+            db.setDatabaseName(dbPath.data());
+            if (db.open())
+            {
+                QSqlQuery query {db};
+                isUpdated = query.exec(u"UPDATE meta SET value = %1 WHERE name = 'version';"_s.arg(version))
+                        && (query.numRowsAffected() == 1);
+                db.close();
+            }
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+        return isUpdated;
+    }
+
+    void storeTorrents(const DBResumeDataStorage &storage, const int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const TorrentID id = makeTorrentID(i);
+            storage.store(id, makeLoadTorrentParams(id, i));
+        }
+    }
+}
+
+class TestBitTorrentDBResumeDataStorage final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBitTorrentDBResumeDataStorage)
+
+public:
+    TestBitTorrentDBResumeDataStorage() = default;
+
+private slots:
+    void initTestCase()
+    {
+        m_profile = std::make_unique<TestHelpers::TestProfile>();
+        QVERIFY(m_profile->isValid());
+    }
+
+    void cleanupTestCase()
+    {
+        m_profile.reset();
+    }
+
+    void testStoreAndLoad() const
+    {
+        const QTemporaryDir tmpDir;
+        const Path dbPath {tmpDir.filePath(u"torrents.db"_s)};
+
+        const DBResumeDataStorage storage {dbPath};
+        storeTorrents(storage, 3);
+        QTRY_COMPARE_WITH_TIMEOUT(storage.registeredTorrents().size(), 3, STORE_TIMEOUT);
+
+        const BitTorrent::LoadResumeDataResult result = storage.load(makeTorrentID(1));
+        QVERIFY2(result.has_value(), qUtf8Printable(result.error()));
+        QCOMPARE(result.value().name, u"Torrent 1"_s);
+    }
+
+    void testUpgradeBackup() const
+    {
+        const QTemporaryDir tmpDir;
+        const Path dbPath {tmpDir.filePath(u"torrents.db"_s)};
+        {
+            const DBResumeDataStorage storage {dbPath};
+            storeTorrents(storage, 3);
+            QTRY_COMPARE_WITH_TIMEOUT(storage.registeredTorrents().size(), 3, STORE_TIMEOUT);
+        }
+        QVERIFY(setDBVersion(dbPath, 10));
+
+        const DBResumeDataStorage storage {dbPath};
+        QCOMPARE(storage.registeredTorrents().size(), 3);
+
+        // Copy of the previous version is kept for older versions of qBittorrent
+        QVERIFY((dbPath + u".v10.bak").exists());
+    }
+
+    void testRefuseNewerDatabase() const
+    {
+        const QTemporaryDir tmpDir;
+        const Path dbPath {tmpDir.filePath(u"torrents.db"_s)};
+        {
+            const DBResumeDataStorage storage {dbPath};
+        }
+        QVERIFY(setDBVersion(dbPath, 1000));
+
+        QVERIFY_THROWS_EXCEPTION(RuntimeError, std::make_unique<DBResumeDataStorage>(dbPath));
+        QVERIFY(!QSqlDatabase::contains(u"ResumeDataStorage"_s));
+    }
+
+    void benchmarkStore() const
+    {
+        QBENCHMARK
+        {
+            const QTemporaryDir tmpDir;
+            const DBResumeDataStorage storage {Path(tmpDir.filePath(u"torrents.db"_s))};
+            storeTorrents(storage, BENCHMARK_TORRENTS_COUNT);
+            QTRY_COMPARE_WITH_TIMEOUT(storage.registeredTorrents().size(), BENCHMARK_TORRENTS_COUNT, STORE_TIMEOUT);
+        }
+    }
+
+    void benchmarkLoadAll() const
+    {
+        const QTemporaryDir tmpDir;
+        const Path dbPath {tmpDir.filePath(u"torrents.db"_s)};
+        {
+            const DBResumeDataStorage storage {dbPath};
+            storeTorrents(storage, BENCHMARK_TORRENTS_COUNT);
+            QTRY_COMPARE_WITH_TIMEOUT(storage.registeredTorrents().size(), BENCHMARK_TORRENTS_COUNT, STORE_TIMEOUT);
+        }
+
+        QBENCHMARK
+        {
+            const DBResumeDataStorage storage {dbPath};
+            QSignalSpy loadFinishedSpy {&storage, &BitTorrent::ResumeDataStorage::loadFinished};
+            storage.loadAll();
+            QTRY_COMPARE_WITH_TIMEOUT(loadFinishedSpy.count(), 1, STORE_TIMEOUT);
+            QCOMPARE(storage.fetchLoadedResumeData().size(), BENCHMARK_TORRENTS_COUNT);
+        }
+    }
+
+private:
+    std::unique_ptr<TestHelpers::TestProfile> m_profile;
+};
+
+QTEST_GUILESS_MAIN(TestBitTorrentDBResumeDataStorage)
+#include "testbittorrentdbresumedatastorage.moc"
@@ -0,0 +1,205 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <libtorrent/address.hpp>
+#include <libtorrent/ip_filter.hpp>
+
+#include <QByteArray>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "base/bittorrent/filterparserthread.h"
+#include "base/global.h"
+
+namespace
+{
+    const int BENCHMARK_LINE_COUNT = 1000000;
+
+    // Builds DAT filter with `lineCount` non-overlapping /24 IPv4 ranges
+    QByteArray generateDATFilter(const int lineCount, const quint32 seed)
+    {
+        QRandomGenerator generator {seed};
+
+        QByteArray data;
+        data.reserve(lineCount * 64);
+        for (int i = 0; i < lineCount; ++i)
+        {
+            const quint32 network = generator.bounded(1U << 24);
+            const auto a = QByteArray::number(network >> 16).rightJustified(3, '0');
+            const auto b = QByteArray::number((network >> 8) & 0xFF).rightJustified(3, '0');
+            const auto c = QByteArray::number(network & 0xFF).rightJustified(3, '0');
+            data += a + '.' + b + '.' + c + ".000 - " + a + '.' + b + '.' + c + ".255 , 000 , Organization "
+                + QByteArray::number(i) + '\n';
+        }
+        return data;
+    }
+
+    bool isBlocked(const lt::ip_filter &filter, const char *address)
+    {
+        return (filter.access(lt::make_address(address)) & lt::ip_filter::blocked) != 0;
+    }
+}
+
+class TestBitTorrentFilterParser final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBitTorrentFilterParser)
+
+public:
+    TestBitTorrentFilterParser() = default;
+
+private slots:
+    void testDAT() const
+    {
+        const QByteArray data =
+            "# comment\r\n"
+            "// another comment\r\n"
+            "001.002.003.000 - 001.002.003.255 , 000 , Some organization\r\n"
+            "001.002.004.000 - 001.002.004.010 , 100 , Adjacent range\r\n"
+            "005.000.000.000 - 005.000.000.255 , 200 , Allowed range\r\n"
+            "\r\n"
+            "2001:db8::1 - 2001:db8::ff , 000 , IPv6 range\r\n"
+            "009.009.009.009\r\n"
+            "009.009.009.009 - 008.008.008.008 , 000 , Inverted range\r\n"
+            "1.2.3.400 - 1.2.3.4 , 000 , Bad start\r\n"
+            "1.2.3.4 - 2001:db8::1 , 000 , Mixed range";
+
+        const auto ruleset = FilterParserThread::parse(data, FilterParserThread::Format::DAT);
+        QCOMPARE(ruleset.ruleCount, 3);
+        QCOMPARE(ruleset.errorCount, 4);
+        QCOMPARE(ruleset.errors.size(), 4);
+        QVERIFY(ruleset.errors[0].contains(u"line 8 "_s));
+        QVERIFY(ruleset.errors[1].contains(u"line 9 "_s));
+        QVERIFY(ruleset.errors[2].contains(u"line 10 "_s));
+        QVERIFY(ruleset.errors[3].contains(u"line 11 "_s));
+
+        // the first two ranges are adjacent and get merged
+        QCOMPARE(ruleset.ipv4Ranges.size(), std::size_t {1});
+        QCOMPARE(ruleset.ipv4Ranges[0].first, 0x01020300U);
+        QCOMPARE(ruleset.ipv4Ranges[0].last, 0x0102040AU);
+        QCOMPARE(ruleset.ipv6Ranges.size(), std::size_t {1});
+
+        const lt::ip_filter filter = FilterParserThread::toIPFilter(ruleset);
+        QVERIFY(isBlocked(filter, "1.2.3.4"));
+        QVERIFY(isBlocked(filter, "1.2.4.10"));
+        QVERIFY(!isBlocked(filter, "1.2.4.11"));
+        QVERIFY(!isBlocked(filter, "5.0.0.1"));
+        QVERIFY(isBlocked(filter, "2001:db8::80"));
+        QVERIFY(!isBlocked(filter, "2001:db8::100"));
+    }
+
+    void testP2P() const
+    {
+        const QByteArray data =
+            "# comment\n"
+            "Some: organization:1.0.0.0-1.255.255.255\n"
+            "Overlapping:1.128.0.0-2.0.0.255\n"
+            "No range\n"
+            "Bad end:3.0.0.0-3.0.0\n";
+
+        const auto ruleset = FilterParserThread::parse(data, FilterParserThread::Format::P2P);
+        QCOMPARE(ruleset.ruleCount, 2);
+        QCOMPARE(ruleset.errorCount, 2);
+        QVERIFY(ruleset.errors[0].contains(u"line 4 "_s));
+        QVERIFY(ruleset.errors[1].contains(u"line 5 "_s));
+        QCOMPARE(ruleset.ipv4Ranges.size(), std::size_t {1});
+        QCOMPARE(ruleset.ipv4Ranges[0].first, 0x01000000U);
+        QCOMPARE(ruleset.ipv4Ranges[0].last, 0x020000FFU);
+    }
+
+    void testP2B() const
+    {
+        const auto appendUInt32 = [](QByteArray &data, const quint32 value)
+        {
+            data += static_cast<char>(value >> 24);
+            data += static_cast<char>(value >> 16);
+            data += static_cast<char>(value >> 8);
+            data += static_cast<char>(value);
+        };
+
+        QByteArray data = QByteArray("\xFF\xFF\xFF\xFFP2B", 7) + '\x03';
+        appendUInt32(data, 2);
+        data += QByteArray("First", 6);
+        data += QByteArray("Second", 7);
+        appendUInt32(data, 2);
+        appendUInt32(data, 0);
+        appendUInt32(data, 0x0A000000);
+        appendUInt32(data, 0x0A0000FF);
+        appendUInt32(data, 1);
+        appendUInt32(data, 0x0B000000);
+        appendUInt32(data, 0x0B0000FF);
+
+        const auto ruleset = FilterParserThread::parse(data, FilterParserThread::Format::P2B);
+        QCOMPARE(ruleset.ruleCount, 2);
+        QCOMPARE(ruleset.errorCount, 0);
+        QCOMPARE(ruleset.ipv4Ranges.size(), std::size_t {2});
+        QCOMPARE(ruleset.ipv4Ranges[1].first, 0x0B000000U);
+
+        // truncated file keeps the ranges read so far
+        data.chop(4);
+        const auto truncated = FilterParserThread::parse(data, FilterParserThread::Format::P2B);
+        QCOMPARE(truncated.ruleCount, 1);
+        QCOMPARE(truncated.errorCount, 1);
+
+        const auto invalid = FilterParserThread::parse("P2B", FilterParserThread::Format::P2B);
+        QCOMPARE(invalid.ruleCount, 0);
+        QCOMPARE(invalid.errorCount, 1);
+    }
+
+    void testChunkedParsing() const
+    {
+        // large enough to be split into several chunks
+        const int lineCount = 100000;
+        QByteArray data = generateDATFilter(lineCount, 1);
+        data += "malformed line\n";
+        data.prepend("malformed line\n");
+
+        const auto ruleset = FilterParserThread::parse(data, FilterParserThread::Format::DAT);
+        QCOMPARE(ruleset.ruleCount, lineCount);
+        QCOMPARE(ruleset.errorCount, 2);
+        QVERIFY(ruleset.errors[0].contains(u"line 1 "_s));
+        QVERIFY(ruleset.errors[1].contains(u"line %1 "_s.arg(lineCount + 2)));
+
+        for (std::size_t i = 1; i < ruleset.ipv4Ranges.size(); ++i)
+            QVERIFY(ruleset.ipv4Ranges[i - 1].last < ruleset.ipv4Ranges[i].first);
+    }
+
+    void benchmarkParseDAT() const
+    {
+        const QByteArray data = generateDATFilter(BENCHMARK_LINE_COUNT, 2);
+        QBENCHMARK
+        {
+            const auto ruleset = FilterParserThread::parse(data, FilterParserThread::Format::DAT);
+            QCOMPARE(ruleset.ruleCount, BENCHMARK_LINE_COUNT);
+        }
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBitTorrentFilterParser)
+#include "testbittorrentfilterparser.moc"
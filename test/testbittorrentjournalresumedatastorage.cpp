@@ -0,0 +1,200 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <memory>
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "base/bittorrent/journalresumedatastorage.h"
+#include "base/global.h"
+#include "base/path.h"
+#include "bittorrenttesthelpers.h"
+
+using BitTorrent::JournalResumeDataStorage;
+using BitTorrent::TorrentID;
+using TestHelpers::makeLoadTorrentParams;
+using TestHelpers::makeTorrentID;
+
+namespace
+{
+    const int BENCHMARK_TORRENTS_COUNT = 10'000;
+    const qsizetype RECORD_HEADER_SIZE = 12;
+
+    // Storage is destroyed before returning so all the records are flushed to the journal
+    QList<TorrentID> populateJournal(const Path &journalPath, const int count)
+    {
+        QList<TorrentID> torrentIDs;
+        torrentIDs.reserve(count);
+
+        const JournalResumeDataStorage storage {journalPath};
+        for (int i = 0; i < count; ++i)
+        {
+            const TorrentID id = makeTorrentID(i);
+            storage.store(id, makeLoadTorrentParams(id, i));
+            torrentIDs.append(id);
+        }
+        storage.storeQueue(torrentIDs);
+
+        return torrentIDs;
+    }
+
+    QStringList corruptedDataFiles(const QTemporaryDir &dir)
+    {
+        return QDir(dir.path()).entryList({u"*.corrupt-*"_s}, QDir::Files);
+    }
+}
+
+class TestBitTorrentJournalResumeDataStorage final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBitTorrentJournalResumeDataStorage)
+
+public:
+    TestBitTorrentJournalResumeDataStorage() = default;
+
+private slots:
+    void initTestCase()
+    {
+        m_profile = std::make_unique<TestHelpers::TestProfile>();
+        QVERIFY(m_profile->isValid());
+    }
+
+    void cleanupTestCase()
+    {
+        m_profile.reset();
+    }
+
+    void testStoreAndLoad() const
+    {
+        const QTemporaryDir tmpDir;
+        const Path journalPath {tmpDir.filePath(u"resume.journal"_s)};
+        const QList<TorrentID> torrentIDs = populateJournal(journalPath, 3);
+
+        const JournalResumeDataStorage storage {journalPath};
+        QCOMPARE(storage.registeredTorrents(), torrentIDs);
+        for (int i = 0; i < torrentIDs.size(); ++i)
+        {
+            const BitTorrent::LoadResumeDataResult result = storage.load(torrentIDs[i]);
+            QVERIFY2(result.has_value(), qUtf8Printable(result.error()));
+            QCOMPARE(result.value().name, u"Torrent %1"_s.arg(i));
+        }
+        QVERIFY(corruptedDataFiles(tmpDir).isEmpty());
+    }
+
+    void testCorruptedHeader() const
+    {
+        const QTemporaryDir tmpDir;
+        const Path journalPath {tmpDir.filePath(u"resume.journal"_s)};
+        const QList<TorrentID> torrentIDs = populateJournal(journalPath, 3);
+
+        // Damage the payload size of the second record. Its checksum covers the header
+        // so it is rejected, and the records following it must still be found.
+        {
+            QFile file {journalPath.data()};
+            QVERIFY(file.open(QIODevice::ReadWrite));
+            QByteArray content = file.readAll();
+            const lt::sha1_hash hash = torrentIDs[1];
+            const qsizetype headerOffset = content.indexOf(QByteArrayView(hash.data(), hash.size())) - RECORD_HEADER_SIZE;
+            QVERIFY(headerOffset > 0);
+            content[headerOffset + 1] = static_cast<char>(content[headerOffset + 1] ^ 0x5A);
+            QVERIFY(file.seek(0));
+            QCOMPARE(file.write(content), content.size());
+        }
+
+        {
+            const JournalResumeDataStorage storage {journalPath};
+            const QList<TorrentID> expectedIDs {torrentIDs[0], torrentIDs[2]};
+            QCOMPARE(storage.registeredTorrents(), expectedIDs);
+            QVERIFY(storage.load(torrentIDs[2]).has_value());
+            QVERIFY(!storage.load(torrentIDs[1]).has_value());
+        }
+
+        QCOMPARE(corruptedDataFiles(tmpDir).size(), 1);
+
+        // Damaged data is removed from the journal after it was saved aside
+        const JournalResumeDataStorage storage {journalPath};
+        QCOMPARE(storage.registeredTorrents().size(), 2);
+        QCOMPARE(corruptedDataFiles(tmpDir).size(), 1);
+    }
+
+    void testIncompleteTail() const
+    {
+        const QTemporaryDir tmpDir;
+        const Path journalPath {tmpDir.filePath(u"resume.journal"_s)};
+        const QList<TorrentID> torrentIDs = populateJournal(journalPath, 3);
+
+        const QByteArray tail = QByteArrayLiteral("\x40\x00\x00\x00\x01\x02");
+        {
+            QFile file {journalPath.data()};
+            QVERIFY(file.open(QIODevice::Append));
+            QCOMPARE(file.write(tail), tail.size());
+        }
+        const qint64 originalSize = QFileInfo(journalPath.data()).size() - tail.size();
+
+        {
+            const JournalResumeDataStorage storage {journalPath};
+            QCOMPARE(storage.registeredTorrents(), torrentIDs);
+        }
+
+        QCOMPARE(QFileInfo(journalPath.data()).size(), originalSize);
+        const QStringList corruptedFiles = corruptedDataFiles(tmpDir);
+        QCOMPARE(corruptedFiles.size(), 1);
+        QFile corruptedFile {tmpDir.filePath(corruptedFiles.first())};
+        QVERIFY(corruptedFile.open(QIODevice::ReadOnly));
+        QCOMPARE(corruptedFile.readAll(), tail);
+    }
+
+    void benchmarkLoadAll() const
+    {
+        const QTemporaryDir tmpDir;
+        const Path journalPath {tmpDir.filePath(u"resume.journal"_s)};
+        populateJournal(journalPath, BENCHMARK_TORRENTS_COUNT);
+
+        QBENCHMARK
+        {
+            const JournalResumeDataStorage storage {journalPath};
+            QSignalSpy loadFinishedSpy {&storage, &BitTorrent::ResumeDataStorage::loadFinished};
+            storage.loadAll();
+            QTRY_COMPARE_WITH_TIMEOUT(loadFinishedSpy.count(), 1, 60'000);
+            QCOMPARE(storage.fetchLoadedResumeData().size(), BENCHMARK_TORRENTS_COUNT);
+        }
+    }
+
+private:
+    std::unique_ptr<TestHelpers::TestProfile> m_profile;
+};
+
+QTEST_GUILESS_MAIN(TestBitTorrentJournalResumeDataStorage)
+#include "testbittorrentjournalresumedatastorage.moc"
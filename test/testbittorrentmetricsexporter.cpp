@@ -0,0 +1,193 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/metricsexporter.h"
+#include "base/global.h"
+
+using BitTorrent::MetricsExporter;
+
+namespace
+{
+    const BitTorrent::TorrentID TORRENT1 = BitTorrent::TorrentID::fromString(u"0123456789abcdef0123456789abcdef01234567"_s);
+    const BitTorrent::TorrentID TORRENT2 = BitTorrent::TorrentID::fromString(u"89abcdef0123456789abcdef0123456789abcdef"_s);
+
+    QList<QByteArray> lines(const QByteArray &text)
+    {
+        return text.split('\n');
+    }
+}
+
+class TestBitTorrentMetricsExporter final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBitTorrentMetricsExporter)
+
+public:
+    TestBitTorrentMetricsExporter() = default;
+
+private slots:
+    void testSessionMetrics() const
+    {
+        MetricsExporter exporter {{
+            {.name = "net.recv_bytes", .valueIndex = 1, .isCounter = true},
+            {.name = "dht.dht_nodes", .valueIndex = 0, .isCounter = false},
+            {.name = "out.of_range", .valueIndex = 5, .isCounter = false}
+        }};
+        QVERIFY(exporter.text().isEmpty());
+
+        exporter.update(std::vector<std::int64_t> {42, 1234567890123});
+        const QList<QByteArray> result = lines(exporter.text());
+        QVERIFY(result.contains("# TYPE libtorrent_net_recv_bytes counter"));
+        QVERIFY(result.contains("libtorrent_net_recv_bytes 1234567890123"));
+        QVERIFY(result.contains("# TYPE libtorrent_dht_dht_nodes gauge"));
+        QVERIFY(result.contains("libtorrent_dht_dht_nodes 42"));
+        QVERIFY(!exporter.text().contains("out_of_range"));
+
+        exporter.update(std::vector<std::int64_t> {7, 1234567890124});
+        QVERIFY(lines(exporter.text()).contains("libtorrent_dht_dht_nodes 7"));
+        QVERIFY(!lines(exporter.text()).contains("libtorrent_dht_dht_nodes 42"));
+    }
+
+    void testExtraMetrics() const
+    {
+        MetricsExporter exporter {{{.name = "dht.dht_nodes", .valueIndex = 0, .isCounter = false}}};
+        exporter.setExtraMetric("qbittorrent_reverse_dns_lookups", 12, true);
+        exporter.setExtraMetric("qbittorrent_reverse_dns_queue_depth", 3, false);
+        QVERIFY(exporter.text().isEmpty());
+
+        exporter.update(std::vector<std::int64_t> {42});
+        QList<QByteArray> result = lines(exporter.text());
+        QVERIFY(result.contains("libtorrent_dht_dht_nodes 42"));
+        QVERIFY(result.contains("# TYPE qbittorrent_reverse_dns_lookups counter"));
+        QVERIFY(result.contains("qbittorrent_reverse_dns_lookups 12"));
+        QVERIFY(result.contains("# TYPE qbittorrent_reverse_dns_queue_depth gauge"));
+        QVERIFY(result.contains("qbittorrent_reverse_dns_queue_depth 3"));
+
+        exporter.setExtraMetric("qbittorrent_reverse_dns_lookups", 13, true);
+        exporter.update(std::vector<std::int64_t> {42});
+        result = lines(exporter.text());
+        QVERIFY(result.contains("qbittorrent_reverse_dns_lookups 13"));
+        QCOMPARE(result.count("# TYPE qbittorrent_reverse_dns_lookups counter"), qsizetype {1});
+    }
+
+    void testCategoryAggregates() const
+    {
+        MetricsExporter exporter {QList<MetricsExporter::Metric> {}};
+        exporter.updateTorrent(TORRENT1, {.category = u"movies"_s, .downloadRate = 100, .uploadRate = 10, .peers = 3});
+        exporter.updateTorrent(TORRENT2, {.category = u"movies"_s, .downloadRate = 50, .uploadRate = 5, .peers = 2, .isSeed = true});
+        exporter.update({});
+
+        QList<QByteArray> result = lines(exporter.text());
+        QVERIFY(result.contains("# TYPE qbittorrent_category_torrents gauge"));
+        QVERIFY(result.contains("qbittorrent_category_torrents{category=\"movies\"} 2"));
+        QVERIFY(result.contains("qbittorrent_category_seeding_torrents{category=\"movies\"} 1"));
+        QVERIFY(result.contains("qbittorrent_category_peers{category=\"movies\"} 5"));
+        QVERIFY(result.contains("qbittorrent_category_download_rate_bytes{category=\"movies\"} 150"));
+        QVERIFY(result.contains("qbittorrent_category_upload_rate_bytes{category=\"movies\"} 15"));
+
+        // values of a torrent are replaced rather than accumulated
+        exporter.updateTorrent(TORRENT1, {.category = u"movies"_s, .downloadRate = 20, .uploadRate = 10, .peers = 3});
+        exporter.update({});
+        QVERIFY(lines(exporter.text()).contains("qbittorrent_category_download_rate_bytes{category=\"movies\"} 70"));
+
+        exporter.setTorrentCategory(TORRENT2, u"tv"_s);
+        exporter.update({});
+        result = lines(exporter.text());
+        QVERIFY(result.contains("qbittorrent_category_torrents{category=\"movies\"} 1"));
+        QVERIFY(result.contains("qbittorrent_category_torrents{category=\"tv\"} 1"));
+        QVERIFY(result.contains("qbittorrent_category_seeding_torrents{category=\"tv\"} 1"));
+
+        exporter.removeTorrent(TORRENT2);
+        exporter.removeTorrent(TORRENT2);
+        exporter.update({});
+        QVERIFY(!exporter.text().contains("category=\"tv\""));
+        QVERIFY(lines(exporter.text()).contains("qbittorrent_category_torrents{category=\"movies\"} 1"));
+    }
+
+    void testTrackerAggregates() const
+    {
+        MetricsExporter exporter {QList<MetricsExporter::Metric> {}};
+        exporter.setTorrentTrackers(TORRENT1, {u"tracker.example.org"_s, u"tracker.example.org"_s, u"udp.example.net"_s});
+        exporter.updateTorrent(TORRENT1, {.allTimeDownload = 1000, .allTimeUpload = 500});
+        exporter.setTorrentTrackers(TORRENT2, {u"udp.example.net"_s});
+        exporter.updateTorrent(TORRENT2, {.allTimeDownload = 10, .allTimeUpload = 5});
+        exporter.update({});
+
+        QList<QByteArray> result = lines(exporter.text());
+        QVERIFY(result.contains("qbittorrent_tracker_torrents{tracker=\"tracker.example.org\"} 1"));
+        QVERIFY(result.contains("qbittorrent_tracker_downloaded_bytes{tracker=\"tracker.example.org\"} 1000"));
+        QVERIFY(result.contains("qbittorrent_tracker_torrents{tracker=\"udp.example.net\"} 2"));
+        QVERIFY(result.contains("qbittorrent_tracker_uploaded_bytes{tracker=\"udp.example.net\"} 505"));
+        QVERIFY(result.contains("qbittorrent_category_torrents{category=\"\"} 2"));
+
+        exporter.setTorrentTrackers(TORRENT1, {});
+        exporter.update({});
+        result = lines(exporter.text());
+        QVERIFY(!exporter.text().contains("tracker.example.org"));
+        QVERIFY(result.contains("qbittorrent_tracker_torrents{tracker=\"udp.example.net\"} 2"));
+        QVERIFY(result.contains("qbittorrent_tracker_uploaded_bytes{tracker=\"udp.example.net\"} 505"));
+    }
+
+    void testLoadedTorrent() const
+    {
+        // the session sets category and trackers of loaded torrent before its first state update
+        MetricsExporter exporter {QList<MetricsExporter::Metric> {}};
+        exporter.setTorrentCategory(TORRENT1, u"movies"_s);
+        exporter.setTorrentTrackers(TORRENT1, {u"tracker.example.org"_s});
+        exporter.update({});
+
+        QList<QByteArray> result = lines(exporter.text());
+        QVERIFY(result.contains("qbittorrent_category_torrents{category=\"movies\"} 1"));
+        QVERIFY(result.contains("qbittorrent_tracker_torrents{tracker=\"tracker.example.org\"} 1"));
+        QVERIFY(!exporter.text().contains("category=\"\""));
+
+        exporter.updateTorrent(TORRENT1, {.category = u"movies"_s, .downloadRate = 100});
+        exporter.update({});
+        result = lines(exporter.text());
+        QVERIFY(result.contains("qbittorrent_category_torrents{category=\"movies\"} 1"));
+        QVERIFY(result.contains("qbittorrent_tracker_download_rate_bytes{tracker=\"tracker.example.org\"} 100"));
+    }
+
+    void testLabelEscaping() const
+    {
+        MetricsExporter exporter {QList<MetricsExporter::Metric> {}};
+        exporter.updateTorrent(TORRENT1, {.category = u"a\"b\\c\nd"_s});
+        exporter.update({});
+        QVERIFY(lines(exporter.text()).contains("qbittorrent_category_torrents{category=\"a\\\"b\\\\c\\nd\"} 1"));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBitTorrentMetricsExporter)
+#include "testbittorrentmetricsexporter.moc"
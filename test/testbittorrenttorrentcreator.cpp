@@ -0,0 +1,207 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <algorithm>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/torrentcreator.h"
+#include "base/bittorrent/torrentdescriptor.h"
+#include "base/global.h"
+#include "base/path.h"
+
+using BitTorrent::TorrentCreator;
+using BitTorrent::TorrentCreatorLimits;
+using BitTorrent::TorrentCreatorParams;
+
+namespace
+{
+    const int PIECE_SIZE = 256 * 1024;
+
+    bool writeRandomFile(const QString &filePath, const qint64 size, const quint32 seed)
+    {
+        QFile file {filePath};
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        QRandomGenerator generator {seed};
+        QByteArray chunk {(1024 * 1024), Qt::Uninitialized};
+        for (qint64 written = 0; written < size; written += chunk.size())
+        {
+            generator.fillRange(reinterpret_cast<quint32 *>(chunk.data()), (chunk.size() / sizeof(quint32)));
+            const qint64 chunkSize = std::min<qint64>(chunk.size(), (size - written));
+            if (file.write(chunk.constData(), chunkSize) != chunkSize)
+                return false;
+        }
+        return true;
+    }
+
+    struct CreationResult
+    {
+        BitTorrent::InfoHash infoHash;
+        QList<int> progress;
+        qint64 throughput = 0;
+        QString error;
+    };
+
+    CreationResult createTorrent(const Path &sourcePath, const Path &torrentFilePath, const TorrentCreatorLimits &limits)
+    {
+        const TorrentCreatorParams params
+        {
+            .pieceSize = PIECE_SIZE,
+            .sourcePath = sourcePath,
+            .torrentFilePath = torrentFilePath
+        };
+
+        CreationResult result;
+        TorrentCreator creator {params};
+        creator.setAutoDelete(false);
+        creator.setLimits(limits);
+        QObject::connect(&creator, &TorrentCreator::progressUpdated, &creator, [&result](const int progress)
+        {
+            result.progress.append(progress);
+        });
+        QObject::connect(&creator, &TorrentCreator::throughputUpdated, &creator, [&result](const qint64 bytesPerSecond)
+        {
+            result.throughput = bytesPerSecond;
+        });
+        QObject::connect(&creator, &TorrentCreator::creationFailure, &creator, [&result](const QString &msg)
+        {
+            result.error = msg;
+        });
+        creator.run();
+
+        if (result.error.isEmpty())
+        {
+            if (const auto descriptor = BitTorrent::TorrentDescriptor::loadFromFile(torrentFilePath))
+                result.infoHash = descriptor.value().infoHash();
+            else
+                result.error = descriptor.error();
+        }
+        return result;
+    }
+}
+
+class TestBitTorrentTorrentCreator final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBitTorrentTorrentCreator)
+
+public:
+    TestBitTorrentTorrentCreator() = default;
+
+private slots:
+    void testHashingThreads() const
+    {
+        const QTemporaryDir tmpDir;
+        const QString contentPath = tmpDir.filePath(u"content"_s);
+        QVERIFY(QDir().mkpath(contentPath));
+        // sizes not aligned to piece size so that pieces span file boundaries
+        QVERIFY(writeRandomFile((contentPath + u"/a.bin"), (3 * PIECE_SIZE + 1000), 1));
+        QVERIFY(writeRandomFile((contentPath + u"/b.bin"), 12345, 2));
+        QVERIFY(writeRandomFile((contentPath + u"/c.bin"), (5 * PIECE_SIZE), 3));
+
+        const CreationResult singleThreaded = createTorrent(Path(contentPath)
+                , Path(tmpDir.filePath(u"single.torrent"_s)), {.hashingThreads = 1});
+        QVERIFY2(singleThreaded.error.isEmpty(), qUtf8Printable(singleThreaded.error));
+        QVERIFY(singleThreaded.infoHash.isValid());
+
+        for (const int threads : {2, 4, 8})
+        {
+            const CreationResult multiThreaded = createTorrent(Path(contentPath)
+                    , Path(tmpDir.filePath(u"multi%1.torrent"_s.arg(threads))), {.hashingThreads = threads});
+            QVERIFY2(multiThreaded.error.isEmpty(), qUtf8Printable(multiThreaded.error));
+            QCOMPARE(multiThreaded.infoHash, singleThreaded.infoHash);
+        }
+    }
+
+    void testProgress() const
+    {
+        const QTemporaryDir tmpDir;
+        const QString filePath = tmpDir.filePath(u"file.bin"_s);
+        QVERIFY(writeRandomFile(filePath, (16 * PIECE_SIZE), 4));
+
+        const CreationResult result = createTorrent(Path(filePath), Path(tmpDir.filePath(u"file.torrent"_s)), {.hashingThreads = 4});
+        QVERIFY2(result.error.isEmpty(), qUtf8Printable(result.error));
+        QVERIFY(!result.progress.isEmpty());
+        QCOMPARE(result.progress.first(), 0);
+        QCOMPARE(result.progress.last(), 100);
+        QVERIFY(std::is_sorted(result.progress.cbegin(), result.progress.cend()));
+        QVERIFY(result.throughput > 0);
+    }
+
+    void testMaxReadRate() const
+    {
+        const QTemporaryDir tmpDir;
+        const QString filePath = tmpDir.filePath(u"file.bin"_s);
+        QVERIFY(writeRandomFile(filePath, (8 * PIECE_SIZE), 5));
+
+        // 2 MiB at 4 MiB/s can't take less than half a second
+        QElapsedTimer timer;
+        timer.start();
+        const CreationResult result = createTorrent(Path(filePath), Path(tmpDir.filePath(u"file.torrent"_s))
+                , {.hashingThreads = 1, .maxReadRate = (4 * 1024 * 1024)});
+        QVERIFY2(result.error.isEmpty(), qUtf8Printable(result.error));
+        QVERIFY(timer.elapsed() >= 450);
+        QVERIFY(result.throughput <= (5 * 1024 * 1024));
+    }
+
+    void benchmarkHashing_data() const
+    {
+        QTest::addColumn<int>("threads");
+
+        QTest::newRow("1 thread") << 1;
+        QTest::newRow("CPU cores") << 0;
+    }
+
+    void benchmarkHashing() const
+    {
+        QFETCH(const int, threads);
+
+        const QTemporaryDir tmpDir;
+        const QString filePath = tmpDir.filePath(u"file.bin"_s);
+        QVERIFY(writeRandomFile(filePath, (64 * 1024 * 1024), 6));
+
+        CreationResult result;
+        QBENCHMARK
+        {
+            result = createTorrent(Path(filePath), Path(tmpDir.filePath(u"file.torrent"_s)), {.hashingThreads = threads});
+        }
+        QVERIFY2(result.error.isEmpty(), qUtf8Printable(result.error));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBitTorrentTorrentCreator)
+#include "testbittorrenttorrentcreator.moc"
@@ -0,0 +1,213 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/torrentfilterindex.h"
+#include "base/global.h"
+#include "base/tag.h"
+#include "base/torrentfilter.h"
+
+using BitTorrent::TorrentFilterIndex;
+using BitTorrent::TorrentID;
+using BitTorrent::TorrentState;
+
+namespace
+{
+    const TorrentID TORRENT1 = TorrentID::fromString(u"0123456789abcdef0123456789abcdef01234567"_s);
+    const TorrentID TORRENT2 = TorrentID::fromString(u"89abcdef0123456789abcdef0123456789abcdef"_s);
+    const TorrentID TORRENT3 = TorrentID::fromString(u"fedcba9876543210fedcba9876543210fedcba98"_s);
+
+    TorrentFilterIndex::TorrentKeys keys(const QString &category, const TagSet &tags, const QStringList &trackerHosts
+            , const TorrentState state, const bool isPrivate = false)
+    {
+        return {.category = category, .tags = tags, .trackerHosts = trackerHosts, .state = state, .isPrivate = isPrivate};
+    }
+}
+
+class TestBitTorrentTorrentFilterIndex final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBitTorrentTorrentFilterIndex)
+
+public:
+    TestBitTorrentTorrentFilterIndex() = default;
+
+private slots:
+    void testCandidates() const
+    {
+        TorrentFilterIndex index;
+        index.addTorrent(TORRENT1, keys(u"movies"_s, {Tag(u"hd"_s)}, {u"tracker.example.com"_s}, TorrentState::Downloading));
+        index.addTorrent(TORRENT2, keys(u"movies/old"_s, {}, {}, TorrentState::StalledUploading, true));
+        index.addTorrent(TORRENT3, keys({}, {Tag(u"hd"_s), Tag(u"new"_s)}, {u"tracker.example.com"_s, u"other.example.org"_s}
+                , TorrentState::Error));
+        QCOMPARE(index.torrentsCount(), 3);
+
+        QVERIFY(!index.candidates(TorrentFilter()));
+        QVERIFY(!index.candidates(TorrentFilter(TorrentFilter::Active)));
+
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, u"movies"_s)), TorrentIDSet({TORRENT1, TORRENT2}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, u"movies/old"_s)), TorrentIDSet({TORRENT2}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, u"mov"_s)), TorrentIDSet());
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, QString())), TorrentIDSet({TORRENT3}));
+
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, Tag(u"hd"_s))), TorrentIDSet({TORRENT1, TORRENT3}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, Tag())), TorrentIDSet({TORRENT2}));
+
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, {}, true)), TorrentIDSet({TORRENT2}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, {}, false)), TorrentIDSet({TORRENT1, TORRENT3}));
+
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, {}, {}, u"tracker.example.com"_s))
+                , TorrentIDSet({TORRENT1, TORRENT3}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, {}, {}, QString())), TorrentIDSet({TORRENT2}));
+
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Downloading)), TorrentIDSet({TORRENT1}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Completed)), TorrentIDSet({TORRENT2}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Errored)), TorrentIDSet({TORRENT3}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Checking)), TorrentIDSet());
+
+        // Conditions are intersected
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, TorrentIDSet({TORRENT1, TORRENT2}), {}, Tag(u"hd"_s)))
+                , TorrentIDSet({TORRENT1}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Errored, {}, {}, Tag(u"new"_s), false, u"other.example.org"_s))
+                , TorrentIDSet({TORRENT3}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Downloading, {}, u"movies"_s, {}, true)), TorrentIDSet());
+    }
+
+    void testUpdates() const
+    {
+        TorrentFilterIndex index;
+        index.addTorrent(TORRENT1, keys(u"movies"_s, {}, {}, TorrentState::Downloading));
+        index.addTorrent(TORRENT2, keys(u"movies"_s, {}, {}, TorrentState::Downloading));
+
+        index.setTorrentCategory(TORRENT1, u"music"_s);
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, u"movies"_s)), TorrentIDSet({TORRENT2}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, u"music"_s)), TorrentIDSet({TORRENT1}));
+
+        index.setTorrentTags(TORRENT1, {Tag(u"hd"_s)});
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, Tag(u"hd"_s))), TorrentIDSet({TORRENT1}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, Tag())), TorrentIDSet({TORRENT2}));
+        index.setTorrentTags(TORRENT1, {});
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, Tag(u"hd"_s))), TorrentIDSet());
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, Tag())), TorrentIDSet({TORRENT1, TORRENT2}));
+
+        index.setTorrentTrackers(TORRENT2, {u"tracker.example.com"_s, u"tracker.example.com"_s});
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, {}, {}, u"tracker.example.com"_s))
+                , TorrentIDSet({TORRENT2}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, {}, {}, QString())), TorrentIDSet({TORRENT1}));
+
+        index.setTorrentState(TORRENT2, TorrentState::StalledUploading);
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Downloading)), TorrentIDSet({TORRENT1}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Stalled)), TorrentIDSet({TORRENT2}));
+
+        index.setTorrentPrivate(TORRENT1, true);
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, {}, true)), TorrentIDSet({TORRENT1}));
+
+        // Unknown torrents are ignored
+        index.setTorrentCategory(TORRENT3, u"movies"_s);
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, u"movies"_s)), TorrentIDSet({TORRENT2}));
+
+        index.removeTorrent(TORRENT2);
+        QCOMPARE(index.torrentsCount(), 1);
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, u"movies"_s)), TorrentIDSet());
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Stalled)), TorrentIDSet());
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::All, {}, {}, Tag())), TorrentIDSet({TORRENT1}));
+    }
+
+    void testStatusStates() const
+    {
+        TorrentFilterIndex index;
+        index.addTorrent(TORRENT1, keys({}, {}, {}, TorrentState::Moving));
+        index.addTorrent(TORRENT2, keys({}, {}, {}, TorrentState::CheckingResumeData));
+        index.addTorrent(TORRENT3, keys({}, {}, {}, TorrentState::StoppedUploading));
+
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Moving)), TorrentIDSet({TORRENT1}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Checking)), TorrentIDSet({TORRENT2}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Completed)), TorrentIDSet({TORRENT3}));
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Seeding)), TorrentIDSet());
+        QVERIFY(!index.candidates(TorrentFilter(TorrentFilter::Stopped)));
+
+        // Moving torrent is indexed by its new state once the move is finished
+        index.setTorrentState(TORRENT1, TorrentState::StoppedDownloading);
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Moving)), TorrentIDSet());
+        QCOMPARE(index.candidates(TorrentFilter(TorrentFilter::Downloading)), TorrentIDSet({TORRENT1}));
+    }
+
+    void testOrderedCandidates() const
+    {
+        TorrentFilterIndex index;
+        index.addTorrent(TORRENT3, keys(u"movies"_s, {}, {}, TorrentState::Downloading));
+        index.addTorrent(TORRENT1, keys(u"movies"_s, {}, {}, TorrentState::Downloading));
+        index.addTorrent(TORRENT2, keys(u"movies"_s, {}, {}, TorrentState::Downloading));
+
+        const TorrentFilter filter {TorrentFilter::All, {}, u"movies"_s};
+        QCOMPARE(index.orderedCandidates(filter), QList<TorrentID>({TORRENT3, TORRENT1, TORRENT2}));
+
+        // Re-added torrent goes last
+        index.removeTorrent(TORRENT3);
+        index.addTorrent(TORRENT3, keys(u"movies"_s, {}, {}, TorrentState::Downloading));
+        QCOMPARE(index.orderedCandidates(filter), QList<TorrentID>({TORRENT1, TORRENT2, TORRENT3}));
+
+        // Unknown torrents in the ID set are dropped
+        const TorrentID unknownID = TorrentID::fromString(u"0000000000000000000000000000000000000001"_s);
+        QCOMPARE(index.orderedCandidates(TorrentFilter(TorrentFilter::All, TorrentIDSet({TORRENT2, unknownID})))
+                , QList<TorrentID>({TORRENT2}));
+
+        QVERIFY(!index.orderedCandidates(TorrentFilter()));
+    }
+
+    void benchmarkCandidates() const
+    {
+        const int torrentsCount = 50'000;
+
+        TorrentFilterIndex index;
+        TorrentID targetID;
+        for (int i = 0; i < torrentsCount; ++i)
+        {
+            const QByteArray hash = QByteArray::number(i).rightJustified(40, '0');
+            const TorrentID id = TorrentID::fromString(QString::fromLatin1(hash));
+            const QString category = (i % 1000) ? u"category%1"_s.arg(i % 100) : u"rare"_s;
+            index.addTorrent(id, keys(category, {}, {u"tracker%1.example.com"_s.arg(i % 10)}
+                    , ((i % 2) ? TorrentState::Uploading : TorrentState::Downloading)));
+        }
+
+        const TorrentFilter filter {TorrentFilter::Downloading, {}, u"rare"_s, {}, {}, u"tracker0.example.com"_s};
+        std::optional<TorrentIDSet> candidates;
+        QBENCHMARK
+        {
+            candidates = index.candidates(filter);
+        }
+        QVERIFY(candidates);
+        QCOMPARE(candidates->size(), (torrentsCount / 1000));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBitTorrentTorrentFilterIndex)
+#include "testbittorrenttorrentfilterindex.moc"
@@ -0,0 +1,89 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QHostAddress>
+#include <QObject>
+#include <QTest>
+
+#include "base/bittorrent/tracker.h"
+#include "base/global.h"
+#include "base/http/environment.h"
+#include "base/http/irequesthandler.h"
+#include "base/http/requestparser.h"
+
+namespace
+{
+    // Not valid UTF-8, so it only survives parsing if query values are kept as raw bytes
+    const QByteArray INFO_HASH = QByteArray::fromHex("00ff80c3289f0102030405060708090a0b0c0dfe");
+
+    Http::Response announce(Http::IRequestHandler &tracker, const QByteArray &peerID, const quint16 port, const QHostAddress &clientAddress)
+    {
+        const QByteArray data = "GET /announce?info_hash=" + INFO_HASH.toPercentEncoding()
+            + "&peer_id=" + peerID.toPercentEncoding() + "&port=" + QByteArray::number(port)
+            + "&left=100&compact=1 HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+        const Http::RequestParser::ParseResult result = Http::RequestParser::parse(data);
+        if (result.status != Http::RequestParser::ParseStatus::OK)
+            return {};
+
+        return tracker.processRequest(result.request, {.clientAddress = clientAddress, .clientPort = port});
+    }
+}
+
+class TestBitTorrentTracker final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBitTorrentTracker)
+
+public:
+    TestBitTorrentTracker() = default;
+
+private slots:
+    void testBinaryInfoHash() const
+    {
+        BitTorrent::Tracker tracker;
+
+        // peer_id is binary as well
+        const QByteArray peerID1 = QByteArray::fromHex("2d71423530353030ff80fe0102030405060708ff");
+        const Http::Response response1 = announce(tracker, peerID1, 6881, QHostAddress(u"192.0.2.1"_s));
+        QCOMPARE(response1.status.code, 200);
+        QVERIFY(!response1.content.contains("failure reason"));
+        QVERIFY(response1.content.contains("10:incompletei1e"));
+
+        const QByteArray peerID2 = QByteArray::fromHex("2d71423530353030000102030405060708090a0b");
+        const Http::Response response2 = announce(tracker, peerID2, 6882, QHostAddress(u"192.0.2.2"_s));
+        QCOMPARE(response2.status.code, 200);
+        QVERIFY(!response2.content.contains("failure reason"));
+        QVERIFY(response2.content.contains("10:incompletei2e"));
+        // compact endpoint of the first peer: 192.0.2.1:6881
+        QVERIFY(response2.content.contains(QByteArray("5:peers6:\xc0\x00\x02\x01\x1a\xe1", 15)));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestBitTorrentTracker)
+#include "testbittorrenttracker.moc"
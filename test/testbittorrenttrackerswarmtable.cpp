@@ -0,0 +1,257 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include <QtEndian>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSet>
+#include <QTest>
+
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/trackerswarmtable.h"
+#include "base/global.h"
+#include "bittorrenttesthelpers.h"
+
+using namespace std::chrono_literals;
+using TestHelpers::makeTorrentID;
+
+namespace
+{
+    const std::chrono::seconds PEER_TTL = 1h;
+
+    BitTorrent::Peer makePeer(const quint32 index, const bool isSeeder = false)
+    {
+        const quint32 ipv4 = 0x0A000000 + index;  // 10.0.0.0/8
+        const ushort port = 6881;
+
+        char endpoint[6];
+        qToBigEndian(ipv4, endpoint);
+        qToBigEndian(port, (endpoint + 4));
+
+        BitTorrent::Peer peer;
+        peer.peerId = QByteArray::number(index).rightJustified(20, '-');
+        peer.port = port;
+        peer.isSeeder = isSeeder;
+        peer.address = u"10.%1.%2.%3"_s.arg(((ipv4 >> 16) & 0xFF)).arg(((ipv4 >> 8) & 0xFF)).arg((ipv4 & 0xFF)).toStdString();
+        peer.endpoint = {endpoint, sizeof(endpoint)};
+        return peer;
+    }
+}
+
+class TestBittorrentTrackerSwarmTable final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBittorrentTrackerSwarmTable)
+
+public:
+    TestBittorrentTrackerSwarmTable() = default;
+
+private slots:
+    void testAnnounce() const
+    {
+        BitTorrent::TrackerSwarmTable swarms {10, 10, PEER_TTL};
+        const BitTorrent::TorrentID id = makeTorrentID(0);
+
+        const auto result1 = swarms.announce(id, makePeer(1), BitTorrent::TrackerAnnounceEvent::Started, 50);
+        QVERIFY(result1);
+        QVERIFY(result1->peers.empty());
+        QCOMPARE(result1->stats.leechers, 1);
+        QCOMPARE(result1->stats.seeders, 0);
+
+        QVERIFY(swarms.announce(id, makePeer(2, true), BitTorrent::TrackerAnnounceEvent::Started, 50));
+        const auto result3 = swarms.announce(id, makePeer(3), BitTorrent::TrackerAnnounceEvent::Started, 50);
+        QVERIFY(result3);
+        QCOMPARE(std::ssize(result3->peers), 2);
+        QCOMPARE(result3->stats.leechers, 2);
+        QCOMPARE(result3->stats.seeders, 1);
+        for (const BitTorrent::Peer &peer : result3->peers)
+            QCOMPARE_NE(peer.uniqueID(), makePeer(3).uniqueID());
+
+        // re-announce replaces the peer
+        const auto result4 = swarms.announce(id, makePeer(3, true), BitTorrent::TrackerAnnounceEvent::Completed, 1);
+        QVERIFY(result4);
+        QCOMPARE(std::ssize(result4->peers), 1);
+        QCOMPARE(result4->stats.leechers, 1);
+        QCOMPARE(result4->stats.seeders, 2);
+        QCOMPARE(result4->stats.completed, 1);
+
+        const BitTorrent::TrackerSwarmStats stats = swarms.scrape(id);
+        QCOMPARE(stats.leechers, 1);
+        QCOMPARE(stats.seeders, 2);
+        QCOMPARE(stats.completed, 1);
+        QCOMPARE(swarms.scrape(makeTorrentID(1)).seeders, 0);
+    }
+
+    void testStopped() const
+    {
+        BitTorrent::TrackerSwarmTable swarms {10, 10, PEER_TTL};
+        const BitTorrent::TorrentID id = makeTorrentID(0);
+
+        QVERIFY(swarms.announce(id, makePeer(1), BitTorrent::TrackerAnnounceEvent::Started, 50));
+        QVERIFY(swarms.announce(id, makePeer(2), BitTorrent::TrackerAnnounceEvent::Started, 50));
+        QCOMPARE(swarms.torrentsCount(), 1);
+
+        const auto result = swarms.announce(id, makePeer(1), BitTorrent::TrackerAnnounceEvent::Stopped, 50);
+        QVERIFY(result);
+        QVERIFY(result->peers.empty());
+        QCOMPARE(result->stats.leechers, 1);
+
+        QVERIFY(swarms.announce(id, makePeer(2), BitTorrent::TrackerAnnounceEvent::Stopped, 50));
+        QCOMPARE(swarms.torrentsCount(), 0);
+    }
+
+    void testRandomSampling() const
+    {
+        const int peersCount = 100;
+        const int numWant = 10;
+
+        BitTorrent::TrackerSwarmTable swarms {10, peersCount, PEER_TTL};
+        const BitTorrent::TorrentID id = makeTorrentID(0);
+        for (int i = 0; i < peersCount; ++i)
+            QVERIFY(swarms.announce(id, makePeer(i), BitTorrent::TrackerAnnounceEvent::Started, 0));
+
+        QSet<QByteArray> returnedPeers;
+        for (int i = 0; i < 200; ++i)
+        {
+            const auto result = swarms.announce(id, makePeer(0), BitTorrent::TrackerAnnounceEvent::None, numWant);
+            QVERIFY(result);
+            QCOMPARE(std::ssize(result->peers), numWant);
+
+            QSet<QByteArray> samplePeers;
+            for (const BitTorrent::Peer &peer : result->peers)
+                samplePeers.insert(peer.uniqueID());
+            QCOMPARE(samplePeers.size(), numWant);
+            QVERIFY(!samplePeers.contains(makePeer(0).uniqueID()));
+
+            returnedPeers.unite(samplePeers);
+        }
+
+        // every other peer is eventually returned
+        QCOMPARE(returnedPeers.size(), (peersCount - 1));
+    }
+
+    void testExpiry() const
+    {
+        BitTorrent::TrackerSwarmTable swarms {10, 10, PEER_TTL};
+        const BitTorrent::TorrentID id = makeTorrentID(0);
+        const auto now = BitTorrent::TrackerSwarmTable::Clock::now();
+
+        QVERIFY(swarms.announce(id, makePeer(1), BitTorrent::TrackerAnnounceEvent::Started, 50, now));
+        QVERIFY(swarms.announce(id, makePeer(2), BitTorrent::TrackerAnnounceEvent::Started, 50, now));
+        QVERIFY(swarms.announce(id, makePeer(2), BitTorrent::TrackerAnnounceEvent::None, 50, (now + 30min)));
+
+        QCOMPARE(swarms.removeExpiredPeers(now + 59min), 0);
+        QCOMPARE(swarms.removeExpiredPeers(now + 1h), 1);
+        QCOMPARE(swarms.scrape(id).leechers, 1);
+
+        QCOMPARE(swarms.removeExpiredPeers(now + 90min), 1);
+        QCOMPARE(swarms.torrentsCount(), 0);
+    }
+
+    void testLimits() const
+    {
+        BitTorrent::TrackerSwarmTable swarms {2, 2, PEER_TTL};
+        const auto now = BitTorrent::TrackerSwarmTable::Clock::now();
+
+        QVERIFY(swarms.announce(makeTorrentID(0), makePeer(1), BitTorrent::TrackerAnnounceEvent::Started, 50));
+        QVERIFY(swarms.announce(makeTorrentID(1), makePeer(1), BitTorrent::TrackerAnnounceEvent::Started, 50));
+        QVERIFY(!swarms.announce(makeTorrentID(2), makePeer(1), BitTorrent::TrackerAnnounceEvent::Started, 50));
+        QCOMPARE(swarms.torrentsCount(), 2);
+
+        // the least recently announced peer is replaced when the swarm is full
+        const BitTorrent::TorrentID id = makeTorrentID(0);
+        QVERIFY(swarms.announce(id, makePeer(2), BitTorrent::TrackerAnnounceEvent::Started, 50, (now + 1min)));
+        QVERIFY(swarms.announce(id, makePeer(1), BitTorrent::TrackerAnnounceEvent::None, 50, (now + 2min)));
+        const auto result = swarms.announce(id, makePeer(3), BitTorrent::TrackerAnnounceEvent::Started, 50, (now + 3min));
+        QVERIFY(result);
+        QCOMPARE(result->stats.leechers, 2);
+        QCOMPARE(std::ssize(result->peers), 1);
+        QCOMPARE(result->peers.front().uniqueID(), makePeer(1).uniqueID());
+    }
+
+    // Load generator: measures sustained announce rate of a LAN sized tracker
+    void benchmarkAnnounces() const
+    {
+        const int torrentsCount = 30000;
+        const int peersCount = 1500;
+        const int announcesPerThread = 50000;
+        const int threadsCount = 4;
+
+        BitTorrent::TrackerSwarmTable swarms {torrentsCount, 500, PEER_TTL};
+
+        std::vector<BitTorrent::TorrentID> ids;
+        ids.reserve(torrentsCount);
+        for (int i = 0; i < torrentsCount; ++i)
+            ids.push_back(makeTorrentID(i));
+
+        std::vector<BitTorrent::Peer> peers;
+        peers.reserve(peersCount);
+        for (int i = 0; i < peersCount; ++i)
+            peers.push_back(makePeer(i, ((i % 4) == 0)));
+
+        std::atomic<int> failedCount = 0;
+        QElapsedTimer timer;
+        timer.start();
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadsCount; ++t)
+        {
+            threads.emplace_back([&swarms, &ids, &peers, &failedCount, t]
+            {
+                for (int i = 0; i < announcesPerThread; ++i)
+                {
+                    const int n = (t * announcesPerThread) + i;
+                    const BitTorrent::TorrentID &id = ids[(n * 7919) % torrentsCount];
+                    const BitTorrent::Peer &peer = peers[(n / 7) % peersCount];
+                    if (!swarms.announce(id, peer, BitTorrent::TrackerAnnounceEvent::None, 50))
+                        ++failedCount;
+                }
+            });
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+
+        const qint64 elapsed = std::max<qint64>(timer.elapsed(), 1);
+        QCOMPARE(failedCount.load(), 0);
+        QCOMPARE(swarms.torrentsCount(), torrentsCount);
+
+        const qint64 announcesCount = qint64 {threadsCount} * announcesPerThread;
+        qInfo("%lld announces in %lld ms using %d threads: %lld announces/s"
+                , announcesCount, elapsed, threadsCount, ((announcesCount * 1000) / elapsed));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBittorrentTrackerSwarmTable)
+#include "testbittorrenttrackerswarmtable.moc"
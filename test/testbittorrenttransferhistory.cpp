@@ -0,0 +1,254 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <memory>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "base/bittorrent/infohash.h"
+#include "base/bittorrent/transferhistory.h"
+#include "base/global.h"
+#include "base/path.h"
+
+using BitTorrent::TransferHistoryFile;
+using BitTorrent::TransferHistorySeries;
+
+namespace
+{
+    const qint64 BASE_TIME = 1700000000; // seconds since epoch
+
+    const QList<TransferHistorySeries::RingLayout> LAYOUT = {
+        {1, 10},
+        {60, 5}
+    };
+
+    qint64 msecs(const qint64 secs)
+    {
+        return secs * 1000;
+    }
+
+    // Opens file keeping a single series
+    std::unique_ptr<TransferHistoryFile> openSeriesFile(const Path &path, const QList<TransferHistorySeries::RingLayout> &layout = LAYOUT)
+    {
+        auto file = TransferHistoryFile::open(path, layout);
+        if (!file)
+            return nullptr;
+        if ((*file)->slotKey(0).isEmpty() && !(*file)->allocateSlots({QByteArrayLiteral("test")}))
+            return nullptr;
+        return std::move(file.value());
+    }
+}
+
+class TestBitTorrentTransferHistory final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestBitTorrentTransferHistory)
+
+public:
+    TestBitTorrentTransferHistory() = default;
+
+private slots:
+    void testAdd() const
+    {
+        const QTemporaryDir tmpDir;
+        const auto file = openSeriesFile(Path(tmpDir.filePath(u"test.history"_s)));
+        QVERIFY(file);
+        TransferHistorySeries series = file->series(0);
+
+        // 1.5 seconds of transfer is spread over two samples
+        series.add(msecs(BASE_TIME), (msecs(BASE_TIME) + 1500), 1500, 300);
+
+        const BitTorrent::TransferHistoryRange seconds = series.samples(1, BASE_TIME, (BASE_TIME + 2));
+        QCOMPARE(seconds.resolution, 1);
+        QCOMPARE(seconds.start, BASE_TIME);
+        QCOMPARE(seconds.samples.size(), 3);
+        QCOMPARE(seconds.samples[0].downloaded, 1000U);
+        QCOMPARE(seconds.samples[0].uploaded, 200U);
+        QCOMPARE(seconds.samples[1].downloaded, 500U);
+        QCOMPARE(seconds.samples[1].uploaded, 100U);
+        QCOMPARE(seconds.samples[2].downloaded, 0U);
+
+        const BitTorrent::TransferHistoryRange minutes = series.samples(60, BASE_TIME, BASE_TIME);
+        QCOMPARE(minutes.samples.size(), 1);
+        QCOMPARE(minutes.samples[0].downloaded, 1500U);
+        QCOMPARE(minutes.samples[0].uploaded, 300U);
+
+        QVERIFY(series.samples(3600, BASE_TIME, BASE_TIME).samples.isEmpty());
+    }
+
+    void testRingWrap() const
+    {
+        const QTemporaryDir tmpDir;
+        const auto file = openSeriesFile(Path(tmpDir.filePath(u"test.history"_s)));
+        QVERIFY(file);
+        TransferHistorySeries series = file->series(0);
+
+        for (qint64 i = 0; i < 15; ++i)
+            series.add(msecs(BASE_TIME + i), msecs(BASE_TIME + i + 1), (i + 1), 0);
+
+        // only the last 10 seconds are kept
+        const BitTorrent::TransferHistoryRange range = series.samples(1, BASE_TIME, (BASE_TIME + 14));
+        QCOMPARE(range.start, (BASE_TIME + 5));
+        QCOMPARE(range.samples.size(), 10);
+        for (qsizetype i = 0; i < range.samples.size(); ++i)
+            QCOMPARE(range.samples[i].downloaded, static_cast<quint64>(i + 6));
+
+        // a gap clears the samples in between
+        series.add(msecs(BASE_TIME + 20), msecs(BASE_TIME + 21), 100, 0);
+        const BitTorrent::TransferHistoryRange afterGap = series.samples(1, (BASE_TIME + 12), (BASE_TIME + 20));
+        QCOMPARE(afterGap.samples.size(), 9);
+        QCOMPARE(afterGap.samples[0].downloaded, 13U);
+        QCOMPARE(afterGap.samples[3].downloaded, 0U);
+        QCOMPARE(afterGap.samples[8].downloaded, 100U);
+    }
+
+    void testPersistence() const
+    {
+        const QTemporaryDir tmpDir;
+        const Path path {tmpDir.filePath(u"test.history"_s)};
+        {
+            const auto file = openSeriesFile(path);
+            QVERIFY(file);
+            file->series(0).add(msecs(BASE_TIME), msecs(BASE_TIME + 1), 42, 24);
+        }
+
+        {
+            const auto file = openSeriesFile(path);
+            QVERIFY(file);
+            QCOMPARE(file->slotKey(0), QByteArrayLiteral("test"));
+            const BitTorrent::TransferHistoryRange range = file->series(0).samples(1, BASE_TIME, BASE_TIME);
+            QCOMPARE(range.samples.size(), 1);
+            QCOMPARE(range.samples[0].downloaded, 42U);
+            QCOMPARE(range.samples[0].uploaded, 24U);
+        }
+
+        // history is reset when layout changes
+        const auto file = TransferHistoryFile::open(path, {{1, 20}});
+        QVERIFY(file);
+        QVERIFY((*file)->slotKey(0).isEmpty());
+    }
+
+    void testSlots() const
+    {
+        const QTemporaryDir tmpDir;
+        const Path path {tmpDir.filePath(u"test.history"_s)};
+        {
+            auto file = TransferHistoryFile::open(path, LAYOUT, 2);
+            QVERIFY(file);
+            QCOMPARE((*file)->slotCount(), 2);
+
+            // the file is grown once there are no free slots left
+            const auto allocatedSlots = (*file)->allocateSlots({QByteArrayLiteral("a"), QByteArrayLiteral("b"), QByteArrayLiteral("c")});
+            QVERIFY(allocatedSlots);
+            QCOMPARE(*allocatedSlots, QList<int>({0, 1, 2}));
+            QCOMPARE((*file)->slotCount(), 4);
+
+            // series of different slots don't overlap
+            (*file)->series(0).add(msecs(BASE_TIME), msecs(BASE_TIME + 1), 10, 0);
+            (*file)->series(2).add(msecs(BASE_TIME), msecs(BASE_TIME + 1), 30, 0);
+            (*file)->freeSlot(1);
+        }
+
+        auto file = TransferHistoryFile::open(path, LAYOUT, 2);
+        QVERIFY(file);
+        QCOMPARE((*file)->slotCount(), 4);
+        QCOMPARE((*file)->slotKey(0), QByteArrayLiteral("a"));
+        QVERIFY((*file)->slotKey(1).isEmpty());
+        QCOMPARE((*file)->slotKey(2), QByteArrayLiteral("c"));
+        QCOMPARE((*file)->series(0).samples(1, BASE_TIME, BASE_TIME).samples[0].downloaded, 10U);
+        QCOMPARE((*file)->series(2).samples(1, BASE_TIME, BASE_TIME).samples[0].downloaded, 30U);
+
+        // the lowest free slot is reused and its series is cleared
+        const auto allocatedSlots = (*file)->allocateSlots({QByteArrayLiteral("d")});
+        QVERIFY(allocatedSlots);
+        QCOMPARE(*allocatedSlots, QList<int>({1}));
+        QCOMPARE((*file)->series(1).samples(1, BASE_TIME, BASE_TIME).samples[0].downloaded, 0U);
+    }
+
+    void testTorrentCounters() const
+    {
+        const QTemporaryDir tmpDir;
+        BitTorrent::TransferHistory history {Path(tmpDir.path())};
+        const auto id = BitTorrent::TorrentID::fromString(u"0123456789abcdef0123456789abcdef01234567"_s);
+
+        // the first update only sets the baseline
+        history.updateTorrentTransfer(id, u"movies"_s, 1000000, 500);
+        history.updateTorrentTransfer(id, u"movies"_s, 1000100, 520);
+
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        const auto sumOf = [](const BitTorrent::TransferHistoryRange &range)
+        {
+            quint64 downloaded = 0;
+            for (const BitTorrent::TransferHistorySample &sample : range.samples)
+                downloaded += sample.downloaded;
+            return downloaded;
+        };
+        QCOMPARE(sumOf(history.torrentHistory(id, BitTorrent::TransferHistory::MINUTE, (now - 120), now)), 100U);
+        QCOMPARE(sumOf(history.categoryHistory(u"movies"_s, BitTorrent::TransferHistory::MINUTE, (now - 120), now)), 100U);
+        QVERIFY(history.torrentHistory(id, BitTorrent::TransferHistory::SECOND, (now - 120), now).samples.isEmpty());
+
+        history.removeTorrent(id);
+        QVERIFY(history.torrentHistory(id, BitTorrent::TransferHistory::MINUTE, (now - 120), now).samples.isEmpty());
+    }
+
+    void testTorrentsFile() const
+    {
+        const QTemporaryDir tmpDir;
+        const auto id1 = BitTorrent::TorrentID::fromString(u"0123456789abcdef0123456789abcdef01234567"_s);
+        const auto id2 = BitTorrent::TorrentID::fromString(u"89abcdef0123456789abcdef0123456789abcdef"_s);
+        {
+            BitTorrent::TransferHistory history {Path(tmpDir.path())};
+            history.addTorrents({id1, id2});
+            history.updateTorrentTransfer(id2, {}, 0, 0);
+            history.updateTorrentTransfer(id2, {}, 100, 0);
+        }
+
+        // all the torrents share a single file
+        QVERIFY(Path(tmpDir.filePath(u"torrents.history"_s)).exists());
+
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        const auto sumOf = [](const BitTorrent::TransferHistoryRange &range)
+        {
+            quint64 downloaded = 0;
+            for (const BitTorrent::TransferHistorySample &sample : range.samples)
+                downloaded += sample.downloaded;
+            return downloaded;
+        };
+        BitTorrent::TransferHistory history {Path(tmpDir.path())};
+        QCOMPARE(sumOf(history.torrentHistory(id2, BitTorrent::TransferHistory::MINUTE, (now - 120), now)), 100U);
+        QCOMPARE(sumOf(history.torrentHistory(id1, BitTorrent::TransferHistory::MINUTE, (now - 120), now)), 0U);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestBitTorrentTransferHistory)
+#include "testbittorrenttransferhistory.moc"
@@ -0,0 +1,303 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+#include <QAbstractTableModel>
+#include <QDateTime>
+#include <QModelIndex>
+#include <QObject>
+#include <QSortFilterProxyModel>
+#include <QTest>
+#include <QVariant>
+
+#include "base/global.h"
+#include "base/tag.h"
+#include "base/tagset.h"
+#include "base/utils/compare.h"
+#include "gui/transferlistmodel.h"
+#include "gui/transferlistsortkeys.h"
+
+namespace
+{
+    const int BENCHMARK_ROWS = 50'000;
+
+    TransferListSortKeys makeKeys(const int column, const QVariantList &values, const QVariantList &additionalValues = {})
+    {
+        TransferListSortKeys keys {column};
+        keys.insertRows(0, values.size());
+        for (qsizetype row = 0; row < values.size(); ++row)
+            keys.setKey(row, values[row], additionalValues.value(row));
+        return keys;
+    }
+
+    std::vector<int> sortedRows(const TransferListSortKeys &keys)
+    {
+        std::vector<int> rows(static_cast<std::size_t>(keys.size()));
+        std::iota(rows.begin(), rows.end(), 0);
+        std::ranges::stable_sort(rows, [&keys](const int left, const int right)
+        {
+            return keys.compare(left, right) < 0;
+        });
+        return rows;
+    }
+
+    QVariantList benchmarkNames()
+    {
+        QVariantList names;
+        names.reserve(BENCHMARK_ROWS);
+        for (int i = 0; i < BENCHMARK_ROWS; ++i)
+            names.append(u"Some.Torrent.Name.S%1E%2.1080p"_s.arg(((i * 7919) % 97), ((i * 104729) % BENCHMARK_ROWS)));
+        return names;
+    }
+
+    // Provides UnderlyingDataRole values the way TransferListModel does:
+    // the row's torrent is looked up and the column value is wrapped in QVariant on every call
+    class BenchmarkTransferListModel final : public QAbstractTableModel
+    {
+    public:
+        struct Torrent
+        {
+            QString name;
+        };
+
+        explicit BenchmarkTransferListModel(const QVariantList &names)
+        {
+            m_torrents.reserve(names.size());
+            for (const QVariant &name : names)
+                m_torrents.append({.name = name.toString()});
+        }
+
+        int rowCount(const QModelIndex &parent = {}) const override
+        {
+            return parent.isValid() ? 0 : static_cast<int>(m_torrents.size());
+        }
+
+        int columnCount(const QModelIndex &parent = {}) const override
+        {
+            return parent.isValid() ? 0 : TransferListModel::NB_COLUMNS;
+        }
+
+        QVariant data(const QModelIndex &index, const int role) const override
+        {
+            if (!index.isValid() || (role != TransferListModel::UnderlyingDataRole))
+                return {};
+
+            const Torrent &torrent = m_torrents[index.row()];
+            switch (index.column())
+            {
+            case TransferListModel::TR_NAME:
+                return torrent.name;
+            default:
+                return {};
+            }
+        }
+
+    private:
+        QList<Torrent> m_torrents;
+    };
+
+    // Compares UnderlyingDataRole values of both indexes in each call like TransferListSortModel did before caching the keys
+    class VariantSortProxyModel final : public QSortFilterProxyModel
+    {
+        bool lessThan(const QModelIndex &left, const QModelIndex &right) const override
+        {
+            const int result = compare(left, right);
+            if (result == 0)
+                return compare(left.sibling(left.row(), TransferListModel::TR_NAME), right.sibling(right.row(), TransferListModel::TR_NAME)) < 0;
+            return result < 0;
+        }
+
+        int compare(const QModelIndex &left, const QModelIndex &right) const
+        {
+            const QVariant leftValue = left.data(TransferListModel::UnderlyingDataRole);
+            const QVariant rightValue = right.data(TransferListModel::UnderlyingDataRole);
+            return m_naturalCompare(leftValue.toString(), rightValue.toString());
+        }
+
+        Utils::Compare::NaturalCompare<Qt::CaseInsensitive> m_naturalCompare;
+    };
+
+    // Compares keys built on first use like TransferListSortModel does
+    class SortKeysProxyModel final : public QSortFilterProxyModel
+    {
+        bool lessThan(const QModelIndex &left, const QModelIndex &right) const override
+        {
+            const int result = compare(left, right);
+            if (result == 0)
+                return compare(left.sibling(left.row(), TransferListModel::TR_NAME), right.sibling(right.row(), TransferListModel::TR_NAME)) < 0;
+            return result < 0;
+        }
+
+        int compare(const QModelIndex &left, const QModelIndex &right) const
+        {
+            const int rowCount = sourceModel()->rowCount();
+            if (!m_keys || (m_keys->column() != left.column()) || (m_keys->size() != rowCount))
+            {
+                m_keys.emplace(left.column());
+                m_keys->insertRows(0, rowCount);
+                for (int row = 0; row < rowCount; ++row)
+                    m_keys->setKey(row, sourceModel()->index(row, left.column()).data(TransferListModel::UnderlyingDataRole));
+            }
+
+            return m_keys->compare(left.row(), right.row());
+        }
+
+        mutable std::optional<TransferListSortKeys> m_keys;
+    };
+}
+
+class TestGuiTransferListSortKeys final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestGuiTransferListSortKeys)
+
+public:
+    TestGuiTransferListSortKeys() = default;
+
+private slots:
+    void testNaturalString() const
+    {
+        const TransferListSortKeys keys = makeKeys(TransferListModel::TR_NAME, {u"file10"_s, u"File2"_s, u"file1"_s});
+        QCOMPARE(sortedRows(keys), std::vector<int>({2, 1, 0}));
+    }
+
+    void testOptionalNumbers() const
+    {
+        const TransferListSortKeys sizes = makeKeys(TransferListModel::TR_ETA, {qint64 {100}, qint64 {-1}, qint64 {5}, qint64 {-1}});
+        QCOMPARE(sortedRows(sizes), std::vector<int>({2, 0, 1, 3}));
+        QCOMPARE(sizes.compare(1, 3), 0);
+
+        const TransferListSortKeys ratios = makeKeys(TransferListModel::TR_RATIO, {1.5, -1.0, 0.25});
+        QCOMPARE(sortedRows(ratios), std::vector<int>({2, 0, 1}));
+    }
+
+    void testDates() const
+    {
+        const QDateTime date = QDateTime::fromSecsSinceEpoch(1'000'000'000);
+        const TransferListSortKeys keys = makeKeys(TransferListModel::TR_ADD_DATE, {QDateTime(), date.addDays(1), date});
+        QCOMPARE(sortedRows(keys), std::vector<int>({2, 1, 0}));
+    }
+
+    void testPrivate() const
+    {
+        const TransferListSortKeys keys = makeKeys(TransferListModel::TR_PRIVATE, {QVariant(), true, false});
+        QCOMPARE(sortedRows(keys), std::vector<int>({2, 1, 0}));
+    }
+
+    void testPeers() const
+    {
+        // Active peers take precedence over total peers
+        const TransferListSortKeys keys = makeKeys(TransferListModel::TR_PEERS, {2, 1, 1}, {3, 50, 10});
+        QCOMPARE(sortedRows(keys), std::vector<int>({2, 1, 0}));
+    }
+
+    void testTags() const
+    {
+        const TransferListSortKeys keys = makeKeys(TransferListModel::TR_TAGS
+                , {QVariant::fromValue(TagSet {Tag(u"b"_s)}), QVariant::fromValue(TagSet {Tag(u"a"_s), Tag(u"c"_s)})
+                , QVariant::fromValue(TagSet {Tag(u"a"_s)})});
+        QCOMPARE(sortedRows(keys), std::vector<int>({2, 1, 0}));
+    }
+
+    void testRowChanges() const
+    {
+        TransferListSortKeys keys = makeKeys(TransferListModel::TR_SIZE, {qint64 {30}, qint64 {10}});
+
+        keys.insertRows(1, 2);
+        QCOMPARE(keys.size(), 4);
+        keys.setKey(1, qint64 {20});
+        keys.setKey(2, qint64 {40});
+        QCOMPARE(sortedRows(keys), std::vector<int>({3, 1, 0, 2}));
+
+        keys.removeRows(0, 2);
+        QCOMPARE(keys.size(), 2);
+        QCOMPARE(sortedRows(keys), std::vector<int>({1, 0}));
+
+        keys.setKey(1, qint64 {50});
+        QCOMPARE(sortedRows(keys), std::vector<int>({0, 1}));
+    }
+
+    void benchmarkSortByName_data() const
+    {
+        QTest::addColumn<bool>("isBaseline");
+
+        QTest::newRow("QVariant data per comparison") << true;
+        QTest::newRow("cached sort keys") << false;
+    }
+
+    void benchmarkSortByName() const
+    {
+        QFETCH(const bool, isBaseline);
+
+        BenchmarkTransferListModel model {benchmarkNames()};
+        const std::unique_ptr<QSortFilterProxyModel> proxyModel = isBaseline
+                ? std::unique_ptr<QSortFilterProxyModel>(std::make_unique<VariantSortProxyModel>())
+                : std::unique_ptr<QSortFilterProxyModel>(std::make_unique<SortKeysProxyModel>());
+        proxyModel->setSourceModel(&model);
+
+        QBENCHMARK
+        {
+            // the proxy model ignores a request for the current sort column and order
+            proxyModel->sort(-1);
+            proxyModel->sort(TransferListModel::TR_NAME);
+        }
+
+        QCOMPARE(proxyModel->rowCount(), BENCHMARK_ROWS);
+        const Utils::Compare::NaturalCompare<Qt::CaseInsensitive> naturalCompare;
+        for (int row = 1; row < proxyModel->rowCount(); ++row)
+        {
+            const QString previousName = proxyModel->index((row - 1), TransferListModel::TR_NAME).data(TransferListModel::UnderlyingDataRole).toString();
+            const QString name = proxyModel->index(row, TransferListModel::TR_NAME).data(TransferListModel::UnderlyingDataRole).toString();
+            QVERIFY(naturalCompare(previousName, name) <= 0);
+        }
+    }
+
+    void benchmarkSortBySize() const
+    {
+        QVariantList sizes;
+        sizes.reserve(BENCHMARK_ROWS);
+        for (int i = 0; i < BENCHMARK_ROWS; ++i)
+            sizes.append(static_cast<qint64>((i * 2654435761ULL) % 100'000'000'000ULL));
+        const TransferListSortKeys keys = makeKeys(TransferListModel::TR_SIZE, sizes);
+
+        std::vector<int> rows;
+        QBENCHMARK
+        {
+            rows = sortedRows(keys);
+        }
+        QVERIFY(std::ranges::is_sorted(rows, {}, [&sizes](const int row) { return sizes[row].toLongLong(); }));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestGuiTransferListSortKeys)
+#include "testguitransferlistsortkeys.moc"
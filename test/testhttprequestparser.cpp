@@ -0,0 +1,113 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QObject>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/http/requestparser.h"
+
+class TestHttpRequestParser final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestHttpRequestParser)
+
+public:
+    TestHttpRequestParser() = default;
+
+private slots:
+    void testGet() const
+    {
+        const QByteArray data = QByteArrayLiteral("GET /api/v2/torrents/info?filter=downloading&category=linux%20iso&tag=a+b HTTP/1.1\r\n"
+            "Host: localhost:8080\r\n"
+            "Accept-Encoding: gzip\r\n"
+            "X-Folded: first\r\n"
+            " second\r\n"
+            "\r\n");
+
+        const Http::RequestParser::ParseResult result = Http::RequestParser::parse(data);
+        QCOMPARE(result.status, Http::RequestParser::ParseStatus::OK);
+        QCOMPARE(result.frameSize, data.size());
+        QCOMPARE(result.request.method, u"GET"_s);
+        QCOMPARE(result.request.path, u"/api/v2/torrents/info"_s);
+        QCOMPARE(result.request.version, u"1.1"_s);
+        QCOMPARE(result.request.query.size(), 3);
+        QCOMPARE(result.request.query.value(u"filter"_s), "downloading");
+        QCOMPARE(result.request.query.value(u"category"_s), "linux iso");
+        QCOMPARE(result.request.query.value(u"tag"_s), "a b");
+        QCOMPARE(result.request.headers.value(u"host"_s), u"localhost:8080"_s);
+        QCOMPARE(result.request.headers.value(u"accept-encoding"_s), u"gzip"_s);
+        QCOMPARE(result.request.headers.value(u"x-folded"_s), u"first second"_s);
+    }
+
+    void testPost() const
+    {
+        const QByteArray data = QByteArrayLiteral("POST /api/v2/torrents/stop HTTP/1.1\r\n"
+            "Content-Type: application/x-www-form-urlencoded\r\n"
+            "Content-Length: 11\r\n"
+            "\r\n"
+            "hashes=all");
+
+        QCOMPARE(Http::RequestParser::parse(data).status, Http::RequestParser::ParseStatus::Incomplete);
+
+        const Http::RequestParser::ParseResult result = Http::RequestParser::parse(data + '&');
+        QCOMPARE(result.status, Http::RequestParser::ParseStatus::OK);
+        QCOMPARE(result.request.posts.value(u"hashes"_s), u"all"_s);
+    }
+
+    void testBadRequest() const
+    {
+        QCOMPARE(Http::RequestParser::parse(QByteArrayLiteral("GET /\r\n\r\n")).status, Http::RequestParser::ParseStatus::BadRequest);
+        QCOMPARE(Http::RequestParser::parse(QByteArrayLiteral("get / HTTP/1.1\r\n\r\n")).status, Http::RequestParser::ParseStatus::BadRequest);
+        QCOMPARE(Http::RequestParser::parse(QByteArrayLiteral("GET / HTTP/1.1\r\nHost\r\n\r\n")).status, Http::RequestParser::ParseStatus::BadRequest);
+    }
+
+    void benchmarkTrivialRequest() const
+    {
+        // request of "app/version" as sent by a browser
+        const QByteArray data = QByteArrayLiteral("GET /api/v2/app/version HTTP/1.1\r\n"
+            "Host: localhost:8080\r\n"
+            "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:140.0) Gecko/20100101 Firefox/140.0\r\n"
+            "Accept: */*\r\n"
+            "Accept-Language: en-US,en;q=0.5\r\n"
+            "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+            "Referer: http://localhost:8080/\r\n"
+            "Cookie: QBT_SID_8080=0123456789abcdef0123456789abcdef\r\n"
+            "Connection: keep-alive\r\n"
+            "\r\n");
+
+        QBENCHMARK
+        {
+            const Http::RequestParser::ParseResult result = Http::RequestParser::parse(data);
+            QCOMPARE(result.status, Http::RequestParser::ParseStatus::OK);
+        }
+    }
+};
+
+QTEST_APPLESS_MAIN(TestHttpRequestParser)
+#include "testhttprequestparser.moc"
@@ -0,0 +1,207 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+#include <QTcpSocket>
+#include <QTest>
+#include <QTimer>
+
+#include "base/global.h"
+#include "base/http/constants.h"
+#include "base/http/irequesthandler.h"
+#include "base/http/request.h"
+#include "base/http/response.h"
+#include "base/http/server.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    const QByteArray RESPONSE_CONTENT = QByteArrayLiteral("pong");
+    const QByteArray REQUEST = QByteArrayLiteral("GET /ping HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    // The response content is the only part of the response that is known in advance
+    const QByteArray RESPONSE_END = "\r\n\r\n" + RESPONSE_CONTENT;
+
+    const int BENCHMARK_REQUESTS_COUNT = 10'000;
+    const int LATENCY_CLIENTS_COUNT = 200;
+
+    class PingHandler final : public Http::IRequestHandler
+    {
+    public:
+        Http::Response processRequest(const Http::Request &request, [[maybe_unused]] const Http::Environment &env) override
+        {
+            if (request.path != u"/ping")
+                return {.status = {404, u"Not Found"_s}};
+
+            return {.status = {200, u"OK"_s}, .headers = {{Http::HEADER_CONTENT_TYPE, Http::CONTENT_TYPE_TXT}}
+                    , .content = RESPONSE_CONTENT};
+        }
+    };
+
+    // Each connection sends the requests one after another, the next one is sent once the previous one is answered.
+    // Returns the latencies of received responses in nanoseconds.
+    QList<qint64> sendRequests(const quint16 port, const int connectionsCount, const int requestsPerConnection)
+    {
+        QEventLoop eventLoop;
+        QList<qint64> latencies;
+        latencies.reserve(connectionsCount * requestsPerConnection);
+        int activeConnectionsCount = connectionsCount;
+
+        std::vector<std::unique_ptr<QTcpSocket>> sockets;
+        sockets.reserve(connectionsCount);
+        for (int i = 0; i < connectionsCount; ++i)
+        {
+            QTcpSocket *socket = sockets.emplace_back(std::make_unique<QTcpSocket>()).get();
+            auto receivedData = std::make_shared<QByteArray>();
+            auto sentRequestsCount = std::make_shared<int>(0);
+            auto requestTimer = std::make_shared<QElapsedTimer>();
+
+            const auto sendRequest = [socket, sentRequestsCount, requestTimer]
+            {
+                requestTimer->start();
+                socket->write(REQUEST);
+                ++*sentRequestsCount;
+            };
+            QObject::connect(socket, &QTcpSocket::connected, socket, sendRequest);
+            QObject::connect(socket, &QTcpSocket::readyRead, socket
+                    , [&, socket, receivedData, sentRequestsCount, requestTimer, sendRequest]
+            {
+                receivedData->append(socket->readAll());
+                for (qsizetype end = receivedData->indexOf(RESPONSE_END); end >= 0; end = receivedData->indexOf(RESPONSE_END))
+                {
+                    receivedData->remove(0, (end + RESPONSE_END.size()));
+                    latencies.append(requestTimer->nsecsElapsed());
+
+                    if (*sentRequestsCount < requestsPerConnection)
+                        sendRequest();
+                    else if (--activeConnectionsCount == 0)
+                        eventLoop.quit();
+                }
+            });
+            QObject::connect(socket, &QTcpSocket::disconnected, &eventLoop, &QEventLoop::quit);
+
+            socket->connectToHost(QHostAddress::LocalHost, port);
+        }
+
+        QTimer::singleShot(60s, &eventLoop, &QEventLoop::quit);
+        eventLoop.exec();
+
+        return latencies;
+    }
+
+    // Nearest-rank percentile
+    qint64 percentile(QList<qint64> values, const double percent)
+    {
+        std::ranges::sort(values);
+        const auto rank = static_cast<qsizetype>(std::ceil(percent / 100 * values.size()));
+        return values[std::max<qsizetype>(rank, 1) - 1];
+    }
+}
+
+class TestHttpServer final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestHttpServer)
+
+public:
+    TestHttpServer() = default;
+
+private slots:
+    void testKeepAlive() const
+    {
+        PingHandler handler;
+        Http::Server server {&handler};
+        QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+        QCOMPARE(sendRequests(server.serverPort(), 3, 5).size(), qsizetype {15});
+    }
+
+    void benchmarkThroughput_data() const
+    {
+        QTest::addColumn<int>("connectionsCount");
+
+        QTest::newRow("1 connection") << 1;
+        QTest::newRow("8 connections") << 8;
+        QTest::newRow("64 connections") << 64;
+    }
+
+    void benchmarkThroughput() const
+    {
+        QFETCH(const int, connectionsCount);
+
+        PingHandler handler;
+        Http::Server server {&handler};
+        QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+        const int requestsPerConnection = BENCHMARK_REQUESTS_COUNT / connectionsCount;
+        qsizetype responsesCount = 0;
+        QBENCHMARK
+        {
+            responsesCount = sendRequests(server.serverPort(), connectionsCount, requestsPerConnection).size();
+        }
+        QCOMPARE(responsesCount, qsizetype {connectionsCount * requestsPerConnection});
+    }
+
+    // Reports the latency percentile of requests sent by many concurrent clients
+    void benchmarkLatency_data() const
+    {
+        QTest::addColumn<double>("percent");
+
+        QTest::newRow("p50") << 50.0;
+        QTest::newRow("p99") << 99.0;
+    }
+
+    void benchmarkLatency() const
+    {
+        QFETCH(const double, percent);
+
+        PingHandler handler;
+        Http::Server server {&handler};
+        QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+        const int requestsPerClient = BENCHMARK_REQUESTS_COUNT / LATENCY_CLIENTS_COUNT;
+        const QList<qint64> latencies = sendRequests(server.serverPort(), LATENCY_CLIENTS_COUNT, requestsPerClient);
+        QCOMPARE(latencies.size(), qsizetype {LATENCY_CLIENTS_COUNT * requestsPerClient});
+
+        QTest::setBenchmarkResult(percentile(latencies, percent), QTest::WalltimeNanoseconds);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestHttpServer)
+#include "testhttpserver.moc"
@@ -0,0 +1,370 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <array>
+#include <cstring>
+#include <memory>
+
+#include <QtEndian>
+#include <QHash>
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/net/geoipdatabase.h"
+
+namespace
+{
+    const int LOOKUP_COUNT = 100000;
+
+    // Builds MaxMind DB (https://maxmind.github.io/MaxMind-DB/) with IPv4 networks mapped to "::/96"
+    // and aliased from "::ffff:0:0/96" and "2002::/16" like in the real country databases
+    class DatabaseBuilder
+    {
+    public:
+        DatabaseBuilder()
+            : m_nodes(1)
+        {
+        }
+
+        void addNetwork(const QString &network, const QString &country)
+        {
+            const auto [address, length] = QHostAddress::parseSubnet(network);
+            const bool isIPv4 = (address.protocol() == QAbstractSocket::IPv4Protocol);
+            insert(toBits(address, isIPv4), (isIPv4 ? (96 + length) : length), {.type = Record::Data, .value = dataIndex(country)});
+        }
+
+        QByteArray build()
+        {
+            // IPv4 subtree
+            quint32 ipv4Root = 0;
+            for (int i = 0; i < 96; ++i)
+                ipv4Root = m_nodes[ipv4Root].records[0].value;
+            insert(toBits(QHostAddress(u"::ffff:0:0"_s), false), 96, {.type = Record::Node, .value = ipv4Root});
+            insert(toBits(QHostAddress(u"2002::"_s), false), 16, {.type = Record::Node, .value = ipv4Root});
+
+            const auto nodeCount = static_cast<quint32>(m_nodes.size());
+
+            QByteArray dataSection;
+            QList<quint32> dataOffsets;
+            for (const QString &country : asConst(m_countries))
+            {
+                dataOffsets.append(dataSection.size());
+                dataSection.append("\xE1\x47" "country" "\xE1\x48" "iso_code");
+                dataSection.append(static_cast<char>(0x40 | country.size())).append(country.toLatin1());
+            }
+
+            QByteArray db;
+            const auto appendRecord = [&db, nodeCount, &dataOffsets](const Record &record)
+            {
+                quint32 value = nodeCount;
+                if (record.type == Record::Node)
+                    value = record.value;
+                else if (record.type == Record::Data)
+                    value = nodeCount + 16 + dataOffsets[record.value];
+
+                db.append(static_cast<char>(value >> 16)).append(static_cast<char>(value >> 8)).append(static_cast<char>(value));
+            };
+            for (const Node &node : asConst(m_nodes))
+            {
+                appendRecord(node.records[0]);
+                appendRecord(node.records[1]);
+            }
+
+            db.append(QByteArray(16, '\0'));
+            db.append(dataSection);
+
+            const auto appendKey = [&db](const QByteArray &key)
+            {
+                db.append(static_cast<char>(0x40 | key.size())).append(key);
+            };
+            db.append("\xAB\xCD\xEFMaxMind.com");
+            db.append('\xE7');
+            appendKey("binary_format_major_version");
+            db.append("\xA1\x02", 2);
+            appendKey("binary_format_minor_version");
+            db.append('\xA0');
+            appendKey("ip_version");
+            db.append("\xA1\x06", 2);
+            appendKey("record_size");
+            db.append("\xA1\x18", 2);
+            appendKey("node_count");
+            db.append('\xC4').append(QByteArray(4, '\0'));
+            qToBigEndian(nodeCount, (db.data() + db.size() - 4));
+            appendKey("database_type");
+            appendKey("Test-Country");
+            appendKey("build_epoch");
+            db.append("\x08\x02", 2).append(QByteArray(8, '\0'));
+            qToBigEndian<quint64>(1700000000, (db.data() + db.size() - 8));
+
+            m_nodeCount = nodeCount;
+            m_dataOffsets = dataOffsets;
+            return db;
+        }
+
+        // Lookup by walking the search tree of the built database one bit at a time
+        QString lookupInTree(const QByteArray &db, const QHostAddress &hostAddr) const
+        {
+            const Q_IPV6ADDR addr = hostAddr.toIPv6Address();
+            const auto *data = reinterpret_cast<const uchar *>(db.constData());
+            const uchar *ptr = data;
+            for (int i = 0; i < 16; ++i)
+            {
+                for (int j = 0; j < 8; ++j)
+                {
+                    if ((addr[i] >> (7 - j)) & 1)
+                        ptr += 3;
+
+                    quint32 id = 0;
+                    auto *idPtr = reinterpret_cast<uchar *>(&id);
+                    memcpy(&idPtr[1], ptr, 3);
+                    id = qFromBigEndian(id);
+
+                    if (id == m_nodeCount)
+                        return {};
+                    if (id > m_nodeCount)
+                        return m_countries.value(m_dataOffsets.indexOf(id - m_nodeCount - 16));
+
+                    ptr = data + (id * 6);
+                }
+            }
+
+            return {};
+        }
+
+    private:
+        struct Record
+        {
+            enum Type
+            {
+                Empty,
+                Node,
+                Data
+            };
+
+            Type type = Empty;
+            quint32 value = 0;
+        };
+
+        struct Node
+        {
+            Record records[2];
+        };
+
+        static std::array<bool, 128> toBits(const QHostAddress &address, const bool isIPv4)
+        {
+            const Q_IPV6ADDR addr = isIPv4 ? QHostAddress(u"::"_s).toIPv6Address() : address.toIPv6Address();
+            std::array<bool, 128> bits {};
+            for (int i = 0; i < 128; ++i)
+                bits[i] = (addr[i / 8] >> (7 - (i % 8))) & 1;
+
+            if (isIPv4)
+            {
+                const quint32 ipv4 = address.toIPv4Address();
+                for (int i = 0; i < 32; ++i)
+                    bits[96 + i] = (ipv4 >> (31 - i)) & 1;
+            }
+            return bits;
+        }
+
+        quint32 dataIndex(const QString &country)
+        {
+            if (!m_countries.contains(country))
+                m_countries.append(country);
+            return m_countries.indexOf(country);
+        }
+
+        void insert(const std::array<bool, 128> &bits, const int length, const Record &value)
+        {
+            quint32 node = 0;
+            for (int i = 0; i < (length - 1); ++i)
+            {
+                Record &record = m_nodes[node].records[bits[i]];
+                if (record.type != Record::Node)
+                {
+                    // the new node keeps the data of the network it is split from
+                    m_nodes.append({.records = {record, record}});
+                    m_nodes[node].records[bits[i]] = {.type = Record::Node, .value = static_cast<quint32>(m_nodes.size() - 1)};
+                }
+                node = m_nodes[node].records[bits[i]].value;
+            }
+            m_nodes[node].records[bits[length - 1]] = value;
+        }
+
+        QList<Node> m_nodes;
+        QStringList m_countries;
+        quint32 m_nodeCount = 0;
+        QList<quint32> m_dataOffsets;
+    };
+
+    QList<QHostAddress> randomAddresses(const int count)
+    {
+        QRandomGenerator random {1};
+        QList<QHostAddress> addresses;
+        addresses.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            if ((i % 4) == 3)
+            {
+                Q_IPV6ADDR addr {};
+                const quint64 high = random.generate64();
+                qToBigEndian(high, addr.c);
+                // mostly the networks that are in the database
+                addr[0] = (i % 3) ? 0x20 : addr[0];
+                addr[1] = (i % 3) ? ((i % 2) ? 0x01 : 0x02) : addr[1];
+                addresses.append(QHostAddress(addr));
+            }
+            else
+            {
+                addresses.append(QHostAddress(random.generate()));
+            }
+        }
+        return addresses;
+    }
+}
+
+class TestNetGeoIPDatabase final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestNetGeoIPDatabase)
+
+public:
+    TestNetGeoIPDatabase() = default;
+
+private slots:
+    void initTestCase()
+    {
+        m_builder.addNetwork(u"1.0.0.0/8"_s, u"AU"_s);
+        m_builder.addNetwork(u"1.2.3.0/24"_s, u"CN"_s);
+        m_builder.addNetwork(u"8.8.8.0/24"_s, u"US"_s);
+        m_builder.addNetwork(u"128.0.0.0/2"_s, u"DE"_s);
+        m_builder.addNetwork(u"200.0.0.0/5"_s, u"BR"_s);
+        m_builder.addNetwork(u"2001:db8::/32"_s, u"US"_s);
+        m_builder.addNetwork(u"2001:db8:1::/48"_s, u"NL"_s);
+        m_builder.addNetwork(u"2a00::/12"_s, u"DE"_s);
+        for (int i = 0; i < 4096; ++i)
+            m_builder.addNetwork(u"%1.%2.0.0/16"_s.arg(16 + (i / 256)).arg(i % 256), (((i % 3) == 0) ? u"FR"_s : u"JP"_s));
+        m_data = m_builder.build();
+
+        QString error;
+        m_db.reset(GeoIPDatabase::load(m_data, error));
+        QVERIFY2(m_db, qPrintable(error));
+    }
+
+    void testMetadata() const
+    {
+        QCOMPARE(m_db->type(), u"Test-Country"_s);
+        QCOMPARE(m_db->ipVersion(), quint16 {6});
+        QCOMPARE(m_db->buildEpoch().toSecsSinceEpoch(), 1700000000LL);
+    }
+
+    void testLookup() const
+    {
+        QCOMPARE(m_db->lookup(QHostAddress(u"1.1.1.1"_s)), u"AU"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"1.2.3.4"_s)), u"CN"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"1.2.4.0"_s)), u"AU"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"8.8.8.8"_s)), u"US"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"9.9.9.9"_s)), QString());
+        QCOMPARE(m_db->lookup(QHostAddress(u"191.255.255.255"_s)), u"DE"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"207.255.255.255"_s)), u"BR"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"255.255.255.255"_s)), QString());
+        QCOMPARE(m_db->lookup(QHostAddress(u"0.0.0.0"_s)), QString());
+
+        QCOMPARE(m_db->lookup(QHostAddress(u"2001:db8::1"_s)), u"US"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"2001:db8:1::1"_s)), u"NL"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"2a0f:ffff::1"_s)), u"DE"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"2a10::1"_s)), QString());
+        QCOMPARE(m_db->lookup(QHostAddress(u"::1"_s)), QString());
+
+        // IPv4 aliases
+        QCOMPARE(m_db->lookup(QHostAddress(u"::ffff:1.2.3.4"_s)), u"CN"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"::8.8.8.8"_s)), u"US"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"2002:0102:0304::"_s)), u"CN"_s);
+        QCOMPARE(m_db->lookup(QHostAddress(u"2002:0808:0808:ffff::"_s)), u"US"_s);
+    }
+
+    void testLookupMatchesTree() const
+    {
+        const QList<QHostAddress> addresses = randomAddresses(10000);
+        for (const QHostAddress &address : addresses)
+            QCOMPARE(m_db->lookup(address), m_builder.lookupInTree(m_data, address));
+
+        QStringList expected;
+        for (const QHostAddress &address : addresses)
+            expected.append(m_builder.lookupInTree(m_data, address));
+        QCOMPARE(m_db->lookup(addresses), expected);
+    }
+
+    void testInvalidDatabase() const
+    {
+        QString error;
+        const std::unique_ptr<GeoIPDatabase> db {GeoIPDatabase::load(m_data.first(m_data.size() / 2), error)};
+        QVERIFY(!db);
+        QVERIFY(!error.isEmpty());
+    }
+
+    void benchmarkTreeWalk() const
+    {
+        const QList<QHostAddress> addresses = randomAddresses(LOOKUP_COUNT);
+        QBENCHMARK
+        {
+            for (const QHostAddress &address : addresses)
+                m_builder.lookupInTree(m_data, address);
+        }
+    }
+
+    void benchmarkLookup() const
+    {
+        const QList<QHostAddress> addresses = randomAddresses(LOOKUP_COUNT);
+        QBENCHMARK
+        {
+            for (const QHostAddress &address : addresses)
+                m_db->lookup(address);
+        }
+    }
+
+    void benchmarkBatchLookup() const
+    {
+        const QList<QHostAddress> addresses = randomAddresses(LOOKUP_COUNT);
+        QBENCHMARK
+        {
+            m_db->lookup(addresses);
+        }
+    }
+
+private:
+    DatabaseBuilder m_builder;
+    QByteArray m_data;
+    std::unique_ptr<GeoIPDatabase> m_db;
+};
+
+QTEST_APPLESS_MAIN(TestNetGeoIPDatabase)
+#include "testnetgeoipdatabase.moc"
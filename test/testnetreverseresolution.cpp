@@ -0,0 +1,214 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <chrono>
+#include <functional>
+#include <utility>
+
+#include <QHash>
+#include <QHostAddress>
+#include <QHostInfo>
+#include <QList>
+#include <QObject>
+#include <QTest>
+
+#include "base/global.h"
+#include "base/net/reverseresolution.h"
+
+using namespace std::chrono_literals;
+
+using Net::ReverseResolution;
+
+namespace
+{
+    const QHostAddress IP1 {u"192.0.2.1"_s};
+    const QHostAddress IP2 {u"192.0.2.2"_s};
+    const QHostAddress IP3 {u"192.0.2.3"_s};
+    const QHostAddress IP4 {u"192.0.2.4"_s};
+    const QHostAddress IP5 {u"192.0.2.5"_s};
+
+    // Records lookups instead of querying DNS, they are finished by the test
+    class FakeHostLookups
+    {
+    public:
+        struct Lookup
+        {
+            int id = 0;
+            QHostAddress ip;
+            std::function<void (const QHostInfo &host)> handler;
+        };
+
+        ReverseResolution::Options options()
+        {
+            ReverseResolution::Options options;
+            options.lookupHost = [this](const QHostAddress &ip, std::function<void (const QHostInfo &host)> handler)
+            {
+                m_lookups.append({.id = ++m_lastLookupId, .ip = ip, .handler = std::move(handler)});
+                return m_lastLookupId;
+            };
+            options.abortHostLookup = [](int) {};
+            return options;
+        }
+
+        qsizetype count() const
+        {
+            return m_lookups.size();
+        }
+
+        QList<QHostAddress> ips() const
+        {
+            QList<QHostAddress> result;
+            for (const Lookup &lookup : m_lookups)
+                result.append(lookup.ip);
+            return result;
+        }
+
+        // Finishes the oldest lookup
+        void finish(const QString &hostname, const QHostInfo::HostInfoError error = QHostInfo::NoError)
+        {
+            const Lookup lookup = m_lookups.takeFirst();
+            QHostInfo host {lookup.id};
+            host.setHostName(hostname);
+            host.setError(error);
+            lookup.handler(host);
+        }
+
+    private:
+        QList<Lookup> m_lookups; // unfinished ones
+        int m_lastLookupId = 0;
+    };
+}
+
+class TestNetReverseResolution final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestNetReverseResolution)
+
+public:
+    TestNetReverseResolution() = default;
+
+private slots:
+    void testDeduplication() const
+    {
+        FakeHostLookups lookups;
+        ReverseResolution resolver {lookups.options()};
+
+        QHash<QHostAddress, QString> resolved;
+        connect(&resolver, &ReverseResolution::ipResolved, &resolver, [&resolved](const QHostAddress &ip, const QString &hostname)
+        {
+            QVERIFY(!resolved.contains(ip));
+            resolved.insert(ip, hostname);
+        });
+
+        QVERIFY(resolver.resolve(IP1).isEmpty());
+        QVERIFY(resolver.resolve(IP1).isEmpty());
+        QVERIFY(resolver.resolve({IP1, IP1, IP2}).isEmpty());
+        QCOMPARE(lookups.ips(), (QList<QHostAddress> {IP1, IP2}));
+        QCOMPARE(resolver.statistics().lookups, quint64 {2});
+        QCOMPARE(resolver.statistics().cacheMisses, quint64 {5});
+
+        lookups.finish(u"peer1.example.org"_s);
+        QCOMPARE(resolved.value(IP1), u"peer1.example.org"_s);
+
+        // found name is cached
+        QCOMPARE(resolver.resolve(IP1), u"peer1.example.org"_s);
+        const QHash<QHostAddress, QString> hostnames = resolver.resolve({IP1, IP2});
+        QCOMPARE(hostnames, (QHash<QHostAddress, QString> {{IP1, u"peer1.example.org"_s}}));
+        QCOMPARE(lookups.count(), qsizetype {1});
+        QCOMPARE(resolver.statistics().cacheHits, quint64 {2});
+
+        lookups.finish(u"peer2.example.org"_s);
+        QCOMPARE(resolved.size(), qsizetype {2});
+        QCOMPARE(resolver.statistics().lookups, quint64 {2});
+        QCOMPARE(resolver.statistics().activeLookups, qsizetype {0});
+    }
+
+    void testQueueLimit() const
+    {
+        FakeHostLookups lookups;
+        ReverseResolution::Options options = lookups.options();
+        options.maxConcurrentLookups = 1;
+        options.maxQueueSize = 2;
+        ReverseResolution resolver {options};
+
+        resolver.resolve(IP1);
+        resolver.resolve({IP2, IP3, IP4, IP5});
+        QCOMPARE(lookups.ips(), (QList<QHostAddress> {IP1}));
+        QCOMPARE(resolver.statistics().activeLookups, qsizetype {1});
+        QCOMPARE(resolver.statistics().queueDepth, qsizetype {2});
+        QCOMPARE(resolver.statistics().droppedRequests, quint64 {2});
+
+        // queued address isn't counted as dropped again
+        resolver.resolve(IP2);
+        QCOMPARE(resolver.statistics().droppedRequests, quint64 {2});
+
+        // next queued address is looked up once a slot is free
+        lookups.finish(u"peer1.example.org"_s);
+        QCOMPARE(lookups.ips(), (QList<QHostAddress> {IP2}));
+        QCOMPARE(resolver.statistics().queueDepth, qsizetype {1});
+
+        // there is a room for dropped address now
+        resolver.resolve(IP4);
+        QCOMPARE(resolver.statistics().queueDepth, qsizetype {2});
+        QCOMPARE(resolver.statistics().droppedRequests, quint64 {2});
+
+        lookups.finish(u"peer2.example.org"_s);
+        lookups.finish(u"peer3.example.org"_s);
+        QCOMPARE(lookups.ips(), (QList<QHostAddress> {IP4}));
+        QCOMPARE(resolver.statistics().queueDepth, qsizetype {0});
+    }
+
+    void testNegativeCache() const
+    {
+        FakeHostLookups lookups;
+        ReverseResolution::Options options = lookups.options();
+        options.negativeTTL = 50ms;
+        options.failureTTL = 10min;
+        ReverseResolution resolver {options};
+
+        resolver.resolve({IP1, IP2, IP3});
+        lookups.finish({}, QHostInfo::HostNotFound);
+        lookups.finish(IP2.toString()); // name is the address itself
+        lookups.finish({}, QHostInfo::UnknownError);
+        QCOMPARE(resolver.statistics().failedLookups, quint64 {2});
+
+        QVERIFY(resolver.resolve({IP1, IP2, IP3}).isEmpty());
+        QCOMPARE(lookups.count(), qsizetype {0});
+        QCOMPARE(resolver.statistics().negativeCacheHits, quint64 {3});
+
+        // failures other than missing names expire later
+        QTest::qSleep(100);
+        QVERIFY(resolver.resolve({IP1, IP2, IP3}).isEmpty());
+        QCOMPARE(lookups.ips(), (QList<QHostAddress> {IP1, IP2}));
+        QCOMPARE(resolver.statistics().negativeCacheHits, quint64 {4});
+        QCOMPARE(resolver.statistics().lookups, quint64 {5});
+    }
+};
+
+QTEST_APPLESS_MAIN(TestNetReverseResolution)
+#include "testnetreverseresolution.moc"
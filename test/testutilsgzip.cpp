@@ -65,6 +65,31 @@ private slots:
         QVERIFY(ok);
         QCOMPARE(decompressedData, data);
     }
+
+    void testStreamCompressor() const
+    {
+        const QByteArray data1 = QByteArrayLiteral("abc").repeated(1000);
+        const QByteArray data2 = QByteArrayLiteral("def").repeated(1000);
+
+        Utils::Gzip::StreamCompressor compressor;
+        QVERIFY(compressor.isValid());
+
+        QByteArray compressedData = compressor.compress(data1);
+        QVERIFY(!compressedData.isEmpty());
+        // data is flushed, so even a short chunk (e.g. an event of event stream) can be decompressed right away
+        const QByteArray eventData = compressor.compress(QByteArrayLiteral("data: {}\n\n"));
+        QVERIFY(eventData.endsWith(QByteArrayView("\x00\x00\xff\xff", 4)));
+        compressedData += eventData;
+        compressedData += compressor.compress({});
+        compressedData += compressor.compress(data2);
+        compressedData += compressor.finish();
+        QVERIFY(!compressor.isValid());
+
+        bool ok = false;
+        const QByteArray decompressedData = Utils::Gzip::decompress(compressedData, &ok);
+        QVERIFY(ok);
+        QCOMPARE(decompressedData, (data1 + QByteArrayLiteral("data: {}\n\n") + data2));
+    }
 };
 
 QTEST_APPLESS_MAIN(TestUtilsGzip)
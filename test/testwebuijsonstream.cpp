@@ -0,0 +1,220 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <QCborValue>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QTest>
+
+#include "base/global.h"
+#include "webui/api/jsonstream.h"
+
+namespace
+{
+    const qsizetype TORRENT_COUNT = 10000;
+
+    // resembles the data of "torrents/info" and "sync/maindata"
+    QJsonObject makeTorrent(const qsizetype index)
+    {
+        const double progress = (index % 1000) / 1000.0;
+        return {
+            {u"hash"_s, QString::number((index * 2654435761), 16).repeated(5).left(40)},
+            {u"name"_s, u"Some.Linux.Distribution.%1.x86_64.iso"_s.arg(index)},
+            {u"size"_s, (index * 1048576)},
+            {u"total_size"_s, (index * 1048576)},
+            {u"progress"_s, progress},
+            {u"dlspeed"_s, (index % 7) * 1024},
+            {u"upspeed"_s, (index % 5) * 1024},
+            {u"priority"_s, index},
+            {u"num_seeds"_s, index % 50},
+            {u"num_complete"_s, index % 500},
+            {u"num_leechs"_s, index % 30},
+            {u"num_incomplete"_s, index % 300},
+            {u"ratio"_s, (index % 300) / 7.0},
+            {u"popularity"_s, 0.0},
+            {u"eta"_s, 8640000},
+            {u"state"_s, u"stalledUP"_s},
+            {u"seq_dl"_s, false},
+            {u"f_l_piece_prio"_s, false},
+            {u"category"_s, u"linux"_s},
+            {u"tags"_s, u"iso, distro"_s},
+            {u"super_seeding"_s, false},
+            {u"force_start"_s, false},
+            {u"save_path"_s, u"/srv/downloads/linux"_s},
+            {u"download_path"_s, QString()},
+            {u"content_path"_s, u"/srv/downloads/linux/Some.Linux.Distribution.%1.x86_64.iso"_s.arg(index)},
+            {u"root_path"_s, QString()},
+            {u"added_on"_s, (1700000000 + index)},
+            {u"completion_on"_s, (1700003600 + index)},
+            {u"tracker"_s, u"udp://tracker.example.org:6969/announce"_s},
+            {u"trackers_count"_s, 3},
+            {u"dl_limit"_s, -1},
+            {u"up_limit"_s, -1},
+            {u"downloaded"_s, (index * 1048576)},
+            {u"uploaded"_s, (index * 3145728)},
+            {u"downloaded_session"_s, 0},
+            {u"uploaded_session"_s, (index * 1024)},
+            {u"amount_left"_s, 0},
+            {u"completed"_s, (index * 1048576)},
+            {u"max_ratio"_s, -1},
+            {u"max_seeding_time"_s, -1},
+            {u"ratio_limit"_s, -2},
+            {u"seeding_time_limit"_s, -2},
+            {u"seen_complete"_s, (1700007200 + index)},
+            {u"last_activity"_s, (1700007200 + index)},
+            {u"time_active"_s, (3600 + index)},
+            {u"seeding_time"_s, index},
+            {u"auto_tmm"_s, true},
+            {u"availability"_s, -1},
+            {u"reannounce"_s, 1800},
+            {u"comment"_s, QString()},
+            {u"private"_s, false},
+            {u"has_metadata"_s, true}
+        };
+    }
+
+    std::shared_ptr<JSONStream> createTorrentsStream(const qsizetype size, const JSONStream::Format format)
+    {
+        auto stream = JSONStream::createArray(size, [](const qsizetype index) -> std::optional<QJsonObject>
+        {
+            // skipped items must not break the output
+            if ((index % 100) == 99)
+                return std::nullopt;
+            return makeTorrent(index);
+        });
+        stream->setFormat(format);
+        return stream;
+    }
+
+    QByteArray readAll(const std::shared_ptr<JSONStream> &stream)
+    {
+        QByteArray data;
+        while (!stream->atEnd())
+            data += stream->read();
+        return data;
+    }
+
+    QJsonArray expectedTorrents(const qsizetype size)
+    {
+        QJsonArray torrents;
+        for (qsizetype i = 0; i < size; ++i)
+        {
+            if ((i % 100) != 99)
+                torrents.append(makeTorrent(i));
+        }
+        return torrents;
+    }
+}
+
+class TestWebUIJSONStream final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestWebUIJSONStream)
+
+public:
+    TestWebUIJSONStream() = default;
+
+private slots:
+    void testArrayJSON() const
+    {
+        const QByteArray data = readAll(createTorrentsStream(1000, JSONStream::Format::JSON));
+        QCOMPARE(QJsonDocument::fromJson(data).array(), expectedTorrents(1000));
+
+        QCOMPARE(readAll(createTorrentsStream(0, JSONStream::Format::JSON)), QByteArrayLiteral("[]"));
+    }
+
+    void testArrayCBOR() const
+    {
+        const QByteArray data = readAll(createTorrentsStream(1000, JSONStream::Format::CBOR));
+        QCborParserError error;
+        const QCborValue value = QCborValue::fromCbor(data, &error);
+        QCOMPARE(error.error, QCborError::NoError);
+        QCOMPARE(value.toJsonValue().toArray(), expectedTorrents(1000));
+
+        QCOMPARE(QCborValue::fromCbor(readAll(createTorrentsStream(0, JSONStream::Format::CBOR))).toJsonValue().toArray(), QJsonArray());
+    }
+
+    void testObject() const
+    {
+        const QJsonObject object {{u"rid"_s, 5}, {u"full_update"_s, true}};
+        const auto createStream = [&object](const qsizetype size, const JSONStream::Format format)
+        {
+            auto stream = JSONStream::createObject(object, u"torrents"_s, size, [](const qsizetype index) -> std::optional<std::pair<QString, QJsonObject>>
+            {
+                return std::pair {QString::number(index), makeTorrent(index)};
+            });
+            stream->setFormat(format);
+            return stream;
+        };
+
+        QJsonObject torrents;
+        for (qsizetype i = 0; i < 100; ++i)
+            torrents[QString::number(i)] = makeTorrent(i);
+        QJsonObject expected = object;
+        expected[u"torrents"_s] = torrents;
+
+        QCOMPARE(QJsonDocument::fromJson(readAll(createStream(100, JSONStream::Format::JSON))).object(), expected);
+        QCOMPARE(QCborValue::fromCbor(readAll(createStream(100, JSONStream::Format::CBOR))).toJsonValue().toObject(), expected);
+
+        // no additional member without items
+        QCOMPARE(QJsonDocument::fromJson(readAll(createStream(0, JSONStream::Format::JSON))).object(), object);
+        QCOMPARE(QCborValue::fromCbor(readAll(createStream(0, JSONStream::Format::CBOR))).toJsonValue().toObject(), object);
+    }
+
+    void testSerialize() const
+    {
+        const QJsonDocument document {expectedTorrents(100)};
+        QCOMPARE(JSONStream::serialize(document, JSONStream::Format::JSON), document.toJson(QJsonDocument::Compact));
+        QCOMPARE(QCborValue::fromCbor(JSONStream::serialize(document, JSONStream::Format::CBOR)).toJsonValue().toArray(), document.array());
+    }
+
+    void benchmarkJSON() const
+    {
+        qsizetype size = 0;
+        QBENCHMARK
+        {
+            size = readAll(createTorrentsStream(TORRENT_COUNT, JSONStream::Format::JSON)).size();
+        }
+        qInfo("JSON payload of %lld torrents: %lld bytes", static_cast<qlonglong>(TORRENT_COUNT), static_cast<qlonglong>(size));
+    }
+
+    void benchmarkCBOR() const
+    {
+        qsizetype size = 0;
+        QBENCHMARK
+        {
+            size = readAll(createTorrentsStream(TORRENT_COUNT, JSONStream::Format::CBOR)).size();
+        }
+        qInfo("CBOR payload of %lld torrents: %lld bytes", static_cast<qlonglong>(TORRENT_COUNT), static_cast<qlonglong>(size));
+    }
+};
+
+QTEST_APPLESS_MAIN(TestWebUIJSONStream)
+#include "testwebuijsonstream.moc"
@@ -0,0 +1,304 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include <algorithm>
+#include <cstddef>
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QTest>
+#include <QVariantMap>
+
+#include "base/bittorrent/infohash.h"
+#include "base/global.h"
+#include "webui/api/serialize/serialize_torrent.h"
+
+namespace
+{
+    // resembles the data of "sync/maindata"
+    TorrentSnapshot makeSnapshot(const int index)
+    {
+        TorrentSnapshot snapshot;
+        snapshot.infoHashV1 = u"%1"_s.arg(index, 40, 16, QChar(u'0'));
+        snapshot.name = u"Some.Linux.Distribution.%1.x86_64.iso"_s.arg(index);
+        snapshot.hasMetadata = true;
+        snapshot.totalSize = index * 1048576LL;
+        snapshot.size = snapshot.totalSize;
+        snapshot.progress = (index % 1000) / 1000.0;
+        snapshot.dlSpeed = (index % 7) * 1024;
+        snapshot.upSpeed = (index % 5) * 1024;
+        snapshot.queuePosition = index;
+        snapshot.seeds = index % 50;
+        snapshot.leechs = index % 30;
+        snapshot.ratio = (index % 300) / 7.0;
+        snapshot.eta = 8640000;
+        snapshot.state = BitTorrent::TorrentState::StalledUploading;
+        snapshot.category = u"linux"_s;
+        snapshot.tags = u"iso, distro"_s;
+        snapshot.savePath = u"/srv/downloads/linux"_s;
+        snapshot.contentPath = snapshot.savePath + u'/' + snapshot.name;
+        snapshot.addedOn = 1700000000 + index;
+        snapshot.tracker = u"udp://tracker.example.org:6969/announce"_s;
+        snapshot.trackersCount = 3;
+        snapshot.dlLimit = -1;
+        snapshot.upLimit = -1;
+        snapshot.timeActive = index * 60LL;
+        return snapshot;
+    }
+
+    QList<TorrentSnapshot> makeSnapshots(const int count)
+    {
+        QList<TorrentSnapshot> snapshots;
+        snapshots.reserve(count);
+        for (int i = 0; i < count; ++i)
+            snapshots.append(makeSnapshot(i));
+        return snapshots;
+    }
+
+    void addTorrentsCountRows()
+    {
+        QTest::addColumn<int>("torrentsCount");
+
+        QTest::newRow("1k torrents") << 1'000;
+        QTest::newRow("10k torrents") << 10'000;
+        QTest::newRow("50k torrents") << 50'000;
+    }
+
+    // Finds changed fields the way sync/maindata did before torrent snapshots were introduced,
+    // i.e. by comparing maps of all the serialized fields (see processMap() in synccontroller.cpp)
+    QVariantMap diffVariantMaps(const QVariantMap &prevData, const QVariantMap &data)
+    {
+        QVariantMap syncData;
+        for (auto i = data.cbegin(); i != data.cend(); ++i)
+        {
+            if (prevData[i.key()] != i.value())
+                syncData[i.key()] = i.value();
+        }
+
+        return syncData;
+    }
+
+    // Changes transfer statistics of every 20th torrent, like a typical refresh interval does
+    QList<TorrentSnapshot> updateSnapshots(QList<TorrentSnapshot> snapshots)
+    {
+        for (qsizetype i = 0; i < snapshots.size(); i += 20)
+        {
+            TorrentSnapshot &snapshot = snapshots[i];
+            snapshot.dlSpeed += 1024;
+            snapshot.upSpeed += 512;
+            snapshot.timeActive += 1;
+        }
+        return snapshots;
+    }
+}
+
+class TestWebUITorrentSnapshot final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TestWebUITorrentSnapshot)
+
+public:
+    TestWebUITorrentSnapshot() = default;
+
+private slots:
+    void testChangedFields() const
+    {
+        const TorrentSnapshot prevSnapshot = makeSnapshot(1);
+        QVERIFY(changedSnapshotFields(prevSnapshot, prevSnapshot).none());
+
+        TorrentSnapshot snapshot = prevSnapshot;
+        snapshot.name = u"Renamed"_s;
+        snapshot.dlSpeed = 4096;
+
+        const TorrentSnapshotFields fields = changedSnapshotFields(prevSnapshot, snapshot);
+        QCOMPARE(fields.count(), std::size_t {2});
+        QVERIFY(fields.test(snapshotFieldIndex(KEY_TORRENT_NAME)));
+        QVERIFY(fields.test(snapshotFieldIndex(KEY_TORRENT_DLSPEED)));
+
+        QJsonObject serialized;
+        serializeSnapshot(snapshot, fields, serialized);
+        const QJsonObject expected {{KEY_TORRENT_NAME, u"Renamed"_s}, {KEY_TORRENT_DLSPEED, 4096}};
+        QCOMPARE(serialized, expected);
+
+        // the previous approach finds the same changes
+        const QVariantMap syncData = diffVariantMaps(snapshotToVariantMap(prevSnapshot), snapshotToVariantMap(snapshot));
+        QCOMPARE(QJsonObject::fromVariantMap(syncData), expected);
+
+        QJsonObject fullySerialized;
+        serializeSnapshot(snapshot, fullySerialized);
+        QCOMPARE(fullySerialized.size(), qsizetype {TORRENT_SNAPSHOT_FIELD_COUNT});
+    }
+
+    void benchmarkMaindataDiff_data() const
+    {
+        QTest::addColumn<int>("torrentsCount");
+        QTest::addColumn<bool>("isBaseline");
+
+        for (const int torrentsCount : {1'000, 10'000, 50'000})
+        {
+            QTest::addRow("%dk torrents, QVariantMap diff", (torrentsCount / 1'000)) << torrentsCount << true;
+            QTest::addRow("%dk torrents, snapshot diff", (torrentsCount / 1'000)) << torrentsCount << false;
+        }
+    }
+
+    // Compares the per-refresh cost of finding and serializing changed torrents with the previous approach,
+    // which serialized every torrent into QVariantMap and compared it with the map sent last time
+    void benchmarkMaindataDiff() const
+    {
+        QFETCH(const int, torrentsCount);
+        QFETCH(const bool, isBaseline);
+
+        const QList<TorrentSnapshot> prevSnapshots = makeSnapshots(torrentsCount);
+        const QList<TorrentSnapshot> snapshots = updateSnapshots(prevSnapshots);
+
+        int changedCount = 0;
+        if (isBaseline)
+        {
+            // serialized data of the previous refresh is kept by sync/maindata
+            QList<QVariantMap> prevData;
+            prevData.reserve(prevSnapshots.size());
+            for (const TorrentSnapshot &snapshot : prevSnapshots)
+                prevData.append(snapshotToVariantMap(snapshot));
+
+            QBENCHMARK
+            {
+                changedCount = 0;
+                for (qsizetype i = 0; i < snapshots.size(); ++i)
+                {
+                    const QVariantMap syncData = diffVariantMaps(prevData[i], snapshotToVariantMap(snapshots[i]));
+                    if (syncData.isEmpty())
+                        continue;
+
+                    const QJsonObject serializedTorrent = QJsonObject::fromVariantMap(syncData);
+                    ++changedCount;
+                }
+            }
+        }
+        else
+        {
+            QBENCHMARK
+            {
+                changedCount = 0;
+                for (qsizetype i = 0; i < snapshots.size(); ++i)
+                {
+                    const TorrentSnapshotFields fields = changedSnapshotFields(prevSnapshots[i], snapshots[i]);
+                    if (fields.none())
+                        continue;
+
+                    QJsonObject serializedTorrent;
+                    serializeSnapshot(snapshots[i], fields, serializedTorrent);
+                    ++changedCount;
+                }
+            }
+        }
+        QCOMPARE(changedCount, ((torrentsCount + 19) / 20));
+    }
+
+    void testFieldOrder() const
+    {
+        const TorrentSnapshot snapshot1 = makeSnapshot(1);
+        const TorrentSnapshot snapshot2 = makeSnapshot(2);
+
+        const int dlSpeedIndex = snapshotFieldIndex(KEY_TORRENT_DLSPEED);
+        QVERIFY(dlSpeedIndex >= 0);
+        QVERIFY(isSnapshotFieldLess(dlSpeedIndex, snapshot1, snapshot2));
+        QVERIFY(!isSnapshotFieldLess(dlSpeedIndex, snapshot2, snapshot1));
+        QVERIFY(!isSnapshotFieldLess(dlSpeedIndex, snapshot1, snapshot1));
+
+        QCOMPARE(snapshotFieldIndex(u"unknown"_s), -1);
+    }
+
+    // Keeps torrents sorted by the snapshot field while some of them are changed
+    // and serializes only the requested page, as "torrents/info" does
+    void benchmarkSortedPage_data() const
+    {
+        addTorrentsCountRows();
+    }
+
+    void benchmarkSortedPage() const
+    {
+        QFETCH(const int, torrentsCount);
+
+        QHash<BitTorrent::TorrentID, TorrentSnapshot> snapshots;
+        snapshots.reserve(torrentsCount);
+        for (int i = 0; i < torrentsCount; ++i)
+        {
+            const TorrentSnapshot snapshot = makeSnapshot(i);
+            snapshots.insert(BitTorrent::TorrentID::fromString(snapshot.infoHashV1), snapshot);
+        }
+        const QList<BitTorrent::TorrentID> torrentIDs = snapshots.keys();
+        const auto getSnapshot = [&snapshots](const BitTorrent::TorrentID &torrentID) -> const TorrentSnapshot &
+        {
+            return *snapshots.constFind(torrentID);
+        };
+
+        const int sortFieldIndex = snapshotFieldIndex(KEY_TORRENT_DLSPEED);
+        const auto lessThan = snapshotFieldLessThan(sortFieldIndex, getSnapshot);
+        QList<BitTorrent::TorrentID> sortedTorrentIDs = torrentIDs;
+        std::ranges::sort(sortedTorrentIDs, lessThan);
+
+        const qsizetype pageSize = 100;
+        const qsizetype offset = torrentsCount / 2;
+
+        qsizetype round = 0;
+        QList<QJsonObject> page;
+        QBENCHMARK
+        {
+            // each refresh changes download speed of every 20th torrent
+            QSet<BitTorrent::TorrentID> changedTorrentIDs;
+            for (qsizetype i = (round++ % 20); i < torrentIDs.size(); i += 20)
+            {
+                TorrentSnapshot &snapshot = snapshots[torrentIDs[i]];
+                snapshot.dlSpeed = (snapshot.dlSpeed + 1024) % (8 * 1024);
+                changedTorrentIDs.insert(torrentIDs[i]);
+            }
+            updateSnapshotSortOrder(sortFieldIndex, sortedTorrentIDs, changedTorrentIDs, {}, getSnapshot);
+
+            page.clear();
+            page.reserve(pageSize);
+            for (qsizetype i = offset; i < (offset + pageSize); ++i)
+            {
+                QJsonObject serializedTorrent;
+                serializeSnapshot(getSnapshot(sortedTorrentIDs[i]), serializedTorrent);
+                page.append(serializedTorrent);
+            }
+        }
+
+        QCOMPARE(sortedTorrentIDs.size(), torrentIDs.size());
+        QVERIFY(std::ranges::is_sorted(sortedTorrentIDs, lessThan));
+        QCOMPARE(page.size(), pageSize);
+        for (qsizetype i = 1; i < page.size(); ++i)
+            QVERIFY(page[i - 1][KEY_TORRENT_DLSPEED].toInt() <= page[i][KEY_TORRENT_DLSPEED].toInt());
+    }
+};
+
+QTEST_APPLESS_MAIN(TestWebUITorrentSnapshot)
+#include "testwebuitorrentsnapshot.moc"